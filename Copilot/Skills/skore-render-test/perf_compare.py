@@ -134,9 +134,9 @@ def check_regressions(cur_stats, bas_stats, cur_json, bas_json):
         # thermal transitions) — display them but don't gate commits.
         if marker.endswith("_gpu"):
             continue
-        # PipelineSync measures glFinish/Flush wait time — it is entirely
-        # driven by GPU load and scheduling jitter, not CPU logic.
-        if "PipelineSync" in marker:
+        # GpuWait (PipelineSync in older runs) measures the CPU blocking on the
+        # GPU — it is entirely driven by GPU load and scheduling jitter, not CPU logic.
+        if "GpuWait" in marker or "PipelineSync" in marker:
             continue
         pm = bas_stats.get(marker)
         if not pm:
@@ -0,0 +1,98 @@
+"""
+y4m_frame.py — Pull single frames out of a `capture_video` stream as PNG.
+
+Usage:
+    py y4m_frame.py <capture.y4m> --info
+    py y4m_frame.py <capture.y4m> --frame <N> --out <frame.png>
+    py y4m_frame.py <capture.y4m> --all --out-dir <dir>
+
+Reads the 4:2:0 YUV4MPEG2 files written by SkullbonezCore (BT.601 full range,
+C420jpeg).  Frames are fixed-size, so frame N is read with a single seek.
+"""
+import argparse
+import sys
+from pathlib import Path
+
+from PIL import Image
+
+
+# ── stream ───────────────────────────────────────────────────────────────────
+
+class Y4mStream:
+    def __init__(self, path):
+        self.file = open(path, "rb")
+        header = self.file.readline()
+        if not header.startswith(b"YUV4MPEG2 "):
+            raise ValueError(f"{path} is not a YUV4MPEG2 file")
+
+        self.width = self.height = 0
+        self.rate = "?"
+        for token in header.split()[1:]:
+            tag, value = token[:1], token[1:].decode()
+            if tag == b"W": self.width = int(value)
+            elif tag == b"H": self.height = int(value)
+            elif tag == b"F": self.rate = value
+            elif tag == b"C" and not value.startswith("420"):
+                raise ValueError(f"Unsupported chroma layout C{value}")
+
+        self.data_start = self.file.tell()
+        self.luma_bytes = self.width * self.height
+        self.chroma_bytes = (self.width // 2) * (self.height // 2)
+        self.frame_bytes = len(b"FRAME\n") + self.luma_bytes + 2 * self.chroma_bytes
+
+        self.file.seek(0, 2)
+        self.frame_count = (self.file.tell() - self.data_start) // self.frame_bytes
+
+    def read_frame(self, index):
+        if not 0 <= index < self.frame_count:
+            raise IndexError(f"Frame {index} out of range (0..{self.frame_count - 1})")
+
+        self.file.seek(self.data_start + index * self.frame_bytes)
+        if self.file.readline() != b"FRAME\n":
+            raise ValueError(f"Frame {index} has no FRAME marker")
+
+        size = (self.width, self.height)
+        half = (self.width // 2, self.height // 2)
+        y  = Image.frombytes("L", size, self.file.read(self.luma_bytes))
+        cb = Image.frombytes("L", half, self.file.read(self.chroma_bytes)).resize(size, Image.BILINEAR)
+        cr = Image.frombytes("L", half, self.file.read(self.chroma_bytes)).resize(size, Image.BILINEAR)
+        return Image.merge("YCbCr", (y, cb, cr)).convert("RGB")
+
+
+# ── main ─────────────────────────────────────────────────────────────────────
+
+def main():
+    parser = argparse.ArgumentParser(description="Extract frames from a SkullbonezCore Y4M capture.")
+    parser.add_argument("video", type=Path, help="Capture written by the capture_video scene directive")
+    parser.add_argument("--info", action="store_true", help="Print size, rate and frame count")
+    parser.add_argument("--frame", type=int, help="Frame index to extract (0-based)")
+    parser.add_argument("--out", type=Path, help="Output PNG for --frame")
+    parser.add_argument("--all", action="store_true", help="Extract every frame")
+    parser.add_argument("--out-dir", type=Path, help="Output directory for --all")
+    args = parser.parse_args()
+
+    if not args.video.exists():
+        print(f"ERROR: Video not found: {args.video}"); return 1
+
+    stream = Y4mStream(args.video)
+    if args.info or (args.frame is None and not args.all):
+        print(f"{args.video}: {stream.width}x{stream.height}, F{stream.rate}, {stream.frame_count} frames")
+        return 0
+
+    if args.frame is not None:
+        out = args.out or args.video.with_name(f"{args.video.stem}_{args.frame:04d}.png")
+        stream.read_frame(args.frame).save(out)
+        print(f"Wrote {out}")
+
+    if args.all:
+        out_dir = args.out_dir or args.video.parent
+        out_dir.mkdir(parents=True, exist_ok=True)
+        for i in range(stream.frame_count):
+            stream.read_frame(i).save(out_dir / f"capture_{i + 1:04d}.png")
+        print(f"Wrote {stream.frame_count} frames to {out_dir}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
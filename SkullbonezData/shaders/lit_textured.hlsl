@@ -22,7 +22,7 @@ SamplerState sSampler0 : register(s0);
 struct VS_IN
 {
     float3 position : POSITION;
-    float3 normal   : NORMAL;
+    float3 normal   : NORMAL;     // R10G10B10A2_UNORM, biased to [0,1]
     float2 texCoord : TEXCOORD0;
 };
 
@@ -46,7 +46,7 @@ VS_OUT main_vs(VS_IN input)
     output.clipDist = dot(mul(uModel, float4(input.position, 1.0)), uClipPlane);
 
     output.viewPos  = viewPos.xyz;
-    output.normal   = mul((float3x3)modelView, input.normal);
+    output.normal   = mul((float3x3)modelView, input.normal * 2.0 - 1.0);
     output.texCoord = input.texCoord;
 
     return output;
@@ -6,7 +6,7 @@
 // Default (0,1,0,1e9) always passes — enable GL_CLIP_DISTANCE0 only when needed.
 
 layout(location = 0) in vec3 aPosition;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec3 aNormal;      // packed 10:10:10:2, biased to [0,1]
 layout(location = 2) in vec2 aTexCoord;
 
 uniform mat4 uModel;
@@ -28,6 +28,6 @@ void main()
     gl_ClipDistance[0] = dot(uModel * vec4(aPosition, 1.0), uClipPlane);
 
     vViewPos  = viewPos.xyz;
-    vNormal   = transpose(inverse(mat3(modelView))) * aNormal;
+    vNormal   = transpose(inverse(mat3(modelView))) * (aNormal * 2.0 - 1.0);
     vTexCoord = aTexCoord;
 }
@@ -1,5 +1,5 @@
 // Phong lighting + texture: instanced shader (HLSL 5.0, combined VS+PS)
-// Per-instance model matrix arrives via vertex attributes.
+// Per-instance centre + radius and orientation quaternion arrive via vertex attributes.
 // Column-major matrices — uploaded directly from engine Matrix4 without transposing.
 
 #pragma pack_matrix(column_major)
@@ -21,13 +21,11 @@ SamplerState sSampler0 : register(s0);
 
 struct VS_IN
 {
-    float3 position : POSITION;
-    float3 normal   : NORMAL;
-    float2 texCoord : TEXCOORD0;
-    float4 model0   : TEXCOORD1;
-    float4 model1   : TEXCOORD2;
-    float4 model2   : TEXCOORD3;
-    float4 model3   : TEXCOORD4;
+    float3 position    : POSITION;
+    float3 normal      : NORMAL;
+    float2 texCoord    : TEXCOORD0;
+    float4 posRadius   : TEXCOORD1;
+    float4 orientation : TEXCOORD2;
 };
 
 struct VS_OUT
@@ -39,22 +37,33 @@ struct VS_OUT
     float2 texCoord  : TEXCOORD2;
 };
 
+// Rotation matrix of a unit quaternion (x, y, z, w), for use as mul(R, v)
+float3x3 QuaternionToMatrix(float4 q)
+{
+    q = normalize(q);
+    float3 q2 = q.xyz * 2.0;
+    float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+    float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+    float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+    return float3x3(1.0 - yy - zz, xy - wz,       xz + wy,
+                    xy + wz,       1.0 - xx - zz, yz - wx,
+                    xz - wy,       yz + wx,       1.0 - xx - yy);
+}
+
 VS_OUT main_vs(VS_IN input)
 {
     VS_OUT output;
 
-    // Instance data arrives as columns (matching GL convention) but float4x4()
-    // assembles them as rows — transpose to get the correct orientation.
-    float4x4 model = transpose(float4x4(input.model0, input.model1, input.model2, input.model3));
-
-    float4x4 modelView = mul(uView, model);
-    float4 viewPos     = mul(modelView, float4(input.position, 1.0));
-    output.position    = mul(uProjection, viewPos);
+    float3x3 rotation = QuaternionToMatrix(input.orientation);
+    float3 worldPos   = input.posRadius.xyz + mul(rotation, input.position * input.posRadius.w);
+    float4 viewPos    = mul(uView, float4(worldPos, 1.0));
+    output.position   = mul(uProjection, viewPos);
 
-    output.clipDist = dot(mul(model, float4(input.position, 1.0)), uClipPlane);
+    output.clipDist = dot(float4(worldPos, 1.0), uClipPlane);
 
+    // Rigid rotation + uniform scale: the normal matrix is the rotation itself
     output.viewPos  = viewPos.xyz;
-    output.normal   = mul((float3x3)modelView, input.normal);
+    output.normal   = mul((float3x3)uView, mul(rotation, input.normal));
     output.texCoord = input.texCoord;
 
     return output;
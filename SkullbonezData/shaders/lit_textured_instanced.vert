@@ -1,13 +1,15 @@
 #version 330 core
 
 // Phong lighting + texture: instanced vertex shader
-// Per-instance model matrix arrives via vertex attributes (divisor=1).
+// Per-instance compact transform arrives via vertex attributes (divisor=1):
+// centre + uniform scale, and orientation as a unit quaternion (x, y, z, w).
 // View, projection, lighting, and clip plane are shared via uniforms.
 
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
-layout(location = 3) in mat4 aModel;          // per-instance model matrix (locations 3-6)
+layout(location = 3) in vec4 aPosRadius;      // per-instance centre (xyz) and radius (w)
+layout(location = 4) in vec4 aOrientation;    // per-instance rotation quaternion
 
 uniform mat4 uView;
 uniform mat4 uProjection;
@@ -18,15 +20,29 @@ out vec3 vViewPos;
 out vec3 vNormal;
 out vec2 vTexCoord;
 
+mat3 QuaternionToMat3(vec4 q)
+{
+    q = normalize(q);
+    vec3 q2 = q.xyz * 2.0;
+    float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+    float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+    float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+    return mat3(1.0 - yy - zz, xy + wz,       xz - wy,
+                xy - wz,       1.0 - xx - zz, yz + wx,
+                xz + wy,       yz - wx,       1.0 - xx - yy);
+}
+
 void main()
 {
-    mat4 modelView = uView * aModel;
-    vec4 viewPos   = modelView * vec4(aPosition, 1.0);
+    mat3 rotation  = QuaternionToMat3(aOrientation);
+    vec3 worldPos  = aPosRadius.xyz + rotation * (aPosition * aPosRadius.w);
+    vec4 viewPos   = uView * vec4(worldPos, 1.0);
     gl_Position    = uProjection * viewPos;
 
-    gl_ClipDistance[0] = dot(aModel * vec4(aPosition, 1.0), uClipPlane);
+    gl_ClipDistance[0] = dot(vec4(worldPos, 1.0), uClipPlane);
 
+    // Rigid rotation + uniform scale: the normal matrix is the rotation itself
     vViewPos  = viewPos.xyz;
-    vNormal   = transpose(inverse(mat3(modelView))) * aNormal;
+    vNormal   = mat3(uView) * (rotation * aNormal);
     vTexCoord = aTexCoord;
 }
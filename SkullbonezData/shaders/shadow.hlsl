@@ -1,5 +1,6 @@
 // Instanced shadow decal shader (HLSL 5.0, combined VS+PS)
-// Static disc geometry drawn via DrawInstanced. Per-instance model matrix and alpha.
+// Static disc geometry drawn via DrawInstanced. Per-instance ground point + radius and
+// terrain normal + alpha; the disc is tilted onto the terrain here rather than on the CPU.
 
 #pragma pack_matrix(column_major)
 
@@ -11,12 +12,9 @@ cbuffer Uniforms : register(b0)
 
 struct VS_IN
 {
-    float3 position : POSITION;
-    float4 model0   : TEXCOORD1;
-    float4 model1   : TEXCOORD2;
-    float4 model2   : TEXCOORD3;
-    float4 model3   : TEXCOORD4;
-    float  alpha    : TEXCOORD5;
+    float3 position    : POSITION;
+    float4 posRadius   : TEXCOORD1;
+    float4 normalAlpha : TEXCOORD2;
 };
 
 struct VS_OUT
@@ -29,14 +27,19 @@ VS_OUT main_vs(VS_IN input)
 {
     VS_OUT output;
 
-    // Instance data arrives as columns (matching GL convention) but float4x4()
-    // assembles them as rows — transpose to get the correct orientation.
-    float4x4 model = transpose(float4x4(input.model0, input.model1, input.model2, input.model3));
-    float4 worldPos = mul(model, float4(input.position, 1.0));
-    output.position = mul(uProjection, mul(uView, worldPos));
+    // Shortest-arc rotation taking +Y onto the terrain normal N (N.y > 0 on a heightfield):
+    // R = c*I + [v]x + v*v^T / (1 + c) with v = Y x N = (N.z, 0, -N.x), c = N.y
+    float3 N = input.normalAlpha.xyz;
+    float k  = 1.0 / (1.0 + N.y);
+    float3x3 rotation = float3x3(N.y + k * N.z * N.z, N.x,  -k * N.x * N.z,
+                                 -N.x,                N.y,  -N.z,
+                                 -k * N.x * N.z,      N.z,  N.y + k * N.x * N.x);
+
+    float3 worldPos = input.posRadius.xyz + mul(rotation, input.position * input.posRadius.w);
+    output.position = mul(uProjection, mul(uView, float4(worldPos, 1.0)));
 
     float distFromCenter = length(input.position.xz);
-    output.alpha = input.alpha * (1.0 - distFromCenter);
+    output.alpha = input.normalAlpha.w * (1.0 - distFromCenter);
 
     return output;
 }
@@ -2,11 +2,12 @@
 
 // Instanced shadow decal: vertex shader
 // Static disc geometry drawn once per instance via glDrawArraysInstanced.
-// Per-instance model matrix and alpha arrive via vertex attributes (divisor=1).
+// Per-instance ground point + radius and terrain normal + alpha arrive via vertex attributes
+// (divisor=1); the disc is tilted onto the terrain here rather than on the CPU.
 
 layout(location = 0) in vec3 aPosition;      // disc vertex (unit radius, XZ plane)
-layout(location = 3) in mat4 aModel;          // per-instance model matrix (locations 3-6)
-layout(location = 7) in float aAlpha;         // per-instance shadow opacity
+layout(location = 3) in vec4 aPosRadius;      // per-instance disc centre (xyz) and radius (w)
+layout(location = 4) in vec4 aNormalAlpha;    // per-instance terrain normal (xyz) and shadow opacity (w)
 
 uniform mat4 uView;
 uniform mat4 uProjection;
@@ -15,9 +16,18 @@ out float vAlpha;
 
 void main()
 {
-    gl_Position = uProjection * uView * aModel * vec4(aPosition, 1.0);
+    // Shortest-arc rotation taking +Y onto the terrain normal N (N.y > 0 on a heightfield):
+    // R = c*I + [v]x + v*v^T / (1 + c) with v = Y x N = (N.z, 0, -N.x), c = N.y
+    vec3 N  = aNormalAlpha.xyz;
+    float k = 1.0 / (1.0 + N.y);
+    mat3 rotation = mat3(N.y + k * N.z * N.z, -N.x, -k * N.x * N.z,
+                         N.x,                 N.y,  N.z,
+                         -k * N.x * N.z,      -N.z, N.y + k * N.x * N.x);
+
+    vec3 worldPos = aPosRadius.xyz + rotation * (aPosition * aPosRadius.w);
+    gl_Position = uProjection * uView * vec4(worldPos, 1.0);
 
     // Center vertex (0,0,0) gets full alpha; edge vertices fade to zero
     float distFromCenter = length(aPosition.xz);
-    vAlpha = aAlpha * (1.0 - distFromCenter);
+    vAlpha = aNormalAlpha.w * (1.0 - distFromCenter);
 }
@@ -0,0 +1,76 @@
+#version 330 core
+
+// Ray-cast sphere impostor: fragment shader
+// Intersects the eye ray with the sphere, writes the true surface depth, and shades the hit with
+// the same Phong model as lit_textured_instanced. The user clip plane is evaluated per fragment.
+
+uniform mat4 uProjection;
+uniform vec4 uLightPosition;
+uniform vec4 uLightAmbient;
+uniform vec4 uLightDiffuse;
+uniform vec4 uMaterialAmbient;
+uniform vec4 uMaterialDiffuse;
+uniform sampler2D uTexture;
+
+in vec3 vViewPos;
+flat in vec3 vCenter;
+flat in float vRadius;
+flat in vec3 vAxisX;
+flat in vec3 vAxisY;
+flat in vec3 vAxisZ;
+flat in vec4 vClip;
+
+out vec4 FragColor;
+
+const float PI = 3.14159265;
+
+void main()
+{
+    // Nearest eye-ray / sphere intersection
+    vec3 dir    = normalize(vViewPos);
+    float b     = dot(dir, vCenter);
+    float c     = dot(vCenter, vCenter) - vRadius * vRadius;
+    float disc  = b * b - c;
+    if (disc < 0.0)
+        discard;
+
+    vec3 hit    = dir * (b - sqrt(disc));
+    vec3 offset = hit - vCenter;
+    if (vClip.w + dot(vClip.xyz, offset) < 0.0)
+        discard;
+
+    vec4 clipPos = uProjection * vec4(hit, 1.0);
+    gl_FragDepth = (clipPos.z / clipPos.w) * 0.5 + 0.5;
+
+    // Object-space normal → the UV-sphere mesh's (theta, phi) parameterisation
+    vec3 N   = offset / vRadius;
+    vec3 obj = vec3(dot(vAxisX, N), dot(vAxisY, N), dot(vAxisZ, N));
+    float theta = atan(obj.z, obj.x) / (2.0 * PI);
+    float v     = acos(clamp(obj.y, -1.0, 1.0)) / PI;
+
+    // Two u candidates with seams on opposite sides; take the continuous one so mip selection
+    // does not see a derivative spike along the wrap
+    float uA = fract(theta);
+    float uB = fract(theta + 0.5) - 0.5;
+    float u  = fwidth(uA) <= fwidth(uB) + 0.0001 ? uA : uB;
+
+    vec3 V = normalize(-hit);
+
+    vec3 L;
+    if (uLightPosition.w == 0.0)
+        L = normalize(uLightPosition.xyz);
+    else
+        L = normalize(uLightPosition.xyz - hit);
+
+    vec3 ambient = uLightAmbient.rgb * uMaterialAmbient.rgb;
+
+    float diff = max(dot(N, L), 0.0);
+    vec3 diffuse = uLightDiffuse.rgb * uMaterialDiffuse.rgb * diff;
+
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(V, R), 0.0), 64.0);
+    vec3 specular = uLightDiffuse.rgb * spec * 0.1;
+
+    vec4 texColor = texture(uTexture, vec2(u, v));
+    FragColor = vec4((ambient + diffuse) * texColor.rgb + specular, 1.0);
+}
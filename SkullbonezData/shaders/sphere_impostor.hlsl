@@ -0,0 +1,143 @@
+// Ray-cast sphere impostor: instanced shader (HLSL 5.0, combined VS+PS)
+// One camera-facing quad per instance; the pixel shader intersects the eye ray with the sphere,
+// writes the true surface depth, and evaluates the user clip plane per fragment.
+// Column-major matrices — uploaded directly from engine Matrix4 without transposing.
+
+#pragma pack_matrix(column_major)
+
+cbuffer Uniforms : register(b0)
+{
+    float4x4 uView;
+    float4x4 uProjection;
+    float4   uClipPlane;
+    float4   uLightPosition;
+    float4   uLightAmbient;
+    float4   uLightDiffuse;
+    float4   uMaterialAmbient;
+    float4   uMaterialDiffuse;
+};
+
+Texture2D    uTexture  : register(t0);
+SamplerState sSampler0 : register(s0);
+
+static const float PI = 3.14159265;
+
+struct VS_IN
+{
+    float2 corner      : POSITION;
+    float4 posRadius   : TEXCOORD1;
+    float4 orientation : TEXCOORD2;
+};
+
+struct VS_OUT
+{
+    float4 position                : SV_POSITION;
+    float3 viewPos                 : TEXCOORD0;
+    nointerpolation float3 center  : TEXCOORD1;
+    nointerpolation float  radius  : TEXCOORD2;
+    nointerpolation float3 axisX   : TEXCOORD3;
+    nointerpolation float3 axisY   : TEXCOORD4;
+    nointerpolation float3 axisZ   : TEXCOORD5;
+    nointerpolation float4 clip    : TEXCOORD6;
+};
+
+struct PS_OUT
+{
+    float4 color : SV_TARGET;
+    float  depth : SV_DEPTH;
+};
+
+VS_OUT main_vs(VS_IN input)
+{
+    VS_OUT output;
+
+    // Unit quaternion -> object axes (rotation matrix columns)
+    float4 q     = normalize(input.orientation);
+    float3 q2    = q.xyz * 2.0;
+    float3 axisX = float3(1.0 - q.y * q2.y - q.z * q2.z, q.x * q2.y + q.w * q2.z, q.x * q2.z - q.w * q2.y);
+    float3 axisY = float3(q.x * q2.y - q.w * q2.z, 1.0 - q.x * q2.x - q.z * q2.z, q.y * q2.z + q.w * q2.x);
+    float3 axisZ = float3(q.x * q2.z + q.w * q2.y, q.y * q2.z - q.w * q2.x, 1.0 - q.x * q2.x - q.y * q2.y);
+
+    float radius      = input.posRadius.w;
+    float3x3 viewRot  = (float3x3)uView;
+    float3 center     = mul(uView, float4(input.posRadius.xyz, 1.0)).xyz;
+
+    // Basis perpendicular to the eye -> centre ray
+    float dist   = length(center);
+    float3 toEye = -center / dist;
+    float3 up    = abs(toEye.y) < 0.99 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0);
+    float3 right = normalize(cross(up, toEye));
+    up           = cross(toEye, right);
+
+    // Silhouette cone radius at the near cap plane (dist - radius from the eye)
+    float capDist  = max(dist - radius, 0.0);
+    float sinAngle = min(radius / dist, 0.999);
+    float halfSize = capDist * sinAngle / sqrt(1.0 - sinAngle * sinAngle);
+
+    float3 viewPos  = center + toEye * radius + (right * input.corner.x + up * input.corner.y) * halfSize;
+    output.position = mul(uProjection, float4(viewPos, 1.0));
+
+    output.viewPos = viewPos;
+    output.center  = center;
+    output.radius  = radius;
+    output.axisX   = mul(viewRot, axisX);
+    output.axisY   = mul(viewRot, axisY);
+    output.axisZ   = mul(viewRot, axisZ);
+    output.clip    = float4(mul(viewRot, uClipPlane.xyz), dot(float4(input.posRadius.xyz, 1.0), uClipPlane));
+
+    return output;
+}
+
+PS_OUT main_ps(VS_OUT input)
+{
+    PS_OUT output;
+
+    // Nearest eye-ray / sphere intersection
+    float3 dir  = normalize(input.viewPos);
+    float b     = dot(dir, input.center);
+    float c     = dot(input.center, input.center) - input.radius * input.radius;
+    float disc  = b * b - c;
+    if (disc < 0.0)
+        discard;
+
+    float3 hit    = dir * (b - sqrt(disc));
+    float3 offset = hit - input.center;
+    if (input.clip.w + dot(input.clip.xyz, offset) < 0.0)
+        discard;
+
+    float4 clipPos = mul(uProjection, float4(hit, 1.0));
+    output.depth   = clipPos.z / clipPos.w;
+
+    // Object-space normal -> the UV-sphere mesh's (theta, phi) parameterisation
+    float3 N    = offset / input.radius;
+    float3 obj  = float3(dot(input.axisX, N), dot(input.axisY, N), dot(input.axisZ, N));
+    float theta = atan2(obj.z, obj.x) / (2.0 * PI);
+    float v     = acos(clamp(obj.y, -1.0, 1.0)) / PI;
+
+    // Two u candidates with seams on opposite sides; take the continuous one so mip selection
+    // does not see a derivative spike along the wrap
+    float uA = frac(theta);
+    float uB = frac(theta + 0.5) - 0.5;
+    float u  = fwidth(uA) <= fwidth(uB) + 0.0001 ? uA : uB;
+
+    float3 V = normalize(-hit);
+
+    float3 L;
+    if (uLightPosition.w == 0.0)
+        L = normalize(uLightPosition.xyz);
+    else
+        L = normalize(uLightPosition.xyz - hit);
+
+    float3 ambient = uLightAmbient.rgb * uMaterialAmbient.rgb;
+
+    float diff = max(dot(N, L), 0.0);
+    float3 diffuse = uLightDiffuse.rgb * uMaterialDiffuse.rgb * diff;
+
+    float3 R = reflect(-L, N);
+    float spec = pow(max(dot(V, R), 0.0), 64.0);
+    float3 specular = uLightDiffuse.rgb * spec * 0.1;
+
+    float4 texColor = uTexture.Sample(sSampler0, float2(u, v));
+    output.color = float4((ambient + diffuse) * texColor.rgb + specular, 1.0);
+    return output;
+}
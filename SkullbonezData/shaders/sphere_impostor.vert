@@ -0,0 +1,59 @@
+#version 330 core
+
+// Ray-cast sphere impostor: instanced vertex shader
+// One camera-facing quad per instance, placed at the sphere's near cap and sized to its
+// perspective silhouette. Instance data is the same compact centre/radius + quaternion
+// layout the mesh path uses.
+
+layout(location = 0) in vec2 aCorner;         // quad corner in [-1,1]
+layout(location = 3) in vec4 aPosRadius;      // per-instance centre (xyz) and radius (w)
+layout(location = 4) in vec4 aOrientation;    // per-instance rotation quaternion
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+uniform vec4 uClipPlane;
+
+out vec3 vViewPos;                            // point on the quad = eye ray direction
+flat out vec3 vCenter;                        // sphere centre, view space
+flat out float vRadius;
+flat out vec3 vAxisX;                         // object axes in view space (orientation for texcoords)
+flat out vec3 vAxisY;
+flat out vec3 vAxisZ;
+flat out vec4 vClip;                          // xyz: clip plane normal in view space, w: clip distance at centre
+
+void main()
+{
+    // Unit quaternion → object axes (rotation matrix columns)
+    vec4 q     = normalize(aOrientation);
+    vec3 q2    = q.xyz * 2.0;
+    vec3 axisX = vec3(1.0 - q.y * q2.y - q.z * q2.z, q.x * q2.y + q.w * q2.z, q.x * q2.z - q.w * q2.y);
+    vec3 axisY = vec3(q.x * q2.y - q.w * q2.z, 1.0 - q.x * q2.x - q.z * q2.z, q.y * q2.z + q.w * q2.x);
+    vec3 axisZ = vec3(q.x * q2.z + q.w * q2.y, q.y * q2.z - q.w * q2.x, 1.0 - q.x * q2.x - q.y * q2.y);
+
+    float radius = aPosRadius.w;
+    mat3 viewRot = mat3(uView);
+    vec3 center  = (uView * vec4(aPosRadius.xyz, 1.0)).xyz;
+
+    // Basis perpendicular to the eye → centre ray
+    float dist  = length(center);
+    vec3 toEye  = -center / dist;
+    vec3 up     = abs(toEye.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 right  = normalize(cross(up, toEye));
+    up          = cross(toEye, right);
+
+    // Silhouette cone radius at the near cap plane (dist - radius from the eye)
+    float capDist  = max(dist - radius, 0.0);
+    float sinAngle = min(radius / dist, 0.999);
+    float halfSize = capDist * sinAngle / sqrt(1.0 - sinAngle * sinAngle);
+
+    vec3 viewPos = center + toEye * radius + (right * aCorner.x + up * aCorner.y) * halfSize;
+    gl_Position  = uProjection * vec4(viewPos, 1.0);
+
+    vViewPos = viewPos;
+    vCenter  = center;
+    vRadius  = radius;
+    vAxisX   = viewRot * axisX;
+    vAxisY   = viewRot * axisY;
+    vAxisZ   = viewRot * axisZ;
+    vClip    = vec4(viewRot * uClipPlane.xyz, dot(vec4(aPosRadius.xyz, 1.0), uClipPlane));
+}
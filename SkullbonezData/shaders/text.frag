@@ -1,17 +1,20 @@
 #version 330 core
 
 // Text rendering: fragment shader
-// Samples font texture atlas, applies text color.
+// Samples the signed-distance font atlas (0.5 on the glyph outline) and antialiases the edge over
+// one screen pixel, whatever the text size. HUD quads point at the atlas's solid white texel, so
+// they come out as flat color.
 
 in vec2 vTexCoord;
+in vec4 vColor;
 
 uniform sampler2D uFontTexture;
-uniform vec3 uTextColor;
 
 out vec4 FragColor;
 
 void main()
 {
-    float alpha = texture(uFontTexture, vTexCoord).r;
-    FragColor = vec4(uTextColor, alpha);
+    float dist = texture(uFontTexture, vTexCoord).r;
+    float alpha = clamp((dist - 0.5) / max(fwidth(dist), 1e-4) + 0.5, 0.0, 1.0);
+    FragColor = vec4(vColor.rgb, vColor.a * alpha);
 }
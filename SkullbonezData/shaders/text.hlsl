@@ -1,13 +1,13 @@
 // Text rendering shader (HLSL 5.0, combined VS+PS)
-// 2D orthographic projection for bitmap font quads.
+// 2D orthographic projection for the batched overlay stream (glyph and HUD quads).
+// Glyphs come from a signed-distance atlas (0.5 on the outline), antialiased over one screen pixel.
+// HUD quads point at the atlas's solid white texel, so they come out as flat color.
 
 #pragma pack_matrix(column_major)
 
 cbuffer Uniforms : register(b0)
 {
     float4x4 uProjection;
-    float3   uTextColor;
-    float    _pad0;
 };
 
 Texture2D    uFontTexture : register(t0);
@@ -17,12 +17,14 @@ struct VS_IN
 {
     float2 position : POSITION;
     float2 texCoord : TEXCOORD0;
+    float4 color    : TEXCOORD1;
 };
 
 struct VS_OUT
 {
     float4 position : SV_POSITION;
     float2 texCoord : TEXCOORD0;
+    float4 color    : TEXCOORD1;
 };
 
 VS_OUT main_vs(VS_IN input)
@@ -30,12 +32,13 @@ VS_OUT main_vs(VS_IN input)
     VS_OUT output;
     output.position = mul(uProjection, float4(input.position, 0.0, 1.0));
     output.texCoord = input.texCoord;
+    output.color    = input.color;
     return output;
 }
 
 float4 main_ps(VS_OUT input) : SV_TARGET
 {
-    float alpha = uFontTexture.Sample(sSampler0, input.texCoord).r;
-    return float4(uTextColor, alpha);
+    float dist  = uFontTexture.Sample(sSampler0, input.texCoord).r;
+    float alpha = saturate((dist - 0.5) / max(fwidth(dist), 1e-4) + 0.5);
+    return float4(input.color.rgb, input.color.a * alpha);
 }
-
@@ -0,0 +1,300 @@
+// --- Includes ---
+#include "SkullbonezAssetPack.h"
+#include <cstring>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Basics;
+
+
+AssetPack::AssetPack()
+    : m_file( INVALID_HANDLE_VALUE ), m_mapping( nullptr ), m_base( nullptr ), m_size( 0 ), m_entries( nullptr ), m_entryCount( 0 )
+{
+}
+
+
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+
+AssetPack& AssetPack::Instance()
+{
+    static AssetPack s_instance;
+    return s_instance;
+}
+
+
+void AssetPack::NormalisePath( const char* path, char* out, size_t size )
+{
+    size_t i = 0;
+    for ( ; path[i] != '\0' && i + 1 < size; ++i )
+    {
+        char c = path[i];
+        if ( c == '\\' )
+        {
+            c = '/';
+        }
+        else if ( c >= 'A' && c <= 'Z' )
+        {
+            c = static_cast<char>( c - 'A' + 'a' );
+        }
+        out[i] = c;
+    }
+    out[i] = '\0';
+}
+
+
+uint32_t AssetPack::HashPath( const char* path )
+{
+    char normalised[ASSET_PACK_MAX_PATH];
+    NormalisePath( path, normalised, sizeof( normalised ) );
+    return HashStr( normalised );
+}
+
+
+bool AssetPack::GetSourceStamp( const char* path, uint64_t& size, uint64_t& time )
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if ( !GetFileAttributesExA( path, GetFileExInfoStandard, &info ) || ( info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) )
+    {
+        return false;
+    }
+    size = ( static_cast<uint64_t>( info.nFileSizeHigh ) << 32 ) | info.nFileSizeLow;
+    time = ( static_cast<uint64_t>( info.ftLastWriteTime.dwHighDateTime ) << 32 ) | info.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+
+bool AssetPack::HasLooseData()
+{
+    DWORD attributes = GetFileAttributesA( ASSET_PACK_SOURCE_DIR );
+    return attributes != INVALID_FILE_ATTRIBUTES && ( attributes & FILE_ATTRIBUTE_DIRECTORY );
+}
+
+
+bool AssetPack::Open( const char* path, bool isCheckingSources )
+{
+    Close();
+
+    m_file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr );
+    if ( m_file == INVALID_HANDLE_VALUE )
+    {
+        return false; // pack is optional -- loaders fall back to loose files
+    }
+
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( m_file, &fileSize ) || fileSize.QuadPart < static_cast<LONGLONG>( sizeof( AssetPackHeader ) ) )
+    {
+        Close();
+        throw std::runtime_error( "Asset pack is truncated.  (AssetPack::Open)" );
+    }
+
+    m_mapping = CreateFileMappingA( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( !m_mapping )
+    {
+        Close();
+        throw std::runtime_error( "CreateFileMapping failed.  (AssetPack::Open)" );
+    }
+
+    m_base = static_cast<const uint8_t*>( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if ( !m_base )
+    {
+        Close();
+        throw std::runtime_error( "MapViewOfFile failed.  (AssetPack::Open)" );
+    }
+    m_size = static_cast<uint64_t>( fileSize.QuadPart );
+
+    const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>( m_base );
+    if ( header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION )
+    {
+        Close();
+        throw std::runtime_error( "Asset pack has wrong magic or version -- rebuild with --build-pack.  (AssetPack::Open)" );
+    }
+
+    uint64_t indexEnd = sizeof( AssetPackHeader ) + static_cast<uint64_t>( header->entryCount ) * sizeof( AssetPackEntry );
+    if ( header->fileSize != m_size || indexEnd > m_size )
+    {
+        Close();
+        throw std::runtime_error( "Asset pack is truncated.  (AssetPack::Open)" );
+    }
+
+    m_entries = reinterpret_cast<const AssetPackEntry*>( m_base + sizeof( AssetPackHeader ) );
+    m_entryCount = header->entryCount;
+
+    for ( uint32_t i = 0; i < m_entryCount; ++i )
+    {
+        if ( m_entries[i].offset + m_entries[i].size > m_size )
+        {
+            Close();
+            throw std::runtime_error( "Asset pack entry out of range.  (AssetPack::Open)" );
+        }
+    }
+
+    // Development only (--check-pack): loose files edited since the pack was built win over their packed
+    // copies.  Costs a stat per entry, and timestamps only match on the machine that built the pack, so it
+    // stays off by default and is skipped when there is no loose data beside the pack
+    if ( isCheckingSources && HasLooseData() )
+    {
+        m_isStale.assign( m_entryCount, false );
+        uint32_t staleCount = 0;
+        for ( uint32_t i = 0; i < m_entryCount; ++i )
+        {
+            uint64_t sourceSize = 0;
+            uint64_t sourceTime = 0;
+            if ( GetSourceStamp( m_entries[i].path, sourceSize, sourceTime ) &&
+                 ( sourceSize != m_entries[i].sourceSize || sourceTime != m_entries[i].sourceTime ) )
+            {
+                m_isStale[i] = true;
+                ++staleCount;
+            }
+        }
+        if ( staleCount > 0 )
+        {
+            fprintf( stderr, "WARNING: %u packed asset(s) differ from their loose files -- using the loose copies (rebuild with --build-pack)\n", staleCount );
+        }
+    }
+
+    return true;
+}
+
+
+void AssetPack::Close()
+{
+    if ( m_base )
+    {
+        UnmapViewOfFile( m_base );
+        m_base = nullptr;
+    }
+    if ( m_mapping )
+    {
+        CloseHandle( m_mapping );
+        m_mapping = nullptr;
+    }
+    if ( m_file != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle( m_file );
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_size = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_isStale.clear();
+}
+
+
+bool AssetPack::IsOpen() const
+{
+    return m_base != nullptr;
+}
+
+
+const AssetPackEntry* AssetPack::Find( const char* path ) const
+{
+    if ( !m_entries )
+    {
+        return nullptr;
+    }
+
+    char normalised[ASSET_PACK_MAX_PATH];
+    NormalisePath( path, normalised, sizeof( normalised ) );
+    uint32_t hash = HashStr( normalised );
+
+    // Index is sorted by hash; the builder rejects collisions so the first hit is the only hit
+    uint32_t lo = 0;
+    uint32_t hi = m_entryCount;
+    while ( lo < hi )
+    {
+        uint32_t mid = lo + ( hi - lo ) / 2;
+        if ( m_entries[mid].hash < hash )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if ( lo < m_entryCount && m_entries[lo].hash == hash && strcmp( m_entries[lo].path, normalised ) == 0 &&
+         ( m_isStale.empty() || !m_isStale[lo] ) )
+    {
+        return &m_entries[lo];
+    }
+    return nullptr;
+}
+
+
+const uint8_t* AssetPack::GetData( const AssetPackEntry& e ) const
+{
+    return m_base + e.offset;
+}
+
+
+AssetTextReader::AssetTextReader()
+    : m_file( nullptr ), m_cursor( nullptr ), m_end( nullptr )
+{
+}
+
+
+AssetTextReader::~AssetTextReader()
+{
+    Close();
+}
+
+
+bool AssetTextReader::Open( const char* path )
+{
+    Close();
+
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( path );
+    if ( entry && entry->type == AssetType::Text )
+    {
+        m_cursor = reinterpret_cast<const char*>( pack.GetData( *entry ) );
+        m_end = m_cursor + entry->size;
+        return true;
+    }
+
+    return fopen_s( &m_file, path, "r" ) == 0 && m_file;
+}
+
+
+bool AssetTextReader::ReadLine( char* buffer, size_t size )
+{
+    if ( m_file )
+    {
+        return fgets( buffer, static_cast<int>( size ), m_file ) != nullptr;
+    }
+
+    if ( !m_cursor || m_cursor >= m_end || size < 2 )
+    {
+        return false;
+    }
+
+    size_t n = 0;
+    while ( m_cursor < m_end && n + 1 < size )
+    {
+        char c = *m_cursor++;
+        buffer[n++] = c;
+        if ( c == '\n' )
+        {
+            break;
+        }
+    }
+    buffer[n] = '\0';
+    return true;
+}
+
+
+void AssetTextReader::Close()
+{
+    if ( m_file )
+    {
+        fclose( m_file );
+        m_file = nullptr;
+    }
+    m_cursor = nullptr;
+    m_end = nullptr;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezCommon.h"
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Basics
+{
+constexpr uint32_t ASSET_PACK_MAGIC = 0x4B504253; // "SBPK"
+constexpr uint32_t ASSET_PACK_VERSION = 2;
+constexpr uint32_t ASSET_PACK_ALIGNMENT = 256;    // blob alignment (satisfies D3D12 texture placement + cache lines)
+constexpr int ASSET_PACK_MAX_PATH = 104;
+constexpr const char* ASSET_PACK_PATH = "SkullbonezData.pak";
+constexpr const char* ASSET_PACK_SOURCE_DIR = "SkullbonezData";
+
+
+enum class AssetType : uint32_t
+{
+    Raw = 0,     // opaque bytes (terrain.raw)
+    Texture = 1, // decoded RGBA8, full mip chain tightly packed level 0 first
+    Text = 2     // shader sources, scenes, engine.cfg (NUL-terminated, terminator excluded from size)
+};
+
+
+// On-disk pack header. Followed by entryCount AssetPackEntry records sorted by hash.
+struct AssetPackHeader
+{
+    uint32_t magic;      // ASSET_PACK_MAGIC
+    uint32_t version;    // ASSET_PACK_VERSION
+    uint32_t entryCount; // number of index records
+    uint32_t alignment;  // blob alignment in bytes
+    uint64_t fileSize;   // total pack size (truncation check)
+};
+
+
+// On-disk index record. All blobs start on a header.alignment boundary.
+struct AssetPackEntry
+{
+    char path[ASSET_PACK_MAX_PATH]; // normalised relative path, e.g. "skullbonezdata/shaders/text.vert"
+    uint32_t hash;                  // AssetPack::HashPath( path )
+    AssetType type;
+    uint64_t offset;     // byte offset from start of pack
+    uint64_t size;       // blob size in bytes
+    int32_t width;       // Texture: level 0 width
+    int32_t height;      // Texture: level 0 height
+    int32_t channels;    // Texture: bytes per texel
+    int32_t mipCount;    // Texture: number of levels in the blob
+    uint64_t sourceSize; // Loose file size when the pack was built
+    uint64_t sourceTime; // Loose file last-write time (FILETIME) when the pack was built
+};
+
+static_assert( sizeof( AssetPackHeader ) == 24, "AssetPackHeader layout changed" );
+static_assert( sizeof( AssetPackEntry ) == 160, "AssetPackEntry layout changed" );
+
+
+/* -- Asset Pack -------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Read-only view of a memory-mapped SkullbonezData.pak. Lookups are by the same relative path the
+    loose-file loaders use; returned pointers reference the mapping directly and stay valid until Close().
+    When no pack is present every lookup misses and callers fall back to loose files.  While developing,
+    --check-pack makes an entry whose loose file has changed size or modification time since the pack was
+    built miss as well, so edited data is picked up without rebuilding the pack (Open warns with a count of
+    such entries).  The check is off by default: it stats every entry, and the build machine's timestamps
+    mean nothing on a fresh checkout.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class AssetPack
+{
+
+  private:
+    AssetPack();
+    ~AssetPack();
+    AssetPack( const AssetPack& ) = delete;
+    AssetPack& operator=( const AssetPack& ) = delete;
+
+    HANDLE m_file;                   // Pack file handle
+    HANDLE m_mapping;                // File mapping object
+    const uint8_t* m_base;           // Start of mapped view
+    uint64_t m_size;                 // Size of mapped view
+    const AssetPackEntry* m_entries; // Index records (inside the mapping)
+    uint32_t m_entryCount;           // Number of index records
+    std::vector<bool> m_isStale;     // Per entry: loose file differs from the packed copy (empty unless checked)
+
+    static bool HasLooseData(); // ASSET_PACK_SOURCE_DIR exists beside the pack
+
+  public:
+    static AssetPack& Instance();                                                   // Access the process-wide pack
+    static uint32_t HashPath( const char* path );                                   // FNV-1a over the lower-cased, forward-slashed path
+    static void NormalisePath( const char* path, char* out, size_t size );          // Lower-case and forward-slash a relative path
+    static bool GetSourceStamp( const char* path, uint64_t& size, uint64_t& time ); // Loose file size and last-write time; false if absent
+
+    bool Open( const char* path, bool isCheckingSources = false ); // Map the pack; returns false if it does not exist, throws if malformed (isCheckingSources: --check-pack)
+    void Close();                                                  // Unmap the pack
+    bool IsOpen() const;                                           // True while a pack is mapped
+    const AssetPackEntry* Find( const char* path ) const;          // Binary search the index; nullptr on miss
+    const uint8_t* GetData( const AssetPackEntry& e ) const;       // Pointer to the entry's blob inside the mapping
+};
+
+
+/* -- Asset Text Reader ------------------------------------------------------------------------------------------------------------------------------------------
+
+    fgets-style line reader over a packed text blob, falling back to the loose file when the pack
+    does not contain the path.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class AssetTextReader
+{
+
+  private:
+    FILE* m_file;         // Loose-file fallback
+    const char* m_cursor; // Read position inside the packed blob
+    const char* m_end;    // End of the packed blob
+
+  public:
+    AssetTextReader();
+    ~AssetTextReader();
+    AssetTextReader( const AssetTextReader& ) = delete;
+    AssetTextReader& operator=( const AssetTextReader& ) = delete;
+
+    bool Open( const char* path );                // Returns false if the path is neither packed nor on disk
+    bool ReadLine( char* buffer, size_t size );   // fgets semantics: keeps the newline, truncates long lines
+    void Close();
+};
+} // namespace Basics
+} // namespace SkullbonezCore
@@ -0,0 +1,256 @@
+// --- Includes ---
+#include "SkullbonezAssetPackBuilder.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Basics;
+
+
+static bool HasExtension( const std::string& path, const char* const* exts, int count )
+{
+    size_t dot = path.find_last_of( '.' );
+    if ( dot == std::string::npos )
+    {
+        return false;
+    }
+    const char* ext = path.c_str() + dot + 1;
+    for ( int i = 0; i < count; ++i )
+    {
+        if ( _stricmp( ext, exts[i] ) == 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void AssetPackBuilder::CollectDirectory( const std::string& dir )
+{
+    WIN32_FIND_DATAA fd;
+    HANDLE find = FindFirstFileA( ( dir + "/*" ).c_str(), &fd );
+    if ( find == INVALID_HANDLE_VALUE )
+    {
+        return;
+    }
+
+    do
+    {
+        if ( strcmp( fd.cFileName, "." ) == 0 || strcmp( fd.cFileName, ".." ) == 0 )
+        {
+            continue;
+        }
+
+        std::string child = dir + "/" + fd.cFileName;
+        if ( fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        {
+            CollectDirectory( child );
+        }
+        else
+        {
+            AddFile( child );
+        }
+    } while ( FindNextFileA( find, &fd ) );
+
+    FindClose( find );
+}
+
+
+void AssetPackBuilder::AddFile( const std::string& path )
+{
+    static const char* const imageExts[] = { "jpg", "jpeg", "png", "bmp", "tga" };
+    static const char* const textExts[] = { "vert", "frag", "hlsl", "cfg", "scene", "suite" };
+    static const char* const skipExts[] = { "pak" };
+
+    if ( HasExtension( path, skipExts, 1 ) )
+    {
+        return;
+    }
+
+    if ( path.size() >= ASSET_PACK_MAX_PATH )
+    {
+        char msg[512];
+        sprintf_s( msg, sizeof( msg ), "Asset path too long for pack index: %s  (AssetPackBuilder::AddFile)", path.c_str() );
+        throw std::runtime_error( msg );
+    }
+
+    PendingAsset asset = {};
+    AssetPack::NormalisePath( path.c_str(), asset.entry.path, sizeof( asset.entry.path ) );
+    asset.entry.hash = HashStr( asset.entry.path );
+    AssetPack::GetSourceStamp( path.c_str(), asset.entry.sourceSize, asset.entry.sourceTime );
+
+    if ( HasExtension( path, imageExts, 5 ) )
+    {
+        int w = 0;
+        int h = 0;
+        int channels = 0;
+        unsigned char* rgba = stbi_load( path.c_str(), &w, &h, &channels, 4 );
+        if ( !rgba )
+        {
+            char msg[512];
+            sprintf_s( msg, sizeof( msg ), "Image decode failed: %s  (AssetPackBuilder::AddFile)", path.c_str() );
+            throw std::runtime_error( msg );
+        }
+
+        asset.entry.type = AssetType::Texture;
+        asset.entry.width = w;
+        asset.entry.height = h;
+        asset.entry.channels = 4;
+        BuildMipChain( asset, rgba );
+        stbi_image_free( rgba );
+    }
+    else
+    {
+        FILE* f = nullptr;
+        if ( fopen_s( &f, path.c_str(), "rb" ) != 0 || !f )
+        {
+            char msg[512];
+            sprintf_s( msg, sizeof( msg ), "Failed to open asset: %s  (AssetPackBuilder::AddFile)", path.c_str() );
+            throw std::runtime_error( msg );
+        }
+        fseek( f, 0, SEEK_END );
+        long length = ftell( f );
+        fseek( f, 0, SEEK_SET );
+        asset.blob.resize( static_cast<size_t>( length ) );
+        fread( asset.blob.data(), 1, asset.blob.size(), f );
+        fclose( f );
+
+        if ( HasExtension( path, textExts, 6 ) )
+        {
+            // Match text-mode fopen: readers never see a CR
+            asset.blob.erase( std::remove( asset.blob.begin(), asset.blob.end(), static_cast<uint8_t>( '\r' ) ), asset.blob.end() );
+            asset.entry.type = AssetType::Text;
+            asset.entry.size = asset.blob.size();
+            asset.blob.push_back( 0 );
+        }
+        else
+        {
+            asset.entry.type = AssetType::Raw;
+        }
+    }
+
+    if ( asset.entry.type != AssetType::Text )
+    {
+        asset.entry.size = asset.blob.size();
+    }
+
+    m_assets.push_back( std::move( asset ) );
+}
+
+
+void AssetPackBuilder::BuildMipChain( PendingAsset& asset, const uint8_t* rgba )
+{
+    int w = asset.entry.width;
+    int h = asset.entry.height;
+
+    asset.blob.assign( rgba, rgba + static_cast<size_t>( w ) * h * 4 );
+    asset.entry.mipCount = 1;
+
+    size_t srcOffset = 0;
+    while ( w > 1 || h > 1 )
+    {
+        int nw = ( w > 1 ) ? w / 2 : 1;
+        int nh = ( h > 1 ) ? h / 2 : 1;
+        size_t dstOffset = asset.blob.size();
+        asset.blob.resize( dstOffset + static_cast<size_t>( nw ) * nh * 4 );
+
+        // 2x2 box filter; edge texels are clamped for odd / 1-wide levels
+        for ( int y = 0; y < nh; ++y )
+        {
+            int y0 = y * 2;
+            int y1 = ( y0 + 1 < h ) ? y0 + 1 : y0;
+            for ( int x = 0; x < nw; ++x )
+            {
+                int x0 = x * 2;
+                int x1 = ( x0 + 1 < w ) ? x0 + 1 : x0;
+                const uint8_t* s00 = &asset.blob[srcOffset + ( static_cast<size_t>( y0 ) * w + x0 ) * 4];
+                const uint8_t* s01 = &asset.blob[srcOffset + ( static_cast<size_t>( y0 ) * w + x1 ) * 4];
+                const uint8_t* s10 = &asset.blob[srcOffset + ( static_cast<size_t>( y1 ) * w + x0 ) * 4];
+                const uint8_t* s11 = &asset.blob[srcOffset + ( static_cast<size_t>( y1 ) * w + x1 ) * 4];
+                uint8_t* d = &asset.blob[dstOffset + ( static_cast<size_t>( y ) * nw + x ) * 4];
+                for ( int c = 0; c < 4; ++c )
+                {
+                    d[c] = static_cast<uint8_t>( ( s00[c] + s01[c] + s10[c] + s11[c] + 2 ) / 4 );
+                }
+            }
+        }
+
+        srcOffset = dstOffset;
+        w = nw;
+        h = nh;
+        ++asset.entry.mipCount;
+    }
+}
+
+
+void AssetPackBuilder::Build( const char* dataDir, const char* outPath )
+{
+    AssetPackBuilder builder;
+    builder.CollectDirectory( dataDir );
+
+    std::sort( builder.m_assets.begin(), builder.m_assets.end(), []( const PendingAsset& a, const PendingAsset& b )
+               {
+                   return a.entry.hash < b.entry.hash;
+               } );
+
+    for ( size_t i = 1; i < builder.m_assets.size(); ++i )
+    {
+        if ( builder.m_assets[i].entry.hash == builder.m_assets[i - 1].entry.hash )
+        {
+            char msg[512];
+            sprintf_s( msg, sizeof( msg ), "Path hash collision: %s / %s  (AssetPackBuilder::Build)", builder.m_assets[i - 1].entry.path, builder.m_assets[i].entry.path );
+            throw std::runtime_error( msg );
+        }
+    }
+
+    // Lay out blobs after the index, each on an ASSET_PACK_ALIGNMENT boundary
+    uint64_t cursor = sizeof( AssetPackHeader ) + builder.m_assets.size() * sizeof( AssetPackEntry );
+    for ( PendingAsset& asset : builder.m_assets )
+    {
+        cursor = ( cursor + ASSET_PACK_ALIGNMENT - 1 ) & ~static_cast<uint64_t>( ASSET_PACK_ALIGNMENT - 1 );
+        asset.entry.offset = cursor;
+        cursor += asset.blob.size();
+    }
+
+    AssetPackHeader header = {};
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>( builder.m_assets.size() );
+    header.alignment = ASSET_PACK_ALIGNMENT;
+    header.fileSize = cursor;
+
+    FILE* f = nullptr;
+    if ( fopen_s( &f, outPath, "wb" ) != 0 || !f )
+    {
+        char msg[512];
+        sprintf_s( msg, sizeof( msg ), "Failed to create asset pack: %s  (AssetPackBuilder::Build)", outPath );
+        throw std::runtime_error( msg );
+    }
+
+    fwrite( &header, sizeof( header ), 1, f );
+    for ( const PendingAsset& asset : builder.m_assets )
+    {
+        fwrite( &asset.entry, sizeof( AssetPackEntry ), 1, f );
+    }
+
+    static const uint8_t zeros[ASSET_PACK_ALIGNMENT] = {};
+    uint64_t written = sizeof( AssetPackHeader ) + builder.m_assets.size() * sizeof( AssetPackEntry );
+    for ( const PendingAsset& asset : builder.m_assets )
+    {
+        fwrite( zeros, 1, static_cast<size_t>( asset.entry.offset - written ), f );
+        fwrite( asset.blob.data(), 1, asset.blob.size(), f );
+        written = asset.entry.offset + asset.blob.size();
+    }
+
+    bool failed = ferror( f ) != 0;
+    fclose( f );
+    if ( failed )
+    {
+        throw std::runtime_error( "Failed to write asset pack.  (AssetPackBuilder::Build)" );
+    }
+
+    printf( "Asset pack written: %s (%u entries, %llu bytes)\n", outPath, header.entryCount, static_cast<unsigned long long>( header.fileSize ) );
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezAssetPack.h"
+#include <string>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Basics
+{
+/* -- Asset Pack Builder -----------------------------------------------------------------------------------------------------------------------------------------
+
+    Offline tool (run via --build-pack) that walks SkullbonezData and writes a single pack file:
+    images are decoded to RGBA8 with a box-filtered mip chain, text assets have CRs stripped and a NUL
+    appended, everything else is copied verbatim. The index is sorted by path hash.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class AssetPackBuilder
+{
+
+  private:
+    struct PendingAsset
+    {
+        AssetPackEntry entry;      // Index record (offset filled in at write time)
+        std::vector<uint8_t> blob; // Payload
+    };
+
+    std::vector<PendingAsset> m_assets;
+
+    void CollectDirectory( const std::string& dir );                       // Recursively gather files under dir
+    void AddFile( const std::string& path );                               // Classify and encode a single file
+    static void BuildMipChain( PendingAsset& asset, const uint8_t* rgba ); // Append all mip levels to asset.blob
+
+  public:
+    static void Build( const char* dataDir, const char* outPath ); // Build the pack, throws on failure
+};
+} // namespace Basics
+} // namespace SkullbonezCore
@@ -366,15 +366,20 @@ void CameraCollection::SetCamera()
         // avoid going through the m_terrain during tweens
         if ( m_terrain )
         {
-            // check the m_height of the m_terrain
-            float terrainHeight =
-                m_terrain->GetTerrainHeightAt( m_tweenCamera.m_position.x,
-                                               m_tweenCamera.m_position.z );
-
-            // update the tween camera if necessary
-            if ( m_tweenCamera.m_position.y < terrainHeight )
+            // only look up the exact m_height when the camera is below the highest ground in its cell
+            const Vector3& tweenPosition = m_tweenCamera.m_position;
+            if ( tweenPosition.y < m_terrain->GetMaxHeightInRegion( tweenPosition.x, tweenPosition.z, tweenPosition.x, tweenPosition.z ) )
             {
-                m_tweenCamera.m_position.y = terrainHeight + Cfg().minCameraHeight;
+                // check the m_height of the m_terrain
+                float terrainHeight =
+                    m_terrain->GetTerrainHeightAt( m_tweenCamera.m_position.x,
+                                                   m_tweenCamera.m_position.z );
+
+                // update the tween camera if necessary
+                if ( m_tweenCamera.m_position.y < terrainHeight )
+                {
+                    m_tweenCamera.m_position.y = terrainHeight + Cfg().minCameraHeight;
+                }
             }
         }
         else
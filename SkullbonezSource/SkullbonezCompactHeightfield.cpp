@@ -0,0 +1,170 @@
+// --- Includes ---
+#include "SkullbonezCompactHeightfield.h"
+#include <algorithm>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Geometry;
+
+
+CompactHeightfield::CompactHeightfield()
+    : m_posts( nullptr ), m_postsPerSide( 0 ), m_rowStride( 0 ), m_spacing( 0.0f ), m_heightBase( 0.0f ), m_heightStep( 0.0f )
+{
+}
+
+
+void CompactHeightfield::Build( const std::vector<TerrainPost>& posts, int postsPerSide, float spacing )
+{
+    if ( postsPerSide < 2 || static_cast<int>( posts.size() ) < postsPerSide * postsPerSide )
+    {
+        throw std::runtime_error( "Post data does not cover the grid.  (CompactHeightfield::Build)" );
+    }
+
+    m_postsPerSide = postsPerSide;
+    m_spacing = spacing;
+    m_rowStride = ( postsPerSide + POSTS_PER_LINE - 1 ) / POSTS_PER_LINE * POSTS_PER_LINE;
+    m_lines.assign( static_cast<size_t>( postsPerSide ) * ( m_rowStride / POSTS_PER_LINE ), Line{} );
+    m_posts = m_lines[0].posts;
+
+    // Quantise over the map's own height range
+    float minY = posts[0].vPosition.y;
+    float maxY = minY;
+    for ( int i = 0; i < postsPerSide * postsPerSide; ++i )
+    {
+        minY = ( std::min )( minY, posts[i].vPosition.y );
+        maxY = ( std::max )( maxY, posts[i].vPosition.y );
+    }
+    m_heightBase = minY;
+    m_heightStep = maxY > minY ? ( maxY - minY ) / 65535.0f : 1.0f;
+
+    for ( int ix = 0; ix < postsPerSide; ++ix )
+    {
+        for ( int iz = 0; iz < postsPerSide; ++iz )
+        {
+            const TerrainPost& source = posts[ix * postsPerSide + iz];
+            Post& post = m_posts[ix * m_rowStride + iz];
+            float quantised = ( source.vPosition.y - m_heightBase ) / m_heightStep + 0.5f;
+            post.height = static_cast<uint16_t>( ( std::min )( quantised, 65535.0f ) );
+            post.normal = EncodeNormal( source.vNormal );
+        }
+    }
+}
+
+
+int CompactHeightfield::GetPostsPerSide() const
+{
+    return m_postsPerSide;
+}
+
+
+float CompactHeightfield::GetSpacing() const
+{
+    return m_spacing;
+}
+
+
+float CompactHeightfield::GetHeightStep() const
+{
+    return m_heightStep;
+}
+
+
+size_t CompactHeightfield::GetMemoryBytes() const
+{
+    return m_lines.size() * sizeof( Line );
+}
+
+
+Vector3 CompactHeightfield::GetNormal( int ix, int iz ) const
+{
+    return DecodeNormal( m_posts[ix * m_rowStride + iz].normal );
+}
+
+
+bool CompactHeightfield::SetHeight( int ix, int iz, float height )
+{
+    bool isRequantised = false;
+    float maxY = m_heightBase + 65535.0f * m_heightStep;
+    if ( height < m_heightBase || height > maxY )
+    {
+        // Widen the side that overflowed by a quarter of the new span so repeated edits rarely land here again
+        float headroom = ( ( std::max )( maxY, height ) - ( std::min )( m_heightBase, height ) ) * 0.25f;
+        Requantise( height < m_heightBase ? height - headroom : m_heightBase,
+                    height > maxY ? height + headroom : maxY );
+        isRequantised = true;
+    }
+
+    float quantised = ( height - m_heightBase ) / m_heightStep + 0.5f;
+    m_posts[ix * m_rowStride + iz].height = static_cast<uint16_t>( ( std::max )( 0.0f, ( std::min )( quantised, 65535.0f ) ) );
+    return isRequantised;
+}
+
+
+void CompactHeightfield::SetNormal( int ix, int iz, const Vector3& normal )
+{
+    m_posts[ix * m_rowStride + iz].normal = EncodeNormal( normal );
+}
+
+
+void CompactHeightfield::Requantise( float minY, float maxY )
+{
+    float newBase = minY;
+    float newStep = maxY > minY ? ( maxY - minY ) / 65535.0f : 1.0f;
+
+    for ( int ix = 0; ix < m_postsPerSide; ++ix )
+    {
+        for ( int iz = 0; iz < m_postsPerSide; ++iz )
+        {
+            Post& post = m_posts[ix * m_rowStride + iz];
+            float quantised = ( GetHeight( ix, iz ) - newBase ) / newStep + 0.5f;
+            post.height = static_cast<uint16_t>( ( std::max )( 0.0f, ( std::min )( quantised, 65535.0f ) ) );
+        }
+    }
+
+    m_heightBase = newBase;
+    m_heightStep = newStep;
+}
+
+
+uint16_t CompactHeightfield::EncodeNormal( const Vector3& normal )
+{
+    // Project onto the octahedron |x| + |y| + |z| = 1 and flatten it around +Y (terrain normals point mostly up)
+    float length = fabsf( normal.x ) + fabsf( normal.y ) + fabsf( normal.z );
+    if ( length < TOLERANCE )
+    {
+        return 0x8080; // Straight up
+    }
+
+    float u = normal.x / length;
+    float v = normal.z / length;
+    if ( normal.y < 0.0f )
+    {
+        float foldedU = ( 1.0f - fabsf( v ) ) * ( u >= 0.0f ? 1.0f : -1.0f );
+        float foldedV = ( 1.0f - fabsf( u ) ) * ( v >= 0.0f ? 1.0f : -1.0f );
+        u = foldedU;
+        v = foldedV;
+    }
+
+    int packedU = static_cast<int>( floorf( ( u * 0.5f + 0.5f ) * 255.0f + 0.5f ) );
+    int packedV = static_cast<int>( floorf( ( v * 0.5f + 0.5f ) * 255.0f + 0.5f ) );
+    return static_cast<uint16_t>( packedU | ( packedV << 8 ) );
+}
+
+
+Vector3 CompactHeightfield::DecodeNormal( uint16_t packed )
+{
+    float u = static_cast<float>( packed & 0xFF ) / 255.0f * 2.0f - 1.0f;
+    float v = static_cast<float>( packed >> 8 ) / 255.0f * 2.0f - 1.0f;
+    float y = 1.0f - fabsf( u ) - fabsf( v );
+    if ( y < 0.0f )
+    {
+        float unfoldedU = ( 1.0f - fabsf( v ) ) * ( u >= 0.0f ? 1.0f : -1.0f );
+        float unfoldedV = ( 1.0f - fabsf( u ) ) * ( v >= 0.0f ? 1.0f : -1.0f );
+        u = unfoldedU;
+        v = unfoldedV;
+    }
+
+    Vector3 normal( u, y, v );
+    normal.Normalise();
+    return normal;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+
+// --- Includes ---
+#include <cstdint>
+#include <vector>
+#include "SkullbonezCommon.h"
+#include "SkullbonezGeometricStructures.h"
+
+
+namespace SkullbonezCore
+{
+namespace Geometry
+{
+/* -- Compact Heightfield ----------------------------------------------------------------------------------------------------------------------------------------
+
+    Collision copy of the terrain posts at 4 bytes each instead of the 24 of a TerrainPost.  X and Z are implied by
+    the grid index and spacing; the height is quantised to 16 bits over the map's height range and the normal is
+    octahedral-packed into 8 + 8 bits.  Rows (one per X index, matching the TerrainPost layout) are padded to whole
+    cache lines and the storage is cache-line aligned, so a cell's four posts touch at most two lines.
+    SetHeight edits a post in place; a height outside the quantised range requantises the whole field with some
+    headroom, so a run of craters or mounds only pays for that occasionally.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class CompactHeightfield
+{
+
+  public:
+    static constexpr int CACHE_LINE_BYTES = 64;
+
+    struct Post
+    {
+        uint16_t height; // Quantised: heightBase + height * heightStep
+        uint16_t normal; // Octahedral: low byte u, high byte v
+    };
+
+    static constexpr int POSTS_PER_LINE = CACHE_LINE_BYTES / static_cast<int>( sizeof( Post ) );
+
+  private:
+    struct alignas( CACHE_LINE_BYTES ) Line
+    {
+        Post posts[POSTS_PER_LINE];
+    };
+
+    std::vector<Line> m_lines; // Rows of m_rowStride posts
+    Post* m_posts;             // First post of m_lines
+    int m_postsPerSide;
+    int m_rowStride;           // Posts per row including padding (whole lines)
+    float m_spacing;           // World distance between neighbouring posts
+    float m_heightBase;        // World height of quantised 0
+    float m_heightStep;        // World height of one quantisation step
+
+    void Requantise( float minY, float maxY ); // Re-encodes every height over a new range
+
+    static uint16_t EncodeNormal( const Vector3& normal );
+    static Vector3 DecodeNormal( uint16_t packed );
+
+  public:
+    CompactHeightfield();
+
+    void Build( const std::vector<TerrainPost>& posts, int postsPerSide, float spacing ); // posts laid out [ix * postsPerSide + iz]
+
+    int GetPostsPerSide() const;
+    float GetSpacing() const;
+    float GetHeightStep() const; // Quantisation step; stored heights stay within 2.5 steps of the source across requantisations
+    size_t GetMemoryBytes() const;
+
+    float GetHeight( int ix, int iz ) const;
+    Vector3 GetPosition( int ix, int iz ) const;
+    Vector3 GetNormal( int ix, int iz ) const;
+
+    bool SetHeight( int ix, int iz, float height ); // Returns true when the whole field had to be requantised
+    void SetNormal( int ix, int iz, const Vector3& normal );
+};
+
+
+inline float CompactHeightfield::GetHeight( int ix, int iz ) const
+{
+    return m_heightBase + static_cast<float>( m_posts[ix * m_rowStride + iz].height ) * m_heightStep;
+}
+
+
+inline Vector3 CompactHeightfield::GetPosition( int ix, int iz ) const
+{
+    return Vector3( static_cast<float>( ix ) * m_spacing, GetHeight( ix, iz ), static_cast<float>( iz ) * m_spacing );
+}
+} // namespace Geometry
+} // namespace SkullbonezCore
@@ -1,6 +1,7 @@
 // --- Includes ---
 #include "SkullbonezCommon.h"
 #include "SkullbonezConfig.h"
+#include "SkullbonezAssetPack.h"
 #include <string.h>
 
 
@@ -19,14 +20,14 @@ SkullbonezConfig& SkullbonezConfig::Instance()
 /* ---------------------------------------------------------------------------------*/
 void SkullbonezConfig::Load( const char* path )
 {
-    FILE* f = nullptr;
-    if ( fopen_s( &f, path, "r" ) != 0 || !f )
+    AssetTextReader f;
+    if ( !f.Open( path ) )
     {
         return; // config file is optional
     }
 
     char line[512];
-    while ( fgets( line, sizeof( line ), f ) )
+    while ( f.ReadLine( line, sizeof( line ) ) )
     {
         size_t len = strlen( line );
         while ( len > 0 && ( line[len - 1] == '\r' || line[len - 1] == '\n' ) )
@@ -165,6 +166,46 @@ void SkullbonezConfig::Load( const char* path )
         {
             terrainHeightScale = static_cast<float>( atof( v ) );
         }
+        else if ( strcmp( k, "procedural_tile_cells" ) == 0 )
+        {
+            proceduralTileCells = atoi( v );
+        }
+        else if ( strcmp( k, "procedural_post_spacing" ) == 0 )
+        {
+            proceduralPostSpacing = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "procedural_world_tiles" ) == 0 )
+        {
+            proceduralWorldTiles = atoi( v );
+        }
+        else if ( strcmp( k, "procedural_height_base" ) == 0 )
+        {
+            proceduralHeightBase = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "procedural_height_amplitude" ) == 0 )
+        {
+            proceduralHeightAmplitude = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "procedural_feature_size" ) == 0 )
+        {
+            proceduralFeatureSize = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "procedural_octaves" ) == 0 )
+        {
+            proceduralOctaves = atoi( v );
+        }
+        else if ( strcmp( k, "procedural_stream_radius" ) == 0 )
+        {
+            proceduralStreamRadius = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "procedural_tile_cache" ) == 0 )
+        {
+            proceduralTileCache = atoi( v );
+        }
+        else if ( strcmp( k, "procedural_workers" ) == 0 )
+        {
+            proceduralWorkers = atoi( v );
+        }
 
         // Skybox
         else if ( strcmp( k, "skybox_render_height" ) == 0 )
@@ -225,6 +266,18 @@ void SkullbonezConfig::Load( const char* path )
         {
             broadphaseCell = static_cast<float>( atof( v ) );
         }
+        else if ( strcmp( k, "simulation_thread" ) == 0 )
+        {
+            simulationThread = atoi( v ) != 0;
+        }
+        else if ( strcmp( k, "simulation_rate" ) == 0 )
+        {
+            simulationRate = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "terrain_swept_sphere" ) == 0 )
+        {
+            terrainSweptSphere = atoi( v ) != 0;
+        }
 
         // Shadows
         else if ( strcmp( k, "shadow_max_height" ) == 0 )
@@ -248,6 +301,36 @@ void SkullbonezConfig::Load( const char* path )
             shadowScale = static_cast<float>( atof( v ) );
         }
 
+        // Sphere LOD
+        else if ( strcmp( k, "sphere_lod_pixels_1" ) == 0 )
+        {
+            sphereLodPixels1 = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "sphere_lod_pixels_2" ) == 0 )
+        {
+            sphereLodPixels2 = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "sphere_lod_pixels_3" ) == 0 )
+        {
+            sphereLodPixels3 = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "sphere_impostors" ) == 0 )
+        {
+            sphereImpostors = atoi( v ) != 0;
+        }
+        else if ( strcmp( k, "horizon_culling" ) == 0 )
+        {
+            horizonCulling = atoi( v ) != 0;
+        }
+        else if ( strcmp( k, "horizon_range" ) == 0 )
+        {
+            horizonRange = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "horizon_chunk_cells" ) == 0 )
+        {
+            horizonChunkCells = atoi( v );
+        }
+
         // Ball spawn ranges
         else if ( strcmp( k, "spawn_x_base" ) == 0 )
         {
@@ -353,13 +436,53 @@ void SkullbonezConfig::Load( const char* path )
         {
             oceanPerturbStrength = static_cast<float>( atof( v ) );
         }
+        else if ( strcmp( k, "reflection_scale" ) == 0 )
+        {
+            reflectionScale = static_cast<float>( atof( v ) );
+        }
+        else if ( strcmp( k, "reflection_interval" ) == 0 )
+        {
+            reflectionInterval = atoi( v );
+        }
+        else if ( strcmp( k, "reflection_reuse_threshold" ) == 0 )
+        {
+            reflectionReuseThreshold = static_cast<float>( atof( v ) );
+        }
 
         // Debug
         else if ( strcmp( k, "render_collision_volumes" ) == 0 )
         {
             renderCollisionVolumes = atoi( v ) != 0;
         }
+        else if ( strcmp( k, "capture_format" ) == 0 )
+        {
+            captureFormat = v;
+        }
+        else if ( strcmp( k, "null_renderer_stats" ) == 0 )
+        {
+            nullRendererStats = v;
+        }
+        else if ( strcmp( k, "render_capture_start_frame" ) == 0 )
+        {
+            renderCaptureStartFrame = atoi( v );
+        }
+        else if ( strcmp( k, "render_capture_frames" ) == 0 )
+        {
+            renderCaptureFrames = atoi( v );
+        }
+        else if ( strcmp( k, "replay_loops" ) == 0 )
+        {
+            replayLoops = atoi( v );
+        }
+        else if ( strcmp( k, "replay_report" ) == 0 )
+        {
+            replayReport = v;
+        }
+        else if ( strcmp( k, "shader_cache_dir" ) == 0 )
+        {
+            shaderCacheDir = v;
+        }
     }
 
-    fclose( f );
+    f.Close();
 }
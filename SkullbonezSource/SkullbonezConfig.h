@@ -10,7 +10,8 @@ namespace Basics
 {
 
 /*
-    Singleton configuration loaded once from SkullbonezData/engine.cfg at startup.
+    Singleton configuration loaded once from SkullbonezData/engine.cfg at startup, then from the
+    --config file if one is given (only the keys it lists change).
     Access via SkullbonezConfig::Instance().fieldName anywhere SkullbonezCommon.h is included.
     All fields carry defaults matching the original hard-coded values; the config
     file is optional -- if absent, defaults apply.
@@ -46,6 +47,18 @@ class SkullbonezConfig
     float terrainScale = 5.0f;
     float terrainHeightScale = 0.15f;
 
+    // Procedural terrain (scene directive procedural_terrain)
+    int proceduralTileCells = 32;            // Cells per tile side
+    float proceduralPostSpacing = 40.0f;     // World distance between posts
+    int proceduralWorldTiles = 64;           // World extent in tiles per side
+    float proceduralHeightBase = 40.0f;      // Mean height
+    float proceduralHeightAmplitude = 90.0f; // Maximum deviation from the mean
+    float proceduralFeatureSize = 2500.0f;   // Wavelength of the broadest noise octave
+    int proceduralOctaves = 5;               // Each adds detail at twice the frequency and half the amplitude of the last
+    float proceduralStreamRadius = 2000.0f;  // Tiles within this distance of the camera or a tracked body are kept resident
+    int proceduralTileCache = 96;            // Resident tile budget (tiles in range are never evicted)
+    int proceduralWorkers = 2;               // Tile generation threads (0 = generate on the render thread)
+
     // Skybox
     float skyboxRenderHeight = 30.0f;
     int skyboxOverflow = 1;
@@ -65,6 +78,9 @@ class SkullbonezConfig
     float contactRestitutionThreshold = 2.0f;
     float contactEpsilon = 0.05f;
     float broadphaseCell = 11.0f;
+    bool simulationThread = true;   // Step physics on its own thread in legacy mode (scene mode stays in lockstep)
+    float simulationRate = 120.0f;  // Fixed steps per second on the simulation thread
+    bool terrainSweptSphere = true; // Sweep the whole sphere against every terrain triangle it passes (off = ray under the centre)
 
     // Shadows
     float shadowMaxHeight = 50.0f;
@@ -73,6 +89,17 @@ class SkullbonezConfig
     int shadowSegments = 16;
     float shadowScale = 1.2f;
 
+    // Sphere LOD (projected radius in pixels at which each coarser tessellation takes over)
+    float sphereLodPixels1 = 40.0f;
+    float sphereLodPixels2 = 16.0f;
+    float sphereLodPixels3 = 6.0f;
+    bool sphereImpostors = false; // Ray-cast impostor quads instead of mesh LODs (toggle with 4)
+
+    // Terrain horizon occlusion (main view balls and shadows)
+    bool horizonCulling = true;   // Skip balls and shadows hidden behind hills
+    float horizonRange = 4000.0f; // Farthest ground used as an occluder
+    int horizonChunkCells = 4;    // Occluder size in terrain cells (rounded down to a power of two)
+
     // Ball spawn ranges (legacy random mode)
     float spawnXBase = 400.0f;
     int spawnXRange = 400;
@@ -103,9 +130,19 @@ class SkullbonezConfig
     // Water
     float oceanWaveHeight = 4.0f;
     float oceanPerturbStrength = 0.002f;
+    float reflectionScale = 2.0f;          // Reflection render target size relative to the window
+    int reflectionInterval = 1;            // Frames a reflection is kept before it may be re-rendered (1 = every frame)
+    float reflectionReuseThreshold = 0.0f; // Keep the reflection while the camera and reflected bodies move no more than this
 
     // Debug / rendering flags
     bool renderCollisionVolumes = false;
+    std::string captureFormat = "qoi";                         // Extension of interval and auto-cycle captures: "qoi" (compressed) or "bmp"
+    std::string nullRendererStats = "null_renderer_stats.csv"; // Call statistics written by --renderer null on exit ("" = none)
+    int renderCaptureStartFrame = 120;                         // Frames run before --capture starts recording (only their resources and state are kept)
+    int renderCaptureFrames = 300;                             // Frames recorded by --capture
+    int replayLoops = 10;                                      // Passes --replay makes over the captured frames
+    std::string replayReport = "replay_report.csv";            // Per-frame replay times written by --replay ("" = none)
+    std::string shaderCacheDir = "ShaderCache";                // Compiled shader / program binary cache directory ("" = always compile)
 
   private:
     SkullbonezConfig() = default;
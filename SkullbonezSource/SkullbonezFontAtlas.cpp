@@ -0,0 +1,300 @@
+// --- Includes ---
+#include "SkullbonezFontAtlas.h"
+#include "SkullbonezAssetPack.h"
+#include <cmath>
+#include <cstring>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Text;
+using namespace SkullbonezCore::Basics;
+
+
+static const char FONT_ATLAS_MAGIC[4] = { 'S', 'B', 'F', 'A' };
+
+
+// Distance from each atlas texel's centre to the nearest raster pixel on the other side of the outline,
+// searched within FONT_SPREAD texels and never across its own cell (so neighbours cannot bleed in)
+static void BuildDistanceField( const std::vector<uint8_t>& ink, std::vector<uint8_t>& texels )
+{
+    const int S = FONT_BAKE_SCALE;
+    const int rasterW = FONT_ATLAS_W * S;
+    const int radius = FONT_SPREAD * S;
+    const int maxDistSq = radius * radius;
+
+    texels.assign( static_cast<size_t>( FONT_ATLAS_W ) * FONT_ATLAS_H, 0 );
+
+    for ( int y = 0; y < FONT_ATLAS_H; ++y )
+    {
+        const int cellY0 = ( y / FONT_CELL_H ) * FONT_CELL_H * S;
+        const int cellY1 = cellY0 + FONT_CELL_H * S;
+        const int cy = y * S + S / 2;
+
+        for ( int x = 0; x < FONT_ATLAS_W; ++x )
+        {
+            const int cellX0 = ( x / FONT_CELL_W ) * FONT_CELL_W * S;
+            const int cellX1 = cellX0 + FONT_CELL_W * S;
+            const int cx = x * S + S / 2;
+            const uint8_t inside = ink[cy * rasterW + cx];
+
+            const int y0 = ( std::max )( cy - radius, cellY0 );
+            const int y1 = ( std::min )( cy + radius, cellY1 - 1 );
+            const int x0 = ( std::max )( cx - radius, cellX0 );
+            const int x1 = ( std::min )( cx + radius, cellX1 - 1 );
+
+            int bestSq = maxDistSq;
+            for ( int ry = y0; ry <= y1; ++ry )
+            {
+                const int dySq = ( ry - cy ) * ( ry - cy );
+                if ( dySq >= bestSq )
+                {
+                    continue;
+                }
+                const uint8_t* row = ink.data() + static_cast<size_t>( ry ) * rasterW;
+                for ( int rx = x0; rx <= x1; ++rx )
+                {
+                    if ( row[rx] != inside )
+                    {
+                        const int distSq = dySq + ( rx - cx ) * ( rx - cx );
+                        bestSq = ( std::min )( bestSq, distSq );
+                    }
+                }
+            }
+
+            // Map [-spread, +spread] texels onto [0, 255] with the outline at 128
+            float dist = sqrtf( static_cast<float>( bestSq ) ) / static_cast<float>( S );
+            float signedDist = inside ? dist : -dist;
+            float value = 127.5f + signedDist * ( 127.5f / static_cast<float>( FONT_SPREAD ) );
+            texels[y * FONT_ATLAS_W + x] = static_cast<uint8_t>( ( std::min )( ( std::max )( value, 0.0f ), 255.0f ) );
+        }
+    }
+
+    // The bottom-right corner lies past the last glyph's advance and below its descender; fill it
+    // solid so Render2dQuad can share the text shader and batch
+    for ( int y = FONT_ATLAS_H - FONT_WHITE_TEXELS; y < FONT_ATLAS_H; ++y )
+    {
+        for ( int x = FONT_ATLAS_W - FONT_WHITE_TEXELS; x < FONT_ATLAS_W; ++x )
+        {
+            texels[y * FONT_ATLAS_W + x] = 255;
+        }
+    }
+}
+
+
+void FontAtlas::Bake( HDC hDC, const char* cFontName )
+{
+    const int S = FONT_BAKE_SCALE;
+    const int rasterW = FONT_ATLAS_W * S;
+    const int rasterH = FONT_ATLAS_H * S;
+
+    // Create a top-down 32bpp DIB section to rasterise the glyphs into
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+    bmi.bmiHeader.biWidth = rasterW;
+    bmi.bmiHeader.biHeight = -rasterH; // negative = top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* pBits = nullptr;
+    HDC memDC = CreateCompatibleDC( hDC );
+    HBITMAP hBitmap = CreateDIBSection( hDC, &bmi, DIB_RGB_COLORS, &pBits, nullptr, 0 );
+
+    if ( !hBitmap || !memDC )
+    {
+        if ( memDC )
+        {
+            DeleteDC( memDC );
+        }
+        if ( hBitmap )
+        {
+            DeleteObject( hBitmap );
+        }
+        throw std::runtime_error( "DIB section creation failed (FontAtlas::Bake)" );
+    }
+
+    HBITMAP hOldBitmap = reinterpret_cast<HBITMAP>( SelectObject( memDC, hBitmap ) );
+
+    // Fill with black
+    RECT fillRect = { 0, 0, rasterW, rasterH };
+    HBRUSH hBlackBrush = CreateSolidBrush( RGB( 0, 0, 0 ) );
+    FillRect( memDC, &fillRect, hBlackBrush );
+    DeleteObject( hBlackBrush );
+
+    // Create the requested font at the raster's em height
+    HFONT hFont = CreateFont(
+        -FONT_EM * S, // negative = character height in pixels
+        0,
+        0,
+        0,
+        FW_NORMAL,
+        FALSE,
+        FALSE,
+        FALSE,
+        ANSI_CHARSET,
+        OUT_TT_PRECIS,
+        CLIP_DEFAULT_PRECIS,
+        ANTIALIASED_QUALITY,
+        FF_DONTCARE | DEFAULT_PITCH,
+        cFontName );
+
+    if ( !hFont )
+    {
+        SelectObject( memDC, hOldBitmap );
+        DeleteObject( hBitmap );
+        DeleteDC( memDC );
+        throw std::runtime_error( "Font creation failed (FontAtlas::Bake)" );
+    }
+
+    HFONT hOldFont = reinterpret_cast<HFONT>( SelectObject( memDC, hFont ) );
+
+    // Measure advance widths for all 96 printable ASCII chars (32..127)
+    INT advWidths[FONT_CHAR_COUNT] = {};
+    GetCharWidth32( memDC, FONT_FIRST_CHAR, FONT_FIRST_CHAR + FONT_CHAR_COUNT - 1, advWidths );
+    for ( int i = 0; i < FONT_CHAR_COUNT; ++i )
+    {
+        advance[i] = static_cast<float>( advWidths[i] ) / static_cast<float>( FONT_EM * S );
+    }
+
+    // Render each character inside its cell's padding
+    SetBkMode( memDC, TRANSPARENT );
+    SetTextColor( memDC, RGB( 255, 255, 255 ) );
+
+    char ch[2] = { 0, 0 };
+    for ( int i = 0; i < FONT_CHAR_COUNT; ++i )
+    {
+        ch[0] = static_cast<char>( i + FONT_FIRST_CHAR );
+        int col = i % FONT_COLS;
+        int row = i / FONT_COLS;
+        TextOutA( memDC, ( col * FONT_CELL_W + FONT_SPREAD ) * S, ( row * FONT_CELL_H + FONT_SPREAD ) * S, ch, 1 );
+    }
+    GdiFlush();
+
+    // White on black, so the red channel is coverage; half covered counts as inside
+    std::vector<uint8_t> ink( static_cast<size_t>( rasterW ) * rasterH );
+    const DWORD* pPixels = reinterpret_cast<const DWORD*>( pBits );
+    for ( size_t i = 0; i < ink.size(); ++i )
+    {
+        ink[i] = ( pPixels[i] & 0xFF ) >= 128 ? 1 : 0;
+    }
+
+    // Cleanup GDI resources
+    SelectObject( memDC, hOldFont );
+    SelectObject( memDC, hOldBitmap );
+    DeleteObject( hFont );
+    DeleteObject( hBitmap );
+    DeleteDC( memDC );
+
+    BuildDistanceField( ink, texels );
+    fontName = cFontName;
+}
+
+
+bool FontAtlas::Parse( const uint8_t* data, uint64_t size, const char* cFontName )
+{
+    const uint64_t texelBytes = static_cast<uint64_t>( FONT_ATLAS_W ) * FONT_ATLAS_H;
+    if ( size != sizeof( FontAtlasHeader ) + texelBytes )
+    {
+        return false;
+    }
+
+    FontAtlasHeader header;
+    memcpy( &header, data, sizeof( header ) );
+    if ( memcmp( header.magic, FONT_ATLAS_MAGIC, sizeof( header.magic ) ) != 0 ||
+         header.version != FONT_ATLAS_VERSION ||
+         strncmp( header.fontName, cFontName, sizeof( header.fontName ) ) != 0 ||
+         header.width != FONT_ATLAS_W || header.height != FONT_ATLAS_H ||
+         header.em != FONT_EM || header.spread != FONT_SPREAD )
+    {
+        return false;
+    }
+
+    fontName = cFontName;
+    memcpy( advance, header.advance, sizeof( advance ) );
+    texels.assign( data + sizeof( header ), data + sizeof( header ) + texelBytes );
+    return true;
+}
+
+
+bool FontAtlas::Load( const char* path, const char* cFontName )
+{
+    // Packed atlas is read in place from the mapping; a stale packed copy gives way to the loose file,
+    // which is where a startup bake saves its result
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( path );
+    if ( entry && entry->type == AssetType::Raw && Parse( pack.GetData( *entry ), entry->size, cFontName ) )
+    {
+        return true;
+    }
+
+    FILE* file = nullptr;
+    if ( fopen_s( &file, path, "rb" ) != 0 || !file )
+    {
+        return false;
+    }
+    fseek( file, 0, SEEK_END );
+    long length = ftell( file );
+    fseek( file, 0, SEEK_SET );
+    std::vector<uint8_t> fileData( length > 0 ? static_cast<size_t>( length ) : 0 );
+    fileData.resize( fread( fileData.data(), 1, fileData.size(), file ) );
+    fclose( file );
+
+    return Parse( fileData.data(), fileData.size(), cFontName );
+}
+
+
+void FontAtlas::Save( const char* path ) const
+{
+    if ( texels.size() != static_cast<size_t>( FONT_ATLAS_W ) * FONT_ATLAS_H )
+    {
+        throw std::runtime_error( "Font atlas has not been baked.  (FontAtlas::Save)" );
+    }
+
+    FontAtlasHeader header = {};
+    memcpy( header.magic, FONT_ATLAS_MAGIC, sizeof( header.magic ) );
+    header.version = FONT_ATLAS_VERSION;
+    strncpy_s( header.fontName, sizeof( header.fontName ), fontName.c_str(), _TRUNCATE );
+    header.width = FONT_ATLAS_W;
+    header.height = FONT_ATLAS_H;
+    header.em = FONT_EM;
+    header.spread = FONT_SPREAD;
+    memcpy( header.advance, advance, sizeof( header.advance ) );
+
+    FILE* f = nullptr;
+    if ( fopen_s( &f, path, "wb" ) != 0 || !f )
+    {
+        char msg[512];
+        sprintf_s( msg, sizeof( msg ), "Failed to create font atlas: %s  (FontAtlas::Save)", path );
+        throw std::runtime_error( msg );
+    }
+
+    fwrite( &header, sizeof( header ), 1, f );
+    fwrite( texels.data(), 1, texels.size(), f );
+
+    bool failed = ferror( f ) != 0;
+    fclose( f );
+    if ( failed )
+    {
+        throw std::runtime_error( "Failed to write font atlas.  (FontAtlas::Save)" );
+    }
+}
+
+
+void FontAtlas::Build( const char* cFontName, const char* outPath )
+{
+    FontAtlas atlas;
+    HDC screenDC = GetDC( nullptr );
+    try
+    {
+        atlas.Bake( screenDC, cFontName );
+    }
+    catch ( ... )
+    {
+        ReleaseDC( nullptr, screenDC );
+        throw;
+    }
+    ReleaseDC( nullptr, screenDC );
+
+    atlas.Save( outPath );
+    printf( "Font atlas written: %s (%s, %dx%d, %d texels per em)\n", outPath, cFontName, FONT_ATLAS_W, FONT_ATLAS_H, FONT_EM );
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezCommon.h"
+#include <string>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Text
+{
+constexpr const char* FONT_ATLAS_PATH = "SkullbonezData/verdana.sdf";
+constexpr uint32_t FONT_ATLAS_VERSION = 1;
+
+constexpr int FONT_FIRST_CHAR = 32;                            // Printable ASCII 32..127
+constexpr int FONT_CHAR_COUNT = 96;                            // Glyphs in the atlas
+constexpr int FONT_EM = 16;                                    // Atlas texels per em (the CreateFont character height)
+constexpr int FONT_SPREAD = 4;                                 // Distance range either side of the outline, in atlas texels (also the cell padding)
+constexpr int FONT_CELL_W = FONT_EM * 5 / 4 + 2 * FONT_SPREAD; // 1.25 em (wider than any Verdana glyph) plus padding
+constexpr int FONT_CELL_H = FONT_EM * 3 / 2 + 2 * FONT_SPREAD; // 1.5 em (descender and outline room) plus padding
+constexpr int FONT_COLS = 16;                                  // Columns in the atlas
+constexpr int FONT_ROWS = 6;                                   // Rows in the atlas (16*6 = 96 chars)
+constexpr int FONT_ATLAS_W = FONT_CELL_W * FONT_COLS;          // 448 texels
+constexpr int FONT_ATLAS_H = FONT_CELL_H * FONT_ROWS;          // 192 texels
+constexpr int FONT_WHITE_TEXELS = 2;                           // Solid block in the atlas's bottom-right corner (HUD quads sample it)
+constexpr int FONT_BAKE_SCALE = 8;                             // GDI raster resolution per atlas texel when baking
+
+
+// File layout: header, then FONT_ATLAS_W * FONT_ATLAS_H distance bytes, rows top-down
+struct FontAtlasHeader
+{
+    char magic[4];                  // "SBFA"
+    uint32_t version;               // FONT_ATLAS_VERSION
+    char fontName[32];              // Face the atlas was baked from
+    int32_t width;                  // FONT_ATLAS_W
+    int32_t height;                 // FONT_ATLAS_H
+    int32_t em;                     // FONT_EM
+    int32_t spread;                 // FONT_SPREAD
+    float advance[FONT_CHAR_COUNT]; // Advance width per glyph, in ems
+};
+
+static_assert( sizeof( FontAtlasHeader ) == 440, "FontAtlasHeader layout changed" );
+
+
+/* -- Font Atlas -------------------------------------------------------------------------------------------------------------------------------------------------
+
+    The overlay font as a single-channel signed-distance atlas: each texel holds the distance to the nearest
+    glyph outline, 128 on the outline, rising inside and falling outside until FONT_SPREAD texels away.
+    Thresholding at 128 after bilinear filtering gives sharp edges at any text size, so one small atlas serves
+    the whole overlay.
+
+    Baking rasterises the font through GDI at FONT_BAKE_SCALE times the atlas resolution and measures
+    distances in that raster.  It is done once, offline (--build-font), and the result loaded at startup
+    from the asset pack or the loose file.  When that file is missing or was built for a different font or
+    layout, startup bakes the atlas and saves it in its place, so that happens at most once.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class FontAtlas
+{
+
+  private:
+    bool Parse( const uint8_t* data, uint64_t size, const char* cFontName ); // Validate an atlas file's bytes and take its contents
+
+  public:
+    std::string fontName;                // Face the atlas holds
+    float advance[FONT_CHAR_COUNT] = {}; // Advance width per glyph, in ems
+    std::vector<uint8_t> texels;         // FONT_ATLAS_W * FONT_ATLAS_H distances
+
+    void Bake( HDC hDC, const char* cFontName );                     // Rasterise and measure distances, throws on failure
+    bool Load( const char* path, const char* cFontName );            // Pack entry or loose file; false if missing, corrupt or stale
+    void Save( const char* path ) const;                             // Write the atlas file, throws on failure
+    static void Build( const char* cFontName, const char* outPath ); // Offline tool (--build-font): bake and save, throws on failure
+};
+} // namespace Text
+} // namespace SkullbonezCore
@@ -0,0 +1,318 @@
+// --- Includes ---
+#include "SkullbonezFrustum.h"
+#include "SkullbonezTerrainHorizon.h"
+#include <xmmintrin.h>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Geometry;
+
+
+static constexpr int CLIP_PLANE_SLOT = 6;
+static constexpr float PLANE_ALWAYS_PASS = 1.0e30f;
+
+
+static void SetPlane( float* nx, float* ny, float* nz, float* d, int slot, float a, float b, float c, float w )
+{
+    float len = sqrtf( a * a + b * b + c * c );
+    float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    nx[slot] = a * inv;
+    ny[slot] = b * inv;
+    nz[slot] = c * inv;
+    d[slot] = len > 0.0f ? w * inv : PLANE_ALWAYS_PASS;
+}
+
+
+// Maps a float to a uint32 whose unsigned order matches the float order (negatives included)
+static uint32_t SortableKey( float f )
+{
+    uint32_t u;
+    memcpy( &u, &f, sizeof( u ) );
+    return ( u & 0x80000000u ) ? ~u : ( u | 0x80000000u );
+}
+
+
+Frustum::Frustum()
+    : m_depthRow{ 0.0f, 0.0f, 0.0f, 0.0f }, m_planeCount( 0 )
+{
+    for ( int i = 0; i < MAX_PLANES; ++i )
+    {
+        m_nx[i] = m_ny[i] = m_nz[i] = 0.0f;
+        m_d[i] = PLANE_ALWAYS_PASS;
+    }
+}
+
+
+Frustum::Frustum( const Matrix4& viewProj )
+    : Frustum()
+{
+    // Row i of the column-major matrix is (m[i], m[4+i], m[8+i], m[12+i])
+    const float* m = viewProj.m;
+    float r0[4] = { m[0], m[4], m[8], m[12] };
+    float r1[4] = { m[1], m[5], m[9], m[13] };
+    float r2[4] = { m[2], m[6], m[10], m[14] };
+    float r3[4] = { m[3], m[7], m[11], m[15] };
+
+    SetPlane( m_nx, m_ny, m_nz, m_d, 0, r3[0] + r0[0], r3[1] + r0[1], r3[2] + r0[2], r3[3] + r0[3] ); // Left
+    SetPlane( m_nx, m_ny, m_nz, m_d, 1, r3[0] - r0[0], r3[1] - r0[1], r3[2] - r0[2], r3[3] - r0[3] ); // Right
+    SetPlane( m_nx, m_ny, m_nz, m_d, 2, r3[0] + r1[0], r3[1] + r1[1], r3[2] + r1[2], r3[3] + r1[3] ); // Bottom
+    SetPlane( m_nx, m_ny, m_nz, m_d, 3, r3[0] - r1[0], r3[1] - r1[1], r3[2] - r1[2], r3[3] - r1[3] ); // Top
+    SetPlane( m_nx, m_ny, m_nz, m_d, 4, r3[0] + r2[0], r3[1] + r2[1], r3[2] + r2[2], r3[3] + r2[3] ); // Near
+    SetPlane( m_nx, m_ny, m_nz, m_d, 5, r3[0] - r2[0], r3[1] - r2[1], r3[2] - r2[2], r3[3] - r2[3] ); // Far
+    m_planeCount = 6;
+
+    memcpy( m_depthRow, r3, sizeof( m_depthRow ) );
+}
+
+
+void Frustum::SetClipPlane( float a, float b, float c, float d )
+{
+    SetPlane( m_nx, m_ny, m_nz, m_d, CLIP_PLANE_SLOT, a, b, c, d );
+    m_planeCount = CLIP_PLANE_SLOT + 1;
+}
+
+
+bool Frustum::TestSphere( float x, float y, float z, float r ) const
+{
+    for ( int p = 0; p < m_planeCount; ++p )
+    {
+        if ( m_nx[p] * x + m_ny[p] * y + m_nz[p] * z + m_d[p] < -r )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+float Frustum::GetDepth( float x, float y, float z ) const
+{
+    return m_depthRow[0] * x + m_depthRow[1] * y + m_depthRow[2] * z + m_depthRow[3];
+}
+
+
+SphereCullList::SphereCullList()
+    : m_count( 0 )
+{
+}
+
+
+void SphereCullList::Reserve( int capacity )
+{
+    size_t padded = static_cast<size_t>( ( capacity + 3 ) & ~3 );
+    m_x.reserve( padded );
+    m_y.reserve( padded );
+    m_z.reserve( padded );
+    m_r.reserve( padded );
+    m_visible.reserve( padded );
+    m_keys.reserve( padded );
+    m_scratchKeys.reserve( padded );
+    m_scratchValues.reserve( padded );
+}
+
+
+void SphereCullList::Clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_r.clear();
+    m_visible.clear();
+    m_count = 0;
+}
+
+
+void SphereCullList::Add( float x, float y, float z, float r )
+{
+    m_x.push_back( x );
+    m_y.push_back( y );
+    m_z.push_back( z );
+    m_r.push_back( r );
+    ++m_count;
+}
+
+
+int SphereCullList::Cull( const Frustum& frustum, bool backToFront )
+{
+    m_visible.clear();
+    if ( m_count == 0 )
+    {
+        return 0;
+    }
+
+    // Pad the SoA arrays to whole SSE lanes; padding lanes are masked off below
+    size_t padded = static_cast<size_t>( ( m_count + 3 ) & ~3 );
+    m_x.resize( padded, 0.0f );
+    m_y.resize( padded, 0.0f );
+    m_z.resize( padded, 0.0f );
+    m_r.resize( padded, 0.0f );
+    m_visible.resize( padded );
+    m_keys.resize( padded );
+
+    __m128 planeX[Frustum::MAX_PLANES];
+    __m128 planeY[Frustum::MAX_PLANES];
+    __m128 planeZ[Frustum::MAX_PLANES];
+    __m128 planeD[Frustum::MAX_PLANES];
+    int planeCount = frustum.m_planeCount;
+    for ( int p = 0; p < planeCount; ++p )
+    {
+        planeX[p] = _mm_set1_ps( frustum.m_nx[p] );
+        planeY[p] = _mm_set1_ps( frustum.m_ny[p] );
+        planeZ[p] = _mm_set1_ps( frustum.m_nz[p] );
+        planeD[p] = _mm_set1_ps( frustum.m_d[p] );
+    }
+    const __m128 depthX = _mm_set1_ps( frustum.m_depthRow[0] );
+    const __m128 depthY = _mm_set1_ps( frustum.m_depthRow[1] );
+    const __m128 depthZ = _mm_set1_ps( frustum.m_depthRow[2] );
+    const __m128 depthW = _mm_set1_ps( frustum.m_depthRow[3] );
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 allLanes = _mm_cmpeq_ps( zero, zero );
+
+    int visibleCount = 0;
+    for ( int i = 0; i < m_count; i += 4 )
+    {
+        __m128 x = _mm_loadu_ps( &m_x[i] );
+        __m128 y = _mm_loadu_ps( &m_y[i] );
+        __m128 z = _mm_loadu_ps( &m_z[i] );
+        __m128 negR = _mm_sub_ps( zero, _mm_loadu_ps( &m_r[i] ) );
+
+        // Inside unless the centre is more than r behind any plane
+        __m128 inside = allLanes;
+        for ( int p = 0; p < planeCount; ++p )
+        {
+            __m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( planeX[p], x ), _mm_mul_ps( planeY[p], y ) ),
+                                      _mm_add_ps( _mm_mul_ps( planeZ[p], z ), planeD[p] ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( dist, negR ) );
+        }
+
+        int mask = _mm_movemask_ps( inside );
+        int lanes = m_count - i;
+        if ( lanes < 4 )
+        {
+            mask &= ( 1 << lanes ) - 1;
+        }
+        if ( !mask )
+        {
+            continue;
+        }
+
+        float depth[4];
+        _mm_storeu_ps( depth, _mm_add_ps( _mm_add_ps( _mm_mul_ps( depthX, x ), _mm_mul_ps( depthY, y ) ),
+                                          _mm_add_ps( _mm_mul_ps( depthZ, z ), depthW ) ) );
+        for ( int lane = 0; lane < 4; ++lane )
+        {
+            if ( mask & ( 1 << lane ) )
+            {
+                uint32_t key = SortableKey( depth[lane] );
+                m_visible[visibleCount] = static_cast<uint32_t>( i + lane );
+                m_keys[visibleCount] = backToFront ? ~key : key;
+                ++visibleCount;
+            }
+        }
+    }
+
+    m_visible.resize( visibleCount );
+    SortVisible( visibleCount );
+    return visibleCount;
+}
+
+
+int SphereCullList::RemoveOccluded( const TerrainHorizon& horizon )
+{
+    if ( !horizon.IsActive() )
+    {
+        return static_cast<int>( m_visible.size() );
+    }
+
+    size_t kept = 0;
+    for ( uint32_t index : m_visible )
+    {
+        if ( !horizon.IsSphereOccluded( m_x[index], m_y[index], m_z[index], m_r[index] ) )
+        {
+            m_visible[kept++] = index;
+        }
+    }
+    m_visible.resize( kept );
+    return static_cast<int>( kept );
+}
+
+
+void SphereCullList::SortVisible( int visibleCount )
+{
+    if ( visibleCount < 2 )
+    {
+        return;
+    }
+
+    m_scratchKeys.resize( visibleCount );
+    m_scratchValues.resize( visibleCount );
+
+    // One histogram pass for all four digits
+    uint32_t histogram[4][256] = {};
+    for ( int i = 0; i < visibleCount; ++i )
+    {
+        uint32_t key = m_keys[i];
+        ++histogram[0][key & 0xFF];
+        ++histogram[1][( key >> 8 ) & 0xFF];
+        ++histogram[2][( key >> 16 ) & 0xFF];
+        ++histogram[3][key >> 24];
+    }
+
+    uint32_t* srcKeys = m_keys.data();
+    uint32_t* srcValues = m_visible.data();
+    uint32_t* dstKeys = m_scratchKeys.data();
+    uint32_t* dstValues = m_scratchValues.data();
+    bool inScratch = false;
+
+    for ( int digit = 0; digit < 4; ++digit )
+    {
+        int shift = digit * 8;
+
+        // Every key shares this digit: the pass would be an identity copy
+        if ( histogram[digit][( srcKeys[0] >> shift ) & 0xFF] == static_cast<uint32_t>( visibleCount ) )
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for ( int b = 0; b < 256; ++b )
+        {
+            uint32_t count = histogram[digit][b];
+            histogram[digit][b] = offset;
+            offset += count;
+        }
+
+        for ( int i = 0; i < visibleCount; ++i )
+        {
+            uint32_t key = srcKeys[i];
+            uint32_t slot = histogram[digit][( key >> shift ) & 0xFF]++;
+            dstKeys[slot] = key;
+            dstValues[slot] = srcValues[i];
+        }
+
+        std::swap( srcKeys, dstKeys );
+        std::swap( srcValues, dstValues );
+        inScratch = !inScratch;
+    }
+
+    if ( inScratch )
+    {
+        m_keys.swap( m_scratchKeys );
+        m_visible.swap( m_scratchValues );
+    }
+}
+
+
+int SphereCullList::GetCount() const
+{
+    return m_count;
+}
+
+
+const uint32_t* SphereCullList::GetVisible() const
+{
+    return m_visible.data();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+
+// --- Includes ---
+#include <vector>
+#include <cstdint>
+#include "SkullbonezMatrix4.h"
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Math::Transformation;
+
+
+namespace SkullbonezCore
+{
+namespace Geometry
+{
+class TerrainHorizon;
+
+
+/* -- Frustum ----------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Six view-volume planes extracted from a view-projection matrix (Gribb/Hartmann), normalised and stored
+    structure-of-arrays so four spheres can be tested per SSE iteration.  An optional user clip plane (e.g.
+    the reflection pass water plane) occupies a seventh slot; unused slots always pass.  The near plane is
+    taken as w + z, which is exact for [-1,1] depth and conservative for [0,1] depth projections.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class Frustum
+{
+
+  public:
+    static constexpr int MAX_PLANES = 8;
+
+  private:
+    friend class SphereCullList;
+
+    float m_nx[MAX_PLANES]; // Plane normals / distances, SoA
+    float m_ny[MAX_PLANES];
+    float m_nz[MAX_PLANES];
+    float m_d[MAX_PLANES];
+    float m_depthRow[4]; // Clip-space w row: view depth of a point for sorting
+    int m_planeCount;    // 6, or 7 with a clip plane
+
+  public:
+    Frustum();                                   // All planes pass
+    explicit Frustum( const Matrix4& viewProj ); // Extract from a view-projection matrix
+
+    void SetClipPlane( float a, float b, float c, float d );     // Keep ax + by + cz + d >= 0 (normal need not be unit length)
+    bool TestSphere( float x, float y, float z, float r ) const; // Scalar test for single objects
+    float GetDepth( float x, float y, float z ) const;           // Clip-space w (view depth for perspective)
+};
+
+
+/* -- Sphere Cull List -------------------------------------------------------------------------------------------------------------------------------------------
+
+    Retained-capacity list of bounding spheres for one pass.  Add() every candidate, then Cull() writes the
+    indices (in Add() order) of spheres intersecting the frustum, radix-sorted by view depth.  No heap
+    allocations once the buffers have grown to the working set.  RemoveOccluded() then drops visible spheres
+    hidden behind the terrain, keeping the depth order of the rest.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class SphereCullList
+{
+
+  private:
+    std::vector<float> m_x, m_y, m_z, m_r; // Candidate spheres, SoA (padded to a multiple of 4 by Cull)
+    std::vector<uint32_t> m_visible;       // Sorted visible candidate indices
+    std::vector<uint32_t> m_keys;          // Radix sort keys (sortable depth bits)
+    std::vector<uint32_t> m_scratchKeys;   // Radix sort ping-pong keys
+    std::vector<uint32_t> m_scratchValues; // Radix sort ping-pong indices
+    int m_count;                           // Candidates added since Clear()
+
+    void SortVisible( int visibleCount ); // LSD radix sort of m_visible by m_keys
+
+  public:
+    SphereCullList();
+
+    void Reserve( int capacity );
+    void Clear();
+    void Add( float x, float y, float z, float r );
+    int Cull( const Frustum& frustum, bool backToFront = false ); // Returns the visible count
+    int RemoveOccluded( const TerrainHorizon& horizon );          // After Cull(); returns the remaining visible count
+
+    int GetCount() const;               // Candidates added since Clear()
+    const uint32_t* GetVisible() const; // Valid until the next Clear()
+};
+} // namespace Geometry
+} // namespace SkullbonezCore
@@ -4,6 +4,7 @@
 #include "SkullbonezGeometricStructures.h"
 #include "SkullbonezGeometricMath.h"
 #include "SkullbonezCollisionResponse.h"
+#include <algorithm>
 
 
 // --- Usings ---
@@ -249,6 +250,32 @@ Matrix4 GameModel::GetModelMatrix()
 }
 
 
+void GameModel::GetRenderInstance( float out[8] )
+{
+    // Same rotation as GetModelMatrix() expressed as a unit quaternion (x, y, z, w) in the usual
+    // active-rotation convention, so the vertex shaders can rebuild it without a Matrix4 per ball.
+    // FromQuaternion() yields the transpose of the standard matrix, i.e. the conjugate q*;
+    // the visual 90° Y yaw is then appended as the Hamilton product q* (x) (0, sin45, 0, cos45).
+    float qx, qy, qz, qw;
+    m_physicsInfo.GetOrientation().GetComponents( qx, qy, qz, qw );
+    const float h = 0.70710678f;
+    float ax = -qx;
+    float ay = -qy;
+    float az = -qz;
+    float aw = qw;
+
+    const Vector3& pos = m_physicsInfo.GetPosition();
+    out[0] = pos.x;
+    out[1] = pos.y;
+    out[2] = pos.z;
+    out[3] = GetBoundingRadius();
+    out[4] = ( ax - az ) * h;
+    out[5] = ( aw + ay ) * h;
+    out[6] = ( ax + az ) * h;
+    out[7] = ( aw - ay ) * h;
+}
+
+
 void GameModel::ApplyForces( float changeInTime )
 {
     // throttle the angular velocity
@@ -332,11 +359,41 @@ float GameModel::GetTerrainCollisionTime( float changeInTime )
     float bottomOffset = GetShapeTerrainBottomOffset( m_boundingVolume );
 
     // if out of bounds, no collision has occured
-    if ( !m_terrain->IsInBounds( m_physicsInfo.GetPosition().x, m_physicsInfo.GetPosition().z ) )
+    const Vector3& position = m_physicsInfo.GetPosition();
+    if ( !m_terrain->IsInBounds( position.x, position.z ) )
     {
         return NO_COLLISION;
     }
 
+    // airborne early-out: the lowest point of the sphere stays above the highest ground under its path this step
+    const Vector3& motion = m_responseInformation.testingRay.vector3;
+    float lowestY = position.y + ( std::min )( motion.y, 0.0f ) - bottomOffset;
+    float reach = GetShapeBoundingRadius( m_boundingVolume );
+    float groundMaxY = m_terrain->GetMaxHeightInRegion( position.x + ( std::min )( motion.x, 0.0f ) - reach,
+                                                        position.z + ( std::min )( motion.z, 0.0f ) - reach,
+                                                        position.x + ( std::max )( motion.x, 0.0f ) + reach,
+                                                        position.z + ( std::max )( motion.z, 0.0f ) + reach );
+    if ( lowestY - groundMaxY > Cfg().contactEpsilon )
+    {
+        return NO_COLLISION;
+    }
+
+    // swept sphere: earliest contact with any triangle the sphere passes this step (within contactEpsilon counts as touching)
+    if ( Cfg().terrainSweptSphere )
+    {
+        TerrainHit hit;
+        if ( !m_terrain->SweepSphere( position, reach + Cfg().contactEpsilon, motion, hit ) )
+        {
+            return NO_COLLISION;
+        }
+
+        // respond against the tangent plane at the contact point
+        m_responseInformation.testingPlane.m_normal = hit.normal;
+        m_responseInformation.testingPlane.m_distance = hit.normal * hit.point;
+        m_responseInformation.collisionTime = hit.time;
+        return hit.time;
+    }
+
     // store the plane vertically aligned with the object
     m_responseInformation.testingPlane = GeometricMath::ComputePlane( m_terrain->LocatePolygon( m_physicsInfo.GetPosition().x,
                                                                                                 m_physicsInfo.GetPosition().z ) );
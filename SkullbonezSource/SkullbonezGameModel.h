@@ -67,6 +67,7 @@ class GameModel
     GameModel& operator=( GameModel&& ) noexcept = default; // Move assignment
 
     Matrix4 GetModelMatrix();                                                         // Returns the model matrix for rendering (T*R*T*S)
+    void GetRenderInstance( float out[8] );                                           // Writes centre, radius and render orientation quaternion (compact instance)
     bool IsResponseRequired();                                                        // Indicates whether a collision response is required
     float GetSubmergedVolumePercent();                                                // Returns the percentage of the game model submerged in fluid
     float GetMass();                                                                  // Returns the mass of the game model
@@ -3,7 +3,9 @@
 #include "SkullbonezProfiler.h"
 #include "SkullbonezHelper.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
 #include <cmath>
+#include <cstring>
 
 
 // --- Usings ---
@@ -11,15 +13,18 @@ using namespace SkullbonezCore::GameObjects;
 using namespace SkullbonezCore::Basics;
 
 
-// Per-instance data layout: mat4 (16 floats) + alpha (1 float)
-static constexpr int SHADOW_INSTANCE_FLOATS = 17;
+// Per-instance data layout: disc centre + radius (4 floats), terrain normal + alpha (4 floats)
+static constexpr int SHADOW_INSTANCE_FLOATS = 8;
 
 
 GameModelCollection::GameModelCollection()
     : m_spatialGrid( Cfg().broadphaseCell ), m_rollLog( nullptr )
 {
     m_gameModels.reserve( MAX_GAME_MODELS );
-    m_shadowInstanceData.reserve( MAX_GAME_MODELS * SHADOW_INSTANCE_FLOATS );
+    m_modelCull.Reserve( MAX_GAME_MODELS );
+    m_visibleLods.reserve( MAX_GAME_MODELS );
+    m_shadowCull.Reserve( MAX_GAME_MODELS );
+    m_shadowCandidates.reserve( MAX_GAME_MODELS );
 };
 
 void GameModelCollection::AddGameModel( GameModel gameModel )
@@ -47,26 +52,164 @@ void GameModelCollection::Clear()
 }
 
 
-void GameModelCollection::RenderModels( const Matrix4& view, const Matrix4& proj, const float lightPos[4] )
+void GameModelCollection::PublishRenderState()
 {
-    if ( m_gameModels.empty() )
+    std::vector<RenderBody>& bodies = m_renderState.GetWriteBuffer();
+    bodies.resize( m_gameModels.size() );
+    for ( size_t i = 0; i < m_gameModels.size(); ++i )
     {
-        return;
+        GameModel& model = m_gameModels[i];
+        RenderBody& body = bodies[i];
+        model.GetRenderInstance( body.instance );
+        body.velocity = model.GetVelocity();
+        body.angularVelocity = model.GetAngularVelocity();
+        body.orientationUp = model.GetOrientationUp();
     }
+    m_renderState.Publish();
+}
 
-    SkullbonezHelper::DrawSphereBatchBegin( view, proj, lightPos, Cfg().renderCollisionVolumes );
-    for ( int x = 0; x < static_cast<int>( m_gameModels.size() ); ++x )
+
+bool GameModelCollection::AcquireRenderState()
+{
+    return m_renderState.Acquire();
+}
+
+
+const std::vector<GameModelCollection::RenderBody>& GameModelCollection::GetRenderBodies() const
+{
+    return m_renderState.GetReadBuffer();
+}
+
+
+void GameModelCollection::SnapshotRenderBodies( std::vector<float>& out ) const
+{
+    const std::vector<RenderBody>& bodies = m_renderState.GetReadBuffer();
+    out.resize( bodies.size() * 8 );
+    for ( size_t i = 0; i < bodies.size(); ++i )
+    {
+        memcpy( &out[i * 8], bodies[i].instance, sizeof( bodies[i].instance ) );
+    }
+}
+
+
+bool GameModelCollection::HasVisibleMotion( const Geometry::Frustum& frustum, const std::vector<float>& snapshot, float threshold ) const
+{
+    const std::vector<RenderBody>& bodies = m_renderState.GetReadBuffer();
+    if ( snapshot.size() != bodies.size() * 8 )
+    {
+        return true; // Bodies were added or removed
+    }
+
+    for ( size_t i = 0; i < bodies.size(); ++i )
+    {
+        const float* now = bodies[i].instance;
+        const float* then = &snapshot[i * 8];
+
+        // A body outside the frustum at both ends cannot have changed what the pass sees
+        if ( !frustum.TestSphere( now[0], now[1], now[2], now[3] ) && !frustum.TestSphere( then[0], then[1], then[2], then[3] ) )
+        {
+            continue;
+        }
+
+        float dx = now[0] - then[0];
+        float dy = now[1] - then[1];
+        float dz = now[2] - then[2];
+        if ( dx * dx + dy * dy + dz * dz > threshold * threshold || now[3] != then[3] )
+        {
+            return true;
+        }
+
+        // Surface travel from rotation: |q - q'| (or |q + q'|, same rotation) is about half the angle turned
+        float minus = 0.0f;
+        float plus = 0.0f;
+        for ( int k = 4; k < 8; ++k )
+        {
+            minus += ( now[k] - then[k] ) * ( now[k] - then[k] );
+            plus += ( now[k] + then[k] ) * ( now[k] + then[k] );
+        }
+        if ( now[3] * 2.0f * sqrtf( ( std::min )( minus, plus ) ) > threshold )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int GameModelCollection::RenderModels( const Matrix4& view, const Matrix4& proj, const float lightPos[4], int viewportHeight, const float* clipPlane, const Geometry::TerrainHorizon* horizon )
+{
+    const std::vector<RenderBody>& bodies = m_renderState.GetReadBuffer();
+    if ( bodies.empty() )
+    {
+        return 0;
+    }
+
+    Geometry::Frustum frustum( proj * view );
+    if ( clipPlane )
+    {
+        frustum.SetClipPlane( clipPlane[0], clipPlane[1], clipPlane[2], clipPlane[3] );
+    }
+
+    m_modelCull.Clear();
+    for ( const RenderBody& body : bodies )
     {
-        Matrix4 model = m_gameModels[x].GetModelMatrix();
-        SkullbonezHelper::DrawSphereBatchModel( model );
+        m_modelCull.Add( body.instance[0], body.instance[1], body.instance[2], body.instance[3] );
     }
-    SkullbonezHelper::DrawSphereBatchEnd();
+
+    // Opaque spheres go front-to-back for early depth rejection; translucent ones back-to-front for blending
+    bool isTransparent = Cfg().renderCollisionVolumes;
+    int visibleCount = m_modelCull.Cull( frustum, isTransparent );
+    if ( horizon )
+    {
+        int inFrustum = visibleCount;
+        visibleCount = m_modelCull.RemoveOccluded( *horizon );
+        PROFILE_COUNTER_ADD( "Cull/Horizon/Balls", inFrustum - visibleCount );
+    }
+    if ( visibleCount == 0 )
+    {
+        return 0;
+    }
+
+    // Projected radius in pixels = r * proj[1][1] * (height / 2) / w
+    float pixelScale = proj.m[5] * 0.5f * static_cast<float>( viewportHeight );
+    bool selectLod = !SkullbonezHelper::IsSphereImpostors();
+
+    // Pick levels first so each level's draw can be sized up front, then write instances straight into
+    // the mapped spans in depth order
+    const uint32_t* visible = m_modelCull.GetVisible();
+    int lodCounts[SkullbonezHelper::SPHERE_LOD_COUNT] = {};
+    m_visibleLods.resize( visibleCount );
+    for ( int i = 0; i < visibleCount; ++i )
+    {
+        const float* instance = bodies[visible[i]].instance;
+        float radius = instance[3];
+        float w = frustum.GetDepth( instance[0], instance[1], instance[2] );
+        int lod = ( selectLod && w > radius ) ? SkullbonezHelper::SelectSphereLod( radius * pixelScale / w ) : 0;
+
+        m_visibleLods[i] = static_cast<uint8_t>( lod );
+        ++lodCounts[lod];
+    }
+
+    float* cursors[SkullbonezHelper::SPHERE_LOD_COUNT];
+    SkullbonezHelper::DrawSphereBatchBegin( view, proj, lightPos, isTransparent );
+    SkullbonezHelper::DrawSphereBatchEnd( lodCounts, cursors );
+    for ( int i = 0; i < visibleCount; ++i )
+    {
+        float*& cursor = cursors[m_visibleLods[i]];
+        if ( cursor )
+        {
+            memcpy( cursor, bodies[visible[i]].instance, sizeof( bodies[visible[i]].instance ) );
+            cursor += SkullbonezHelper::SPHERE_INSTANCE_FLOATS;
+        }
+    }
+    return visibleCount;
 }
 
 
 void GameModelCollection::RenderShadows( Geometry::Terrain* m_terrain,
                                          const Matrix4& view,
-                                         const Matrix4& proj )
+                                         const Matrix4& proj,
+                                         const Geometry::TerrainHorizon* horizon )
 {
     if ( !m_terrain )
     {
@@ -78,18 +221,25 @@ void GameModelCollection::RenderShadows( Geometry::Terrain* m_terrain,
         BuildShadowMesh();
     }
 
-    // Build per-instance data: model matrix (16 floats) + alpha (1 float)
-    m_shadowInstanceData.clear();
-    for ( int i = 0; i < static_cast<int>( m_gameModels.size() ); ++i )
+    // Gather shadows that pass the height fade as discs on the ground, then cull them against the view
+    m_shadowCull.Clear();
+    m_shadowCandidates.clear();
+    for ( const RenderBody& body : m_renderState.GetReadBuffer() )
     {
-        Vector3 pos = m_gameModels[i].GetPosition();
-        float radius = m_gameModels[i].GetBoundingRadius();
+        Vector3 pos( body.instance[0], body.instance[1], body.instance[2] );
+        float radius = body.instance[3];
 
         if ( !m_terrain->IsInBounds( pos.x, pos.z ) )
         {
             continue;
         }
 
+        // Too high above the highest ground nearby to cast a visible shadow: skip the polygon lookup
+        if ( pos.y - radius - m_terrain->GetMaxHeightInRegion( pos.x, pos.z, pos.x, pos.z ) >= Cfg().shadowMaxHeight )
+        {
+            continue;
+        }
+
         float groundY = m_terrain->GetTerrainHeightAt( pos.x, pos.z );
         float height = pos.y - groundY - radius;
         if ( height < 0.0f )
@@ -101,68 +251,79 @@ void GameModelCollection::RenderShadows( Geometry::Terrain* m_terrain,
             continue;
         }
 
-        float alpha = Cfg().shadowMaxAlpha * ( 1.0f - height / Cfg().shadowMaxHeight );
-        float shadowRadius = radius * Cfg().shadowScale;
-
-        Vector3 N = m_terrain->GetTerrainNormalAt( pos.x, pos.z );
-
-        // Build model matrix: translate → rotate to terrain normal → scale
-        Matrix4 model = Matrix4::Translate( pos.x, groundY + Cfg().shadowOffset, pos.z );
-
-        float cosA = N.y;
-        if ( cosA < 0.9999f )
-        {
-            float axisX = N.z;
-            float axisZ = -N.x;
-            float axisMag = sqrtf( axisX * axisX + axisZ * axisZ );
-            axisX /= axisMag;
-            axisZ /= axisMag;
-            float angleDeg = acosf( cosA ) * ( 180.0f / 3.14159265f );
-            model = model * Matrix4::RotateAxis( angleDeg, axisX, 0.0f, axisZ );
-        }
-
-        model = model * Matrix4::Scale( shadowRadius );
+        ShadowCandidate candidate;
+        candidate.ground = Vector3( pos.x, groundY + Cfg().shadowOffset, pos.z );
+        candidate.radius = radius * Cfg().shadowScale;
+        candidate.alpha = Cfg().shadowMaxAlpha * ( 1.0f - height / Cfg().shadowMaxHeight );
+        m_shadowCandidates.push_back( candidate );
+        m_shadowCull.Add( candidate.ground.x, candidate.ground.y, candidate.ground.z, candidate.radius );
+    }
 
-        // Append mat4 (16 floats) + alpha (1 float)
-        const float* md = model.Data();
-        m_shadowInstanceData.insert( m_shadowInstanceData.end(), md, md + 16 );
-        m_shadowInstanceData.push_back( alpha );
+    int visibleCount = m_shadowCull.Cull( Geometry::Frustum( proj * view ) );
+    if ( horizon )
+    {
+        int inFrustum = visibleCount;
+        visibleCount = m_shadowCull.RemoveOccluded( *horizon );
+        PROFILE_COUNTER_ADD( "Cull/Horizon/Shadows", inFrustum - visibleCount );
     }
+    PROFILE_COUNTER_ADD( "Cull/Shadows/Visible", visibleCount );
+    PROFILE_COUNTER_ADD( "Cull/Shadows/Culled", m_shadowCull.GetCount() - visibleCount );
 
-    int instanceCount = static_cast<int>( m_shadowInstanceData.size() ) / SHADOW_INSTANCE_FLOATS;
-    if ( instanceCount == 0 )
+    if ( visibleCount == 0 )
     {
         return;
     }
 
-    // Upload instance data
-    Gfx().UploadInstanceData( m_shadowInstMesh, m_shadowInstanceData.data(), static_cast<int>( m_shadowInstanceData.size() ) );
-
-    // Render all shadows in one instanced draw call
-    Gfx().SetBlend( true );
-    Gfx().SetPolygonOffset( true, -1.0f, -1.0f );
-    Gfx().SetCullFace( false );
-
-    m_shadowShader->Use();
-    m_shadowShader->SetMat4( "uView", view );
-    m_shadowShader->SetMat4( "uProjection", proj );
-
-    Gfx().DrawInstancedMesh( m_shadowInstMesh, m_shadowDiscVertexCount, instanceCount );
+    // Render all shadows in one instanced draw call, after the terrain they sit on
+    RenderState state;
+    state.blend = true;
+    state.polygonOffset = true;
+    state.polygonOffsetFactor = -1.0f;
+    state.polygonOffsetUnits = -1.0f;
+    state.cullFace = false;
+
+    RenderQueue& queue = RenderQueue::Instance();
+    queue.Begin( RenderLayer::Decal, m_shadowShader.get(), state );
+    queue.SetMat4( m_shadowView, view );
+    queue.SetMat4( m_shadowProjection, proj );
+    float* dst = queue.DrawInstancedMapped( m_shadowInstMesh, m_shadowDiscVertexCount, visibleCount, visibleCount * SHADOW_INSTANCE_FLOATS );
+    if ( !dst )
+    {
+        return;
+    }
 
-    Gfx().SetPolygonOffset( false );
-    Gfx().SetCullFace( true );
-    Gfx().SetBlend( false );
+    // Write per-instance data for the visible discs straight into the mapped span; the shader tilts each
+    // disc onto the normal
+    const uint32_t* visible = m_shadowCull.GetVisible();
+    for ( int i = 0; i < visibleCount; ++i )
+    {
+        const ShadowCandidate& candidate = m_shadowCandidates[visible[i]];
+        const Vector3& ground = candidate.ground;
+        Vector3 N = m_terrain->GetTerrainNormalAt( ground.x, ground.z );
+
+        dst[0] = ground.x;
+        dst[1] = ground.y;
+        dst[2] = ground.z;
+        dst[3] = candidate.radius;
+        dst[4] = N.x;
+        dst[5] = N.y;
+        dst[6] = N.z;
+        dst[7] = candidate.alpha;
+        dst += SHADOW_INSTANCE_FLOATS;
+    }
 }
 
 
 Vector3 GameModelCollection::GetModelPosition( int index )
 {
-    if ( index < 0 || index >= static_cast<int>( m_gameModels.size() ) )
+    const std::vector<RenderBody>& bodies = m_renderState.GetReadBuffer();
+    if ( index < 0 || index >= static_cast<int>( bodies.size() ) )
     {
         throw std::runtime_error( "No game model exists at the specified index.  (GameModelCollection::GetModelPosition)" );
     }
 
-    return m_gameModels[index].GetPosition();
+    const float* instance = bodies[index].instance;
+    return Vector3( instance[0], instance[1], instance[2] );
 }
 
 
@@ -399,13 +560,15 @@ void GameModelCollection::BuildShadowMesh()
 
     m_shadowDiscVertexCount = Cfg().shadowSegments * 3;
 
-    // Instance layout: 5 attributes (4×vec4 for mat4 + 1×float for alpha), starting at location 3
-    int instanceAttribSizes[] = { 4, 4, 4, 4, 1 };
-    m_shadowInstMesh = Gfx().CreateInstancedMesh( verts.data(), m_shadowDiscVertexCount, 3, MAX_GAME_MODELS, SHADOW_INSTANCE_FLOATS, 3, instanceAttribSizes, 5 );
+    // Instance layout: 2 attributes (centre+radius vec4, normal+alpha vec4), starting at location 3
+    int instanceAttribSizes[] = { 4, 4 };
+    m_shadowInstMesh = Gfx().CreateInstancedMesh( verts.data(), m_shadowDiscVertexCount, 3, SHADOW_INSTANCE_FLOATS, 3, instanceAttribSizes, 2 );
 
     // Create shader
     m_shadowShader = Gfx().CreateShader( "SkullbonezData/shaders/shadow.vert",
                                          "SkullbonezData/shaders/shadow.frag" );
+    m_shadowView = m_shadowShader->GetUniformHandle( "uView" );
+    m_shadowProjection = m_shadowShader->GetUniformHandle( "uProjection" );
 }
 
 
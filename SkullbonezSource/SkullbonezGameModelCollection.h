@@ -13,6 +13,8 @@
 #include "SkullbonezTerrain.h"
 #include "SkullbonezMatrix4.h"
 #include "SkullbonezIShader.h"
+#include "SkullbonezFrustum.h"
+#include "SkullbonezTripleBuffer.h"
 
 
 // --- Usings ---
@@ -30,22 +32,49 @@ namespace GameObjects
 /* -- Game Model Collection --------------------------------------------------------------------------------------------------------------------------------------
 
     Represents a collection of game models and operations to assist in managing the collection.
+
+    Physics and rendering are split: RunPhysics() mutates the models, PublishRenderState() snapshots what
+    rendering needs into a lock-free triple buffer, and the render methods only read the snapshot taken by
+    AcquireRenderState().  That lets the simulation run on its own thread (see SimulationThread).
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class GameModelCollection
 {
 
+  public:
+    struct RenderBody
+    {
+        float instance[8];       // GameModel::GetRenderInstance layout: centre, radius, orientation quaternion
+        Vector3 velocity;        // Debug vectors
+        Vector3 angularVelocity; // Debug vectors
+        Vector3 orientationUp;   // Debug vectors
+    };
+
   private:
+    struct ShadowCandidate
+    {
+        Vector3 ground; // Terrain contact point beneath the model
+        float radius;   // Disc radius
+        float alpha;    // Fade by height above ground
+    };
+
     std::vector<GameModel> m_gameModels;               // Collection of game models
     SpatialGrid m_spatialGrid;                         // Broadphase spatial grid for collision culling
     std::vector<std::pair<int, int>> m_candidatePairs; // Retained-capacity pair buffer (avoids per-frame alloc)
     std::unique_ptr<IShader> m_shadowShader;           // Shadow decal shader (instanced)
-    uint32_t m_shadowInstMesh = 0;                     // Instanced mesh handle (via Gfx())
-    int m_shadowDiscVertexCount = 0;                   // Disc triangle vertex count
-    std::vector<float> m_shadowInstanceData;           // Retained-capacity staging buffer (mat4 + alpha per instance)
-    FILE* m_rollLog;                                   // Optional roll orientation log (null = disabled)
-    std::vector<bool> m_planeSeenGreen;                // True after a model first enters BLUE tolerance
-    std::vector<bool> m_planeFailed;                   // Latched failure: model went WHITE after first BLUE
-    std::vector<int> m_planeBlueStreak;                // Consecutive grounded BLUE frames before lock
+    UniformHandle m_shadowView = UniformHandle::Invalid;
+    UniformHandle m_shadowProjection = UniformHandle::Invalid;
+    uint32_t m_shadowInstMesh = 0;                   // Instanced mesh handle (via Gfx())
+    int m_shadowDiscVertexCount = 0;                 // Disc triangle vertex count
+    Geometry::SphereCullList m_modelCull;            // Per-pass sphere culling / depth sort
+    std::vector<uint8_t> m_visibleLods;              // Tessellation level per visible model, in cull order
+    Geometry::SphereCullList m_shadowCull;           // Shadow disc culling against the main view
+    std::vector<ShadowCandidate> m_shadowCandidates; // Shadows that pass the height test, in cull list order
+    FILE* m_rollLog;                                 // Optional roll orientation log (null = disabled)
+    std::vector<bool> m_planeSeenGreen;              // True after a model first enters BLUE tolerance
+    std::vector<bool> m_planeFailed;                 // Latched failure: model went WHITE after first BLUE
+    std::vector<int> m_planeBlueStreak;              // Consecutive grounded BLUE frames before lock
+
+    Basics::TripleBuffer<std::vector<RenderBody>> m_renderState; // Simulation -> render hand-off
 
     void BuildShadowMesh(); // Builds the shadow disc VAO with instanced attributes
 
@@ -53,16 +82,21 @@ class GameModelCollection
     GameModelCollection(); // Default constructor
     ~GameModelCollection() = default;
 
-    void AddGameModel( GameModel gameModel );                                                   // Moves a game model into the collection
-    void Clear();                                                                               // Clears all game models (retains GPU resources)
-    void RunPhysics( float fChangeInTime );                                                     // Runs the physics for the specified time step
-    void RenderModels( const Matrix4& view, const Matrix4& proj, const float lightPos[4] );     // Renders the game models
-    void RenderShadows( Geometry::Terrain* terrain, const Matrix4& view, const Matrix4& proj ); // Renders ground shadows beneath all models
-    void ResetGLResources();                                                                    // Releases GPU resources for GL context reset
-    void SetRollLog( FILE* file );                                                              // Sets the roll orientation log file (null = disabled)
-    Vector3 GetModelPosition( int index );                                                      // Returns the position of the specified game model
-    int GetModelCount() const;                                                                  // Returns the number of game models
-    GameModel& GetModelAtIndex( int index );                                                    // Returns a reference to the game model at the given index
+    void AddGameModel( GameModel gameModel );                                                                                                                                                       // Moves a game model into the collection
+    void Clear();                                                                                                                                                                                   // Clears all game models (retains GPU resources)
+    void RunPhysics( float fChangeInTime );                                                                                                                                                         // Runs the physics for the specified time step
+    void PublishRenderState();                                                                                                                                                                      // Simulation side: snapshots body transforms for the renderer
+    bool AcquireRenderState();                                                                                                                                                                      // Render side: switches to the newest snapshot (false = nothing newer)
+    const std::vector<RenderBody>& GetRenderBodies() const;                                                                                                                                         // Render side: bodies of the acquired snapshot
+    void SnapshotRenderBodies( std::vector<float>& out ) const;                                                                                                                                     // Render side: copies the instance data of the acquired snapshot
+    bool HasVisibleMotion( const Geometry::Frustum& frustum, const std::vector<float>& snapshot, float threshold ) const;                                                                           // Render side: true if a body inside the frustum moved more than threshold since the snapshot
+    int RenderModels( const Matrix4& view, const Matrix4& proj, const float lightPos[4], int viewportHeight, const float* clipPlane = nullptr, const Geometry::TerrainHorizon* horizon = nullptr ); // Culls, LOD-buckets and renders; returns visible count
+    void RenderShadows( Geometry::Terrain* terrain, const Matrix4& view, const Matrix4& proj, const Geometry::TerrainHorizon* horizon = nullptr );                                                  // Renders ground shadows beneath all visible models (horizon: skip those hidden behind terrain)
+    void ResetGLResources();                                                                                                                                                                        // Releases GPU resources for GL context reset
+    void SetRollLog( FILE* file );                                                                                                                                                                  // Sets the roll orientation log file (null = disabled)
+    Vector3 GetModelPosition( int index );                                                                                                                                                          // Returns the rendered position of the specified game model
+    int GetModelCount() const;                                                                                                                                                                      // Returns the number of game models
+    GameModel& GetModelAtIndex( int index );                                                                                                                                                        // Returns a reference to the game model at the given index
 };
 } // namespace GameObjects
 } // namespace SkullbonezCore
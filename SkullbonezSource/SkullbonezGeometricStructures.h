@@ -87,6 +87,17 @@ struct XZCoords
     float x, z;
 };
 
+/* -- Terrain Hit ------------------------------------------------------------------------------------------------------------------------------------------------
+
+    First contact found by a terrain ray cast or sphere sweep: time along the query, surface point, and the contact
+    normal pointing from the surface towards the query.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+struct TerrainHit
+{
+    float time;
+    Vector3 point, normal;
+};
+
 /* -- Ray --------------------------------------------------------------------------------------------------------------------------------------------------------
 
     A generic ray to represent a directed displacement.
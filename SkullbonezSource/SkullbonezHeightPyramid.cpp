@@ -0,0 +1,188 @@
+// --- Includes ---
+#include "SkullbonezHeightPyramid.h"
+#include <algorithm>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Geometry;
+
+
+HeightPyramid::HeightPyramid()
+    : m_levelOffset{}, m_levelSide{}, m_levelCount( 0 )
+{
+}
+
+
+void HeightPyramid::Build( const CompactHeightfield& heightfield )
+{
+    int cellsPerSide = heightfield.GetPostsPerSide() - 1;
+    if ( cellsPerSide < 1 )
+    {
+        throw std::runtime_error( "Terrain needs at least two posts per side.  (HeightPyramid::Build)" );
+    }
+
+    // Level sizes: halve (rounding up) until one node covers the map
+    int total = 0;
+    m_levelCount = 0;
+    for ( int side = cellsPerSide;; side = ( side + 1 ) / 2 )
+    {
+        if ( m_levelCount == MAX_LEVELS )
+        {
+            throw std::runtime_error( "Terrain is too large for the height pyramid.  (HeightPyramid::Build)" );
+        }
+        m_levelOffset[m_levelCount] = total;
+        m_levelSide[m_levelCount] = side;
+        total += side * side;
+        ++m_levelCount;
+        if ( side == 1 )
+        {
+            break;
+        }
+    }
+    m_nodes.resize( total );
+
+    // Level 0: each cell's four posts
+    for ( int cx = 0; cx < cellsPerSide; ++cx )
+    {
+        for ( int cz = 0; cz < cellsPerSide; ++cz )
+        {
+            FitCell( heightfield, cx, cz );
+        }
+    }
+
+    // Upper levels: merge the (up to) 2x2 children below
+    for ( int level = 1; level < m_levelCount; ++level )
+    {
+        int side = m_levelSide[level];
+        for ( int cx = 0; cx < side; ++cx )
+        {
+            for ( int cz = 0; cz < side; ++cz )
+            {
+                MergeNode( level, cx, cz );
+            }
+        }
+    }
+}
+
+
+void HeightPyramid::Refit( const CompactHeightfield& heightfield, int cellXMin, int cellZMin, int cellXMax, int cellZMax )
+{
+    int last = m_levelSide[0] - 1;
+    cellXMin = ( std::max )( cellXMin, 0 );
+    cellZMin = ( std::max )( cellZMin, 0 );
+    cellXMax = ( std::min )( cellXMax, last );
+    cellZMax = ( std::min )( cellZMax, last );
+    if ( cellXMin > cellXMax || cellZMin > cellZMax )
+    {
+        return;
+    }
+
+    for ( int cx = cellXMin; cx <= cellXMax; ++cx )
+    {
+        for ( int cz = cellZMin; cz <= cellZMax; ++cz )
+        {
+            FitCell( heightfield, cx, cz );
+        }
+    }
+
+    // Only the ancestors of the touched cells change: the rectangle halves at each level
+    for ( int level = 1; level < m_levelCount; ++level )
+    {
+        for ( int cx = cellXMin >> level; cx <= cellXMax >> level; ++cx )
+        {
+            for ( int cz = cellZMin >> level; cz <= cellZMax >> level; ++cz )
+            {
+                MergeNode( level, cx, cz );
+            }
+        }
+    }
+}
+
+
+void HeightPyramid::FitCell( const CompactHeightfield& heightfield, int cx, int cz )
+{
+    float h00 = heightfield.GetHeight( cx, cz );
+    float h01 = heightfield.GetHeight( cx, cz + 1 );
+    float h10 = heightfield.GetHeight( cx + 1, cz );
+    float h11 = heightfield.GetHeight( cx + 1, cz + 1 );
+
+    Range& range = m_nodes[cx * m_levelSide[0] + cz];
+    range.minY = ( std::min )( ( std::min )( h00, h01 ), ( std::min )( h10, h11 ) );
+    range.maxY = ( std::max )( ( std::max )( h00, h01 ), ( std::max )( h10, h11 ) );
+}
+
+
+void HeightPyramid::MergeNode( int level, int cx, int cz )
+{
+    int childSide = m_levelSide[level - 1];
+    const Range* children = &m_nodes[m_levelOffset[level - 1]];
+
+    Range merged = children[( cx * 2 ) * childSide + cz * 2];
+    for ( int i = 0; i < 2; ++i )
+    {
+        for ( int j = 0; j < 2; ++j )
+        {
+            int childX = cx * 2 + i;
+            int childZ = cz * 2 + j;
+            if ( childX < childSide && childZ < childSide )
+            {
+                const Range& child = children[childX * childSide + childZ];
+                merged.minY = ( std::min )( merged.minY, child.minY );
+                merged.maxY = ( std::max )( merged.maxY, child.maxY );
+            }
+        }
+    }
+    m_nodes[m_levelOffset[level] + cx * m_levelSide[level] + cz] = merged;
+}
+
+
+int HeightPyramid::GetLevelCount() const
+{
+    return m_levelCount;
+}
+
+
+int HeightPyramid::GetLevelSide( int level ) const
+{
+    return m_levelSide[level];
+}
+
+
+int HeightPyramid::GetCellsPerSide() const
+{
+    return m_levelCount ? m_levelSide[0] : 0;
+}
+
+
+const HeightPyramid::Range& HeightPyramid::GetRange( int level, int cx, int cz ) const
+{
+    return m_nodes[m_levelOffset[level] + cx * m_levelSide[level] + cz];
+}
+
+
+float HeightPyramid::GetMaxHeight( int cellXMin, int cellZMin, int cellXMax, int cellZMax ) const
+{
+    int last = m_levelSide[0] - 1;
+    cellXMin = cellXMin < 0 ? 0 : ( cellXMin > last ? last : cellXMin );
+    cellZMin = cellZMin < 0 ? 0 : ( cellZMin > last ? last : cellZMin );
+    cellXMax = cellXMax < cellXMin ? cellXMin : ( cellXMax > last ? last : cellXMax );
+    cellZMax = cellZMax < cellZMin ? cellZMin : ( cellZMax > last ? last : cellZMax );
+
+    // Climb until the rectangle spans at most 2x2 nodes, then take their maximum
+    int level = 0;
+    while ( level + 1 < m_levelCount &&
+            ( ( cellXMax >> level ) - ( cellXMin >> level ) > 1 || ( cellZMax >> level ) - ( cellZMin >> level ) > 1 ) )
+    {
+        ++level;
+    }
+
+    float maxY = GetRange( level, cellXMin >> level, cellZMin >> level ).maxY;
+    for ( int cx = cellXMin >> level; cx <= cellXMax >> level; ++cx )
+    {
+        for ( int cz = cellZMin >> level; cz <= cellZMax >> level; ++cz )
+        {
+            maxY = ( std::max )( maxY, GetRange( level, cx, cz ).maxY );
+        }
+    }
+    return maxY;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+
+// --- Includes ---
+#include <vector>
+#include "SkullbonezCommon.h"
+#include "SkullbonezCompactHeightfield.h"
+
+
+namespace SkullbonezCore
+{
+namespace Geometry
+{
+/* -- Height Pyramid ---------------------------------------------------------------------------------------------------------------------------------------------
+
+    Min/max mip pyramid over the cells of a terrain post grid.  Level 0 holds the height range of each cell
+    (the four posts around it, which bound both of its triangles); each level above merges 2x2 nodes of the
+    one below, up to a single root node covering the whole map.  Node (cx, cz) of level L covers cells
+    [cx << L, (cx + 1) << L) on each axis, clipped to the grid.  Cell indices follow the post layout: the
+    first index runs along world X, the second along world Z.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class HeightPyramid
+{
+
+  public:
+    static constexpr int MAX_LEVELS = 16; // Up to 32768 cells per side
+
+    struct Range
+    {
+        float minY, maxY;
+    };
+
+  private:
+    std::vector<Range> m_nodes;    // All levels, level 0 first, each laid out [cx * side + cz]
+    int m_levelOffset[MAX_LEVELS]; // First node of each level in m_nodes
+    int m_levelSide[MAX_LEVELS];   // Nodes per side at each level
+    int m_levelCount;
+
+    void FitCell( const CompactHeightfield& heightfield, int cx, int cz ); // Level 0 node from the cell's four posts
+    void MergeNode( int level, int cx, int cz );                           // Node from its (up to) 2x2 children
+
+  public:
+    HeightPyramid();
+
+    void Build( const CompactHeightfield& heightfield ); // Rebuilds every level from the (quantised) post heights
+    void Refit( const CompactHeightfield& heightfield, int cellXMin, int cellZMin, int cellXMax, int cellZMax ); // Recomputes an inclusive cell rectangle and the nodes above it
+
+    int GetLevelCount() const;
+    int GetLevelSide( int level ) const;
+    int GetCellsPerSide() const;
+    const Range& GetRange( int level, int cx, int cz ) const;
+    float GetMaxHeight( int cellXMin, int cellZMin, int cellXMax, int cellZMax ) const; // Upper bound over an inclusive cell rectangle (clamped to the grid)
+};
+} // namespace Geometry
+} // namespace SkullbonezCore
@@ -2,6 +2,8 @@
 #include "SkullbonezHelper.h"
 #include "SkullbonezProfiler.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
+#include "SkullbonezTextureCollection.h"
 #include <vector>
 #include <cmath>
 #include <cstring>
@@ -10,14 +12,16 @@
 // --- Usings ---
 using namespace SkullbonezCore::Basics;
 using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Textures;
 using namespace SkullbonezCore::Math::Transformation;
 using namespace SkullbonezCore::Math::Vector;
 
 
 std::unique_ptr<IShader> SkullbonezHelper::sphereShader;
-uint32_t SkullbonezHelper::sphereInstMesh = 0;
-int SkullbonezHelper::sphereVertexCount = 0;
-std::vector<float> SkullbonezHelper::sphereInstanceData;
+uint32_t SkullbonezHelper::sphereInstMesh[SPHERE_LOD_COUNT] = {};
+int SkullbonezHelper::sphereIndexCount[SPHERE_LOD_COUNT] = {};
+std::unique_ptr<IShader> SkullbonezHelper::impostorShader;
+uint32_t SkullbonezHelper::impostorInstMesh = 0;
 std::unique_ptr<IShader> SkullbonezHelper::debugLineShader;
 unsigned int SkullbonezHelper::debugLineVAO = 0;
 unsigned int SkullbonezHelper::debugLineVBO = 0;
@@ -31,13 +35,40 @@ void SkullbonezHelper::SetClipPlane( float x, float y, float z, float w )
 }
 
 
+void SkullbonezHelper::SetClipPlaneEnabled( bool enable )
+{
+    sClipPlaneEnabled = enable;
+}
+
+
+void SkullbonezHelper::SetSphereImpostors( bool enable )
+{
+    sSphereImpostors = enable;
+}
+
+
+bool SkullbonezHelper::IsSphereImpostors()
+{
+    return sSphereImpostors;
+}
+
+
 void SkullbonezHelper::ResetGLResources()
 {
     sphereShader.reset();
-    if ( sphereInstMesh != 0 )
+    for ( int lod = 0; lod < SPHERE_LOD_COUNT; ++lod )
     {
-        Gfx().DestroyInstancedMesh( sphereInstMesh );
-        sphereInstMesh = 0;
+        if ( sphereInstMesh[lod] != 0 )
+        {
+            Gfx().DestroyInstancedMesh( sphereInstMesh[lod] );
+            sphereInstMesh[lod] = 0;
+        }
+    }
+    impostorShader.reset();
+    if ( impostorInstMesh != 0 )
+    {
+        Gfx().DestroyInstancedMesh( impostorInstMesh );
+        impostorInstMesh = 0;
     }
     debugLineShader.reset();
     if ( debugLineVBO != 0 )
@@ -53,73 +84,112 @@ void SkullbonezHelper::ResetGLResources()
 }
 
 
-void SkullbonezHelper::BuildSphereMesh( int slices, int stacks )
+void SkullbonezHelper::BuildSphereMesh( int lod, int slices, int stacks )
 {
-    // Generate a unit sphere with normals and texcoords (8 floats per vertex)
+    // Generate a unit sphere with normals and texcoords (8 floats per vertex) on a shared (stacks+1) x (slices+1)
+    // grid.  The seam column is duplicated (u = 0 and u = 1) and the poles once per slice, as texcoords require.
+    int columns = slices + 1;
     std::vector<float> verts;
-    verts.reserve( slices * stacks * 6 * 8 );
+    verts.reserve( ( stacks + 1 ) * columns * 8 );
 
-    for ( int i = 0; i < stacks; ++i )
+    for ( int i = 0; i <= stacks; ++i )
     {
-        float phi0 = _PI * static_cast<float>( i ) / static_cast<float>( stacks );
-        float phi1 = _PI * static_cast<float>( i + 1 ) / static_cast<float>( stacks );
+        float phi = _PI * static_cast<float>( i ) / static_cast<float>( stacks );
+        float v = static_cast<float>( i ) / static_cast<float>( stacks );
 
-        for ( int j = 0; j < slices; ++j )
+        for ( int j = 0; j <= slices; ++j )
         {
-            float theta0 = _2PI * static_cast<float>( j ) / static_cast<float>( slices );
-            float theta1 = _2PI * static_cast<float>( j + 1 ) / static_cast<float>( slices );
+            float theta = _2PI * static_cast<float>( j ) / static_cast<float>( slices );
+            float u = static_cast<float>( j ) / static_cast<float>( slices );
 
-            // 4 corners of the quad
-            float x00 = sinf( phi0 ) * cosf( theta0 ), y00 = cosf( phi0 ), z00 = sinf( phi0 ) * sinf( theta0 );
-            float x01 = sinf( phi0 ) * cosf( theta1 ), y01 = cosf( phi0 ), z01 = sinf( phi0 ) * sinf( theta1 );
-            float x10 = sinf( phi1 ) * cosf( theta0 ), y10 = cosf( phi1 ), z10 = sinf( phi1 ) * sinf( theta0 );
-            float x11 = sinf( phi1 ) * cosf( theta1 ), y11 = cosf( phi1 ), z11 = sinf( phi1 ) * sinf( theta1 );
+            float x = sinf( phi ) * cosf( theta ), y = cosf( phi ), z = sinf( phi ) * sinf( theta );
+            verts.insert( verts.end(), { x, y, z, x, y, z, u, v } );
+        }
+    }
 
-            float u0 = static_cast<float>( j ) / static_cast<float>( slices ), v0 = static_cast<float>( i ) / static_cast<float>( stacks );
-            float u1 = static_cast<float>( j + 1 ) / static_cast<float>( slices ), v1 = static_cast<float>( i + 1 ) / static_cast<float>( stacks );
+    std::vector<uint16_t> indices;
+    indices.reserve( slices * stacks * 6 );
+    for ( int i = 0; i < stacks; ++i )
+    {
+        for ( int j = 0; j < slices; ++j )
+        {
+            uint16_t i00 = static_cast<uint16_t>( i * columns + j );
+            uint16_t i01 = static_cast<uint16_t>( i00 + 1 );
+            uint16_t i10 = static_cast<uint16_t>( i00 + columns );
+            uint16_t i11 = static_cast<uint16_t>( i10 + 1 );
 
             // Triangle 1: (0,0) → (1,1) → (1,0)  (CCW viewed from outside)
-            verts.insert( verts.end(), { x00, y00, z00, x00, y00, z00, u0, v0 } );
-            verts.insert( verts.end(), { x11, y11, z11, x11, y11, z11, u1, v1 } );
-            verts.insert( verts.end(), { x10, y10, z10, x10, y10, z10, u0, v1 } );
+            indices.insert( indices.end(), { i00, i11, i10 } );
 
             // Triangle 2: (0,0) → (0,1) → (1,1)  (CCW viewed from outside)
-            verts.insert( verts.end(), { x00, y00, z00, x00, y00, z00, u0, v0 } );
-            verts.insert( verts.end(), { x01, y01, z01, x01, y01, z01, u1, v0 } );
-            verts.insert( verts.end(), { x11, y11, z11, x11, y11, z11, u1, v1 } );
+            indices.insert( indices.end(), { i00, i01, i11 } );
         }
     }
 
-    sphereVertexCount = slices * stacks * 6;
+    sphereIndexCount[lod] = static_cast<int>( indices.size() );
 
     // Static layout: 3 attributes (pos3, normal3, uv2) at locations 0-2
     int staticAttribSizes[] = { 3, 3, 2 };
-    // Instance layout: 4 attributes (4×vec4 for mat4 = 16 floats), starting at location 3
-    int instanceAttribSizes[] = { 4, 4, 4, 4 };
-    sphereInstMesh = Gfx().CreateInstancedMesh( verts.data(), sphereVertexCount, 8, MAX_GAME_MODELS, 16, 3, instanceAttribSizes, 4, staticAttribSizes, 3 );
+    // Instance layout: 2 attributes (centre+radius vec4, orientation quaternion vec4), starting at location 3
+    int instanceAttribSizes[] = { 4, 4 };
+    sphereInstMesh[lod] = Gfx().CreateInstancedMesh( verts.data(), ( stacks + 1 ) * columns, 8, SPHERE_INSTANCE_FLOATS, 3, instanceAttribSizes, 2, staticAttribSizes, 3, indices.data(), sphereIndexCount[lod] );
+}
+
 
-    sphereInstanceData.reserve( MAX_GAME_MODELS * 16 );
+void SkullbonezHelper::BuildImpostorMesh()
+{
+    // Two CCW triangles spanning [-1,1]^2; the vertex shader orients and sizes the quad per instance
+    static const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f,
+                                     -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f };
+
+    // Static layout: corner (vec2) at location 0. Instance layout matches the mesh path (locations 3-4)
+    int staticAttribSizes[] = { 2 };
+    int instanceAttribSizes[] = { 4, 4 };
+    impostorInstMesh = Gfx().CreateInstancedMesh( corners, 6, 2, SPHERE_INSTANCE_FLOATS, 3, instanceAttribSizes, 2, staticAttribSizes, 1 );
+
+    impostorShader = Gfx().CreateShader(
+        "SkullbonezData/shaders/sphere_impostor.vert",
+        "SkullbonezData/shaders/sphere_impostor.frag" );
+    SetSphereMaterial( impostorShader.get() );
+    uImpostorView = impostorShader->GetUniformHandle( "uView" );
+    uImpostorProj = impostorShader->GetUniformHandle( "uProjection" );
+    uImpostorClip = impostorShader->GetUniformHandle( "uClipPlane" );
+    uImpostorLight = impostorShader->GetUniformHandle( "uLightPosition" );
+}
+
+
+void SkullbonezHelper::SetSphereMaterial( IShader* shader )
+{
+    shader->Use();
+    shader->SetVec4( "uLightAmbient", 1.0f, 0.5f, 0.5f, 1.0f );
+    shader->SetVec4( "uLightDiffuse", 1.0f, 0.5f, 0.5f, 1.0f );
+    shader->SetVec4( "uMaterialAmbient", 0.2f, 0.2f, 0.2f, 1.0f );
+    shader->SetVec4( "uMaterialDiffuse", 0.8f, 0.8f, 0.8f, 1.0f );
 }
 
 
 void SkullbonezHelper::DrawSphereBatchBegin( const Matrix4& view, const Matrix4& proj, const float lightPos[4], bool isTransparent )
 {
-    if ( sphereInstMesh == 0 )
+    if ( sphereInstMesh[0] == 0 )
     {
-        BuildSphereMesh( 25, 25 );
+        // Slices/stacks per LOD; level 0 matches the original single tessellation
+        static constexpr int LOD_SEGMENTS[SPHERE_LOD_COUNT] = { 25, 16, 10, 6 };
+        for ( int lod = 0; lod < SPHERE_LOD_COUNT; ++lod )
+        {
+            BuildSphereMesh( lod, LOD_SEGMENTS[lod], LOD_SEGMENTS[lod] );
+        }
         sphereShader = Gfx().CreateShader(
             "SkullbonezData/shaders/lit_textured_instanced.vert",
             "SkullbonezData/shaders/lit_textured_instanced.frag" );
-        sphereShader->Use();
-        sphereShader->SetVec4( "uLightAmbient", 1.0f, 0.5f, 0.5f, 1.0f );
-        sphereShader->SetVec4( "uLightDiffuse", 1.0f, 0.5f, 0.5f, 1.0f );
-        sphereShader->SetVec4( "uMaterialAmbient", 0.2f, 0.2f, 0.2f, 1.0f );
-        sphereShader->SetVec4( "uMaterialDiffuse", 0.8f, 0.8f, 0.8f, 1.0f );
+        SetSphereMaterial( sphereShader.get() );
+        uSphereView = sphereShader->GetUniformHandle( "uView" );
+        uSphereProj = sphereShader->GetUniformHandle( "uProjection" );
+        uSphereClip = sphereShader->GetUniformHandle( "uClipPlane" );
+        uSphereLight = sphereShader->GetUniformHandle( "uLightPosition" );
     }
-
-    if ( isTransparent )
+    if ( sSphereImpostors && impostorInstMesh == 0 )
     {
-        Gfx().SetBlend( true );
+        BuildImpostorMesh();
     }
 
     float viewLightPos[4];
@@ -129,31 +199,81 @@ void SkullbonezHelper::DrawSphereBatchBegin( const Matrix4& view, const Matrix4&
     }
     viewLightPos[3] = lightPos[3];
 
-    sphereShader->Use();
-    sphereShader->SetMat4( "uView", view );
-    sphereShader->SetMat4( "uProjection", proj );
-    sphereShader->SetVec4( "uClipPlane", sClipPlane[0], sClipPlane[1], sClipPlane[2], sClipPlane[3] );
-    sphereShader->SetVec4( "uLightPosition", viewLightPos[0], viewLightPos[1], viewLightPos[2], viewLightPos[3] );
-    sphereInstanceData.clear();
+    // Impostors evaluate the clip plane per fragment (the quad is not the surface), and their quads
+    // always face the eye, so hardware clipping and culling stay off for them
+    sSphereBatchImpostor = sSphereImpostors;
+    RenderState state;
+    state.blend = isTransparent;
+    state.clipPlane0 = sClipPlaneEnabled && !sSphereBatchImpostor;
+    state.cullFace = !sSphereBatchImpostor;
+
+    IShader* shader = sSphereBatchImpostor ? impostorShader.get() : sphereShader.get();
+    RenderQueue& queue = RenderQueue::Instance();
+    queue.Begin( isTransparent ? RenderLayer::Transparent : RenderLayer::Opaque, shader, state );
+    queue.SetTexture( 0, TextureCollection::Instance()->GetTextureHandle( TEXTURE_BOUNDING_SPHERE ) );
+    queue.SetMat4( sSphereBatchImpostor ? uImpostorView : uSphereView, view );
+    queue.SetMat4( sSphereBatchImpostor ? uImpostorProj : uSphereProj, proj );
+    queue.SetVec4( sSphereBatchImpostor ? uImpostorClip : uSphereClip, sClipPlane[0], sClipPlane[1], sClipPlane[2], sClipPlane[3] );
+    queue.SetVec4( sSphereBatchImpostor ? uImpostorLight : uSphereLight, viewLightPos[0], viewLightPos[1], viewLightPos[2], viewLightPos[3] );
+    sSphereBatchTransparent = isTransparent;
 }
 
 
-void SkullbonezHelper::DrawSphereBatchModel( const Matrix4& model )
+int SkullbonezHelper::SelectSphereLod( float projectedRadiusPixels )
 {
-    const float* md = model.Data();
-    sphereInstanceData.insert( sphereInstanceData.end(), md, md + 16 );
+    if ( projectedRadiusPixels >= Cfg().sphereLodPixels1 )
+    {
+        return 0;
+    }
+    if ( projectedRadiusPixels >= Cfg().sphereLodPixels2 )
+    {
+        return 1;
+    }
+    if ( projectedRadiusPixels >= Cfg().sphereLodPixels3 )
+    {
+        return 2;
+    }
+    return 3;
 }
 
 
-void SkullbonezHelper::DrawSphereBatchEnd()
+void SkullbonezHelper::DrawSphereBatchEnd( const int lodCounts[SPHERE_LOD_COUNT], float* outInstances[SPHERE_LOD_COUNT] )
 {
-    int instanceCount = static_cast<int>( sphereInstanceData.size() ) / 16;
-    if ( instanceCount > 0 )
+    // Draws share the open packet, so levels cost no extra state or texture changes. Instance data is
+    // written by the caller straight into each draw's upload ring span.
+    // Opaque batches go fine-to-coarse (near first); blended ones coarse-to-fine to stay roughly back-to-front.
+    RenderQueue& queue = RenderQueue::Instance();
+    for ( int lod = 0; lod < SPHERE_LOD_COUNT; ++lod )
     {
-        Gfx().UploadInstanceData( sphereInstMesh, sphereInstanceData.data(), static_cast<int>( sphereInstanceData.size() ) );
-        Gfx().DrawInstancedMesh( sphereInstMesh, sphereVertexCount, instanceCount );
+        outInstances[lod] = nullptr;
+    }
+
+    if ( sSphereBatchImpostor )
+    {
+        // Impostors are resolution-independent: one draw
+        int instanceCount = 0;
+        for ( int lod = 0; lod < SPHERE_LOD_COUNT; ++lod )
+        {
+            instanceCount += lodCounts[lod];
+        }
+        if ( instanceCount > 0 )
+        {
+            outInstances[0] = queue.DrawInstancedMapped( impostorInstMesh, 6, instanceCount, instanceCount * SPHERE_INSTANCE_FLOATS );
+            PROFILE_COUNTER_ADD( "Render/SphereVertices", 6 * instanceCount );
+        }
+        return;
+    }
+
+    for ( int i = 0; i < SPHERE_LOD_COUNT; ++i )
+    {
+        int lod = sSphereBatchTransparent ? SPHERE_LOD_COUNT - 1 - i : i;
+        int instanceCount = lodCounts[lod];
+        if ( instanceCount > 0 )
+        {
+            outInstances[lod] = queue.DrawInstancedMapped( sphereInstMesh[lod], sphereIndexCount[lod], instanceCount, instanceCount * SPHERE_INSTANCE_FLOATS );
+            PROFILE_COUNTER_ADD( "Render/SphereVertices", sphereIndexCount[lod] * instanceCount );
+        }
     }
-    Gfx().SetBlend( false );
 }
 
 
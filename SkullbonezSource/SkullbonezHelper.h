@@ -29,25 +29,48 @@ namespace Basics
 class SkullbonezHelper
 {
 
+  public:
+    static constexpr int SPHERE_LOD_COUNT = 4;       // Tessellation levels, 0 = finest
+    static constexpr int SPHERE_INSTANCE_FLOATS = 8; // centre.xyz, radius, orientation quaternion xyzw
+
   private:
     static std::unique_ptr<IShader> sphereShader;                     // Shared lit_textured_instanced shader
-    static uint32_t sphereInstMesh;                                   // Instanced mesh handle (via Gfx())
-    static int sphereVertexCount;                                     // Per-sphere vertex count
-    static std::vector<float> sphereInstanceData;                     // Staging buffer for model matrices (16 floats per instance)
+    static uint32_t sphereInstMesh[SPHERE_LOD_COUNT];                 // Instanced mesh handle per LOD (via Gfx())
+    static int sphereIndexCount[SPHERE_LOD_COUNT];                    // Per-sphere index count per LOD (16-bit indexed)
     inline static float sClipPlane[4] = { 0.0f, 1.0f, 0.0f, 1.0e9f }; // default: always pass (GL_CLIP_DISTANCE0 disabled)
+    inline static bool sClipPlaneEnabled = false;                     // Recorded into sphere packets as RenderState::clipPlane0
+    inline static bool sSphereBatchTransparent = false;               // Current batch is blended: submit coarse (far) levels first
+    inline static bool sSphereImpostors = false;                      // Draw balls as ray-cast impostor quads instead of mesh LODs
+    inline static bool sSphereBatchImpostor = false;                  // Mode latched by the current DrawSphereBatchBegin()
+    inline static UniformHandle uSphereView = UniformHandle::Invalid; // Resolved once per shader creation
+    inline static UniformHandle uSphereProj = UniformHandle::Invalid;
+    inline static UniformHandle uSphereClip = UniformHandle::Invalid;
+    inline static UniformHandle uSphereLight = UniformHandle::Invalid;
+
+    static std::unique_ptr<IShader> impostorShader; // sphere_impostor shader (ray-cast quads)
+    static uint32_t impostorInstMesh;               // Instanced quad mesh handle (via Gfx())
+    inline static UniformHandle uImpostorView = UniformHandle::Invalid;
+    inline static UniformHandle uImpostorProj = UniformHandle::Invalid;
+    inline static UniformHandle uImpostorClip = UniformHandle::Invalid;
+    inline static UniformHandle uImpostorLight = UniformHandle::Invalid;
 
     static std::unique_ptr<IShader> debugLineShader; // GL-only debug line shader
     static unsigned int debugLineVAO;                // VAO for debug lines
     static unsigned int debugLineVBO;                // VBO for debug lines (streaming)
 
-    static void BuildSphereMesh( int slices, int stacks ); // Generate UV sphere instanced mesh
+    static void BuildSphereMesh( int lod, int slices, int stacks ); // Generate UV sphere instanced mesh for one LOD
+    static void BuildImpostorMesh();                                // Generate the impostor quad instanced mesh and shader
+    static void SetSphereMaterial( IShader* shader );               // Upload the constant light/material uniforms
 
   public:
     static void StateSetup();                                                                                                                  // Assists in setting up initial open gl state
     static void SetClipPlane( float x, float y, float z, float w );                                                                            // Set sphere shader clip plane (default (0,1,0,1e9) = always pass)
-    static void DrawSphereBatchBegin( const Matrix4& view, const Matrix4& proj, const float lightPos[4], bool isTransparent = false );         // Set up instanced shader uniforms and begin collecting instances
-    static void DrawSphereBatchModel( const Matrix4& model );                                                                                  // Append model matrix to instance buffer
-    static void DrawSphereBatchEnd();                                                                                                          // Upload instance data and issue single instanced draw
+    static void SetClipPlaneEnabled( bool enable );                                                                                            // Enable clip distance 0 for subsequent sphere batches
+    static void SetSphereImpostors( bool enable );                                                                                             // Select ray-cast impostors (true) or tessellated mesh LODs (false)
+    static bool IsSphereImpostors();                                                                                                           // True when sphere batches render as impostors
+    static void DrawSphereBatchBegin( const Matrix4& view, const Matrix4& proj, const float lightPos[4], bool isTransparent = false );         // Open the instanced batch packet and record its shader uniforms
+    static int SelectSphereLod( float projectedRadiusPixels );                                                                                 // Pick a tessellation level from on-screen radius (Cfg sphere_lod_pixels_*)
+    static void DrawSphereBatchEnd( const int lodCounts[SPHERE_LOD_COUNT], float* outInstances[SPHERE_LOD_COUNT] );                            // Submit one instanced draw per non-empty LOD in a single packet; fill the returned mapped spans before the queue flushes
     static void DrawDebugVectors( const Matrix4& viewProj, const std::vector<std::pair<Vector3, Vector3>>& lines, float r, float g, float b ); // Draw a batch of world-space line segments (GL only)
     static void ResetGLResources();                                                                                                            // Call after GL context recreated to invalidate cached GL objects
 };
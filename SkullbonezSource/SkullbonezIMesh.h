@@ -5,9 +5,64 @@ namespace SkullbonezCore
 {
 namespace Rendering
 {
+
+// Interleaved static vertex layouts.  Attribute locations / semantics are the same for every layout
+// (0 / POSITION, 1 / NORMAL, 2 / TEXCOORD0); packed attributes reach the shader already converted to float.
+enum class VertexFormat
+{
+    Pos3,                    // float3 (12 bytes)
+    Pos3_Tex2,               // float3, float2 (20 bytes)
+    Pos3_Norm3_Tex2,         // float3, float3, float2 (32 bytes)
+    Pos2_Tex2,               // float2, float2 (16 bytes)
+    Pos2,                    // float2 (8 bytes)
+    Pos3_PackedNorm_HalfTex, // float3, unorm 10:10:10:2 normal, half2: PackedLitVertex (20 bytes)
+    HalfPos_UNormTex         // half4 (w unused), unorm16 x2: PackedUnlitVertex (12 bytes)
+};
+
+
+enum class IndexFormat
+{
+    None, // Non-indexed: draws vertices in order
+    UInt16,
+    UInt32
+};
+
+
+inline int GetVertexStride( VertexFormat format )
+{
+    switch ( format )
+    {
+    case VertexFormat::Pos3:
+        return 12;
+    case VertexFormat::Pos3_Tex2:
+        return 20;
+    case VertexFormat::Pos3_Norm3_Tex2:
+        return 32;
+    case VertexFormat::Pos2_Tex2:
+        return 16;
+    case VertexFormat::Pos2:
+        return 8;
+    case VertexFormat::Pos3_PackedNorm_HalfTex:
+        return 20;
+    case VertexFormat::HalfPos_UNormTex:
+        return 12;
+    }
+    return 0;
+}
+
+
+inline int GetIndexSize( IndexFormat format )
+{
+    return format == IndexFormat::UInt32 ? 4 : ( format == IndexFormat::UInt16 ? 2 : 0 );
+}
+
+
 /* -- IMesh ------------------------------------------------------------------------------------------------------------------------------------------------------
 
     Abstract mesh interface. Concrete implementations handle VAO/VBO (OpenGL) or ID3D11Buffer (DirectX).
+    A mesh is either a plain triangle list or an indexed one (16 or 32-bit indices into shared vertices).
+    UpdateVertices overwrites a contiguous vertex range in place (same interleaved layout the mesh was created
+    with), so small edits upload only the bytes that changed instead of recreating the buffer.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class IMesh
 {
@@ -18,6 +73,8 @@ class IMesh
     virtual void Draw() const = 0;
     virtual void DrawInstanced( int instanceCount ) const = 0;
     virtual int GetVertexCount() const = 0;
+    virtual int GetIndexCount() const = 0; // 0 for non-indexed meshes
+    virtual void UpdateVertices( int firstVertex, int vertexCount, const void* data ) = 0;
 };
 } // namespace Rendering
 } // namespace SkullbonezCore
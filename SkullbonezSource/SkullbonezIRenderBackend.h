@@ -26,16 +26,40 @@ enum class BlendFactor
 };
 
 
+// Write-only view into the backend's streaming upload ring (see IRenderBackend::AllocateUpload)
+struct UploadSpan
+{
+    float* data;     // Mapped destination: write sequentially, never read back (may be write-combined)
+    uint32_t buffer; // Backend id of the ring buffer the span lives in (0 = empty span)
+    uint32_t offset; // Byte offset of data within that buffer
+};
+
+
+// Finished asynchronous backbuffer readback (see IRenderBackend::RequestBackbufferCapture)
+struct CapturedImage
+{
+    std::vector<uint8_t> pixels; // RGBA8 rows, rowPitch bytes apart, copied straight from the readback memory
+    int width;
+    int height;
+    int rowPitch;    // Bytes between rows (>= width * 4)
+    bool isBottomUp; // First row is the bottom of the image (GL)
+};
+
+
 /* -- IRenderBackend ---------------------------------------------------------------------------------------------------------------------------------------------
 
     Abstract render backend interface. Owns GPU state and resource creation.
-    Concrete implementations: RenderBackendGL (OpenGL 3.3), RenderBackendDX11 (DirectX 11).
+    Concrete implementations: RenderBackendGL (OpenGL 3.3), RenderBackendDX11 (DirectX 11), RenderBackendDX12
+    (DirectX 12) and RenderBackendNull (no GPU work; records call statistics).
     One global instance is set during init and accessed via Gfx().
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class IRenderBackend
 {
 
   public:
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 2; // Submitted frames the CPU may run ahead of the GPU
+    static constexpr int CAPTURE_SLOTS = 4;        // Backbuffer readbacks that may be in flight at once
+
     virtual ~IRenderBackend() = default;
 
 
@@ -44,6 +68,7 @@ class IRenderBackend
     virtual bool Init( HWND hwnd, HDC hdc, int width, int height ) = 0;
     virtual void Shutdown() = 0;
     virtual void Present() = 0;
+    virtual void WaitForFrameSlot() = 0; // Block until the frame submitted MAX_FRAMES_IN_FLIGHT Presents ago has retired on the GPU
     virtual void Finish() = 0;
     virtual void FlushGPU() = 0; // Block until all submitted GPU work completes (required before resource destruction)
     virtual void Resize( int width, int height ) = 0;
@@ -82,20 +107,30 @@ class IRenderBackend
     // --- Resource Creation ---
 
     virtual std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) = 0;
-    virtual std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) = 0;
+    virtual std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) = 0;                                                          // Float triangle list: pos3 [+ normal3] [+ uv2]
+    virtual std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) = 0; // Any VertexFormat; indexFormat None ignores indices
     virtual std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) = 0;
 
 
     // --- Textures (opaque uint32_t handles) ---
 
     virtual uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) = 0;
+    // data holds mipCount tightly packed levels (level 0 first, each dimension halved and clamped to 1); channels is 1 or 4
+    virtual uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) = 0;
     virtual void BindTexture( uint32_t handle, int slot ) = 0;
     virtual void DeleteTexture( uint32_t handle ) = 0;
 
 
-    // --- Screenshot (returns BGR pixel data, bottom-up for BMP compatibility) ---
+    // --- Screenshot ---
+    // CaptureBackbuffer stalls until the GPU is idle and returns BGR rows, bottom-up, for BMP compatibility.
+    // RequestBackbufferCapture instead queues a GPU copy of the backbuffer into a readback slot (call it before
+    // Present) and returns false when all CAPTURE_SLOTS are still in flight.  PollBackbufferCapture hands back the
+    // oldest queued capture once the GPU has written it, or waits for it when wait is true; captures complete in
+    // request order.
 
     virtual std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) = 0;
+    virtual bool RequestBackbufferCapture() = 0;
+    virtual bool PollBackbufferCapture( CapturedImage& out, bool wait ) = 0;
 
 
     // --- Window Dimensions ---
@@ -116,24 +151,32 @@ class IRenderBackend
     virtual const char* GetRendererName() const = 0;
 
 
+    // --- Upload Ring (per-frame instance data and dynamic vertices) ---
+    // Spans are mapped straight from a ring buffer with one fence-guarded region per frame in flight; the ring
+    // grows geometrically when a frame outgrows it, so draws have no fixed instance or vertex cap.
+    // Fill a span before the next draw call and consume it before Present(); it is recycled after that.
+
+    virtual UploadSpan AllocateUpload( int floatCount ) = 0;
+
+
     // --- Dynamic Vertex Buffer (per-frame geometry: text quads, HUD overlays) ---
     // attribComponents: component count per attribute (e.g. {2,2} = location0:vec2, location1:vec2)
 
-    virtual uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices ) = 0;
-    virtual void UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount ) = 0;
+    virtual uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) = 0;
+    virtual void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) = 0;
     virtual void DestroyDynamicVB( uint32_t handle ) = 0;
 
 
     // --- Instanced Mesh (hardware instancing: shadow decals, sphere batches) ---
-    // staticData: per-vertex geometry  |  instance data uploaded per frame
+    // staticData: per-vertex geometry  |  instance data streamed per draw through AllocateUpload
     // staticAttribSizes/numStaticAttribs: component counts per static vertex attribute (e.g. {3,3,2} = pos+normal+uv)
     //   If numStaticAttribs==0, all floats go into a single attribute at location 0.
     // instanceAttribSizes: component counts per instance attribute (e.g. {4,4,4,4,1} = mat4+float)
     // instanceStartAttrib: first attribute location for instance data (e.g. 3)
+    // indices/indexCount: optional 16-bit triangle list into staticData; DrawInstancedMesh's staticVertCount then counts indices
 
-    virtual uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0 ) = 0;
-    virtual void UploadInstanceData( uint32_t handle, const float* data, int floatCount ) = 0;
-    virtual void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount ) = 0;
+    virtual uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) = 0;
+    virtual void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) = 0;
     virtual void DestroyInstancedMesh( uint32_t handle ) = 0;
 };
 
@@ -16,10 +16,20 @@ namespace SkullbonezCore
 {
 namespace Rendering
 {
+// Opaque per-shader uniform handle returned by IShader::GetUniformHandle. Only valid for the shader that issued it.
+enum class UniformHandle : int32_t
+{
+    Invalid = -1
+};
+
+
 /* -- IShader ----------------------------------------------------------------------------------------------------------------------------------------------------
 
     Abstract shader interface. Concrete implementations handle GLSL (OpenGL) or HLSL (DirectX).
     Uniform setters write shader constants — the backend handles how they're uploaded.
+    Per-frame callers resolve names once with GetUniformHandle and use the handle setters; values
+    equal to the last one written are dropped before reaching the driver / constant buffer.
+    Setting an Invalid handle (uniform absent or optimised out) is a no-op.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class IShader
 {
@@ -34,6 +44,14 @@ class IShader
     virtual void SetVec3( const char* name, float x, float y, float z ) const = 0;
     virtual void SetVec4( const char* name, float x, float y, float z, float w ) const = 0;
     virtual void SetMat4( const char* name, const Matrix4& mat ) const = 0;
+
+    virtual UniformHandle GetUniformHandle( const char* name ) const = 0;
+    virtual void SetInt( UniformHandle handle, int value ) const = 0;
+    virtual void SetFloat( UniformHandle handle, float value ) const = 0;
+    virtual void SetVec3( UniformHandle handle, const Vector3& v ) const = 0;
+    virtual void SetVec3( UniformHandle handle, float x, float y, float z ) const = 0;
+    virtual void SetVec4( UniformHandle handle, float x, float y, float z, float w ) const = 0;
+    virtual void SetMat4( UniformHandle handle, const Matrix4& mat ) const = 0;
 };
 } // namespace Rendering
 } // namespace SkullbonezCore
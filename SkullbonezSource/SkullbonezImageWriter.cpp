@@ -0,0 +1,475 @@
+// --- Includes ---
+#include "SkullbonezImageWriter.h"
+#include <cstring>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Basics;
+using namespace SkullbonezCore::Rendering;
+
+
+// Row r of the image counted from the top, whichever way round the backend read it
+static const uint8_t* GetTopDownRow( const CapturedImage& image, int r )
+{
+    int stored = image.isBottomUp ? image.height - 1 - r : r;
+    return image.pixels.data() + static_cast<size_t>( stored ) * image.rowPitch;
+}
+
+
+static void PutU32LE( std::vector<uint8_t>& out, uint32_t v )
+{
+    out.push_back( static_cast<uint8_t>( v ) );
+    out.push_back( static_cast<uint8_t>( v >> 8 ) );
+    out.push_back( static_cast<uint8_t>( v >> 16 ) );
+    out.push_back( static_cast<uint8_t>( v >> 24 ) );
+}
+
+
+static void PutU32BE( std::vector<uint8_t>& out, uint32_t v )
+{
+    out.push_back( static_cast<uint8_t>( v >> 24 ) );
+    out.push_back( static_cast<uint8_t>( v >> 16 ) );
+    out.push_back( static_cast<uint8_t>( v >> 8 ) );
+    out.push_back( static_cast<uint8_t>( v ) );
+}
+
+
+// 24-bit BMP: BGR rows, bottom-up, each padded to 4 bytes (same layout SaveScreenshot always wrote)
+static void EncodeBmp( const CapturedImage& image, std::vector<uint8_t>& out )
+{
+    uint32_t rowStride = ( static_cast<uint32_t>( image.width ) * 3 + 3 ) & ~3u;
+    uint32_t imageSize = rowStride * static_cast<uint32_t>( image.height );
+    out.reserve( 54 + imageSize );
+
+    // File header (14 bytes)
+    out.push_back( 'B' );
+    out.push_back( 'M' );
+    PutU32LE( out, 54 + imageSize );
+    PutU32LE( out, 0 );
+    PutU32LE( out, 54 ); // pixel data offset
+
+    // Info header (40 bytes)
+    PutU32LE( out, 40 );
+    PutU32LE( out, static_cast<uint32_t>( image.width ) );
+    PutU32LE( out, static_cast<uint32_t>( image.height ) );
+    PutU32LE( out, 1 | ( 24 << 16 ) ); // colour planes, bits per pixel
+    PutU32LE( out, 0 );                // no compression
+    PutU32LE( out, imageSize );
+    PutU32LE( out, 0 );
+    PutU32LE( out, 0 );
+    PutU32LE( out, 0 );
+    PutU32LE( out, 0 );
+
+    for ( int r = image.height - 1; r >= 0; --r )
+    {
+        const uint8_t* src = GetTopDownRow( image, r );
+        for ( int x = 0; x < image.width; ++x )
+        {
+            out.push_back( src[x * 4 + 2] );
+            out.push_back( src[x * 4 + 1] );
+            out.push_back( src[x * 4 + 0] );
+        }
+        for ( uint32_t pad = static_cast<uint32_t>( image.width ) * 3; pad < rowStride; ++pad )
+        {
+            out.push_back( 0 );
+        }
+    }
+}
+
+
+// Quite OK Image format (qoiformat.org), RGB.  Alpha is dropped: the backbuffer's alpha channel is not
+// meaningful and writing it opaque keeps every pixel on the cheaper RGB opcodes.
+static void EncodeQoi( const CapturedImage& image, std::vector<uint8_t>& out )
+{
+    const uint8_t QOI_OP_INDEX = 0x00;
+    const uint8_t QOI_OP_DIFF = 0x40;
+    const uint8_t QOI_OP_LUMA = 0x80;
+    const uint8_t QOI_OP_RUN = 0xc0;
+    const uint8_t QOI_OP_RGB = 0xfe;
+
+    // Worst case is four bytes a pixel; compressible frames come in far under
+    out.reserve( 14 + static_cast<size_t>( image.width ) * image.height * 4 + 8 );
+    out.push_back( 'q' );
+    out.push_back( 'o' );
+    out.push_back( 'i' );
+    out.push_back( 'f' );
+    PutU32BE( out, static_cast<uint32_t>( image.width ) );
+    PutU32BE( out, static_cast<uint32_t>( image.height ) );
+    out.push_back( 3 ); // channels
+    out.push_back( 0 ); // sRGB with linear alpha
+
+    // Every pixel is written with alpha 255, but the index starts all zero (alpha included) as in the
+    // reference decoder, so an unwritten slot never matches black
+    uint8_t seen[64][4] = {};
+    uint8_t prev[3] = { 0, 0, 0 };
+    int run = 0;
+
+    for ( int r = 0; r < image.height; ++r )
+    {
+        const uint8_t* src = GetTopDownRow( image, r );
+        for ( int x = 0; x < image.width; ++x, src += 4 )
+        {
+            if ( src[0] == prev[0] && src[1] == prev[1] && src[2] == prev[2] )
+            {
+                if ( ++run == 62 )
+                {
+                    out.push_back( static_cast<uint8_t>( QOI_OP_RUN | ( run - 1 ) ) );
+                    run = 0;
+                }
+                continue;
+            }
+
+            if ( run > 0 )
+            {
+                out.push_back( static_cast<uint8_t>( QOI_OP_RUN | ( run - 1 ) ) );
+                run = 0;
+            }
+
+            int hash = ( src[0] * 3 + src[1] * 5 + src[2] * 7 + 255 * 11 ) % 64;
+            if ( seen[hash][0] == src[0] && seen[hash][1] == src[1] && seen[hash][2] == src[2] && seen[hash][3] == 255 )
+            {
+                out.push_back( static_cast<uint8_t>( QOI_OP_INDEX | hash ) );
+            }
+            else
+            {
+                std::memcpy( seen[hash], src, 3 );
+                seen[hash][3] = 255;
+
+                int8_t vr = static_cast<int8_t>( src[0] - prev[0] );
+                int8_t vg = static_cast<int8_t>( src[1] - prev[1] );
+                int8_t vb = static_cast<int8_t>( src[2] - prev[2] );
+                int8_t vgr = static_cast<int8_t>( vr - vg );
+                int8_t vgb = static_cast<int8_t>( vb - vg );
+
+                if ( vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2 )
+                {
+                    out.push_back( static_cast<uint8_t>( QOI_OP_DIFF | ( vr + 2 ) << 4 | ( vg + 2 ) << 2 | ( vb + 2 ) ) );
+                }
+                else if ( vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8 )
+                {
+                    out.push_back( static_cast<uint8_t>( QOI_OP_LUMA | ( vg + 32 ) ) );
+                    out.push_back( static_cast<uint8_t>( ( vgr + 8 ) << 4 | ( vgb + 8 ) ) );
+                }
+                else
+                {
+                    out.push_back( QOI_OP_RGB );
+                    out.push_back( src[0] );
+                    out.push_back( src[1] );
+                    out.push_back( src[2] );
+                }
+            }
+            std::memcpy( prev, src, 3 );
+        }
+    }
+    if ( run > 0 )
+    {
+        out.push_back( static_cast<uint8_t>( QOI_OP_RUN | ( run - 1 ) ) );
+    }
+
+    // End marker
+    static const uint8_t padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    out.insert( out.end(), padding, padding + 8 );
+}
+
+
+static uint8_t ClampByte( int v )
+{
+    return static_cast<uint8_t>( v < 0 ? 0 : ( v > 255 ? 255 : v ) );
+}
+
+
+// One YUV4MPEG2 frame: box-filter the capture down by downscale into width x height (parts past the source
+// edge stay black), then BT.601 full-range Y at full resolution and Cb/Cr averaged over 2x2 blocks
+static void EncodeY4mFrame( const CapturedImage& image, int downscale, int width, int height, std::vector<uint8_t>& out, std::vector<uint8_t>& rgb )
+{
+    rgb.assign( static_cast<size_t>( width ) * height * 3, 0 );
+    int area = downscale * downscale;
+    int columns = image.width / downscale < width ? image.width / downscale : width;
+    int rows = image.height / downscale < height ? image.height / downscale : height;
+    for ( int y = 0; y < rows; ++y )
+    {
+        uint8_t* dst = rgb.data() + static_cast<size_t>( y ) * width * 3;
+        for ( int x = 0; x < columns; ++x, dst += 3 )
+        {
+            int sum[3] = { 0, 0, 0 };
+            for ( int dy = 0; dy < downscale; ++dy )
+            {
+                const uint8_t* src = GetTopDownRow( image, y * downscale + dy ) + x * downscale * 4;
+                for ( int dx = 0; dx < downscale; ++dx, src += 4 )
+                {
+                    sum[0] += src[0];
+                    sum[1] += src[1];
+                    sum[2] += src[2];
+                }
+            }
+            dst[0] = static_cast<uint8_t>( ( sum[0] + area / 2 ) / area );
+            dst[1] = static_cast<uint8_t>( ( sum[1] + area / 2 ) / area );
+            dst[2] = static_cast<uint8_t>( ( sum[2] + area / 2 ) / area );
+        }
+    }
+
+    static const char frameTag[] = "FRAME\n";
+    out.insert( out.end(), frameTag, frameTag + 6 );
+    size_t base = out.size();
+    int chromaWidth = width / 2;
+    int chromaHeight = height / 2;
+    out.resize( base + static_cast<size_t>( width ) * height + static_cast<size_t>( chromaWidth ) * chromaHeight * 2 );
+    uint8_t* planeY = out.data() + base;
+    uint8_t* planeCb = planeY + static_cast<size_t>( width ) * height;
+    uint8_t* planeCr = planeCb + static_cast<size_t>( chromaWidth ) * chromaHeight;
+
+    const uint8_t* src = rgb.data();
+    for ( int i = 0; i < width * height; ++i, src += 3 )
+    {
+        planeY[i] = static_cast<uint8_t>( ( 77 * src[0] + 150 * src[1] + 29 * src[2] + 128 ) >> 8 );
+    }
+
+    for ( int y = 0; y < chromaHeight; ++y )
+    {
+        const uint8_t* top = rgb.data() + static_cast<size_t>( y * 2 ) * width * 3;
+        const uint8_t* bottom = top + static_cast<size_t>( width ) * 3;
+        for ( int x = 0; x < chromaWidth; ++x, top += 6, bottom += 6 )
+        {
+            int r = ( top[0] + top[3] + bottom[0] + bottom[3] + 2 ) >> 2;
+            int g = ( top[1] + top[4] + bottom[1] + bottom[4] + 2 ) >> 2;
+            int b = ( top[2] + top[5] + bottom[2] + bottom[5] + 2 ) >> 2;
+            planeCb[y * chromaWidth + x] = ClampByte( ( -43 * r - 85 * g + 128 * b + 32896 ) >> 8 );
+            planeCr[y * chromaWidth + x] = ClampByte( ( 128 * r - 107 * g - 21 * b + 32896 ) >> 8 );
+        }
+    }
+}
+
+
+static bool HasExtension( const std::string& path, const char* ext )
+{
+    size_t len = strlen( ext );
+    return path.size() >= len && _stricmp( path.c_str() + path.size() - len, ext ) == 0;
+}
+
+
+ImageWriter::ImageWriter()
+    : m_isStopRequested( false ), m_video( nullptr ), m_videoDownscale( 1 ), m_videoStride( 1 ), m_videoWidth( 0 ), m_videoHeight( 0 )
+{
+}
+
+
+ImageWriter::~ImageWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_isStopRequested = true;
+    }
+    m_jobQueued.notify_one();
+    if ( m_thread.joinable() )
+    {
+        m_thread.join();
+    }
+    if ( m_video )
+    {
+        fclose( m_video );
+    }
+}
+
+
+void ImageWriter::Submit( const char* path, CapturedImage&& image )
+{
+    if ( !path || path[0] == '\0' )
+    {
+        throw std::runtime_error( "Screenshot path is empty.  (ImageWriter::Submit)" );
+    }
+    Enqueue( path, std::move( image ) );
+}
+
+
+void ImageWriter::SubmitVideoFrame( CapturedImage&& image )
+{
+    if ( !m_video )
+    {
+        throw std::runtime_error( "No video stream is open.  (ImageWriter::SubmitVideoFrame)" );
+    }
+    Enqueue( std::string(), std::move( image ) );
+}
+
+
+void ImageWriter::OpenVideo( const char* path, int downscale, int frameStride )
+{
+    if ( downscale < 1 || frameStride < 1 )
+    {
+        throw std::runtime_error( "Invalid video parameters.  (ImageWriter::OpenVideo)" );
+    }
+    CloseVideo();
+
+    if ( fopen_s( &m_video, path, "wb" ) != 0 || !m_video )
+    {
+        m_video = nullptr;
+        char msg[512];
+        sprintf_s( msg, sizeof( msg ), "Failed to open capture video: %s  (ImageWriter::OpenVideo)", path );
+        throw std::runtime_error( msg );
+    }
+
+    // Frames land in this buffer and reach the OS in large sequential writes
+    if ( !m_videoBuffer )
+    {
+        m_videoBuffer = std::make_unique<char[]>( VIDEO_BUFFER_BYTES );
+    }
+    setvbuf( m_video, m_videoBuffer.get(), _IOFBF, VIDEO_BUFFER_BYTES );
+
+    m_videoDownscale = downscale;
+    m_videoStride = frameStride;
+    m_videoWidth = 0;
+    m_videoHeight = 0;
+}
+
+
+void ImageWriter::CloseVideo()
+{
+    if ( !m_video )
+    {
+        return;
+    }
+
+    // Drain first: the worker owns the stream while frames are queued
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_jobRetired.wait( lock, [this] { return m_jobs.empty(); } );
+    bool isClosed = fclose( m_video ) == 0;
+    m_video = nullptr;
+    ThrowPendingError();
+    if ( !isClosed )
+    {
+        throw std::runtime_error( "Failed to finish capture video.  (ImageWriter::CloseVideo)" );
+    }
+}
+
+
+bool ImageWriter::IsVideoOpen() const
+{
+    return m_video != nullptr;
+}
+
+
+void ImageWriter::Enqueue( std::string path, CapturedImage&& image )
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        ThrowPendingError();
+        m_jobRetired.wait( lock, [this] { return static_cast<int>( m_jobs.size() ) < MAX_QUEUED_JOBS; } );
+        m_jobs.push_back( { std::move( path ), std::move( image ) } );
+    }
+
+    if ( !m_thread.joinable() )
+    {
+        m_thread = std::thread( &ImageWriter::ThreadMain, this );
+    }
+    m_jobQueued.notify_one();
+}
+
+
+void ImageWriter::Flush()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_jobRetired.wait( lock, [this] { return m_jobs.empty(); } );
+    ThrowPendingError();
+}
+
+
+void ImageWriter::ThrowPendingError()
+{
+    if ( m_error.empty() )
+    {
+        return;
+    }
+
+    std::string msg;
+    msg.swap( m_error );
+    throw std::runtime_error( msg );
+}
+
+
+void ImageWriter::WriteVideoFrame( const CapturedImage& image, std::vector<uint8_t>& encoded, std::vector<uint8_t>& scratch, std::string& error )
+{
+    // The first frame fixes the stream size (4:2:0 needs it even); later frames of another size are cropped or padded
+    if ( m_videoWidth == 0 )
+    {
+        m_videoWidth = ( image.width / m_videoDownscale ) & ~1;
+        m_videoHeight = ( image.height / m_videoDownscale ) & ~1;
+        if ( m_videoWidth == 0 || m_videoHeight == 0 )
+        {
+            error = "Capture video frame is too small to downscale.  (ImageWriter::WriteVideoFrame)";
+            return;
+        }
+        fprintf( m_video, "YUV4MPEG2 W%d H%d F60:%d Ip A1:1 C420jpeg\n", m_videoWidth, m_videoHeight, m_videoStride );
+    }
+
+    EncodeY4mFrame( image, m_videoDownscale, m_videoWidth, m_videoHeight, encoded, scratch );
+    if ( fwrite( encoded.data(), 1, encoded.size(), m_video ) != encoded.size() )
+    {
+        error = "Failed to write capture video frame.  (ImageWriter::WriteVideoFrame)";
+    }
+}
+
+
+void ImageWriter::WriteImage( const Job& job, std::vector<uint8_t>& encoded, std::string& error )
+{
+    if ( HasExtension( job.path, ".qoi" ) )
+    {
+        EncodeQoi( job.image, encoded );
+    }
+    else
+    {
+        EncodeBmp( job.image, encoded );
+    }
+
+    FILE* file = nullptr;
+    if ( fopen_s( &file, job.path.c_str(), "wb" ) != 0 || !file )
+    {
+        error = "Failed to open screenshot file: " + job.path + "  (ImageWriter::WriteImage)";
+        return;
+    }
+    if ( fwrite( encoded.data(), 1, encoded.size(), file ) != encoded.size() )
+    {
+        error = "Failed to write screenshot file: " + job.path + "  (ImageWriter::WriteImage)";
+    }
+    fclose( file );
+}
+
+
+void ImageWriter::ThreadMain()
+{
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> scratch;
+
+    for ( ;; )
+    {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_jobQueued.wait( lock, [this] { return m_isStopRequested || !m_jobs.empty(); } );
+            if ( m_jobs.empty() )
+            {
+                return; // Stop requested and nothing left to write
+            }
+            job = &m_jobs.front(); // Deque front stays put while the render thread pushes to the back
+        }
+
+        encoded.clear();
+        std::string error;
+        if ( job->path.empty() )
+        {
+            WriteVideoFrame( job->image, encoded, scratch, error );
+        }
+        else
+        {
+            WriteImage( *job, encoded, error );
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            if ( !error.empty() && m_error.empty() )
+            {
+                m_error = error;
+            }
+            m_jobs.pop_front();
+        }
+        m_jobRetired.notify_all();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+
+// --- Includes ---
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "SkullbonezCommon.h"
+#include "SkullbonezIRenderBackend.h"
+
+
+namespace SkullbonezCore
+{
+namespace Basics
+{
+/* -- Image Writer -----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Encodes captured backbuffer images and writes them to disk on a worker thread, so screenshots cost the
+    render thread no more than the readback copy.  The format follows the file extension: ".qoi" writes the
+    Quite OK Image format (lossless, typically a fifth of the BMP size), anything else a 24-bit BMP as before.
+
+    It can also stream frames into a single YUV4MPEG2 (.y4m, 4:2:0) file instead of one file per capture:
+    OpenVideo() starts the stream, SubmitVideoFrame() appends a box-filtered, optionally downscaled frame
+    behind a large stdio buffer, CloseVideo() finishes it.  Frames are fixed-size, so frame N starts at
+    header + N * (6 + w * h * 3 / 2) bytes; Copilot/Skills/skore-render-test/y4m_frame.py pulls one out as PNG.
+
+    Jobs are written in submission order.  Submissions block only when MAX_QUEUED_JOBS images are already
+    waiting, which bounds the memory held when the disk falls behind.  A failed write is reported by the next
+    submission, Flush() or CloseVideo() on the calling thread.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class ImageWriter
+{
+
+  private:
+    static constexpr int MAX_QUEUED_JOBS = 8;
+    static constexpr int VIDEO_BUFFER_BYTES = 8 * 1024 * 1024; // stdio write-behind buffer of the video stream
+
+    struct Job
+    {
+        std::string path; // Empty = frame of the open video stream
+        Rendering::CapturedImage image;
+    };
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_jobQueued;  // Worker waits: a job arrived or stop was requested
+    std::condition_variable m_jobRetired; // Submitters wait: room in the queue, or the queue ran dry
+    std::deque<Job> m_jobs;               // Guarded by m_mutex; the front job stays queued until it is written
+    bool m_isStopRequested;
+    std::string m_error; // First failure not yet reported to the caller
+
+    // Video stream: opened and closed by the caller while the queue is empty, written only by the worker
+    FILE* m_video;
+    std::unique_ptr<char[]> m_videoBuffer;
+    int m_videoDownscale;
+    int m_videoStride;
+    int m_videoWidth; // Output size, fixed by the first frame (0 = header not written yet)
+    int m_videoHeight;
+
+    void ThreadMain();
+    void ThrowPendingError(); // Caller holds m_mutex
+    void Enqueue( std::string path, Rendering::CapturedImage&& image );
+    void WriteImage( const Job& job, std::vector<uint8_t>& encoded, std::string& error );
+    void WriteVideoFrame( const Rendering::CapturedImage& image, std::vector<uint8_t>& encoded, std::vector<uint8_t>& scratch, std::string& error );
+
+  public:
+    ImageWriter();
+    ~ImageWriter(); // Writes everything still queued, then joins
+
+    void Submit( const char* path, Rendering::CapturedImage&& image ); // Takes ownership of the pixels
+    void Flush();                                                      // Blocks until every submitted image is on disk
+
+    void OpenVideo( const char* path, int downscale, int frameStride ); // frameStride only sets the header's nominal rate (60 Hz / stride)
+    void SubmitVideoFrame( Rendering::CapturedImage&& image );          // Appends a frame to the open stream
+    void CloseVideo();                                                  // Writes queued frames and closes the stream; no-op when none is open
+    bool IsVideoOpen() const;
+};
+} // namespace Basics
+} // namespace SkullbonezCore
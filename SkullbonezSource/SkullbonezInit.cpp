@@ -7,6 +7,12 @@
 #include "SkullbonezRenderBackendGL.h"
 #include "SkullbonezRenderBackendDX11.h"
 #include "SkullbonezRenderBackendDX12.h"
+#include "SkullbonezRenderBackendNull.h"
+#include "SkullbonezRenderCapture.h"
+#include "SkullbonezRenderReplay.h"
+#include "SkullbonezAssetPack.h"
+#include "SkullbonezAssetPackBuilder.h"
+#include "SkullbonezFontAtlas.h"
 #include <float.h>
 #include <cstring>
 #include <vector>
@@ -18,6 +24,33 @@
 using namespace SkullbonezCore::Basics;
 using namespace SkullbonezCore::Rendering;
 using namespace SkullbonezCore::Math::Transformation;
+using namespace SkullbonezCore::Text;
+
+
+// Value following a command line flag, up to the next space ("" when the flag is absent or followed by another flag)
+static std::string GetArgValue( const char* cmdLine, const char* flag )
+{
+    const char* arg = cmdLine ? strstr( cmdLine, flag ) : nullptr;
+    if ( !arg )
+    {
+        return std::string();
+    }
+    arg += strlen( flag );
+    while ( *arg == ' ' )
+    {
+        ++arg;
+    }
+    if ( arg[0] == '-' && arg[1] == '-' )
+    {
+        return std::string();
+    }
+    const char* end = arg;
+    while ( *end != '\0' && *end != ' ' )
+    {
+        ++end;
+    }
+    return std::string( arg, end );
+}
 
 
 // "Windows Main" - this function is the execution entry point for the application
@@ -45,6 +78,52 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
         freopen_s( &dummy, "CONOUT$", "w", stderr );
     }
 
+    // Offline tool mode: pack SkullbonezData into a single mappable file and exit
+    if ( szCmdLine && strstr( szCmdLine, "--build-pack" ) )
+    {
+        std::string packPath = GetArgValue( szCmdLine, "--build-pack" );
+        try
+        {
+            AssetPackBuilder::Build( ASSET_PACK_SOURCE_DIR, !packPath.empty() ? packPath.c_str() : ASSET_PACK_PATH );
+        }
+        catch ( const std::exception& e )
+        {
+            fprintf( stderr, "FATAL: %s\n", e.what() );
+            return 1;
+        }
+        return 0;
+    }
+
+    // Offline tool mode: bake the overlay font's distance atlas and exit (run before --build-pack to pack it)
+    if ( szCmdLine && strstr( szCmdLine, "--build-font" ) )
+    {
+        std::string fontPath = GetArgValue( szCmdLine, "--build-font" );
+        try
+        {
+            FontAtlas::Build( "Verdana", !fontPath.empty() ? fontPath.c_str() : FONT_ATLAS_PATH );
+        }
+        catch ( const std::exception& e )
+        {
+            fprintf( stderr, "FATAL: %s\n", e.what() );
+            return 1;
+        }
+        return 0;
+    }
+
+    // Map the asset pack if present (--no-pack forces loose files, e.g. while editing data; --check-pack
+    // keeps the pack but prefers loose files changed since it was built)
+    if ( !szCmdLine || !strstr( szCmdLine, "--no-pack" ) )
+    {
+        try
+        {
+            AssetPack::Instance().Open( ASSET_PACK_PATH, szCmdLine && strstr( szCmdLine, "--check-pack" ) );
+        }
+        catch ( const std::exception& e )
+        {
+            fprintf( stderr, "WARNING: %s -- using loose files\n", e.what() );
+        }
+    }
+
     // Build the ordered list of scene paths to run.
     // Each entry is either a .scene path (scene/suite mode) or "" (legacy mode).
     std::vector<std::string> sceneList;
@@ -64,11 +143,11 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
             }
 
             // Read suite file: one scene path per line, # comments ignored
-            FILE* f = nullptr;
-            if ( fopen_s( &f, suiteArg, "r" ) == 0 && f )
+            AssetTextReader f;
+            if ( f.Open( suiteArg ) )
             {
                 char line[512];
-                while ( fgets( line, sizeof( line ), f ) )
+                while ( f.ReadLine( line, sizeof( line ) ) )
                 {
                     size_t len = strlen( line );
                     while ( len > 0 && ( line[len - 1] == '\r' || line[len - 1] == '\n' || line[len - 1] == ' ' ) )
@@ -80,7 +159,6 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
                         sceneList.push_back( line );
                     }
                 }
-                fclose( f );
             }
             isSuiteOrSceneMode = true;
         }
@@ -104,12 +182,13 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
         sceneList.push_back( "" ); // legacy mode — empty string maps to nullptr
     }
 
-    // Parse --renderer arg (default: opengl)
+    // Parse --renderer arg: opengl (default), dx11, dx12 or null
     enum class RendererType
     {
         OpenGL,
         DX11,
-        DX12
+        DX12,
+        Null
     };
     RendererType renderer = RendererType::OpenGL;
     if ( szCmdLine )
@@ -130,10 +209,24 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
             {
                 renderer = RendererType::DX11;
             }
+            else if ( _strnicmp( rendererArg, "null", 4 ) == 0 )
+            {
+                renderer = RendererType::Null;
+            }
         }
     }
 
+    // Render capture (--capture <file>) or replay (--replay <file>) of the backend call stream
+    std::string capturePath = GetArgValue( szCmdLine, "--capture" );
+    std::string replayPath = GetArgValue( szCmdLine, "--replay" );
+
+    // --config <file> overrides engine.cfg key by key (e.g. SkullbonezData/engine_perf.cfg)
     Cfg().Load( "SkullbonezData/engine.cfg" );
+    std::string configPath = GetArgValue( szCmdLine, "--config" );
+    if ( !configPath.empty() )
+    {
+        Cfg().Load( configPath.c_str() );
+    }
 
     // Create an instance of our window class
     SkullbonezWindow* m_cWindow = SkullbonezWindow::Instance();
@@ -144,31 +237,52 @@ int WINAPI WinMain( HINSTANCE hInstance,     // Holds info on instance of app
     // Get the device context for our window
     m_cWindow->m_sDevice = GetDC( m_cWindow->m_sWindow );
 
+    std::unique_ptr<IRenderBackend> backend;
     if ( renderer == RendererType::OpenGL )
     {
         // Init OpenGL (single context for entire lifetime)
         m_cWindow->InitialiseOpenGL();
-
-        auto backend = std::make_unique<RenderBackendGL>();
-        backend->Init( m_cWindow->m_sWindow, m_cWindow->m_sDevice, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
-        SetGfxBackend( std::move( backend ) );
+        backend = std::make_unique<RenderBackendGL>();
+    }
+    else if ( renderer == RendererType::Null )
+    {
+        // No GPU work: every call is recorded for the stats report
+        backend = std::make_unique<RenderBackendNull>();
     }
     else if ( renderer == RendererType::DX12 )
     {
-        auto backend = std::make_unique<RenderBackendDX12>();
-        backend->Init( m_cWindow->m_sWindow, m_cWindow->m_sDevice, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
-        SetGfxBackend( std::move( backend ) );
+        backend = std::make_unique<RenderBackendDX12>();
     }
     else
     {
-        auto backend = std::make_unique<RenderBackendDX11>();
-        backend->Init( m_cWindow->m_sWindow, m_cWindow->m_sDevice, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
-        SetGfxBackend( std::move( backend ) );
+        backend = std::make_unique<RenderBackendDX11>();
+    }
+    backend->Init( m_cWindow->m_sWindow, m_cWindow->m_sDevice, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
+
+    // Record the backend call stream for offline replay (--capture <file>)
+    if ( !capturePath.empty() && replayPath.empty() )
+    {
+        backend = std::make_unique<RenderBackendCapture>( std::move( backend ), capturePath.c_str() );
     }
+    SetGfxBackend( std::move( backend ) );
 
     // Now that the backend is ready, set viewport and projection for the active renderer
     m_cWindow->HandleScreenResize();
 
+    // Offline tool mode: play a render capture into the backend and report frame times
+    if ( !replayPath.empty() )
+    {
+        try
+        {
+            RenderReplay replay( replayPath.c_str() );
+            replay.Run( Cfg().replayLoops );
+        }
+        catch ( const std::exception& e )
+        {
+            fprintf( stderr, "FATAL: %s\n", e.what() );
+        }
+    }
+    else
     {
         // Create the Skullbonez Core instance (scoped so destructor runs
         // BEFORE GL context deletion — ensures GL cleanup calls work)
@@ -34,8 +34,20 @@ static D3D11_INPUT_ELEMENT_DESC s_layoutPos2[] = {
 };
 
 
+static D3D11_INPUT_ELEMENT_DESC s_layoutPos3PackedNormHalfTex[] = {
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL", 0, DXGI_FORMAT_R10G10B10A2_UNORM, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+static D3D11_INPUT_ELEMENT_DESC s_layoutHalfPosUNormTex[] = {
+    { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+
 MeshDX11::MeshDX11( ID3D11Device* device, ID3D11DeviceContext* context )
-    : m_device( device ), m_context( context ), m_vb( nullptr ), m_inputLayout( nullptr ), m_vertexCount( 0 ), m_stride( 0 ), m_format( VertexFormatDX::Pos3 ), m_lastVSBytecode( nullptr )
+    : m_device( device ), m_context( context ), m_vb( nullptr ), m_ib( nullptr ), m_inputLayout( nullptr ), m_vertexCount( 0 ), m_stride( 0 ), m_indexCount( 0 ), m_indexFormat( DXGI_FORMAT_R16_UINT ), m_format( VertexFormat::Pos3 ), m_lastVSBytecode( nullptr )
 {
 }
 
@@ -46,6 +58,10 @@ MeshDX11::~MeshDX11()
     {
         m_inputLayout->Release();
     }
+    if ( m_ib )
+    {
+        m_ib->Release();
+    }
     if ( m_vb )
     {
         m_vb->Release();
@@ -53,43 +69,38 @@ MeshDX11::~MeshDX11()
 }
 
 
-bool MeshDX11::Create( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords )
+bool MeshDX11::Create( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat )
 {
-    int floatsPerVert = 3;
-    if ( hasNormals )
-    {
-        floatsPerVert += 3;
-    }
-    if ( hasTexCoords )
-    {
-        floatsPerVert += 2;
-    }
-
-    m_stride = floatsPerVert * sizeof( float );
+    m_format = format;
+    m_stride = GetVertexStride( format );
     m_vertexCount = vertexCount;
 
-    if ( hasNormals && hasTexCoords )
-    {
-        m_format = VertexFormatDX::Pos3_Norm3_Tex2;
-    }
-    else if ( hasTexCoords )
-    {
-        m_format = VertexFormatDX::Pos3_Tex2;
-    }
-    else
-    {
-        m_format = VertexFormatDX::Pos3;
-    }
-
     D3D11_BUFFER_DESC bd = {};
     bd.ByteWidth = (UINT)( vertexCount * m_stride );
-    bd.Usage = D3D11_USAGE_IMMUTABLE;
+    bd.Usage = D3D11_USAGE_DEFAULT; // Not IMMUTABLE: UpdateVertices patches ranges with UpdateSubresource
     bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
     D3D11_SUBRESOURCE_DATA initData = {};
-    initData.pSysMem = data;
+    initData.pSysMem = vertices;
 
     HRESULT hr = m_device->CreateBuffer( &bd, &initData, &m_vb );
+    if ( FAILED( hr ) || indexFormat == IndexFormat::None || indexCount <= 0 )
+    {
+        return SUCCEEDED( hr );
+    }
+
+    m_indexCount = indexCount;
+    m_indexFormat = indexFormat == IndexFormat::UInt32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+
+    D3D11_BUFFER_DESC ibd = {};
+    ibd.ByteWidth = (UINT)( indexCount * GetIndexSize( indexFormat ) );
+    ibd.Usage = D3D11_USAGE_IMMUTABLE;
+    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+    D3D11_SUBRESOURCE_DATA indexData = {};
+    indexData.pSysMem = indices;
+
+    hr = m_device->CreateBuffer( &ibd, &indexData, &m_ib );
     return SUCCEEDED( hr );
 }
 
@@ -120,26 +131,34 @@ void MeshDX11::EnsureInputLayout() const
 
     switch ( m_format )
     {
-    case VertexFormatDX::Pos3:
+    case VertexFormat::Pos3:
         elements = s_layoutPos3;
         numElements = 1;
         break;
-    case VertexFormatDX::Pos3_Tex2:
+    case VertexFormat::Pos3_Tex2:
         elements = s_layoutPos3Tex2;
         numElements = 2;
         break;
-    case VertexFormatDX::Pos3_Norm3_Tex2:
+    case VertexFormat::Pos3_Norm3_Tex2:
         elements = s_layoutPos3Norm3Tex2;
         numElements = 3;
         break;
-    case VertexFormatDX::Pos2_Tex2:
+    case VertexFormat::Pos2_Tex2:
         elements = s_layoutPos2Tex2;
         numElements = 2;
         break;
-    case VertexFormatDX::Pos2:
+    case VertexFormat::Pos2:
         elements = s_layoutPos2;
         numElements = 1;
         break;
+    case VertexFormat::Pos3_PackedNorm_HalfTex:
+        elements = s_layoutPos3PackedNormHalfTex;
+        numElements = 3;
+        break;
+    case VertexFormat::HalfPos_UNormTex:
+        elements = s_layoutHalfPosUNormTex;
+        numElements = 2;
+        break;
     }
 
     m_device->CreateInputLayout( elements,
@@ -167,7 +186,15 @@ void MeshDX11::Draw() const
     UINT offset = 0;
     m_context->IASetVertexBuffers( 0, 1, &m_vb, &stride, &offset );
     m_context->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-    m_context->Draw( (UINT)m_vertexCount, 0 );
+    if ( m_ib )
+    {
+        m_context->IASetIndexBuffer( m_ib, m_indexFormat, 0 );
+        m_context->DrawIndexed( (UINT)m_indexCount, 0, 0 );
+    }
+    else
+    {
+        m_context->Draw( (UINT)m_vertexCount, 0 );
+    }
 }
 
 
@@ -187,5 +214,29 @@ void MeshDX11::DrawInstanced( int instanceCount ) const
     UINT offset = 0;
     m_context->IASetVertexBuffers( 0, 1, &m_vb, &stride, &offset );
     m_context->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-    m_context->DrawInstanced( (UINT)m_vertexCount, (UINT)instanceCount, 0, 0 );
+    if ( m_ib )
+    {
+        m_context->IASetIndexBuffer( m_ib, m_indexFormat, 0 );
+        m_context->DrawIndexedInstanced( (UINT)m_indexCount, (UINT)instanceCount, 0, 0, 0 );
+    }
+    else
+    {
+        m_context->DrawInstanced( (UINT)m_vertexCount, (UINT)instanceCount, 0, 0 );
+    }
+}
+
+
+void MeshDX11::UpdateVertices( int firstVertex, int vertexCount, const void* data )
+{
+    if ( firstVertex < 0 || vertexCount < 0 || firstVertex + vertexCount > m_vertexCount )
+    {
+        throw std::runtime_error( "Vertex range is outside the mesh.  (MeshDX11::UpdateVertices)" );
+    }
+
+    D3D11_BOX box = {};
+    box.left = (UINT)( firstVertex * m_stride );
+    box.right = (UINT)( ( firstVertex + vertexCount ) * m_stride );
+    box.bottom = 1;
+    box.back = 1;
+    m_context->UpdateSubresource( m_vb, 0, &box, data, 0, 0 );
 }
\ No newline at end of file
@@ -11,20 +11,10 @@ namespace SkullbonezCore
 namespace Rendering
 {
 
-enum class VertexFormatDX
-{
-    Pos3,
-    Pos3_Tex2,
-    Pos3_Norm3_Tex2,
-    Pos2_Tex2,
-    Pos2
-};
-
-
 /* -- MeshDX11 ----------------------------------------------------------------------------------------------------------------------------------------------------
 
     DirectX 11 implementation of the IMesh interface.
-    Holds a D3D11 vertex buffer and vertex format metadata. Input layouts are created lazily.
+    Holds a D3D11 vertex buffer, an optional index buffer and vertex format metadata. Input layouts are created lazily.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class MeshDX11 : public IMesh
 {
@@ -33,10 +23,13 @@ class MeshDX11 : public IMesh
     ID3D11Device* m_device;
     ID3D11DeviceContext* m_context;
     ID3D11Buffer* m_vb;
+    ID3D11Buffer* m_ib; // nullptr for non-indexed meshes
     mutable ID3D11InputLayout* m_inputLayout;
     int m_vertexCount;
     int m_stride;
-    VertexFormatDX m_format;
+    int m_indexCount;
+    DXGI_FORMAT m_indexFormat;
+    VertexFormat m_format;
     mutable const void* m_lastVSBytecode;
 
     void EnsureInputLayout() const;
@@ -45,7 +38,7 @@ class MeshDX11 : public IMesh
     MeshDX11( ID3D11Device* device, ID3D11DeviceContext* context );
     ~MeshDX11() override;
 
-    bool Create( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords );
+    bool Create( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat );
 
     void Draw() const override;
     void DrawInstanced( int instanceCount ) const override;
@@ -53,8 +46,13 @@ class MeshDX11 : public IMesh
     {
         return m_vertexCount;
     }
+    int GetIndexCount() const override
+    {
+        return m_indexCount;
+    }
+    void UpdateVertices( int firstVertex, int vertexCount, const void* data ) override;
 
-    VertexFormatDX GetFormat() const
+    VertexFormat GetFormat() const
     {
         return m_format;
     }
@@ -9,68 +9,102 @@
 using namespace SkullbonezCore::Rendering;
 
 
-MeshDX12::MeshDX12()
-    : m_vertexBuffer( nullptr ), m_vertexCount( 0 ), m_stride( 0 ), m_format( VertexFormat12::Pos3 )
-{
-    m_vbView = {};
-}
-
-
-MeshDX12::~MeshDX12()
-{
-    if ( m_vertexBuffer )
-    {
-        m_vertexBuffer->Release();
-    }
-}
-
-
-void MeshDX12::Create( ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, const float* data, int vertexCount, int floatsPerVert, VertexFormat12 format, D3D12_GPU_VIRTUAL_ADDRESS uploadAddr, uint8_t* uploadPtr )
+// Committed DEFAULT heap buffer filled from the upload buffer, left in restingState
+static ID3D12Resource* CreateFilledBuffer( ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, UINT64 size, D3D12_GPU_VIRTUAL_ADDRESS uploadAddr, D3D12_RESOURCE_STATES restingState )
 {
-    m_vertexCount = vertexCount;
-    m_stride = floatsPerVert * (int)sizeof( float );
-    m_format = format;
-
-    UINT64 dataSize = (UINT64)vertexCount * m_stride;
-
-    // Create committed vertex buffer on default heap
     D3D12_HEAP_PROPERTIES defaultHeap = {};
     defaultHeap.Type = D3D12_HEAP_TYPE_DEFAULT;
     D3D12_RESOURCE_DESC bufDesc = {};
     bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    bufDesc.Width = dataSize;
+    bufDesc.Width = size;
     bufDesc.Height = 1;
     bufDesc.DepthOrArraySize = 1;
     bufDesc.MipLevels = 1;
     bufDesc.SampleDesc.Count = 1;
     bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 
-    HRESULT hr = device->CreateCommittedResource( &defaultHeap, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS( &m_vertexBuffer ) );
+    ID3D12Resource* buffer = nullptr;
+    HRESULT hr = device->CreateCommittedResource( &defaultHeap, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS( &buffer ) );
     if ( FAILED( hr ) )
     {
         throw std::runtime_error( "MeshDX12: CreateCommittedResource failed" );
     }
 
-    // Copy vertex data to upload buffer
-    memcpy( uploadPtr, data, (size_t)dataSize );
-
-    // Record copy from upload buffer to vertex buffer
+    // Record copy from upload buffer
     auto* backend = RenderBackendDX12::Get();
     UINT64 uploadOffset = uploadAddr - backend->GetUploadBuffer()->GetGPUVirtualAddress();
-    cmdList->CopyBufferRegion( m_vertexBuffer, 0, backend->GetUploadBuffer(), uploadOffset, dataSize );
+    cmdList->CopyBufferRegion( buffer, 0, backend->GetUploadBuffer(), uploadOffset, size );
 
-    // Transition to vertex buffer state
     D3D12_RESOURCE_BARRIER barrier = {};
     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = m_vertexBuffer;
+    barrier.Transition.pResource = buffer;
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+    barrier.Transition.StateAfter = restingState;
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
     cmdList->ResourceBarrier( 1, &barrier );
+    return buffer;
+}
+
+
+static UINT64 AlignIndexOffset( UINT64 vertexBytes )
+{
+    return ( vertexBytes + 3 ) & ~(UINT64)3;
+}
+
+
+MeshDX12::MeshDX12()
+    : m_vertexBuffer( nullptr ), m_indexBuffer( nullptr ), m_vertexCount( 0 ), m_indexCount( 0 ), m_stride( 0 ), m_format( VertexFormat::Pos3 )
+{
+    m_vbView = {};
+    m_ibView = {};
+}
+
+
+MeshDX12::~MeshDX12()
+{
+    ResetResources();
+}
+
+
+UINT64 MeshDX12::GetUploadSize( int vertexCount, VertexFormat format, int indexCount, IndexFormat indexFormat )
+{
+    UINT64 vertexBytes = (UINT64)vertexCount * GetVertexStride( format );
+    if ( indexFormat == IndexFormat::None || indexCount <= 0 )
+    {
+        return vertexBytes;
+    }
+    return AlignIndexOffset( vertexBytes ) + (UINT64)indexCount * GetIndexSize( indexFormat );
+}
+
+
+void MeshDX12::Create( ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat, D3D12_GPU_VIRTUAL_ADDRESS uploadAddr, uint8_t* uploadPtr )
+{
+    m_vertexCount = vertexCount;
+    m_stride = GetVertexStride( format );
+    m_format = format;
+
+    UINT64 dataSize = (UINT64)vertexCount * m_stride;
+    memcpy( uploadPtr, vertices, (size_t)dataSize );
+    m_vertexBuffer = CreateFilledBuffer( device, cmdList, dataSize, uploadAddr, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER );
 
     m_vbView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
     m_vbView.SizeInBytes = (UINT)dataSize;
     m_vbView.StrideInBytes = (UINT)m_stride;
+
+    if ( indexFormat == IndexFormat::None || indexCount <= 0 )
+    {
+        return;
+    }
+
+    UINT64 indexOffset = AlignIndexOffset( dataSize );
+    UINT64 indexSize = (UINT64)indexCount * GetIndexSize( indexFormat );
+    memcpy( uploadPtr + indexOffset, indices, (size_t)indexSize );
+    m_indexBuffer = CreateFilledBuffer( device, cmdList, indexSize, uploadAddr + indexOffset, D3D12_RESOURCE_STATE_INDEX_BUFFER );
+    m_indexCount = indexCount;
+
+    m_ibView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
+    m_ibView.SizeInBytes = (UINT)indexSize;
+    m_ibView.Format = indexFormat == IndexFormat::UInt32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
 }
 
 
@@ -83,7 +117,15 @@ void MeshDX12::Draw() const
     }
     backend->PrepareDraw( m_format );
     backend->GetCommandList()->IASetVertexBuffers( 0, 1, &m_vbView );
-    backend->GetCommandList()->DrawInstanced( (UINT)m_vertexCount, 1, 0, 0 );
+    if ( m_indexBuffer )
+    {
+        backend->GetCommandList()->IASetIndexBuffer( &m_ibView );
+        backend->GetCommandList()->DrawIndexedInstanced( (UINT)m_indexCount, 1, 0, 0, 0 );
+    }
+    else
+    {
+        backend->GetCommandList()->DrawInstanced( (UINT)m_vertexCount, 1, 0, 0 );
+    }
 }
 
 
@@ -96,7 +138,35 @@ void MeshDX12::DrawInstanced( int instanceCount ) const
     }
     backend->PrepareDraw( m_format );
     backend->GetCommandList()->IASetVertexBuffers( 0, 1, &m_vbView );
-    backend->GetCommandList()->DrawInstanced( (UINT)m_vertexCount, (UINT)instanceCount, 0, 0 );
+    if ( m_indexBuffer )
+    {
+        backend->GetCommandList()->IASetIndexBuffer( &m_ibView );
+        backend->GetCommandList()->DrawIndexedInstanced( (UINT)m_indexCount, (UINT)instanceCount, 0, 0, 0 );
+    }
+    else
+    {
+        backend->GetCommandList()->DrawInstanced( (UINT)m_vertexCount, (UINT)instanceCount, 0, 0 );
+    }
+}
+
+
+void MeshDX12::UpdateVertices( int firstVertex, int vertexCount, const void* data )
+{
+    if ( firstVertex < 0 || vertexCount < 0 || firstVertex + vertexCount > m_vertexCount )
+    {
+        throw std::runtime_error( "Vertex range is outside the mesh.  (MeshDX12::UpdateVertices)" );
+    }
+
+    auto* backend = RenderBackendDX12::Get();
+    if ( !backend || !m_vertexBuffer )
+    {
+        return;
+    }
+    backend->UploadBufferRegion( m_vertexBuffer,
+                                 (UINT64)firstVertex * m_stride,
+                                 data,
+                                 (UINT64)vertexCount * m_stride,
+                                 D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER );
 }
 
 
@@ -107,4 +177,9 @@ void MeshDX12::ResetResources()
         m_vertexBuffer->Release();
         m_vertexBuffer = nullptr;
     }
+    if ( m_indexBuffer )
+    {
+        m_indexBuffer->Release();
+        m_indexBuffer = nullptr;
+    }
 }
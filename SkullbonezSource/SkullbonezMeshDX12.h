@@ -15,20 +15,10 @@ namespace Rendering
 class RenderBackendDX12;
 
 
-// Vertex format enum for PSO input layout selection
-enum class VertexFormat12
-{
-    Pos3,
-    Pos3_Tex2,
-    Pos3_Norm3_Tex2,
-    Pos2_Tex2,
-    Pos2
-};
-
-
 /* -- MeshDX12 ---------------------------------------------------------------------------------------------------------------------------------------------------
 
-    DirectX 12 static MeshGL implementation. Holds a committed vertex buffer resource on the DEFAULT heap.
+    DirectX 12 static MeshGL implementation. Holds committed vertex and (optional) index buffer resources on the
+    DEFAULT heap.  The format selects the PSO input layout.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class MeshDX12 : public IMesh
 {
@@ -36,15 +26,20 @@ class MeshDX12 : public IMesh
   private:
     ID3D12Resource* m_vertexBuffer;
     D3D12_VERTEX_BUFFER_VIEW m_vbView;
+    ID3D12Resource* m_indexBuffer; // nullptr for non-indexed meshes
+    D3D12_INDEX_BUFFER_VIEW m_ibView;
     int m_vertexCount;
+    int m_indexCount;
     int m_stride;
-    VertexFormat12 m_format;
+    VertexFormat m_format;
 
   public:
     MeshDX12();
     ~MeshDX12() override;
 
-    void Create( ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, const float* data, int vertexCount, int floatsPerVertex, VertexFormat12 format, D3D12_GPU_VIRTUAL_ADDRESS uploadAddr, uint8_t* uploadPtr );
+    // uploadAddr / uploadPtr: one upload allocation holding the vertices, then the indices at a 4-byte aligned offset
+    void Create( ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat, D3D12_GPU_VIRTUAL_ADDRESS uploadAddr, uint8_t* uploadPtr );
+    static UINT64 GetUploadSize( int vertexCount, VertexFormat format, int indexCount, IndexFormat indexFormat );
 
     void Draw() const override;
     void DrawInstanced( int instanceCount ) const override;
@@ -52,7 +47,12 @@ class MeshDX12 : public IMesh
     {
         return m_vertexCount;
     }
-    VertexFormat12 GetFormat() const
+    int GetIndexCount() const override
+    {
+        return m_indexCount;
+    }
+    void UpdateVertices( int firstVertex, int vertexCount, const void* data ) override;
+    VertexFormat GetFormat() const
     {
         return m_format;
     }
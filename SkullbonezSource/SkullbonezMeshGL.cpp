@@ -6,22 +6,68 @@
 using namespace SkullbonezCore::Rendering;
 
 
-MeshGL::MeshGL( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords, GLenum drawMode )
+// One interleaved attribute: component count, GL type, normalised flag and size in bytes
+struct AttribGL
 {
-    m_vertexCount = vertexCount;
-    m_drawMode = drawMode;
+    GLint components;
+    GLenum type;
+    GLboolean isNormalised;
+    int bytes;
+};
 
-    // Calculate stride: m_position(3) + optional m_normal(3) + optional texcoord(2)
-    int floatsPerVertex = 3;
-    if ( hasNormals )
-    {
-        floatsPerVertex += 3;
-    }
-    if ( hasTexCoords )
+
+// Attributes at locations 0 (position), 1 (normal) and 2 (texcoord); components == 0 = absent
+static void GetAttribsGL( VertexFormat format, AttribGL* out )
+{
+    const AttribGL none = { 0, GL_FLOAT, GL_FALSE, 0 };
+    const AttribGL float2 = { 2, GL_FLOAT, GL_FALSE, 8 };
+    const AttribGL float3 = { 3, GL_FLOAT, GL_FALSE, 12 };
+    out[0] = none;
+    out[1] = none;
+    out[2] = none;
+
+    switch ( format )
     {
-        floatsPerVertex += 2;
+    case VertexFormat::Pos3:
+        out[0] = float3;
+        break;
+    case VertexFormat::Pos3_Tex2:
+        out[0] = float3;
+        out[2] = float2;
+        break;
+    case VertexFormat::Pos3_Norm3_Tex2:
+        out[0] = float3;
+        out[1] = float3;
+        out[2] = float2;
+        break;
+    case VertexFormat::Pos2_Tex2:
+        out[0] = float2;
+        out[2] = float2;
+        break;
+    case VertexFormat::Pos2:
+        out[0] = float2;
+        break;
+    case VertexFormat::Pos3_PackedNorm_HalfTex:
+        out[0] = float3;
+        out[1] = { 4, GL_UNSIGNED_INT_2_10_10_10_REV, GL_TRUE, 4 };
+        out[2] = { 2, GL_HALF_FLOAT, GL_FALSE, 4 };
+        break;
+    case VertexFormat::HalfPos_UNormTex:
+        out[0] = { 3, GL_HALF_FLOAT, GL_FALSE, 8 }; // w is padding
+        out[2] = { 2, GL_UNSIGNED_SHORT, GL_TRUE, 4 };
+        break;
     }
-    int stride = floatsPerVertex * static_cast<int>( sizeof( float ) );
+}
+
+
+MeshGL::MeshGL( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat, GLenum drawMode )
+{
+    m_vertexCount = vertexCount;
+    m_drawMode = drawMode;
+    m_stride = GetVertexStride( format );
+    m_ibo = 0;
+    m_indexCount = indexFormat == IndexFormat::None ? 0 : indexCount;
+    m_indexType = indexFormat == IndexFormat::UInt32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 
     // Create VAO
     glGenVertexArrays( 1, &m_vao );
@@ -31,36 +77,45 @@ MeshGL::MeshGL( const float* data, int vertexCount, bool hasNormals, bool hasTex
     glGenBuffers( 1, &m_vbo );
     glBindBuffer( GL_ARRAY_BUFFER, m_vbo );
     glBufferData( GL_ARRAY_BUFFER,
-                  static_cast<GLsizeiptr>( m_vertexCount ) * stride,
-                  data,
+                  static_cast<GLsizeiptr>( m_vertexCount ) * m_stride,
+                  vertices,
                   GL_STATIC_DRAW );
 
-    // Configure vertex attributes
-    int offset = 0;
-
-    // location 0 = aPosition (vec3)
-    glEnableVertexAttribArray( 0 );
-    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
-    offset += 3 * static_cast<int>( sizeof( float ) );
-
-    // location 1 = aNormal (vec3)
-    if ( hasNormals )
+    // Element buffer: the binding is VAO state, so Draw only needs the VAO
+    if ( m_indexCount > 0 )
     {
-        glEnableVertexAttribArray( 1 );
-        glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
-        offset += 3 * static_cast<int>( sizeof( float ) );
+        glGenBuffers( 1, &m_ibo );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_ibo );
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                      static_cast<GLsizeiptr>( m_indexCount ) * GetIndexSize( indexFormat ),
+                      indices,
+                      GL_STATIC_DRAW );
     }
 
-    // location 2 = aTexCoord (vec2)
-    if ( hasTexCoords )
+    // Configure vertex attributes: location 0 = aPosition, 1 = aNormal, 2 = aTexCoord
+    AttribGL attribs[3];
+    GetAttribsGL( format, attribs );
+    int offset = 0;
+    for ( int location = 0; location < 3; ++location )
     {
-        glEnableVertexAttribArray( 2 );
-        glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
+        if ( attribs[location].components == 0 )
+        {
+            continue;
+        }
+        glEnableVertexAttribArray( static_cast<GLuint>( location ) );
+        glVertexAttribPointer( static_cast<GLuint>( location ),
+                               attribs[location].components,
+                               attribs[location].type,
+                               attribs[location].isNormalised,
+                               m_stride,
+                               reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
+        offset += attribs[location].bytes;
     }
 
-    // Unbind
+    // Unbind (VAO first, so it keeps its element buffer)
     glBindVertexArray( 0 );
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 }
 
 
@@ -70,6 +125,10 @@ MeshGL::~MeshGL()
     {
         glDeleteBuffers( 1, &m_vbo );
     }
+    if ( m_ibo )
+    {
+        glDeleteBuffers( 1, &m_ibo );
+    }
     if ( m_vao )
     {
         glDeleteVertexArrays( 1, &m_vao );
@@ -80,14 +139,28 @@ MeshGL::~MeshGL()
 void MeshGL::Draw() const
 {
     glBindVertexArray( m_vao );
-    glDrawArrays( m_drawMode, 0, m_vertexCount );
+    if ( m_indexCount > 0 )
+    {
+        glDrawElements( m_drawMode, m_indexCount, m_indexType, nullptr );
+    }
+    else
+    {
+        glDrawArrays( m_drawMode, 0, m_vertexCount );
+    }
 }
 
 
 void MeshGL::DrawInstanced( int instanceCount ) const
 {
     glBindVertexArray( m_vao );
-    glDrawArraysInstanced( m_drawMode, 0, m_vertexCount, instanceCount );
+    if ( m_indexCount > 0 )
+    {
+        glDrawElementsInstanced( m_drawMode, m_indexCount, m_indexType, nullptr, instanceCount );
+    }
+    else
+    {
+        glDrawArraysInstanced( m_drawMode, 0, m_vertexCount, instanceCount );
+    }
 }
 
 
@@ -95,3 +168,25 @@ int MeshGL::GetVertexCount() const
 {
     return m_vertexCount;
 }
+
+
+int MeshGL::GetIndexCount() const
+{
+    return m_indexCount;
+}
+
+
+void MeshGL::UpdateVertices( int firstVertex, int vertexCount, const void* data )
+{
+    if ( firstVertex < 0 || vertexCount < 0 || firstVertex + vertexCount > m_vertexCount )
+    {
+        throw std::runtime_error( "Vertex range is outside the mesh.  (MeshGL::UpdateVertices)" );
+    }
+
+    glBindBuffer( GL_ARRAY_BUFFER, m_vbo );
+    glBufferSubData( GL_ARRAY_BUFFER,
+                     static_cast<GLintptr>( firstVertex ) * m_stride,
+                     static_cast<GLsizeiptr>( vertexCount ) * m_stride,
+                     data );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
@@ -11,34 +11,42 @@ namespace Rendering
 {
 /* -- MeshGL ------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    OpenGL 3.3 implementation of IMesh. VAO/VBO wrapper for interleaved vertex data.
+    OpenGL 3.3 implementation of IMesh. VAO/VBO wrapper for interleaved vertex data, with an optional element
+    buffer (recorded in the VAO) for indexed meshes.
     Supports flexible vertex formats:
       - Position only (3 floats)
       - Position + Normal (6 floats)
       - Position + TexCoord (5 floats)
       - Position + Normal + TexCoord (8 floats)
+      - The packed VertexFormat layouts (half floats, 10:10:10:2 and 16-bit normalised attributes)
 
     Vertex attribute layout:
       location 0 = aPosition (vec3)
-      location 1 = aNormal   (vec3)  [if hasNormals]
-      location 2 = aTexCoord (vec2)  [if hasTexCoords]
+      location 1 = aNormal   (vec3)  [if the format has normals]
+      location 2 = aTexCoord (vec2)  [if the format has texcoords]
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class MeshGL : public IMesh
 {
 
   private:
-    GLuint m_vao;      // Vertex Array Object
-    GLuint m_vbo;      // Vertex Buffer Object
-    int m_vertexCount; // Number of vertices
-    GLenum m_drawMode; // GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.
+    GLuint m_vao;       // Vertex Array Object
+    GLuint m_vbo;       // Vertex Buffer Object
+    GLuint m_ibo;       // Element buffer (0 = non-indexed)
+    int m_vertexCount;  // Number of vertices
+    int m_indexCount;   // Number of indices (0 = non-indexed)
+    GLenum m_indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    int m_stride;       // Bytes per vertex
+    GLenum m_drawMode;  // GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.
 
   public:
-    MeshGL( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords, GLenum drawMode = GL_TRIANGLES ); // Upload interleaved vertex data
-    ~MeshGL() override;                                                                                               // Destructor: delete VAO/VBO
+    MeshGL( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat, GLenum drawMode = GL_TRIANGLES ); // Upload interleaved vertex data (and indices)
+    ~MeshGL() override;                                                                                                                                                 // Destructor: delete VAO/VBO/IBO
 
     void Draw() const override; // Bind VAO and draw
     void DrawInstanced( int instanceCount ) const override;
     int GetVertexCount() const override; // Get vertex count
+    int GetIndexCount() const override;
+    void UpdateVertices( int firstVertex, int vertexCount, const void* data ) override; // glBufferSubData over the range
 };
 } // namespace Rendering
 } // namespace SkullbonezCore
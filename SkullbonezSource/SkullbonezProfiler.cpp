@@ -53,8 +53,8 @@ Profiler& Profiler::Instance()
 
 
 Profiler::Profiler()
-    : m_markerCount( 0 ), m_stackTop( 0 ), m_qpcFrequency( 0 ), m_lastAvgTicks( 0 ), m_inFrame( false ),
-      m_warmupFrames( WARMUP_FRAMES + 1 )
+    : m_markerCount( 0 ), m_counterCount( 0 ), m_stackTop( 0 ), m_qpcFrequency( 0 ), m_lastAvgTicks( 0 ), m_inFrame( false ),
+      m_warmupFrames( WARMUP_FRAMES + 1 ), m_ownerThreadId( 0 )
 {
     LARGE_INTEGER f;
     if ( QueryPerformanceFrequency( &f ) )
@@ -66,6 +66,7 @@ Profiler::Profiler()
         m_qpcFrequency = 1; // avoid division by zero; timings will be garbage but won't crash
     }
     std::memset( m_markers, 0, sizeof( m_markers ) );
+    std::memset( m_counters, 0, sizeof( m_counters ) );
     std::memset( m_stackIndices, 0, sizeof( m_stackIndices ) );
 }
 
@@ -125,6 +126,8 @@ int Profiler::FindOrRegister( const char* fullPath, uint32_t hash )
     m.p50Ms = 0.0f;
     m.p99Ms = 0.0f;
     m.p99_9Ms = 0.0f;
+    m.overlayP50Ms = 0.0f;
+    m.overlayP99Ms = 0.0f;
     m.minMs = FLT_MAX;
     m.maxMs = 0.0f;
 
@@ -186,8 +189,18 @@ int Profiler::FindOrRegister( const char* fullPath, uint32_t hash )
 }
 
 
+bool Profiler::IsOwnerThread() const
+{
+    return m_ownerThreadId.load( std::memory_order_relaxed ) == GetCurrentThreadId();
+}
+
+
 void Profiler::Begin( const char* fullPath, uint32_t hash )
 {
+    if ( !IsOwnerThread() )
+    {
+        return;
+    }
     if ( !m_inFrame )
     {
         AbortMismatch( "PROFILE_BEGIN called outside frame", fullPath );
@@ -215,6 +228,10 @@ void Profiler::Begin( const char* fullPath, uint32_t hash )
 
 void Profiler::End( const char* fullPath, uint32_t hash )
 {
+    if ( !IsOwnerThread() )
+    {
+        return;
+    }
     if ( m_stackTop == 0 )
     {
         AbortMismatch( "PROFILE_END with empty stack", fullPath );
@@ -244,7 +261,7 @@ void Profiler::End( const char* fullPath, uint32_t hash )
 void Profiler::GpuBegin( const char* fullPath, uint32_t hash )
 {
     // GPU profiler requires OpenGL — skip when running DX11
-    if ( !glGenQueries )
+    if ( !glGenQueries || !IsOwnerThread() )
     {
         return;
     }
@@ -276,7 +293,7 @@ void Profiler::GpuBegin( const char* fullPath, uint32_t hash )
 
 void Profiler::GpuEnd( const char* fullPath, uint32_t hash )
 {
-    if ( !glQueryCounter )
+    if ( !glQueryCounter || !IsOwnerThread() )
     {
         return;
     }
@@ -293,6 +310,48 @@ void Profiler::GpuEnd( const char* fullPath, uint32_t hash )
 }
 
 
+const char* Profiler::GetOpenMarker() const
+{
+    if ( !IsOwnerThread() || m_stackTop == 0 )
+    {
+        return nullptr;
+    }
+    return m_markers[m_stackIndices[m_stackTop - 1]].name;
+}
+
+
+void Profiler::CounterAdd( const char* fullPath, uint32_t hash, int64_t value )
+{
+    if ( !IsOwnerThread() )
+    {
+        return;
+    }
+    for ( int i = 0; i < m_counterCount; ++i )
+    {
+        if ( m_counters[i].hash == hash )
+        {
+            if ( std::strcmp( m_counters[i].name, fullPath ) != 0 )
+            {
+                AbortMismatch( "FNV-1a hash collision between counters", fullPath );
+            }
+            m_counters[i].accumThisFrame += value;
+            return;
+        }
+    }
+
+    if ( m_counterCount >= MAX_COUNTERS )
+    {
+        AbortMismatch( "MAX_COUNTERS exceeded", fullPath );
+    }
+
+    Counter& c = m_counters[m_counterCount++];
+    std::memset( &c, 0, sizeof( c ) );
+    c.name = fullPath;
+    c.hash = hash;
+    c.accumThisFrame = value;
+}
+
+
 void Profiler::ReadPendingGpuResults()
 {
     if ( !glGetQueryObjectuiv )
@@ -395,6 +454,7 @@ void Profiler::FrameBegin()
         AbortMismatch( "FrameBegin with non-empty stack", nullptr );
     }
     m_inFrame = true;
+    m_ownerThreadId.store( GetCurrentThreadId(), std::memory_order_relaxed );
 
     // Consume warmup budget at frame start so FrameEnd and WritePerfCSVRow see the same value
     if ( m_warmupFrames > 0 )
@@ -410,6 +470,10 @@ void Profiler::FrameBegin()
     {
         m_markers[i].accumSecondsThisFrame = 0.0;
     }
+    for ( int i = 0; i < m_counterCount; ++i )
+    {
+        m_counters[i].accumThisFrame = 0;
+    }
 
     // Implicit top-level "Frame" marker captures the entire frame total.
     static constexpr uint32_t kFrameHash = HashStr( "Frame" );
@@ -491,6 +555,23 @@ void Profiler::FrameEnd()
         }
     }
 
+    // Counters: last-frame total always; running sum and max only after warmup
+    for ( int i = 0; i < m_counterCount; ++i )
+    {
+        Counter& c = m_counters[i];
+        c.lastFrame = c.accumThisFrame;
+        if ( m_warmupFrames > 0 )
+        {
+            continue;
+        }
+        c.sumSinceAvg += c.lastFrame;
+        ++c.framesSinceAvg;
+        if ( c.lastFrame > c.peak )
+        {
+            c.peak = c.lastFrame;
+        }
+    }
+
     // Moving average refreshed every 500 ms (CPU and GPU) — skip during warmup
     if ( m_warmupFrames == 0 )
     {
@@ -515,6 +596,8 @@ void Profiler::FrameEnd()
                     }
                     m.avgMs = static_cast<float>( sum / n );
                 }
+                m.overlayP50Ms = m.p50Ms;
+                m.overlayP99Ms = m.p99Ms;
 
                 // GPU average
                 if ( m.hasGpu )
@@ -531,6 +614,17 @@ void Profiler::FrameEnd()
                     }
                 }
             }
+            for ( int i = 0; i < m_counterCount; ++i )
+            {
+                Counter& c = m_counters[i];
+                if ( c.framesSinceAvg > 0 )
+                {
+                    c.avg = static_cast<float>( static_cast<double>( c.sumSinceAvg ) / c.framesSinceAvg );
+                }
+                c.sumSinceAvg = 0;
+                c.framesSinceAvg = 0;
+                c.overlayLast = c.lastFrame;
+            }
         }
     }
 
@@ -554,12 +648,12 @@ float Profiler::LastFrameMsByHash( uint32_t hash ) const
 void Profiler::WritePerfCSVHeader( FILE* f ) const
 {
     static constexpr uint32_t kVsyncHash = ::HashStr( "Frame/VsyncWait" );
-    static constexpr uint32_t kPipelineHash = ::HashStr( "Frame/PipelineSync" );
+    static constexpr uint32_t kGpuWaitHash = ::HashStr( "Frame/GpuWait" );
 
     fprintf( f, "pass,frame" );
     for ( int i = 0; i < m_markerCount; ++i )
     {
-        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kPipelineHash )
+        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kGpuWaitHash )
         {
             continue;
         }
@@ -569,10 +663,10 @@ void Profiler::WritePerfCSVHeader( FILE* f ) const
             fprintf( f, ",%s_gpu", m_markers[i].name );
         }
     }
-    // PipelineSync then VsyncWait at end so they don't skew averages when viewed together
+    // GpuWait then VsyncWait at end so they don't skew averages when viewed together
     for ( int pass = 0; pass < 2; ++pass )
     {
-        uint32_t target = ( pass == 0 ) ? kPipelineHash : kVsyncHash;
+        uint32_t target = ( pass == 0 ) ? kGpuWaitHash : kVsyncHash;
         for ( int i = 0; i < m_markerCount; ++i )
         {
             if ( m_markers[i].hash == target )
@@ -586,6 +680,10 @@ void Profiler::WritePerfCSVHeader( FILE* f ) const
             }
         }
     }
+    for ( int i = 0; i < m_counterCount; ++i )
+    {
+        fprintf( f, ",%s", m_counters[i].name );
+    }
     fprintf( f, "\n" );
 }
 
@@ -598,12 +696,12 @@ void Profiler::WritePerfCSVRow( FILE* f, int pass, int frame ) const
     }
 
     static constexpr uint32_t kVsyncHash = ::HashStr( "Frame/VsyncWait" );
-    static constexpr uint32_t kPipelineHash = ::HashStr( "Frame/PipelineSync" );
+    static constexpr uint32_t kGpuWaitHash = ::HashStr( "Frame/GpuWait" );
 
     fprintf( f, "%d,%d", pass, frame );
     for ( int i = 0; i < m_markerCount; ++i )
     {
-        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kPipelineHash )
+        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kGpuWaitHash )
         {
             continue;
         }
@@ -615,7 +713,7 @@ void Profiler::WritePerfCSVRow( FILE* f, int pass, int frame ) const
     }
     for ( int p = 0; p < 2; ++p )
     {
-        uint32_t target = ( p == 0 ) ? kPipelineHash : kVsyncHash;
+        uint32_t target = ( p == 0 ) ? kGpuWaitHash : kVsyncHash;
         for ( int i = 0; i < m_markerCount; ++i )
         {
             if ( m_markers[i].hash == target )
@@ -629,6 +727,10 @@ void Profiler::WritePerfCSVRow( FILE* f, int pass, int frame ) const
             }
         }
     }
+    for ( int i = 0; i < m_counterCount; ++i )
+    {
+        fprintf( f, ",%lld", static_cast<long long>( m_counters[i].lastFrame ) );
+    }
     fprintf( f, "\n" );
 }
 
@@ -652,7 +754,8 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
     const float padX = fSize * 0.6f;
     const float padY = lineHeight * 1.2f;
     const float panelW = anyGpu ? fSize * 53.0f : fSize * 46.0f;
-    const float rowsHeight = static_cast<float>( m_markerCount + 2 ) * lineHeight; // +2 for header + column labels
+    const int counterRows = ( m_counterCount > 0 ) ? m_counterCount + 1 : 0;                     // +1 for counter column labels
+    const float rowsHeight = static_cast<float>( m_markerCount + 2 + counterRows ) * lineHeight; // +2 for header + column labels
 
     const float yBottom = yAnchor + padY;
     const float yTop = yBottom + rowsHeight;
@@ -674,13 +777,13 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
     const float colMin = anyGpu ? fSize * 39.0f : fSize * 32.0f;
     const float colMax = anyGpu ? fSize * 46.0f : fSize * 39.0f;
 
-    // Look up Frame, VsyncWait, and PipelineSync for CPU time
+    // Look up Frame, VsyncWait, and GpuWait: CPU time excludes both waits, and the CPU-wait-on-GPU is shown on its own
     static constexpr uint32_t kFrameHash = ::HashStr( "Frame" );
     static constexpr uint32_t kVsyncHash = ::HashStr( "Frame/VsyncWait" );
-    static constexpr uint32_t kPipelineSyncHash = ::HashStr( "Frame/PipelineSync" );
+    static constexpr uint32_t kGpuWaitHash = ::HashStr( "Frame/GpuWait" );
     float frameAvgMs = 0.0f;
     float vsyncAvgMs = 0.0f;
-    float pipelineSyncAvgMs = 0.0f;
+    float gpuWaitAvgMs = 0.0f;
     for ( int i = 0; i < m_markerCount; ++i )
     {
         if ( m_markers[i].hash == kFrameHash )
@@ -691,16 +794,16 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
         {
             vsyncAvgMs = m_markers[i].avgMs;
         }
-        else if ( m_markers[i].hash == kPipelineSyncHash )
+        else if ( m_markers[i].hash == kGpuWaitHash )
         {
-            pipelineSyncAvgMs = m_markers[i].avgMs;
+            gpuWaitAvgMs = m_markers[i].avgMs;
         }
     }
-    const float cpuMs = frameAvgMs - vsyncAvgMs - pipelineSyncAvgMs;
+    const float cpuMs = frameAvgMs - vsyncAvgMs - gpuWaitAvgMs;
 
     // Header line
     float y = yTop;
-    Text2d::Render2dTextColor( xLeft, y, fSize, hdrR, hdrG, hdrB, "CPU: %.2f ms  FPS: %.1f", cpuMs, fps );
+    Text2d::Render2dTextColor( xLeft, y, fSize, hdrR, hdrG, hdrB, "CPU: %.2f ms  GPU WAIT: %.2f ms  FPS: %.1f", cpuMs, gpuWaitAvgMs, fps );
     y -= lineHeight;
 
     // Column labels
@@ -719,7 +822,7 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
     // Traffic-light threshold: proportion of CPU budget
     float budgetMs = ( cpuMs > 0.001f ) ? cpuMs : 1.0f;
 
-    // Marker rows — PipelineSync and VsyncWait rendered last (at bottom)
+    // Marker rows — GpuWait and VsyncWait rendered last (at bottom)
     auto renderMarkerRow = [&]( const Marker& m )
     {
         char nameBuf[64] = { 0 };
@@ -735,7 +838,7 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
         strcpy_s( nameBuf + spaces, sizeof( nameBuf ) - spaces, m.leafName );
 
         float mr, mg, mb;
-        if ( m.hash == kVsyncHash || m.hash == kPipelineSyncHash )
+        if ( m.hash == kVsyncHash || m.hash == kGpuWaitHash )
         {
             mr = 0.5f;
             mg = 0.5f;
@@ -777,8 +880,8 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
                 Text2d::Render2dTextColor( xLeft + colGpu, y, fSize, colR, colG, colB, "    - " );
             }
         }
-        Text2d::Render2dTextColor( xLeft + colP50, y, fSize, mr, mg, mb, "%6.2f", m.p50Ms );
-        Text2d::Render2dTextColor( xLeft + colP99, y, fSize, mr, mg, mb, "%6.2f", m.p99Ms );
+        Text2d::Render2dTextColor( xLeft + colP50, y, fSize, mr, mg, mb, "%6.2f", m.overlayP50Ms );
+        Text2d::Render2dTextColor( xLeft + colP99, y, fSize, mr, mg, mb, "%6.2f", m.overlayP99Ms );
         float displayMin = ( m.ringFilled > 0 ) ? m.minMs : 0.0f;
         float displayMax = ( m.ringFilled > 0 ) ? m.maxMs : 0.0f;
         Text2d::Render2dTextColor( xLeft + colMin, y, fSize, mr, mg, mb, "%6.2f", displayMin );
@@ -788,7 +891,7 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
 
     for ( int i = 0; i < m_markerCount; ++i )
     {
-        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kPipelineSyncHash )
+        if ( m_markers[i].hash == kVsyncHash || m_markers[i].hash == kGpuWaitHash )
         {
             continue;
         }
@@ -796,7 +899,7 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
     }
     for ( int pass = 0; pass < 2; ++pass )
     {
-        uint32_t target = ( pass == 0 ) ? kPipelineSyncHash : kVsyncHash;
+        uint32_t target = ( pass == 0 ) ? kGpuWaitHash : kVsyncHash;
         for ( int i = 0; i < m_markerCount; ++i )
         {
             if ( m_markers[i].hash == target )
@@ -806,6 +909,26 @@ void Profiler::RenderOverlay( float xLeft, float yAnchor, float lineHeight, floa
             }
         }
     }
+
+    // Counter rows: last frame / moving average / session max
+    if ( m_counterCount > 0 )
+    {
+        Text2d::Render2dTextColor( xLeft + colName, y, fSize, colR, colG, colB, "COUNTER" );
+        Text2d::Render2dTextColor( xLeft + colAvg, y, fSize, colR, colG, colB, "LAST" );
+        Text2d::Render2dTextColor( xLeft + colP50, y, fSize, colR, colG, colB, "AVG" );
+        Text2d::Render2dTextColor( xLeft + colMax, y, fSize, colR, colG, colB, "MAX" );
+        y -= lineHeight;
+
+        for ( int i = 0; i < m_counterCount; ++i )
+        {
+            const Counter& c = m_counters[i];
+            Text2d::Render2dTextColor( xLeft + colName, y, fSize, gpuR, gpuG, gpuB, "%-14s", FindLeafName( c.name ) );
+            Text2d::Render2dTextColor( xLeft + colAvg, y, fSize, gpuR, gpuG, gpuB, "%6lld", static_cast<long long>( c.overlayLast ) );
+            Text2d::Render2dTextColor( xLeft + colP50, y, fSize, gpuR, gpuG, gpuB, "%6.0f", c.avg );
+            Text2d::Render2dTextColor( xLeft + colMax, y, fSize, gpuR, gpuG, gpuB, "%6lld", static_cast<long long>( c.peak ) );
+            y -= lineHeight;
+        }
+    }
 }
 
 
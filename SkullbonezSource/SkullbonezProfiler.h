@@ -3,6 +3,7 @@
 
 // --- Includes ---
 #include "SkullbonezCommon.h"
+#include <atomic>
 
 namespace SkullbonezCore
 {
@@ -21,8 +22,12 @@ namespace Basics
     Use the macros:
       PROFILE_BEGIN / PROFILE_END / PROFILE_SCOPED         — CPU-only timing
       PROFILE_GPU_BEGIN / PROFILE_GPU_END / PROFILE_GPU_SCOPED — CPU + GPU timing
+      PROFILE_COUNTER_ADD                                  — per-frame event counts (draws, state changes, ...)
 
     Never call methods directly.
+
+    Not thread-safe: the thread that calls FrameBegin() owns the profiler, and marker/counter calls made
+    from any other thread (e.g. RunPhysics on the simulation thread) are silently dropped.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class Profiler
 {
@@ -32,6 +37,7 @@ class Profiler
     static constexpr int RING_SIZE = 600;     // ~10 s @ 60 fps
     static constexpr int GPU_QUERY_DEPTH = 4; // pending query ring depth (non-blocking readback)
     static constexpr int WARMUP_FRAMES = 30;  // frames excluded from ring-buffer stats at session/pass start
+    static constexpr int MAX_COUNTERS = 32;
 
     struct Marker
     {
@@ -51,6 +57,8 @@ class Profiler
         float p50Ms;             // recomputed every frame
         float p99Ms;             // recomputed every frame
         float p99_9Ms;           // recomputed every frame (for perf CSV)
+        float overlayP50Ms;      // p50 snapshot shown by the overlay, refreshed with avgMs
+        float overlayP99Ms;      // p99 snapshot shown by the overlay, refreshed with avgMs
         float minMs;             // session-wide minimum
         float maxMs;             // session-wide maximum
 
@@ -68,6 +76,19 @@ class Profiler
         int gpuRingHead;
     };
 
+    struct Counter
+    {
+        const char* name; // full path literal, e.g. "Render/StateChanges"
+        uint32_t hash;    // FNV-1a of full path
+        int64_t accumThisFrame;
+        int64_t lastFrame;   // most recent finished-frame total
+        int64_t sumSinceAvg; // totals accumulated since the last average refresh
+        int framesSinceAvg;  // frames accumulated since the last average refresh
+        float avg;           // moving average refreshed every 500 ms
+        int64_t peak;        // session-wide maximum (after warmup)
+        int64_t overlayLast; // lastFrame snapshot shown by the overlay, refreshed with avg
+    };
+
     static Profiler& Instance();
 
     void Begin( const char* fullPath, uint32_t hash );
@@ -76,6 +97,8 @@ class Profiler
     void GpuBegin( const char* fullPath, uint32_t hash );
     void GpuEnd( const char* fullPath, uint32_t hash );
 
+    void CounterAdd( const char* fullPath, uint32_t hash, int64_t value );
+
     void FrameBegin();
     void FrameEnd(); // commits per-frame totals; recomputes p50/p99; refreshes moving avg every 500 ms
 
@@ -90,6 +113,17 @@ class Profiler
     {
         return m_markers[i];
     }
+    int CounterCount() const
+    {
+        return m_counterCount;
+    }
+    const Counter& GetCounter( int i ) const
+    {
+        return m_counters[i];
+    }
+
+    // Innermost marker open on the calling thread ("Frame" between markers); nullptr outside a frame or off the owner thread
+    const char* GetOpenMarker() const;
 
     // Accessor for back-compat perf logging (returns last finished-frame total ms; 0 if marker missing)
     float LastFrameMsByHash( uint32_t hash ) const;
@@ -101,6 +135,7 @@ class Profiler
 
     // Renders the indented overlay using Text2d::Render2dText. Caller decides toggle state.
     // xLeft / yTop in the same frustum-unit space used elsewhere; lineHeight in same space; fSize for Text2d.
+    // Values only change on the 500 ms refresh, so between refreshes Text2d reuses the cached lines.
     void RenderOverlay( float xLeft, float yAnchor, float lineHeight, float fSize, float fps ) const;
 
   private:
@@ -116,6 +151,9 @@ class Profiler
     Marker m_markers[MAX_MARKERS];
     int m_markerCount;
 
+    Counter m_counters[MAX_COUNTERS];
+    int m_counterCount;
+
     int m_stackIndices[MAX_DEPTH]; // marker indices currently open (top of stack at [m_stackTop-1])
     int m_stackTop;
 
@@ -123,6 +161,10 @@ class Profiler
     int64_t m_lastAvgTicks;
     bool m_inFrame;
     int m_warmupFrames; // frames remaining in warmup window; ring-buffer stats not recorded when > 0
+
+    std::atomic<DWORD> m_ownerThreadId; // thread running the frame loop; set by FrameBegin
+
+    bool IsOwnerThread() const;
 };
 
 class ProfilerScope
@@ -213,6 +255,13 @@ class GpuProfilerScope
     constexpr uint32_t PROFILE_PASTE( _profSH_, __LINE__ ) = ::HashStr( name ); \
     ::SkullbonezCore::Basics::GpuProfilerScope PROFILE_PASTE( _profS_, __LINE__ )( name, PROFILE_PASTE( _profSH_, __LINE__ ) )
 
+#define PROFILE_COUNTER_ADD( name, value )                                                                                                    \
+    do                                                                                                                                        \
+    {                                                                                                                                         \
+        constexpr uint32_t PROFILE_PASTE( _profH_, __LINE__ ) = ::HashStr( name );                                                            \
+        ::SkullbonezCore::Basics::Profiler::Instance().CounterAdd( name, PROFILE_PASTE( _profH_, __LINE__ ), static_cast<int64_t>( value ) ); \
+    } while ( 0 )
+
 #define PROFILE_FRAME_BEGIN() ::SkullbonezCore::Basics::Profiler::Instance().FrameBegin()
 #define PROFILE_FRAME_END() ::SkullbonezCore::Basics::Profiler::Instance().FrameEnd()
 
@@ -224,6 +273,7 @@ class GpuProfilerScope
 #define PROFILE_GPU_BEGIN( name ) ( (void)0 )
 #define PROFILE_GPU_END( name ) ( (void)0 )
 #define PROFILE_GPU_SCOPED( name ) ( (void)0 )
+#define PROFILE_COUNTER_ADD( name, value ) ( (void)0 )
 #define PROFILE_FRAME_BEGIN() ( (void)0 )
 #define PROFILE_FRAME_END() ( (void)0 )
 
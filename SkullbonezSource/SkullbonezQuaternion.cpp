@@ -100,6 +100,15 @@ void Quaternion::RotateAboutAxis( const Vector3& axis, float angle )
 }
 
 
+void Quaternion::GetComponents( float& x, float& y, float& z, float& w ) const
+{
+    x = m_x;
+    y = m_y;
+    z = m_z;
+    w = m_w;
+}
+
+
 RotationMatrix Quaternion::GetOrientationMatrix()
 {
     // Return the RIGHT HANDED rotation matrix
@@ -3,6 +3,7 @@
 #include "SkullbonezShaderDX11.h"
 #include "SkullbonezMeshDX11.h"
 #include "SkullbonezFramebufferDX11.h"
+#include "SkullbonezProfiler.h"
 #include <stdexcept>
 #include <string>
 #include <algorithm>
@@ -30,7 +31,7 @@ RenderBackendDX11* RenderBackendDX11::s_instance = nullptr;
 
 
 RenderBackendDX11::RenderBackendDX11()
-    : m_swapChain( nullptr ), m_device( nullptr ), m_context( nullptr ), m_backBufferRTV( nullptr ), m_depthStencilTex( nullptr ), m_depthStencilView( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_clearColor{ 0.0f, 0.0f, 0.0f, 1.0f }, m_clearDepth( 1.0f ), m_dsDepthOn( nullptr ), m_dsDepthOff( nullptr ), m_blendOff( nullptr ), m_rsCullOn( nullptr ), m_rsCullOff( nullptr ), m_rsCullOnPolyOffset( nullptr ), m_rsCullOffPolyOffset( nullptr ), m_samplerLinear( nullptr ), m_samplerNearest( nullptr ), m_activeBlendState( nullptr ), m_currentBlendSrc( BlendFactor::One ), m_currentBlendDst( BlendFactor::Zero ), m_cullEnabled( true ), m_polyOffsetEnabled( false ), m_currentRTV( nullptr ), m_currentDSV( nullptr ), m_stagingTex( nullptr ), m_stagingWidth( 0 ), m_stagingHeight( 0 ), m_activeShader( nullptr )
+    : m_swapChain( nullptr ), m_device( nullptr ), m_context( nullptr ), m_backBufferRTV( nullptr ), m_depthStencilTex( nullptr ), m_depthStencilView( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_clearColor{ 0.0f, 0.0f, 0.0f, 1.0f }, m_clearDepth( 1.0f ), m_dsDepthOn( nullptr ), m_dsDepthOff( nullptr ), m_blendOff( nullptr ), m_rsCullOn( nullptr ), m_rsCullOff( nullptr ), m_rsCullOnPolyOffset( nullptr ), m_rsCullOffPolyOffset( nullptr ), m_samplerLinear( nullptr ), m_samplerNearest( nullptr ), m_activeBlendState( nullptr ), m_currentBlendSrc( BlendFactor::One ), m_currentBlendDst( BlendFactor::Zero ), m_cullEnabled( true ), m_polyOffsetEnabled( false ), m_currentRTV( nullptr ), m_currentDSV( nullptr ), m_stagingTex( nullptr ), m_stagingWidth( 0 ), m_stagingHeight( 0 ), m_uploadBuffer( nullptr ), m_uploadMapped( nullptr ), m_uploadId( 0 ), m_uploadFresh( false ), m_uploadFences{}, m_uploadFencePending{}, m_frameFences{}, m_frameFencePending{}, m_frameSlot( 0 ), m_captureSlots{}, m_captureHead( 0 ), m_captureCount( 0 ), m_activeShader( nullptr )
 {
 }
 
@@ -219,6 +220,21 @@ bool RenderBackendDX11::Init( HWND hwnd, HDC /*hdc*/, int width, int height )
     // Create state objects
     CreateStateObjects();
 
+    // Streaming upload ring and its per-region fences
+    D3D11_QUERY_DESC qd = {};
+    qd.Query = D3D11_QUERY_EVENT;
+    for ( int i = 0; i < UploadRing::FRAME_REGIONS; ++i )
+    {
+        hr = m_device->CreateQuery( &qd, &m_uploadFences[i] );
+        ThrowIfFailed( hr, "CreateQuery (upload fence) failed" );
+    }
+    for ( int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i )
+    {
+        hr = m_device->CreateQuery( &qd, &m_frameFences[i] );
+        ThrowIfFailed( hr, "CreateQuery (frame fence) failed" );
+    }
+    CreateUploadBuffer( UploadRing::INITIAL_REGION_BYTES );
+
     // Apply initial state
     m_context->OMSetDepthStencilState( m_dsDepthOn, 0 );
     float blendFactor[4] = { 0, 0, 0, 0 };
@@ -250,10 +266,6 @@ void RenderBackendDX11::Shutdown()
         {
             dvb.inputLayout->Release();
         }
-        if ( dvb.vb )
-        {
-            dvb.vb->Release();
-        }
     }
     m_dynamicVBs.clear();
 
@@ -264,10 +276,6 @@ void RenderBackendDX11::Shutdown()
         {
             im.inputLayout->Release();
         }
-        if ( im.instanceVB )
-        {
-            im.instanceVB->Release();
-        }
         if ( im.staticVB )
         {
             im.staticVB->Release();
@@ -275,6 +283,37 @@ void RenderBackendDX11::Shutdown()
     }
     m_instancedMeshes.clear();
 
+    // Upload ring
+    UnmapUploadBuffers();
+    for ( auto& retired : m_retiredUploadBuffers )
+    {
+        retired.buffer->Release();
+    }
+    m_retiredUploadBuffers.clear();
+    if ( m_uploadBuffer )
+    {
+        m_uploadBuffer->Release();
+        m_uploadBuffer = nullptr;
+    }
+    for ( int i = 0; i < UploadRing::FRAME_REGIONS; ++i )
+    {
+        if ( m_uploadFences[i] )
+        {
+            m_uploadFences[i]->Release();
+            m_uploadFences[i] = nullptr;
+        }
+        m_uploadFencePending[i] = false;
+    }
+    for ( int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i )
+    {
+        if ( m_frameFences[i] )
+        {
+            m_frameFences[i]->Release();
+            m_frameFences[i] = nullptr;
+        }
+        m_frameFencePending[i] = false;
+    }
+
     // Destroy textures
     for ( auto& entry : m_textures )
     {
@@ -313,6 +352,18 @@ void RenderBackendDX11::Shutdown()
         m_stagingTex = nullptr;
     }
 
+    // Screenshot readbacks (any still in flight are dropped)
+    for ( CaptureSlotDX11& slot : m_captureSlots )
+    {
+        if ( slot.staging )
+        {
+            slot.staging->Release();
+        }
+        slot = {};
+    }
+    m_captureHead = 0;
+    m_captureCount = 0;
+
     // State objects
     if ( m_samplerNearest )
     {
@@ -385,7 +436,22 @@ void RenderBackendDX11::Shutdown()
 
 void RenderBackendDX11::Present()
 {
+    // Close this frame's upload region: the runtime keeps retired buffers alive while draws reference them
+    UnmapUploadBuffers();
+    for ( auto& retired : m_retiredUploadBuffers )
+    {
+        retired.buffer->Release();
+    }
+    m_retiredUploadBuffers.clear();
+    int region = m_uploadRing.GetRegion();
+    m_context->End( m_uploadFences[region] );
+    m_uploadFencePending[region] = true;
+    m_uploadRing.Advance();
+
     m_swapChain->Present( 1, 0 );
+    m_context->End( m_frameFences[m_frameSlot] );
+    m_frameFencePending[m_frameSlot] = true;
+    m_frameSlot = ( m_frameSlot + 1 ) % MAX_FRAMES_IN_FLIGHT;
 
     // FLIP_DISCARD unbinds the back buffer RTV from the output-merger after Present.
     // Rebind immediately so the next frame's draws have a valid render target.
@@ -395,6 +461,20 @@ void RenderBackendDX11::Present()
 }
 
 
+void RenderBackendDX11::WaitForFrameSlot()
+{
+    if ( !m_frameFencePending[m_frameSlot] )
+    {
+        return;
+    }
+    while ( m_context->GetData( m_frameFences[m_frameSlot], nullptr, 0, 0 ) == S_FALSE )
+    {
+        SwitchToThread();
+    }
+    m_frameFencePending[m_frameSlot] = false;
+}
+
+
 void RenderBackendDX11::Finish()
 {
     m_context->Flush();
@@ -629,9 +709,20 @@ std::unique_ptr<IShader> RenderBackendDX11::CreateShader( const char* vertPath,
 
 
 std::unique_ptr<IMesh> RenderBackendDX11::CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords )
+{
+    if ( hasNormals && !hasTexCoords )
+    {
+        throw std::runtime_error( "Normals without texcoords are not a supported mesh layout.  (RenderBackendDX11::CreateMesh)" );
+    }
+    VertexFormat format = hasNormals ? VertexFormat::Pos3_Norm3_Tex2 : ( hasTexCoords ? VertexFormat::Pos3_Tex2 : VertexFormat::Pos3 );
+    return CreateIndexedMesh( data, vertexCount, format, nullptr, 0, IndexFormat::None );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendDX11::CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat )
 {
     auto mesh = std::make_unique<MeshDX11>( m_device, m_context );
-    mesh->Create( data, vertexCount, hasNormals, hasTexCoords );
+    mesh->Create( vertices, vertexCount, format, indices, indexCount, indexFormat );
     return mesh;
 }
 
@@ -739,6 +830,66 @@ uint32_t RenderBackendDX11::CreateTexture2D( const uint8_t* data, int w, int h,
 }
 
 
+uint32_t RenderBackendDX11::CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter )
+{
+    if ( ( channels != 1 && channels != 4 ) || mipCount < 1 || mipCount > D3D11_REQ_MIP_LEVELS )
+    {
+        throw std::runtime_error( "CreateTexture2DMips: unsupported channel or mip count" );
+    }
+
+    D3D11_TEXTURE2D_DESC texDesc = {};
+    texDesc.Width = (UINT)w;
+    texDesc.Height = (UINT)h;
+    texDesc.MipLevels = (UINT)mipCount;
+    texDesc.ArraySize = 1;
+    texDesc.Format = ( channels == 1 ) ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    // Point each subresource straight at its packed level -- no staging copy
+    D3D11_SUBRESOURCE_DATA initData[D3D11_REQ_MIP_LEVELS] = {};
+    const uint8_t* level = data;
+    int lw = w;
+    int lh = h;
+    for ( int mip = 0; mip < mipCount; ++mip )
+    {
+        initData[mip].pSysMem = level;
+        initData[mip].SysMemPitch = (UINT)( lw * channels );
+        level += (size_t)lw * lh * channels;
+        lw = ( lw > 1 ) ? lw / 2 : 1;
+        lh = ( lh > 1 ) ? lh / 2 : 1;
+    }
+
+    ID3D11Texture2D* tex = nullptr;
+    HRESULT hr = m_device->CreateTexture2D( &texDesc, initData, &tex );
+    if ( FAILED( hr ) )
+    {
+        throw std::runtime_error( "CreateTexture2D (mips) failed" );
+    }
+
+    ID3D11ShaderResourceView* srv = nullptr;
+    hr = m_device->CreateShaderResourceView( tex, nullptr, &srv );
+    if ( FAILED( hr ) )
+    {
+        tex->Release();
+        throw std::runtime_error( "CreateSRV failed" );
+    }
+
+    ID3D11SamplerState* sampler = linearFilter ? m_samplerLinear : m_samplerNearest;
+    sampler->AddRef();
+
+    TextureEntryDX entry = {};
+    entry.srv = srv;
+    entry.tex = tex;
+    entry.sampler = sampler;
+    entry.owned = true;
+
+    m_textures.push_back( entry );
+    return (uint32_t)m_textures.size(); // 1-based handle
+}
+
+
 void RenderBackendDX11::BindTexture( uint32_t handle, int slot )
 {
     if ( handle == 0 || handle > (uint32_t)m_textures.size() )
@@ -871,6 +1022,83 @@ std::vector<uint8_t> RenderBackendDX11::CaptureBackbuffer( int& outWidth, int& o
 }
 
 
+bool RenderBackendDX11::RequestBackbufferCapture()
+{
+    if ( m_captureCount == CAPTURE_SLOTS )
+    {
+        return false;
+    }
+
+    ID3D11Texture2D* backBuffer = nullptr;
+    HRESULT hr = m_swapChain->GetBuffer( 0, __uuidof( ID3D11Texture2D ), (void**)&backBuffer );
+    ThrowIfFailed( hr, "GetBuffer failed (async capture)" );
+
+    // Slots are only reused once mapped and read, so a stale size can be replaced freely
+    CaptureSlotDX11& slot = m_captureSlots[( m_captureHead + m_captureCount ) % CAPTURE_SLOTS];
+    if ( !slot.staging || slot.width != m_width || slot.height != m_height )
+    {
+        if ( slot.staging )
+        {
+            slot.staging->Release();
+            slot.staging = nullptr;
+        }
+
+        D3D11_TEXTURE2D_DESC desc;
+        backBuffer->GetDesc( &desc );
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.BindFlags = 0;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.MiscFlags = 0;
+
+        hr = m_device->CreateTexture2D( &desc, nullptr, &slot.staging );
+        if ( FAILED( hr ) )
+        {
+            backBuffer->Release();
+            throw std::runtime_error( "CreateTexture2D (capture staging) failed" );
+        }
+        slot.width = m_width;
+        slot.height = m_height;
+    }
+
+    m_context->CopyResource( slot.staging, backBuffer );
+    backBuffer->Release();
+
+    ++m_captureCount;
+    return true;
+}
+
+
+bool RenderBackendDX11::PollBackbufferCapture( CapturedImage& out, bool wait )
+{
+    if ( m_captureCount == 0 )
+    {
+        return false;
+    }
+
+    CaptureSlotDX11& slot = m_captureSlots[m_captureHead];
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = m_context->Map( slot.staging, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped );
+    if ( hr == DXGI_ERROR_WAS_STILL_DRAWING )
+    {
+        return false;
+    }
+    ThrowIfFailed( hr, "Map capture staging texture failed" );
+
+    // Raw RGBA rows, top-down; the image writer converts off the render thread
+    const uint8_t* src = (const uint8_t*)mapped.pData;
+    out.pixels.assign( src, src + (size_t)mapped.RowPitch * slot.height );
+    out.width = slot.width;
+    out.height = slot.height;
+    out.rowPitch = (int)mapped.RowPitch;
+    out.isBottomUp = false;
+    m_context->Unmap( slot.staging, 0 );
+
+    m_captureHead = ( m_captureHead + 1 ) % CAPTURE_SLOTS;
+    --m_captureCount;
+    return true;
+}
+
+
 int RenderBackendDX11::GetWidth() const
 {
     return m_width;
@@ -901,13 +1129,120 @@ bool RenderBackendDX11::UsesZeroToOneDepth() const
 }
 
 
+// --- Upload Ring ---
+
+
+void RenderBackendDX11::CreateUploadBuffer( uint32_t regionBytes )
+{
+    m_uploadRing.Reset( regionBytes );
+
+    D3D11_BUFFER_DESC bd = {};
+    bd.ByteWidth = (UINT)m_uploadRing.GetBufferBytes();
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    HRESULT hr = m_device->CreateBuffer( &bd, nullptr, &m_uploadBuffer );
+    ThrowIfFailed( hr, "CreateBuffer (upload ring) failed" );
+
+    m_uploadMapped = nullptr;
+    m_uploadFresh = true;
+    ++m_uploadId;
+}
+
+
+UploadSpan RenderBackendDX11::AllocateUpload( int floatCount )
+{
+    UploadSpan span = {};
+    if ( floatCount <= 0 || !m_uploadBuffer )
+    {
+        return span;
+    }
+    UINT bytes = (UINT)floatCount * (UINT)sizeof( float );
+
+    // First allocation from this region since it was fenced: the GPU must be done with it
+    int region = m_uploadRing.GetRegion();
+    if ( m_uploadFencePending[region] )
+    {
+        PROFILE_SCOPED( "Render/UploadRingWait" );
+        while ( m_context->GetData( m_uploadFences[region], nullptr, 0, 0 ) == S_FALSE )
+        {
+            SwitchToThread();
+        }
+        m_uploadFencePending[region] = false;
+    }
+
+    uint32_t offset = 0;
+    if ( !m_uploadRing.Allocate( bytes, offset ) )
+    {
+        // Frame outgrew its region: double the ring. Spans already handed out keep pointing into the old
+        // buffer's mapping, so it stays mapped until the next draw and alive until Present.
+        m_retiredUploadBuffers.push_back( { m_uploadBuffer, m_uploadId, m_uploadMapped != nullptr } );
+        CreateUploadBuffer( m_uploadRing.GetGrownRegionBytes( bytes ) );
+        PROFILE_COUNTER_ADD( "Render/UploadRingGrowths", 1 );
+        m_uploadRing.Allocate( bytes, offset );
+    }
+
+    if ( !m_uploadMapped )
+    {
+        // NO_OVERWRITE: we promise not to touch bytes an in-flight draw reads, so the map never stalls
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        HRESULT hr = m_context->Map( m_uploadBuffer, 0, m_uploadFresh ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped );
+        if ( FAILED( hr ) )
+        {
+            return span;
+        }
+        m_uploadMapped = (uint8_t*)mapped.pData;
+        m_uploadFresh = false;
+    }
+
+    span.data = (float*)( m_uploadMapped + offset );
+    span.buffer = m_uploadId;
+    span.offset = offset;
+    return span;
+}
+
+
+void RenderBackendDX11::UnmapUploadBuffers()
+{
+    for ( auto& retired : m_retiredUploadBuffers )
+    {
+        if ( retired.mapped )
+        {
+            m_context->Unmap( retired.buffer, 0 );
+            retired.mapped = false;
+        }
+    }
+    if ( m_uploadMapped )
+    {
+        m_context->Unmap( m_uploadBuffer, 0 );
+        m_uploadMapped = nullptr;
+    }
+}
+
+
+ID3D11Buffer* RenderBackendDX11::GetUploadBuffer( uint32_t id ) const
+{
+    if ( id == m_uploadId )
+    {
+        return m_uploadBuffer;
+    }
+    for ( const auto& retired : m_retiredUploadBuffers )
+    {
+        if ( retired.id == id )
+        {
+            return retired.buffer;
+        }
+    }
+    return nullptr;
+}
+
+
 // --- Dynamic Vertex Buffer ---
 
 
-uint32_t RenderBackendDX11::CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices )
+uint32_t RenderBackendDX11::CreateDynamicVB( const int* attribComponents, int numAttribs )
 {
     DynamicVBDX dvb = {};
-    dvb.maxVertices = maxVertices;
     dvb.numAttribs = numAttribs;
     dvb.lastVSBytecode = nullptr;
 
@@ -920,26 +1255,23 @@ uint32_t RenderBackendDX11::CreateDynamicVB( const int* attribComponents, int nu
     dvb.floatsPerVertex = floatsPerVert;
     dvb.stride = floatsPerVert * (int)sizeof( float );
 
-    D3D11_BUFFER_DESC bd = {};
-    bd.ByteWidth = (UINT)( maxVertices * dvb.stride );
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    HRESULT hr = m_device->CreateBuffer( &bd, nullptr, &dvb.vb );
-    ThrowIfFailed( hr, "CreateBuffer (dynamic VB) failed" );
-
     m_dynamicVBs.push_back( dvb );
     return (uint32_t)m_dynamicVBs.size();
 }
 
 
-void RenderBackendDX11::UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount )
+void RenderBackendDX11::DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount )
 {
-    if ( handle == 0 || handle > (uint32_t)m_dynamicVBs.size() )
+    if ( handle == 0 || handle > (uint32_t)m_dynamicVBs.size() || vertexCount <= 0 )
     {
         return;
     }
     DynamicVBDX& dvb = m_dynamicVBs[handle - 1];
+    ID3D11Buffer* vb = GetUploadBuffer( vertices.buffer );
+    if ( !vb )
+    {
+        return;
+    }
 
     // Flush active ShaderGL CB
     if ( m_activeShader )
@@ -993,17 +1325,12 @@ void RenderBackendDX11::UploadAndDrawDynamicVB( uint32_t handle, const float* da
         dvb.lastVSBytecode = m_activeShader->GetVSBytecode();
     }
 
-    // Upload data
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    m_context->Map( dvb.vb, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped );
-    memcpy( mapped.pData, data, (size_t)vertexCount * dvb.floatsPerVertex * sizeof( float ) );
-    m_context->Unmap( dvb.vb, 0 );
-
-    // Draw
+    // Draw straight from the ring span
+    UnmapUploadBuffers();
     m_context->IASetInputLayout( dvb.inputLayout );
     UINT stride = (UINT)dvb.stride;
-    UINT vbOffset = 0;
-    m_context->IASetVertexBuffers( 0, 1, &dvb.vb, &stride, &vbOffset );
+    UINT vbOffset = (UINT)vertices.offset;
+    m_context->IASetVertexBuffers( 0, 1, &vb, &stride, &vbOffset );
     m_context->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
     m_context->Draw( (UINT)vertexCount, 0 );
 }
@@ -1021,18 +1348,13 @@ void RenderBackendDX11::DestroyDynamicVB( uint32_t handle )
         dvb.inputLayout->Release();
         dvb.inputLayout = nullptr;
     }
-    if ( dvb.vb )
-    {
-        dvb.vb->Release();
-        dvb.vb = nullptr;
-    }
 }
 
 
 // --- Instanced mesh ---
 
 
-uint32_t RenderBackendDX11::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs )
+uint32_t RenderBackendDX11::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs, const uint16_t* indices, int indexCount )
 {
     InstancedMeshDX im = {};
     im.staticFloatsPerVert = staticFloatsPerVert;
@@ -1062,40 +1384,36 @@ uint32_t RenderBackendDX11::CreateInstancedMesh( const float* staticData, int st
     HRESULT hr = m_device->CreateBuffer( &bd, &initData, &im.staticVB );
     ThrowIfFailed( hr, "CreateBuffer (static VB, instanced) failed" );
 
-    // Instance VB
-    bd.ByteWidth = (UINT)( maxInstances * im.instanceStride );
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    hr = m_device->CreateBuffer( &bd, nullptr, &im.instanceVB );
-    ThrowIfFailed( hr, "CreateBuffer (instance VB) failed" );
+    // Optional static IB
+    if ( indices && indexCount > 0 )
+    {
+        D3D11_BUFFER_DESC ibd = {};
+        ibd.ByteWidth = (UINT)( indexCount * sizeof( uint16_t ) );
+        ibd.Usage = D3D11_USAGE_IMMUTABLE;
+        ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA indexData = {};
+        indexData.pSysMem = indices;
+        hr = m_device->CreateBuffer( &ibd, &indexData, &im.staticIB );
+        ThrowIfFailed( hr, "CreateBuffer (static IB, instanced) failed" );
+    }
 
     m_instancedMeshes.push_back( im );
     return (uint32_t)m_instancedMeshes.size();
 }
 
 
-void RenderBackendDX11::UploadInstanceData( uint32_t handle, const float* data, int floatCount )
+void RenderBackendDX11::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances )
 {
-    if ( handle == 0 || handle > (uint32_t)m_instancedMeshes.size() )
+    if ( handle == 0 || handle > (uint32_t)m_instancedMeshes.size() || instanceCount <= 0 )
     {
         return;
     }
     InstancedMeshDX& im = m_instancedMeshes[handle - 1];
-
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    m_context->Map( im.instanceVB, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped );
-    memcpy( mapped.pData, data, (size_t)floatCount * sizeof( float ) );
-    m_context->Unmap( im.instanceVB, 0 );
-}
-
-
-void RenderBackendDX11::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount )
-{
-    if ( handle == 0 || handle > (uint32_t)m_instancedMeshes.size() )
+    ID3D11Buffer* instanceVB = GetUploadBuffer( instances.buffer );
+    if ( !instanceVB )
     {
         return;
     }
-    InstancedMeshDX& im = m_instancedMeshes[handle - 1];
 
     // Flush active ShaderGL CB
     if ( m_activeShader )
@@ -1196,14 +1514,23 @@ void RenderBackendDX11::DrawInstancedMesh( uint32_t handle, int staticVertCount,
         im.lastVSBytecode = m_activeShader->GetVSBytecode();
     }
 
-    // Bind both VBs
-    ID3D11Buffer* vbs[2] = { im.staticVB, im.instanceVB };
+    // Bind both VBs: static geometry, and the instances' ring span
+    UnmapUploadBuffers();
+    ID3D11Buffer* vbs[2] = { im.staticVB, instanceVB };
     UINT strides[2] = { (UINT)im.staticStride, (UINT)im.instanceStride };
-    UINT offsets[2] = { 0, 0 };
+    UINT offsets[2] = { 0, (UINT)instances.offset };
     m_context->IASetInputLayout( im.inputLayout );
     m_context->IASetVertexBuffers( 0, 2, vbs, strides, offsets );
     m_context->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-    m_context->DrawInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0 );
+    if ( im.staticIB )
+    {
+        m_context->IASetIndexBuffer( im.staticIB, DXGI_FORMAT_R16_UINT, 0 );
+        m_context->DrawIndexedInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0, 0 ); // staticVertCount counts indices
+    }
+    else
+    {
+        m_context->DrawInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0 );
+    }
 }
 
 
@@ -1219,14 +1546,14 @@ void RenderBackendDX11::DestroyInstancedMesh( uint32_t handle )
         im.inputLayout->Release();
         im.inputLayout = nullptr;
     }
-    if ( im.instanceVB )
-    {
-        im.instanceVB->Release();
-        im.instanceVB = nullptr;
-    }
     if ( im.staticVB )
     {
         im.staticVB->Release();
         im.staticVB = nullptr;
     }
+    if ( im.staticIB )
+    {
+        im.staticIB->Release();
+        im.staticIB = nullptr;
+    }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 // --- Includes ---
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezUploadRing.h"
 #include <d3d11.h>
 #include <dxgi1_2.h>
 #include <vector>
@@ -27,13 +28,11 @@ struct TextureEntryDX
 };
 
 
-// Dynamic vertex buffer for per-frame geometry (text, HUD)
+// Dynamic vertex buffer for per-frame geometry (text, HUD); vertices live in the upload ring
 struct DynamicVBDX
 {
-    ID3D11Buffer* vb;
     ID3D11InputLayout* inputLayout;
     int floatsPerVertex;
-    int maxVertices;
     int stride;
     const void* lastVSBytecode;
     int numAttribs;
@@ -41,11 +40,11 @@ struct DynamicVBDX
 };
 
 
-// Instanced mesh (shadow decals)
+// Instanced mesh (shadow decals); instance data lives in the upload ring
 struct InstancedMeshDX
 {
     ID3D11Buffer* staticVB;
-    ID3D11Buffer* instanceVB;
+    ID3D11Buffer* staticIB; // 16-bit indices; nullptr when the static geometry is a plain triangle list
     ID3D11InputLayout* inputLayout;
     int staticFloatsPerVert;
     int staticStride;
@@ -60,6 +59,24 @@ struct InstancedMeshDX
 };
 
 
+// Upload ring buffer replaced by a larger one mid-frame; released at Present once its spans are consumed
+struct RetiredUploadDX
+{
+    ID3D11Buffer* buffer;
+    uint32_t id;
+    bool mapped;
+};
+
+
+// Staging texture a backbuffer readback is copied into; mapped with DO_NOT_WAIT until the copy has landed
+struct CaptureSlotDX11
+{
+    ID3D11Texture2D* staging;
+    int width;
+    int height;
+};
+
+
 /* -- RenderBackendDX11 -------------------------------------------------------------------------------------------------------------------------------------------
 
     DirectX 11 implementation of the render backend interface.
@@ -138,11 +155,35 @@ class RenderBackendDX11 : public IRenderBackend
     std::vector<DynamicVBDX> m_dynamicVBs;
     std::vector<InstancedMeshDX> m_instancedMeshes;
 
+    // Streaming upload ring (instance data, dynamic vertices). D3D11 has no persistent mapping, so the buffer
+    // is mapped NO_OVERWRITE on the first allocation after a draw and unmapped before the next draw.
+    UploadRing m_uploadRing;
+    ID3D11Buffer* m_uploadBuffer;
+    uint8_t* m_uploadMapped;                                // Open mapping of m_uploadBuffer, or nullptr
+    uint32_t m_uploadId;                                    // UploadSpan::buffer id of m_uploadBuffer
+    bool m_uploadFresh;                                     // Never mapped: first map must DISCARD
+    ID3D11Query* m_uploadFences[UploadRing::FRAME_REGIONS]; // Event queries issued at Present per region
+    bool m_uploadFencePending[UploadRing::FRAME_REGIONS];
+    std::vector<RetiredUploadDX> m_retiredUploadBuffers;
+
+    // Frames in flight: event query issued at each Present, waited on before the slot's next frame is recorded
+    ID3D11Query* m_frameFences[MAX_FRAMES_IN_FLIGHT];
+    bool m_frameFencePending[MAX_FRAMES_IN_FLIGHT];
+    int m_frameSlot;
+
+    // Asynchronous screenshots: FIFO of readbacks, oldest at m_captureHead
+    CaptureSlotDX11 m_captureSlots[CAPTURE_SLOTS];
+    int m_captureHead;
+    int m_captureCount;
+
     // Active ShaderGL
     ShaderDX11* m_activeShader;
 
     void CreateStateObjects();
     void ApplyRasterizerState();
+    void CreateUploadBuffer( uint32_t regionBytes );
+    void UnmapUploadBuffers(); // Close open mappings before the GPU reads them
+    ID3D11Buffer* GetUploadBuffer( uint32_t id ) const;
 
   public:
     RenderBackendDX11();
@@ -159,6 +200,7 @@ class RenderBackendDX11 : public IRenderBackend
     bool Init( HWND hwnd, HDC hdc, int width, int height ) override;
     void Shutdown() override;
     void Present() override;
+    void WaitForFrameSlot() override;
     void Finish() override;
     void FlushGPU() override;
     void Resize( int width, int height ) override;
@@ -177,13 +219,17 @@ class RenderBackendDX11 : public IRenderBackend
 
     std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) override;
     std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) override;
+    std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) override;
     std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) override;
 
     uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) override;
+    uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) override;
     void BindTexture( uint32_t handle, int slot ) override;
     void DeleteTexture( uint32_t handle ) override;
 
     std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) override;
+    bool RequestBackbufferCapture() override;
+    bool PollBackbufferCapture( CapturedImage& out, bool wait ) override;
 
     int GetWidth() const override;
     int GetHeight() const override;
@@ -196,13 +242,14 @@ class RenderBackendDX11 : public IRenderBackend
         return "DirectX 11";
     }
 
-    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices ) override;
-    void UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount ) override;
+    UploadSpan AllocateUpload( int floatCount ) override;
+
+    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) override;
+    void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) override;
     void DestroyDynamicVB( uint32_t handle ) override;
 
-    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0 ) override;
-    void UploadInstanceData( uint32_t handle, const float* data, int floatCount ) override;
-    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount ) override;
+    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) override;
+    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) override;
     void DestroyInstancedMesh( uint32_t handle ) override;
 
     // DX-specific helpers
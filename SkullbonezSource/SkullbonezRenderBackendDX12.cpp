@@ -3,6 +3,7 @@
 #include "SkullbonezShaderDX12.h"
 #include "SkullbonezMeshDX12.h"
 #include "SkullbonezFramebufferDX12.h"
+#include "SkullbonezProfiler.h"
 #include <stdexcept>
 #include <cstdio>
 #include <cstring>
@@ -35,7 +36,7 @@ RenderBackendDX12::RenderBackendDX12()
       ,
       m_nextDSV( 1 ) // 0 reserved for main depth
       ,
-      m_nextStaticSRV( 0 ), m_nextTransientSRV( 0 ), m_depthStencil( nullptr ), m_uploadBuffer( nullptr ), m_uploadBufferMapped( nullptr ), m_uploadOffset( 0 ), m_rootSignature( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_blendSrc( BlendFactor::One ), m_blendDst( BlendFactor::Zero ), m_cullEnabled( true ), m_polyOffsetEnabled( false ), m_polyOffsetFactor( 0.0f ), m_polyOffsetUnits( 0.0f ), m_clearDepth( 1.0f ), m_psoDirty( true ), m_activeShader( nullptr ), m_renderingToFBO( false ), m_backBufferIsRT( false ), m_lastPSOHash( 0 ), m_texBindingsDirty( true ), m_targetsDirty( true )
+      m_nextStaticSRV( 0 ), m_nextTransientSRV( 0 ), m_depthStencil( nullptr ), m_uploadBuffer( nullptr ), m_uploadBufferMapped( nullptr ), m_uploadOffset( 0 ), m_uploadEpoch( 0 ), m_streamBuffer( nullptr ), m_streamMapped( nullptr ), m_streamId( 0 ), m_streamFenceValues{}, m_rootSignature( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_blendSrc( BlendFactor::One ), m_blendDst( BlendFactor::Zero ), m_cullEnabled( true ), m_polyOffsetEnabled( false ), m_polyOffsetFactor( 0.0f ), m_polyOffsetUnits( 0.0f ), m_clearDepth( 1.0f ), m_psoDirty( true ), m_activeShader( nullptr ), m_renderingToFBO( false ), m_backBufferIsRT( false ), m_lastPSOHash( 0 ), m_texBindingsDirty( true ), m_targetsDirty( true )
 {
     m_clearColor[0] = 0.0f;
     m_clearColor[1] = 0.0f;
@@ -51,6 +52,12 @@ RenderBackendDX12::RenderBackendDX12()
     m_boundTexSlot[1] = UINT_MAX;
     m_currentRTV = {};
     m_currentDSV = {};
+    m_captureHead = 0;
+    m_captureCount = 0;
+    for ( CaptureSlotDX12& slot : m_captureSlots )
+    {
+        slot = {};
+    }
 }
 
 
@@ -96,6 +103,7 @@ void RenderBackendDX12::EnsureCommandListOpen()
     m_commandList->SetGraphicsRootSignature( m_rootSignature );
     m_commandListOpen = true;
     m_uploadOffset = 0;
+    ++m_uploadEpoch;
     m_nextTransientSRV = MAX_STATIC_SRVS;
 
     // All command list state is reset — force full rebind on next draw
@@ -142,6 +150,7 @@ void RenderBackendDX12::FlushUploadBuffer()
     m_commandList->SetGraphicsRootSignature( m_rootSignature );
     m_commandListOpen = true;
     m_uploadOffset = 0;
+    ++m_uploadEpoch;
     m_nextTransientSRV = MAX_STATIC_SRVS;
     m_lastPSOHash = 0;
     m_texBindingsDirty = true;
@@ -178,6 +187,25 @@ uint8_t* RenderBackendDX12::GetUploadPtr( D3D12_GPU_VIRTUAL_ADDRESS addr )
 }
 
 
+void RenderBackendDX12::UploadBufferRegion( ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 size, D3D12_RESOURCE_STATES restingState )
+{
+    if ( size == 0 )
+    {
+        return;
+    }
+
+    // Recorded into the current command list, so draws already recorded this frame still see the old contents
+    EnsureCommandListOpen();
+    FlushUploadBufferIfNeeded( size, 4 );
+    D3D12_GPU_VIRTUAL_ADDRESS uploadAddr = SubAllocateUpload( size, 4 );
+    memcpy( GetUploadPtr( uploadAddr ), data, (size_t)size );
+
+    TransitionBarrier( dest, restingState, D3D12_RESOURCE_STATE_COPY_DEST );
+    m_commandList->CopyBufferRegion( dest, destOffset, m_uploadBuffer, uploadAddr - m_uploadBuffer->GetGPUVirtualAddress(), size );
+    TransitionBarrier( dest, D3D12_RESOURCE_STATE_COPY_DEST, restingState );
+}
+
+
 UINT RenderBackendDX12::AllocateStaticSRV()
 {
     if ( m_nextStaticSRV >= MAX_STATIC_SRVS )
@@ -379,6 +407,9 @@ bool RenderBackendDX12::Init( HWND hwnd, HDC /*hdc*/, int width, int height )
         m_uploadBuffer->Map( 0, nullptr, (void**)&m_uploadBufferMapped );
     }
 
+    // Stream ring
+    CreateStreamBuffer( UploadRing::INITIAL_REGION_BYTES );
+
     // Root signature
     CreateRootSignature();
 
@@ -589,6 +620,28 @@ void RenderBackendDX12::Shutdown()
         m_uploadBuffer->Unmap( 0, nullptr );
         m_uploadBuffer->Release();
     }
+    for ( auto& retired : m_retiredStreamBuffers )
+    {
+        retired.buffer->Unmap( 0, nullptr );
+        retired.buffer->Release();
+    }
+    m_retiredStreamBuffers.clear();
+    if ( m_streamBuffer )
+    {
+        m_streamBuffer->Unmap( 0, nullptr );
+        m_streamBuffer->Release();
+        m_streamBuffer = nullptr;
+    }
+    for ( CaptureSlotDX12& slot : m_captureSlots )
+    {
+        if ( slot.readback )
+        {
+            slot.readback->Release();
+        }
+        slot = {};
+    }
+    m_captureHead = 0;
+    m_captureCount = 0;
     if ( m_depthStencil )
     {
         m_depthStencil->Release();
@@ -681,6 +734,38 @@ void RenderBackendDX12::Present()
     m_frameFenceValues[m_allocatorIndex] = ++m_fenceValue;
     m_commandQueue->Signal( m_fence, m_fenceValue );
 
+    // The same signal guards this frame's stream region, any stream buffers it retired and its screenshot copies
+    for ( int i = 0; i < m_captureCount; ++i )
+    {
+        CaptureSlotDX12& slot = m_captureSlots[( m_captureHead + i ) % CAPTURE_SLOTS];
+        if ( slot.fenceValue == 0 )
+        {
+            slot.fenceValue = m_fenceValue;
+        }
+    }
+    m_streamFenceValues[m_streamRing.GetRegion()] = m_fenceValue;
+    m_streamRing.Advance();
+    UINT64 completed = m_fence->GetCompletedValue();
+    for ( size_t i = 0; i < m_retiredStreamBuffers.size(); )
+    {
+        RetiredStreamDX12& retired = m_retiredStreamBuffers[i];
+        if ( retired.fenceValue == 0 )
+        {
+            retired.fenceValue = m_fenceValue;
+        }
+        if ( retired.fenceValue <= completed )
+        {
+            retired.buffer->Unmap( 0, nullptr );
+            retired.buffer->Release();
+            retired = m_retiredStreamBuffers.back();
+            m_retiredStreamBuffers.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
     // Advance to next frame's allocator and swap chain buffer
     m_allocatorIndex = ( m_allocatorIndex + 1 ) % FRAME_COUNT;
     m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
@@ -688,6 +773,23 @@ void RenderBackendDX12::Present()
 }
 
 
+void RenderBackendDX12::WaitForFrameSlot()
+{
+    // The next command allocator is the frame slot; waiting here rather than in EnsureCommandListOpen keeps
+    // the stall out of whichever draw happens to open the list
+    if ( m_commandListOpen )
+    {
+        return;
+    }
+    UINT64 slotFence = m_frameFenceValues[m_allocatorIndex];
+    if ( slotFence > m_fence->GetCompletedValue() )
+    {
+        m_fence->SetEventOnCompletion( slotFence, m_fenceEvent );
+        WaitForSingleObject( m_fenceEvent, INFINITE );
+    }
+}
+
+
 void RenderBackendDX12::Finish()
 {
     if ( m_commandListOpen )
@@ -905,35 +1007,46 @@ size_t RenderBackendDX12::HashPSOKey( const PSOKey12& key )
 }
 
 
-void RenderBackendDX12::BuildInputLayout( VertexFormat12 format, D3D12_INPUT_ELEMENT_DESC* out, UINT& count )
+void RenderBackendDX12::BuildInputLayout( VertexFormat format, D3D12_INPUT_ELEMENT_DESC* out, UINT& count )
 {
     count = 0;
     switch ( format )
     {
-    case VertexFormat12::Pos3:
+    case VertexFormat::Pos3:
         out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         count = 1;
         break;
-    case VertexFormat12::Pos3_Tex2:
+    case VertexFormat::Pos3_Tex2:
         out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         out[1] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         count = 2;
         break;
-    case VertexFormat12::Pos3_Norm3_Tex2:
+    case VertexFormat::Pos3_Norm3_Tex2:
         out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         out[1] = { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         out[2] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         count = 3;
         break;
-    case VertexFormat12::Pos2_Tex2:
+    case VertexFormat::Pos2_Tex2:
         out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         out[1] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         count = 2;
         break;
-    case VertexFormat12::Pos2:
+    case VertexFormat::Pos2:
         out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
         count = 1;
         break;
+    case VertexFormat::Pos3_PackedNorm_HalfTex:
+        out[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        out[1] = { "NORMAL", 0, DXGI_FORMAT_R10G10B10A2_UNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        out[2] = { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        count = 3;
+        break;
+    case VertexFormat::HalfPos_UNormTex:
+        out[0] = { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        out[1] = { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        count = 2;
+        break;
     }
 }
 
@@ -1046,7 +1159,7 @@ void RenderBackendDX12::BuildDynamicVBInputLayout( const DynamicVBDX12& dvb, D3D
 }
 
 
-ID3D12PipelineState* RenderBackendDX12::CreatePSO( VertexFormat12 format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb )
+ID3D12PipelineState* RenderBackendDX12::CreatePSO( VertexFormat format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb )
 {
     D3D12_INPUT_ELEMENT_DESC elements[16] = {};
     UINT numElements = 0;
@@ -1116,7 +1229,7 @@ ID3D12PipelineState* RenderBackendDX12::CreatePSO( VertexFormat12 format, bool i
 }
 
 
-void RenderBackendDX12::PrepareDraw( VertexFormat12 format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb )
+void RenderBackendDX12::PrepareDraw( VertexFormat format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb )
 {
     EnsureCommandListOpen();
 
@@ -1298,32 +1411,25 @@ std::unique_ptr<IShader> RenderBackendDX12::CreateShader( const char* vertPath,
 
 std::unique_ptr<IMesh> RenderBackendDX12::CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords )
 {
-    VertexFormat12 format;
-    int floatsPerVert;
-    if ( hasNormals && hasTexCoords )
+    if ( hasNormals && !hasTexCoords )
     {
-        format = VertexFormat12::Pos3_Norm3_Tex2;
-        floatsPerVert = 8;
-    }
-    else if ( hasTexCoords )
-    {
-        format = VertexFormat12::Pos3_Tex2;
-        floatsPerVert = 5;
-    }
-    else
-    {
-        format = VertexFormat12::Pos3;
-        floatsPerVert = 3;
+        throw std::runtime_error( "Normals without texcoords are not a supported mesh layout.  (RenderBackendDX12::CreateMesh)" );
     }
+    VertexFormat format = hasNormals ? VertexFormat::Pos3_Norm3_Tex2 : ( hasTexCoords ? VertexFormat::Pos3_Tex2 : VertexFormat::Pos3 );
+    return CreateIndexedMesh( data, vertexCount, format, nullptr, 0, IndexFormat::None );
+}
+
 
+std::unique_ptr<IMesh> RenderBackendDX12::CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat )
+{
     EnsureCommandListOpen();
-    UINT64 dataSize = (UINT64)vertexCount * floatsPerVert * sizeof( float );
+    UINT64 dataSize = MeshDX12::GetUploadSize( vertexCount, format, indexCount, indexFormat );
     FlushUploadBufferIfNeeded( dataSize, 4 );
     D3D12_GPU_VIRTUAL_ADDRESS uploadAddr = SubAllocateUpload( dataSize, 4 );
     uint8_t* uploadPtr = GetUploadPtr( uploadAddr );
 
     auto mesh = std::make_unique<MeshDX12>();
-    mesh->Create( m_device, m_commandList, data, vertexCount, floatsPerVert, format, uploadAddr, uploadPtr );
+    mesh->Create( m_device, m_commandList, vertices, vertexCount, format, indices, indexCount, indexFormat, uploadAddr, uploadPtr );
     return mesh;
 }
 
@@ -1441,6 +1547,88 @@ uint32_t RenderBackendDX12::CreateTexture2D( const uint8_t* data, int w, int h,
 }
 
 
+uint32_t RenderBackendDX12::CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool /*linearFilter*/ )
+{
+    if ( ( channels != 1 && channels != 4 ) || mipCount < 1 || mipCount > D3D12_REQ_MIP_LEVELS )
+    {
+        throw std::runtime_error( "CreateTexture2DMips: unsupported channel or mip count" );
+    }
+
+    EnsureCommandListOpen();
+
+    D3D12_HEAP_PROPERTIES defaultHeap = {};
+    defaultHeap.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    DXGI_FORMAT fmt = ( channels == 1 ) ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    D3D12_RESOURCE_DESC texDesc = {};
+    texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    texDesc.Width = (UINT64)w;
+    texDesc.Height = (UINT)h;
+    texDesc.DepthOrArraySize = 1;
+    texDesc.MipLevels = (UINT16)mipCount;
+    texDesc.Format = fmt;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    ID3D12Resource* texResource = nullptr;
+    m_device->CreateCommittedResource( &defaultHeap, D3D12_HEAP_FLAG_NONE, &texDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS( &texResource ) );
+
+    // One footprint per level, all placed in a single upload sub-allocation
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprints[D3D12_REQ_MIP_LEVELS] = {};
+    UINT numRows[D3D12_REQ_MIP_LEVELS] = {};
+    UINT64 rowSizeBytes[D3D12_REQ_MIP_LEVELS] = {};
+    UINT64 totalBytes = 0;
+    m_device->GetCopyableFootprints( &texDesc, 0, (UINT)mipCount, 0, footprints, numRows, rowSizeBytes, &totalBytes );
+
+    FlushUploadBufferIfNeeded( totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT );
+    D3D12_GPU_VIRTUAL_ADDRESS uploadAddr = SubAllocateUpload( totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT );
+    uint8_t* uploadDst = GetUploadPtr( uploadAddr );
+    UINT64 uploadBase = uploadAddr - m_uploadBuffer->GetGPUVirtualAddress();
+
+    const uint8_t* level = data;
+    for ( int mip = 0; mip < mipCount; ++mip )
+    {
+        // Packed source rows are tight; destination rows follow the 256-byte pitch
+        UINT srcRowPitch = footprints[mip].Footprint.Width * (UINT)channels;
+        for ( UINT row = 0; row < numRows[mip]; ++row )
+        {
+            memcpy( uploadDst + footprints[mip].Offset + row * footprints[mip].Footprint.RowPitch, level + row * srcRowPitch, srcRowPitch );
+        }
+        level += (size_t)srcRowPitch * footprints[mip].Footprint.Height;
+
+        D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+        dstLoc.pResource = texResource;
+        dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dstLoc.SubresourceIndex = (UINT)mip;
+
+        D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+        srcLoc.pResource = m_uploadBuffer;
+        srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        srcLoc.PlacedFootprint = footprints[mip];
+        srcLoc.PlacedFootprint.Offset = uploadBase + footprints[mip].Offset;
+
+        m_commandList->CopyTextureRegion( &dstLoc, 0, 0, 0, &srcLoc, nullptr );
+    }
+    TransitionBarrier( texResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE );
+
+    UINT srvIdx = AllocateStaticSRV();
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = fmt;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = (UINT)mipCount;
+    m_device->CreateShaderResourceView( texResource, &srvDesc, GetSRVStagingCpuHandle( srvIdx ) );
+
+    TextureEntryDX12 entry = {};
+    entry.resource = texResource;
+    entry.srvIndex = srvIdx;
+    entry.owned = true;
+    m_textures.push_back( entry );
+    return (uint32_t)m_textures.size(); // 1-based handle
+}
+
+
 void RenderBackendDX12::BindTexture( uint32_t handle, int slot )
 {
     if ( slot < 0 || slot > 1 )
@@ -1593,14 +1781,204 @@ std::vector<uint8_t> RenderBackendDX12::CaptureBackbuffer( int& outWidth, int& o
 }
 
 
+bool RenderBackendDX12::RequestBackbufferCapture()
+{
+    if ( m_captureCount == CAPTURE_SLOTS )
+    {
+        return false;
+    }
+    EnsureCommandListOpen();
+
+    D3D12_RESOURCE_DESC bbDesc = m_renderTargets[m_frameIndex]->GetDesc();
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    UINT numRows = 0;
+    UINT64 rowSizeBytes = 0;
+    UINT64 totalBytes = 0;
+    m_device->GetCopyableFootprints( &bbDesc, 0, 1, 0, &footprint, &numRows, &rowSizeBytes, &totalBytes );
+
+    // Slots are only reused once mapped and read, so an undersized buffer can be replaced freely
+    CaptureSlotDX12& slot = m_captureSlots[( m_captureHead + m_captureCount ) % CAPTURE_SLOTS];
+    if ( !slot.readback || slot.bytes < totalBytes )
+    {
+        if ( slot.readback )
+        {
+            slot.readback->Release();
+            slot.readback = nullptr;
+        }
+
+        D3D12_HEAP_PROPERTIES readbackHeap = {};
+        readbackHeap.Type = D3D12_HEAP_TYPE_READBACK;
+        D3D12_RESOURCE_DESC readbackDesc = {};
+        readbackDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        readbackDesc.Width = totalBytes;
+        readbackDesc.Height = 1;
+        readbackDesc.DepthOrArraySize = 1;
+        readbackDesc.MipLevels = 1;
+        readbackDesc.SampleDesc.Count = 1;
+        readbackDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        ThrowIfFailed( m_device->CreateCommittedResource( &readbackHeap, D3D12_HEAP_FLAG_NONE, &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS( &slot.readback ) ), "CreateCommittedResource (capture readback) failed" );
+        slot.bytes = totalBytes;
+    }
+    slot.fenceValue = 0;
+    slot.rowPitch = footprint.Footprint.RowPitch;
+    slot.width = m_width;
+    slot.height = m_height;
+
+    // Recorded into this frame's command list; Present() stamps the slot with the frame's fence value
+    TransitionBarrier( m_renderTargets[m_frameIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE );
+
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = slot.readback;
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dstLoc.PlacedFootprint = footprint;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = m_renderTargets[m_frameIndex];
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+
+    m_commandList->CopyTextureRegion( &dstLoc, 0, 0, 0, &srcLoc, nullptr );
+    TransitionBarrier( m_renderTargets[m_frameIndex], D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET );
+
+    ++m_captureCount;
+    return true;
+}
+
+
+bool RenderBackendDX12::PollBackbufferCapture( CapturedImage& out, bool wait )
+{
+    if ( m_captureCount == 0 )
+    {
+        return false;
+    }
+
+    CaptureSlotDX12& slot = m_captureSlots[m_captureHead];
+    if ( slot.fenceValue == 0 )
+    {
+        // Copy still sits in the open command list: submit it now, or come back after Present
+        if ( !wait )
+        {
+            return false;
+        }
+        Finish();
+        slot.fenceValue = m_fenceValue;
+    }
+    if ( slot.fenceValue > m_fence->GetCompletedValue() )
+    {
+        if ( !wait )
+        {
+            return false;
+        }
+        m_fence->SetEventOnCompletion( slot.fenceValue, m_fenceEvent );
+        WaitForSingleObject( m_fenceEvent, INFINITE );
+    }
+
+    // Raw RGBA rows, top-down; the image writer converts off the render thread
+    SIZE_T bytes = (SIZE_T)slot.rowPitch * slot.height;
+    void* mappedData = nullptr;
+    D3D12_RANGE readRange = { 0, bytes };
+    ThrowIfFailed( slot.readback->Map( 0, &readRange, &mappedData ), "Map capture readback failed" );
+    const uint8_t* src = (const uint8_t*)mappedData;
+    out.pixels.assign( src, src + bytes );
+    D3D12_RANGE writeRange = { 0, 0 };
+    slot.readback->Unmap( 0, &writeRange );
+
+    out.width = slot.width;
+    out.height = slot.height;
+    out.rowPitch = (int)slot.rowPitch;
+    out.isBottomUp = false;
+
+    m_captureHead = ( m_captureHead + 1 ) % CAPTURE_SLOTS;
+    --m_captureCount;
+    return true;
+}
+
+
+// --- Stream Ring ---
+
+
+void RenderBackendDX12::CreateStreamBuffer( uint32_t regionBytes )
+{
+    m_streamRing.Reset( regionBytes );
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width = m_streamRing.GetBufferBytes();
+    desc.Height = 1;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    ThrowIfFailed( m_device->CreateCommittedResource( &heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS( &m_streamBuffer ) ), "CreateCommittedResource (stream ring) failed" );
+
+    // Upload heaps may stay mapped for their whole lifetime
+    D3D12_RANGE noRead = { 0, 0 };
+    m_streamBuffer->Map( 0, &noRead, (void**)&m_streamMapped );
+    ++m_streamId;
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS RenderBackendDX12::GetStreamAddress( uint32_t id ) const
+{
+    if ( id == m_streamId )
+    {
+        return m_streamBuffer->GetGPUVirtualAddress();
+    }
+    for ( const auto& retired : m_retiredStreamBuffers )
+    {
+        if ( retired.id == id )
+        {
+            return retired.buffer->GetGPUVirtualAddress();
+        }
+    }
+    return 0;
+}
+
+
+UploadSpan RenderBackendDX12::AllocateUpload( int floatCount )
+{
+    UploadSpan span = {};
+    if ( floatCount <= 0 || !m_streamMapped )
+    {
+        return span;
+    }
+    uint32_t bytes = (uint32_t)floatCount * (uint32_t)sizeof( float );
+
+    // First allocation from this region since it was fenced: the GPU must be done with it
+    UINT64& fenceValue = m_streamFenceValues[m_streamRing.GetRegion()];
+    if ( fenceValue && m_fence->GetCompletedValue() < fenceValue )
+    {
+        PROFILE_SCOPED( "Render/UploadRingWait" );
+        m_fence->SetEventOnCompletion( fenceValue, m_fenceEvent );
+        WaitForSingleObject( m_fenceEvent, INFINITE );
+    }
+    fenceValue = 0;
+
+    uint32_t offset = 0;
+    if ( !m_streamRing.Allocate( bytes, offset ) )
+    {
+        // Frame outgrew its region: double the ring, keeping the old buffer until the GPU has read it
+        m_retiredStreamBuffers.push_back( { m_streamBuffer, m_streamId, 0 } );
+        CreateStreamBuffer( m_streamRing.GetGrownRegionBytes( bytes ) );
+        PROFILE_COUNTER_ADD( "Render/UploadRingGrowths", 1 );
+        m_streamRing.Allocate( bytes, offset );
+    }
+
+    span.data = (float*)( m_streamMapped + offset );
+    span.buffer = m_streamId;
+    span.offset = offset;
+    return span;
+}
+
+
 // --- Dynamic VB ---
 
 
-uint32_t RenderBackendDX12::CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices )
+uint32_t RenderBackendDX12::CreateDynamicVB( const int* attribComponents, int numAttribs )
 {
     DynamicVBDX12 dvb = {};
     dvb.numAttribs = numAttribs;
-    dvb.maxVertices = maxVertices;
     int totalFloats = 0;
     for ( int i = 0; i < numAttribs && i < 8; ++i )
     {
@@ -1614,26 +1992,29 @@ uint32_t RenderBackendDX12::CreateDynamicVB( const int* attribComponents, int nu
 }
 
 
-void RenderBackendDX12::UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount )
+void RenderBackendDX12::DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount )
 {
     if ( handle == 0 || handle > (uint32_t)m_dynamicVBs.size() || vertexCount <= 0 )
     {
         return;
     }
     DynamicVBDX12& dvb = m_dynamicVBs[handle - 1];
+    D3D12_GPU_VIRTUAL_ADDRESS streamAddr = GetStreamAddress( vertices.buffer );
+    if ( streamAddr == 0 )
+    {
+        return;
+    }
 
     EnsureCommandListOpen();
 
-    // Sub-allocate from upload buffer for vertex data
     UINT64 dataSize = (UINT64)vertexCount * dvb.stride;
-    D3D12_GPU_VIRTUAL_ADDRESS vbAddr = SubAllocateUpload( dataSize, 4 );
-    memcpy( GetUploadPtr( vbAddr ), data, (size_t)dataSize );
+    D3D12_GPU_VIRTUAL_ADDRESS vbAddr = streamAddr + vertices.offset;
 
     // Determine vertex format
-    VertexFormat12 fmt = VertexFormat12::Pos2_Tex2;
+    VertexFormat fmt = VertexFormat::Pos2_Tex2;
     if ( dvb.numAttribs == 2 && dvb.attribComponents[0] == 2 && dvb.attribComponents[1] == 2 )
     {
-        fmt = VertexFormat12::Pos2_Tex2;
+        fmt = VertexFormat::Pos2_Tex2;
     }
 
     PrepareDraw( fmt, false, nullptr, &dvb );
@@ -1649,14 +2030,14 @@ void RenderBackendDX12::UploadAndDrawDynamicVB( uint32_t handle, const float* da
 
 void RenderBackendDX12::DestroyDynamicVB( uint32_t /*handle*/ )
 {
-    // No GPU resources to release — upload buffer is shared
+    // No GPU resources to release — the stream ring is shared
 }
 
 
 // --- Instanced mesh ---
 
 
-uint32_t RenderBackendDX12::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int /*maxInstances*/, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs )
+uint32_t RenderBackendDX12::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs, const uint16_t* indices, int indexCount )
 {
     EnsureCommandListOpen();
 
@@ -1704,54 +2085,63 @@ uint32_t RenderBackendDX12::CreateInstancedMesh( const float* staticData, int st
     im.staticVBV.SizeInBytes = (UINT)dataSize;
     im.staticVBV.StrideInBytes = (UINT)im.staticStride;
 
-    m_instancedMeshes.push_back( im );
-    return (uint32_t)m_instancedMeshes.size(); // 1-based
-}
-
-
-void RenderBackendDX12::UploadInstanceData( uint32_t handle, const float* data, int floatCount )
-{
-    if ( handle == 0 || handle > (uint32_t)m_instancedMeshes.size() || floatCount <= 0 )
+    // Optional static IB, same path
+    if ( indices && indexCount > 0 )
     {
-        return;
-    }
-    InstancedMeshDX12& im = m_instancedMeshes[handle - 1];
+        UINT64 indexSize = (UINT64)indexCount * sizeof( uint16_t );
+        bufDesc.Width = indexSize;
+        m_device->CreateCommittedResource( &defaultHeap, D3D12_HEAP_FLAG_NONE, &bufDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS( &im.staticIB ) );
 
-    EnsureCommandListOpen();
+        FlushUploadBufferIfNeeded( indexSize, 4 );
+        D3D12_GPU_VIRTUAL_ADDRESS indexUploadAddr = SubAllocateUpload( indexSize, 4 );
+        memcpy( GetUploadPtr( indexUploadAddr ), indices, (size_t)indexSize );
+        m_commandList->CopyBufferRegion( im.staticIB, 0, m_uploadBuffer, indexUploadAddr - m_uploadBuffer->GetGPUVirtualAddress(), indexSize );
+        TransitionBarrier( im.staticIB, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER );
 
-    UINT64 dataSize = (UINT64)floatCount * sizeof( float );
-    D3D12_GPU_VIRTUAL_ADDRESS addr = SubAllocateUpload( dataSize, 4 );
-    memcpy( GetUploadPtr( addr ), data, (size_t)dataSize );
+        im.staticIBV.BufferLocation = im.staticIB->GetGPUVirtualAddress();
+        im.staticIBV.SizeInBytes = (UINT)indexSize;
+        im.staticIBV.Format = DXGI_FORMAT_R16_UINT;
+    }
 
-    im.instanceDataAddr = addr;
-    im.instanceDataSize = (UINT)dataSize;
+    m_instancedMeshes.push_back( im );
+    return (uint32_t)m_instancedMeshes.size(); // 1-based
 }
 
 
-void RenderBackendDX12::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount )
+void RenderBackendDX12::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances )
 {
     if ( handle == 0 || handle > (uint32_t)m_instancedMeshes.size() || instanceCount <= 0 )
     {
         return;
     }
     InstancedMeshDX12& im = m_instancedMeshes[handle - 1];
-
-    if ( im.instanceDataAddr == 0 )
+    D3D12_GPU_VIRTUAL_ADDRESS streamAddr = GetStreamAddress( instances.buffer );
+    if ( streamAddr == 0 )
     {
-        return; // No instance data uploaded yet
+        return;
     }
 
-    PrepareDraw( VertexFormat12::Pos3, true, &im, nullptr );
+    EnsureCommandListOpen();
+
+    PrepareDraw( VertexFormat::Pos3, true, &im, nullptr );
 
     // Slot 0: static geometry, Slot 1: per-instance data
     D3D12_VERTEX_BUFFER_VIEW vbvs[2] = {};
     vbvs[0] = im.staticVBV;
-    vbvs[1].BufferLocation = im.instanceDataAddr;
-    vbvs[1].SizeInBytes = im.instanceDataSize;
+    vbvs[1].BufferLocation = streamAddr + instances.offset;
+    vbvs[1].SizeInBytes = (UINT)instanceCount * (UINT)im.instanceStride;
     vbvs[1].StrideInBytes = (UINT)im.instanceStride;
 
     m_commandList->IASetVertexBuffers( 0, 2, vbvs );
-    m_commandList->DrawInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0 );
+    if ( im.staticIB )
+    {
+        m_commandList->IASetIndexBuffer( &im.staticIBV );
+        m_commandList->DrawIndexedInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0, 0 ); // staticVertCount counts indices
+    }
+    else
+    {
+        m_commandList->DrawInstanced( (UINT)staticVertCount, (UINT)instanceCount, 0, 0 );
+    }
 }
 
 
@@ -1767,6 +2157,11 @@ void RenderBackendDX12::DestroyInstancedMesh( uint32_t handle )
         im.staticVB->Release();
         im.staticVB = nullptr;
     }
+    if ( im.staticIB )
+    {
+        im.staticIB->Release();
+        im.staticIB = nullptr;
+    }
 }
 
 
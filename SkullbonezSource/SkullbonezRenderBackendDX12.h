@@ -4,6 +4,7 @@
 // --- Includes ---
 #include "SkullbonezIRenderBackend.h"
 #include "SkullbonezMeshDX12.h"
+#include "SkullbonezUploadRing.h"
 #include <d3d12.h>
 #include <dxgi1_4.h>
 #include <unordered_map>
@@ -27,22 +28,23 @@ struct TextureEntryDX12
 };
 
 
-// Dynamic vertex buffer (text, HUD)
+// Dynamic vertex buffer (text, HUD); vertices live in the stream ring
 struct DynamicVBDX12
 {
     int floatsPerVertex;
-    int maxVertices;
     int stride;
     int numAttribs;
     int attribComponents[8];
 };
 
 
-// Instanced mesh (shadow decals)
+// Instanced mesh (shadow decals); instance data lives in the stream ring
 struct InstancedMeshDX12
 {
     ID3D12Resource* staticVB;
     D3D12_VERTEX_BUFFER_VIEW staticVBV;
+    ID3D12Resource* staticIB; // 16-bit indices; nullptr when the static geometry is a plain triangle list
+    D3D12_INDEX_BUFFER_VIEW staticIBV;
     int staticFloatsPerVert;
     int staticStride;
     int instanceFloats;
@@ -52,8 +54,27 @@ struct InstancedMeshDX12
     int instanceAttribSizes[8];
     int numStaticAttribs;
     int staticAttribSizes[8];
-    D3D12_GPU_VIRTUAL_ADDRESS instanceDataAddr;
-    UINT instanceDataSize;
+};
+
+
+// Stream ring buffer replaced by a larger one; released once the GPU has passed fenceValue
+struct RetiredStreamDX12
+{
+    ID3D12Resource* buffer;
+    uint32_t id;
+    UINT64 fenceValue; // 0 until the frame that retired it has been submitted
+};
+
+
+// Readback buffer a backbuffer copy is recorded into; mapped once m_fence passes the submitting frame's value
+struct CaptureSlotDX12
+{
+    ID3D12Resource* readback;
+    UINT64 bytes;      // Current readback buffer size
+    UINT64 fenceValue; // 0 until the frame that recorded the copy has been submitted
+    UINT rowPitch;
+    int width;
+    int height;
 };
 
 
@@ -62,7 +83,7 @@ struct PSOKey12
 {
     const void* shaderVS;
     const void* shaderPS;
-    VertexFormat12 format;
+    VertexFormat format;
     bool isInstanced;
     bool blendEnabled;
     BlendFactor blendSrc;
@@ -85,7 +106,7 @@ class RenderBackendDX12 : public IRenderBackend
     static RenderBackendDX12* s_instance;
 
     // Frame management
-    static const int FRAME_COUNT = 2;
+    static const int FRAME_COUNT = MAX_FRAMES_IN_FLIGHT; // Back buffers and command allocators, one per frame in flight
 
     // Core objects
     IDXGIFactory4* m_factory;
@@ -132,6 +153,21 @@ class RenderBackendDX12 : public IRenderBackend
     uint8_t* m_uploadBufferMapped;
     static const UINT64 UPLOAD_BUFFER_SIZE = 8 * 1024 * 1024;
     UINT64 m_uploadOffset;
+    UINT64 m_uploadEpoch; // Bumped whenever m_uploadOffset rewinds; earlier sub-allocations are then stale
+
+    // Stream ring for instance data and dynamic vertices: persistently mapped, one fenced region per frame in
+    // flight, so spans survive the per-frame rewind of the upload buffer above
+    UploadRing m_streamRing;
+    ID3D12Resource* m_streamBuffer;
+    uint8_t* m_streamMapped;
+    uint32_t m_streamId;                                   // UploadSpan::buffer id of m_streamBuffer
+    UINT64 m_streamFenceValues[UploadRing::FRAME_REGIONS]; // m_fence value signalled after each region's frame
+    std::vector<RetiredStreamDX12> m_retiredStreamBuffers;
+
+    // Asynchronous screenshots: FIFO of readbacks, oldest at m_captureHead
+    CaptureSlotDX12 m_captureSlots[CAPTURE_SLOTS];
+    int m_captureHead;
+    int m_captureCount;
 
     // Root signature
     ID3D12RootSignature* m_rootSignature;
@@ -192,10 +228,12 @@ class RenderBackendDX12 : public IRenderBackend
     void TransitionBarrier( ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after );
     void FlushUploadBuffer();
     void FlushUploadBufferIfNeeded( UINT64 size, UINT64 alignment );
+    void CreateStreamBuffer( uint32_t regionBytes );
+    D3D12_GPU_VIRTUAL_ADDRESS GetStreamAddress( uint32_t id ) const;
     size_t HashPSOKey( const PSOKey12& key );
-    ID3D12PipelineState* CreatePSO( VertexFormat12 format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb );
+    ID3D12PipelineState* CreatePSO( VertexFormat format, bool instanced, const InstancedMeshDX12* im, const DynamicVBDX12* dvb );
 
-    static void BuildInputLayout( VertexFormat12 format, D3D12_INPUT_ELEMENT_DESC* out, UINT& count );
+    static void BuildInputLayout( VertexFormat format, D3D12_INPUT_ELEMENT_DESC* out, UINT& count );
     static void BuildInstancedInputLayout( const InstancedMeshDX12& im, D3D12_INPUT_ELEMENT_DESC* out, UINT& count );
     static void BuildDynamicVBInputLayout( const DynamicVBDX12& dvb, D3D12_INPUT_ELEMENT_DESC* out, UINT& count );
 
@@ -214,6 +252,7 @@ class RenderBackendDX12 : public IRenderBackend
     bool Init( HWND hwnd, HDC hdc, int width, int height ) override;
     void Shutdown() override;
     void Present() override;
+    void WaitForFrameSlot() override;
     void Finish() override;
     void FlushGPU() override;
     void Resize( int width, int height ) override;
@@ -232,13 +271,17 @@ class RenderBackendDX12 : public IRenderBackend
 
     std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) override;
     std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) override;
+    std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) override;
     std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) override;
 
     uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) override;
+    uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) override;
     void BindTexture( uint32_t handle, int slot ) override;
     void DeleteTexture( uint32_t handle ) override;
 
     std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) override;
+    bool RequestBackbufferCapture() override;
+    bool PollBackbufferCapture( CapturedImage& out, bool wait ) override;
 
     int GetWidth() const override;
     int GetHeight() const override;
@@ -251,13 +294,14 @@ class RenderBackendDX12 : public IRenderBackend
         return "DirectX 12";
     }
 
-    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices ) override;
-    void UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount ) override;
+    UploadSpan AllocateUpload( int floatCount ) override;
+
+    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) override;
+    void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) override;
     void DestroyDynamicVB( uint32_t handle ) override;
 
-    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0 ) override;
-    void UploadInstanceData( uint32_t handle, const float* data, int floatCount ) override;
-    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount ) override;
+    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) override;
+    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) override;
     void DestroyInstancedMesh( uint32_t handle ) override;
 
     // DX12-specific helpers for MeshGL/ShaderGL/FramebufferGL classes
@@ -275,7 +319,7 @@ class RenderBackendDX12 : public IRenderBackend
         return m_commandList;
     }
 
-    void PrepareDraw( VertexFormat12 format, bool instanced = false, const InstancedMeshDX12* im = nullptr, const DynamicVBDX12* dvb = nullptr );
+    void PrepareDraw( VertexFormat format, bool instanced = false, const InstancedMeshDX12* im = nullptr, const DynamicVBDX12* dvb = nullptr );
     UINT RegisterSRV( UINT srvIndex );
     void UnregisterSRV( uint32_t handle );
 
@@ -292,6 +336,11 @@ class RenderBackendDX12 : public IRenderBackend
 
     D3D12_GPU_VIRTUAL_ADDRESS SubAllocateUpload( UINT64 size, UINT64 alignment );
     uint8_t* GetUploadPtr( D3D12_GPU_VIRTUAL_ADDRESS addr );
+    void UploadBufferRegion( ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 size, D3D12_RESOURCE_STATES restingState ); // Copies through the upload buffer; dest returns to restingState
+    UINT64 GetUploadEpoch() const
+    {
+        return m_uploadEpoch;
+    }
     ID3D12Resource* GetUploadBuffer() const
     {
         return m_uploadBuffer;
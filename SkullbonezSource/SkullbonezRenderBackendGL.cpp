@@ -3,6 +3,7 @@
 #include "SkullbonezShaderGL.h"
 #include "SkullbonezMeshGL.h"
 #include "SkullbonezFramebufferGL.h"
+#include "SkullbonezProfiler.h"
 #include <cstdio>
 
 
@@ -91,7 +92,7 @@ static void APIENTRY GLDebugCallback( GLenum source, GLenum type, GLuint /*id*/,
 
 
 RenderBackendGL::RenderBackendGL()
-    : m_hdc( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_cullFaceEnabled( true ), m_polygonOffsetEnabled( false ), m_polygonOffsetFactor( 0.0f ), m_polygonOffsetUnits( 0.0f )
+    : m_hdc( nullptr ), m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_cullFaceEnabled( true ), m_polygonOffsetEnabled( false ), m_polygonOffsetFactor( 0.0f ), m_polygonOffsetUnits( 0.0f ), m_uploadBuffer( 0 ), m_uploadMapped( nullptr ), m_uploadMapStart( 0 ), m_uploadPersistent( false ), m_uploadFences{}, m_frameFences{}, m_frameSlot( 0 ), m_captureSlots{}, m_captureHead( 0 ), m_captureCount( 0 )
 {
 }
 
@@ -121,6 +122,11 @@ bool RenderBackendGL::Init( HWND /*hwnd*/, HDC hdc, int width, int height )
     glFrontFace( GL_CCW );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
+    // Streaming uploads: one persistent coherent mapping when buffer storage is available (GL 4.4 drivers),
+    // otherwise unsynchronized transient maps of the same fence-guarded ring
+    m_uploadPersistent = GLAD_GL_ARB_buffer_storage != 0;
+    CreateUploadBuffer( UploadRing::INITIAL_REGION_BYTES );
+
     return true;
 }
 
@@ -130,10 +136,6 @@ void RenderBackendGL::Shutdown()
     // Destroy all dynamic vertex buffers
     for ( auto& dvb : m_dynamicVBs )
     {
-        if ( dvb.vbo )
-        {
-            glDeleteBuffers( 1, &dvb.vbo );
-        }
         if ( dvb.vao )
         {
             glDeleteVertexArrays( 1, &dvb.vao );
@@ -144,10 +146,6 @@ void RenderBackendGL::Shutdown()
     // Destroy all instanced meshes
     for ( auto& im : m_instancedMeshes )
     {
-        if ( im.instanceVBO )
-        {
-            glDeleteBuffers( 1, &im.instanceVBO );
-        }
         if ( im.staticVBO )
         {
             glDeleteBuffers( 1, &im.staticVBO );
@@ -159,13 +157,79 @@ void RenderBackendGL::Shutdown()
     }
     m_instancedMeshes.clear();
 
+    // Upload ring: retired buffers first, then the live one and its fences
+    EndUploadFrame();
+    if ( m_uploadBuffer )
+    {
+        if ( m_uploadMapped )
+        {
+            glBindBuffer( GL_ARRAY_BUFFER, m_uploadBuffer );
+            glUnmapBuffer( GL_ARRAY_BUFFER );
+            glBindBuffer( GL_ARRAY_BUFFER, 0 );
+            m_uploadMapped = nullptr;
+        }
+        glDeleteBuffers( 1, &m_uploadBuffer );
+        m_uploadBuffer = 0;
+    }
+    for ( GLsync& fence : m_uploadFences )
+    {
+        if ( fence )
+        {
+            glDeleteSync( fence );
+            fence = nullptr;
+        }
+    }
+    for ( GLsync& fence : m_frameFences )
+    {
+        if ( fence )
+        {
+            glDeleteSync( fence );
+            fence = nullptr;
+        }
+    }
+
+    // Screenshot readbacks still in flight are dropped
+    for ( CaptureSlotGL& slot : m_captureSlots )
+    {
+        if ( slot.fence )
+        {
+            glDeleteSync( slot.fence );
+        }
+        if ( slot.pbo )
+        {
+            glDeleteBuffers( 1, &slot.pbo );
+        }
+        slot = {};
+    }
+    m_captureHead = 0;
+    m_captureCount = 0;
+
     m_hdc = nullptr;
 }
 
 
 void RenderBackendGL::Present()
 {
+    EndUploadFrame();
     SwapBuffers( m_hdc );
+
+    m_frameFences[m_frameSlot] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    m_frameSlot = ( m_frameSlot + 1 ) % MAX_FRAMES_IN_FLIGHT;
+}
+
+
+void RenderBackendGL::WaitForFrameSlot()
+{
+    GLsync& fence = m_frameFences[m_frameSlot];
+    if ( !fence )
+    {
+        return;
+    }
+    while ( glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull ) == GL_TIMEOUT_EXPIRED )
+    {
+    }
+    glDeleteSync( fence );
+    fence = nullptr;
 }
 
 
@@ -359,7 +423,18 @@ std::unique_ptr<IShader> RenderBackendGL::CreateShader( const char* vertPath, co
 
 std::unique_ptr<IMesh> RenderBackendGL::CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords )
 {
-    return std::make_unique<MeshGL>( data, vertexCount, hasNormals, hasTexCoords );
+    if ( hasNormals && !hasTexCoords )
+    {
+        throw std::runtime_error( "Normals without texcoords are not a supported mesh layout.  (RenderBackendGL::CreateMesh)" );
+    }
+    VertexFormat format = hasNormals ? VertexFormat::Pos3_Norm3_Tex2 : ( hasTexCoords ? VertexFormat::Pos3_Tex2 : VertexFormat::Pos3 );
+    return std::make_unique<MeshGL>( data, vertexCount, format, nullptr, 0, IndexFormat::None );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendGL::CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat )
+{
+    return std::make_unique<MeshGL>( vertices, vertexCount, format, indices, indexCount, indexFormat );
 }
 
 
@@ -401,6 +476,43 @@ uint32_t RenderBackendGL::CreateTexture2D( const uint8_t* data, int w, int h, in
 }
 
 
+uint32_t RenderBackendGL::CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter )
+{
+    GLuint tex = 0;
+    glGenTextures( 1, &tex );
+    glBindTexture( GL_TEXTURE_2D, tex );
+
+    GLenum format = ( channels == 1 ) ? GL_RED : GL_RGBA;
+
+    // Levels are tightly packed -- 1-channel and odd-width levels are not 4-byte aligned
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    const uint8_t* level = data;
+    for ( int mip = 0; mip < mipCount; ++mip )
+    {
+        glTexImage2D( GL_TEXTURE_2D, mip, format, w, h, 0, format, GL_UNSIGNED_BYTE, level );
+        level += static_cast<size_t>( w ) * h * channels;
+        w = ( w > 1 ) ? w / 2 : 1;
+        h = ( h > 1 ) ? h / 2 : 1;
+    }
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1 );
+    if ( mipCount > 1 )
+    {
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linearFilter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST );
+    }
+    else
+    {
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linearFilter ? GL_LINEAR : GL_NEAREST );
+    }
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linearFilter ? GL_LINEAR : GL_NEAREST );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    return static_cast<uint32_t>( tex );
+}
+
+
 void RenderBackendGL::BindTexture( uint32_t handle, int slot )
 {
     glActiveTexture( GL_TEXTURE0 + slot );
@@ -438,6 +550,87 @@ std::vector<uint8_t> RenderBackendGL::CaptureBackbuffer( int& outWidth, int& out
 }
 
 
+bool RenderBackendGL::RequestBackbufferCapture()
+{
+    if ( m_captureCount == CAPTURE_SLOTS )
+    {
+        return false;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv( GL_VIEWPORT, viewport );
+
+    CaptureSlotGL& slot = m_captureSlots[( m_captureHead + m_captureCount ) % CAPTURE_SLOTS];
+    slot.width = viewport[2];
+    slot.height = viewport[3];
+    uint32_t bytes = static_cast<uint32_t>( slot.width ) * static_cast<uint32_t>( slot.height ) * 4;
+
+    if ( !slot.pbo )
+    {
+        glGenBuffers( 1, &slot.pbo );
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, slot.pbo );
+    if ( slot.bytes != bytes )
+    {
+        glBufferData( GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ );
+        slot.bytes = bytes;
+    }
+
+    // With a pack buffer bound the read is queued like any other command; the fence says when it has landed
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+    glReadBuffer( GL_BACK );
+    glReadPixels( 0, 0, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    slot.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+    ++m_captureCount;
+    return true;
+}
+
+
+bool RenderBackendGL::PollBackbufferCapture( CapturedImage& out, bool wait )
+{
+    if ( m_captureCount == 0 )
+    {
+        return false;
+    }
+
+    CaptureSlotGL& slot = m_captureSlots[m_captureHead];
+    if ( wait )
+    {
+        while ( glClientWaitSync( slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull ) == GL_TIMEOUT_EXPIRED )
+        {
+        }
+    }
+    else if ( glClientWaitSync( slot.fence, 0, 0 ) == GL_TIMEOUT_EXPIRED )
+    {
+        return false;
+    }
+    glDeleteSync( slot.fence );
+    slot.fence = nullptr;
+
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, slot.pbo );
+    const uint8_t* src = static_cast<const uint8_t*>( glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, slot.bytes, GL_MAP_READ_BIT ) );
+    if ( !src )
+    {
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+        throw std::runtime_error( "Failed to map screenshot readback buffer.  (RenderBackendGL::PollBackbufferCapture)" );
+    }
+    out.pixels.assign( src, src + slot.bytes );
+    glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+    out.width = slot.width;
+    out.height = slot.height;
+    out.rowPitch = slot.width * 4;
+    out.isBottomUp = true;
+
+    m_captureHead = ( m_captureHead + 1 ) % CAPTURE_SLOTS;
+    --m_captureCount;
+    return true;
+}
+
+
 // --- Window Dimensions ---
 
 
@@ -474,61 +667,195 @@ bool RenderBackendGL::UsesZeroToOneDepth() const
 }
 
 
+// --- Upload Ring ---
+
+
+void RenderBackendGL::CreateUploadBuffer( uint32_t regionBytes )
+{
+    m_uploadRing.Reset( regionBytes );
+    GLsizeiptr size = static_cast<GLsizeiptr>( m_uploadRing.GetBufferBytes() );
+
+    glGenBuffers( 1, &m_uploadBuffer );
+    glBindBuffer( GL_ARRAY_BUFFER, m_uploadBuffer );
+    if ( m_uploadPersistent )
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage( GL_ARRAY_BUFFER, size, nullptr, flags );
+        m_uploadMapped = static_cast<uint8_t*>( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, flags ) );
+        m_uploadMapStart = 0;
+    }
+    else
+    {
+        glBufferData( GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW );
+        m_uploadMapped = nullptr;
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+
+UploadSpan RenderBackendGL::AllocateUpload( int floatCount )
+{
+    UploadSpan span = {};
+    if ( floatCount <= 0 || !m_uploadBuffer )
+    {
+        return span;
+    }
+    uint32_t bytes = static_cast<uint32_t>( floatCount ) * static_cast<uint32_t>( sizeof( float ) );
+
+    // First allocation from this region since it was fenced: the GPU must be done with it
+    GLsync& fence = m_uploadFences[m_uploadRing.GetRegion()];
+    if ( fence )
+    {
+        PROFILE_SCOPED( "Render/UploadRingWait" );
+        while ( glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull ) == GL_TIMEOUT_EXPIRED )
+        {
+        }
+        glDeleteSync( fence );
+        fence = nullptr;
+    }
+
+    uint32_t offset = 0;
+    if ( !m_uploadRing.Allocate( bytes, offset ) )
+    {
+        // Frame outgrew its region: double the ring. Spans already handed out keep pointing into the old
+        // buffer, so it stays alive (and mapped) until this frame is submitted.
+        m_retiredUploadBuffers.push_back( { m_uploadBuffer, m_uploadMapped != nullptr } );
+        CreateUploadBuffer( m_uploadRing.GetGrownRegionBytes( bytes ) );
+        PROFILE_COUNTER_ADD( "Render/UploadRingGrowths", 1 );
+        m_uploadRing.Allocate( bytes, offset );
+    }
+
+    if ( !m_uploadPersistent && !m_uploadMapped )
+    {
+        // Map the rest of this frame's region in one go; no earlier frame can be reading it
+        uint32_t regionEnd = static_cast<uint32_t>( m_uploadRing.GetRegion() + 1 ) * m_uploadRing.GetRegionBytes();
+        glBindBuffer( GL_ARRAY_BUFFER, m_uploadBuffer );
+        m_uploadMapped = static_cast<uint8_t*>( glMapBufferRange( GL_ARRAY_BUFFER, offset, regionEnd - offset, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT ) );
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        m_uploadMapStart = offset;
+    }
+    if ( !m_uploadMapped )
+    {
+        return span;
+    }
+
+    span.data = reinterpret_cast<float*>( m_uploadMapped + ( offset - m_uploadMapStart ) );
+    span.buffer = m_uploadBuffer;
+    span.offset = offset;
+    return span;
+}
+
+
+void RenderBackendGL::UnmapUploadBuffers()
+{
+    if ( m_uploadPersistent )
+    {
+        return;
+    }
+
+    for ( auto& retired : m_retiredUploadBuffers )
+    {
+        if ( retired.mapped )
+        {
+            glBindBuffer( GL_ARRAY_BUFFER, retired.buffer );
+            glUnmapBuffer( GL_ARRAY_BUFFER );
+            retired.mapped = false;
+        }
+    }
+    if ( m_uploadMapped )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, m_uploadBuffer );
+        glUnmapBuffer( GL_ARRAY_BUFFER );
+        m_uploadMapped = nullptr;
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+
+void RenderBackendGL::EndUploadFrame()
+{
+    UnmapUploadBuffers();
+
+    // GL defers the actual deletion until queued draws no longer reference the buffer
+    for ( auto& retired : m_retiredUploadBuffers )
+    {
+        if ( retired.mapped )
+        {
+            glBindBuffer( GL_ARRAY_BUFFER, retired.buffer );
+            glUnmapBuffer( GL_ARRAY_BUFFER );
+            glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        }
+        glDeleteBuffers( 1, &retired.buffer );
+    }
+    m_retiredUploadBuffers.clear();
+
+    if ( !m_uploadBuffer )
+    {
+        return;
+    }
+
+    GLsync& fence = m_uploadFences[m_uploadRing.GetRegion()];
+    if ( fence )
+    {
+        glDeleteSync( fence ); // Region went unused this frame
+    }
+    fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    m_uploadRing.Advance();
+}
+
+
 // --- Dynamic Vertex Buffer ---
 
 
-uint32_t RenderBackendGL::CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices )
+uint32_t RenderBackendGL::CreateDynamicVB( const int* attribComponents, int numAttribs )
 {
     DynamicVBGL dvb = {};
-    dvb.maxVertices = maxVertices;
+    dvb.numAttribs = numAttribs < 8 ? numAttribs : 8;
 
     int floatsPerVert = 0;
-    for ( int i = 0; i < numAttribs; ++i )
+    for ( int i = 0; i < dvb.numAttribs; ++i )
     {
+        dvb.attribComponents[i] = attribComponents[i];
         floatsPerVert += attribComponents[i];
     }
     dvb.floatsPerVertex = floatsPerVert;
 
+    // Attribute pointers are set per draw, against the upload ring span that holds the vertices
     glGenVertexArrays( 1, &dvb.vao );
     glBindVertexArray( dvb.vao );
-
-    glGenBuffers( 1, &dvb.vbo );
-    glBindBuffer( GL_ARRAY_BUFFER, dvb.vbo );
-    glBufferData( GL_ARRAY_BUFFER, static_cast<GLsizeiptr>( maxVertices ) * floatsPerVert * static_cast<GLsizeiptr>( sizeof( float ) ), nullptr, GL_STREAM_DRAW );
-
-    int stride = floatsPerVert * static_cast<int>( sizeof( float ) );
-    int offset = 0;
-    for ( int i = 0; i < numAttribs; ++i )
+    for ( int i = 0; i < dvb.numAttribs; ++i )
     {
         glEnableVertexAttribArray( static_cast<GLuint>( i ) );
-        glVertexAttribPointer( static_cast<GLuint>( i ), attribComponents[i], GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
-        offset += attribComponents[i] * static_cast<int>( sizeof( float ) );
     }
-
     glBindVertexArray( 0 );
-    glBindBuffer( GL_ARRAY_BUFFER, 0 );
 
     m_dynamicVBs.push_back( dvb );
     return static_cast<uint32_t>( m_dynamicVBs.size() ); // 1-based handle
 }
 
 
-void RenderBackendGL::UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount )
+void RenderBackendGL::DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount )
 {
-    if ( handle == 0 || handle > static_cast<uint32_t>( m_dynamicVBs.size() ) )
+    if ( handle == 0 || handle > static_cast<uint32_t>( m_dynamicVBs.size() ) || !vertices.buffer || vertexCount <= 0 )
     {
         return;
     }
     DynamicVBGL& dvb = m_dynamicVBs[handle - 1];
 
+    UnmapUploadBuffers();
+
     glBindVertexArray( dvb.vao );
-    glBindBuffer( GL_ARRAY_BUFFER, dvb.vbo );
-    // Orphan the old buffer then upload new data (avoids implicit sync)
-    GLsizeiptr bufSize = static_cast<GLsizeiptr>( dvb.maxVertices ) * dvb.floatsPerVertex * static_cast<GLsizeiptr>( sizeof( float ) );
-    glBufferData( GL_ARRAY_BUFFER, bufSize, nullptr, GL_STREAM_DRAW );
-    glBufferSubData( GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>( vertexCount ) * dvb.floatsPerVertex * static_cast<GLsizeiptr>( sizeof( float ) ), data );
+    glBindBuffer( GL_ARRAY_BUFFER, vertices.buffer );
+    int stride = dvb.floatsPerVertex * static_cast<int>( sizeof( float ) );
+    intptr_t offset = static_cast<intptr_t>( vertices.offset );
+    for ( int i = 0; i < dvb.numAttribs; ++i )
+    {
+        glVertexAttribPointer( static_cast<GLuint>( i ), dvb.attribComponents[i], GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( offset ) );
+        offset += dvb.attribComponents[i] * static_cast<int>( sizeof( float ) );
+    }
     glDrawArrays( GL_TRIANGLES, 0, vertexCount );
     glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
 }
 
 
@@ -539,11 +866,6 @@ void RenderBackendGL::DestroyDynamicVB( uint32_t handle )
         return;
     }
     DynamicVBGL& dvb = m_dynamicVBs[handle - 1];
-    if ( dvb.vbo )
-    {
-        glDeleteBuffers( 1, &dvb.vbo );
-        dvb.vbo = 0;
-    }
     if ( dvb.vao )
     {
         glDeleteVertexArrays( 1, &dvb.vao );
@@ -555,11 +877,17 @@ void RenderBackendGL::DestroyDynamicVB( uint32_t handle )
 // --- Instanced MeshGL ---
 
 
-uint32_t RenderBackendGL::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs )
+uint32_t RenderBackendGL::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs, const uint16_t* indices, int indexCount )
 {
     InstancedMesh im = {};
     im.staticFloatsPerVert = staticFloatsPerVert;
     im.instanceFloats = instanceFloats;
+    im.instanceStartAttrib = instanceStartAttrib;
+    im.numInstanceAttribs = numInstanceAttribs < 8 ? numInstanceAttribs : 8;
+    for ( int i = 0; i < im.numInstanceAttribs; ++i )
+    {
+        im.instanceAttribSizes[i] = instanceAttribSizes[i];
+    }
 
     glGenVertexArrays( 1, &im.vao );
     glBindVertexArray( im.vao );
@@ -569,6 +897,14 @@ uint32_t RenderBackendGL::CreateInstancedMesh( const float* staticData, int stat
     glBindBuffer( GL_ARRAY_BUFFER, im.staticVBO );
     glBufferData( GL_ARRAY_BUFFER, static_cast<GLsizeiptr>( staticVertCount ) * staticFloatsPerVert * static_cast<GLsizeiptr>( sizeof( float ) ), staticData, GL_STATIC_DRAW );
 
+    // Optional 16-bit element buffer (captured by the VAO)
+    if ( indices && indexCount > 0 )
+    {
+        glGenBuffers( 1, &im.staticIBO );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, im.staticIBO );
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>( indexCount ) * static_cast<GLsizeiptr>( sizeof( uint16_t ) ), indices, GL_STATIC_DRAW );
+    }
+
     // Static attributes
     if ( numStaticAttribs > 0 && staticAttribSizes )
     {
@@ -589,54 +925,53 @@ uint32_t RenderBackendGL::CreateInstancedMesh( const float* staticData, int stat
         glVertexAttribPointer( 0, staticFloatsPerVert, GL_FLOAT, GL_FALSE, staticFloatsPerVert * static_cast<int>( sizeof( float ) ), nullptr );
     }
 
-    // Instance data VBO (dynamic, updated each frame)
-    glGenBuffers( 1, &im.instanceVBO );
-    glBindBuffer( GL_ARRAY_BUFFER, im.instanceVBO );
-    glBufferData( GL_ARRAY_BUFFER, static_cast<GLsizeiptr>( maxInstances ) * instanceFloats * static_cast<GLsizeiptr>( sizeof( float ) ), nullptr, GL_DYNAMIC_DRAW );
-
-    int stride = instanceFloats * static_cast<int>( sizeof( float ) );
-    int offset = 0;
-    for ( int i = 0; i < numInstanceAttribs; ++i )
+    // Instance attributes: pointers are set per draw, against the upload ring span that holds the instances
+    for ( int i = 0; i < im.numInstanceAttribs; ++i )
     {
         GLuint loc = static_cast<GLuint>( instanceStartAttrib + i );
         glEnableVertexAttribArray( loc );
-        glVertexAttribPointer( loc, instanceAttribSizes[i], GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( static_cast<intptr_t>( offset ) ) );
         glVertexAttribDivisor( loc, 1 );
-        offset += instanceAttribSizes[i] * static_cast<int>( sizeof( float ) );
     }
 
     glBindVertexArray( 0 );
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 
     m_instancedMeshes.push_back( im );
     return static_cast<uint32_t>( m_instancedMeshes.size() ); // 1-based handle
 }
 
 
-void RenderBackendGL::UploadInstanceData( uint32_t handle, const float* data, int floatCount )
+void RenderBackendGL::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances )
 {
-    if ( handle == 0 || handle > static_cast<uint32_t>( m_instancedMeshes.size() ) )
+    if ( handle == 0 || handle > static_cast<uint32_t>( m_instancedMeshes.size() ) || !instances.buffer || instanceCount <= 0 )
     {
         return;
     }
     InstancedMesh& im = m_instancedMeshes[handle - 1];
 
-    glBindBuffer( GL_ARRAY_BUFFER, im.instanceVBO );
-    glBufferSubData( GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>( floatCount ) * static_cast<GLsizeiptr>( sizeof( float ) ), data );
-}
+    UnmapUploadBuffers();
 
-
-void RenderBackendGL::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount )
-{
-    if ( handle == 0 || handle > static_cast<uint32_t>( m_instancedMeshes.size() ) )
+    glBindVertexArray( im.vao );
+    glBindBuffer( GL_ARRAY_BUFFER, instances.buffer );
+    int stride = im.instanceFloats * static_cast<int>( sizeof( float ) );
+    intptr_t offset = static_cast<intptr_t>( instances.offset );
+    for ( int i = 0; i < im.numInstanceAttribs; ++i )
     {
-        return;
+        GLuint loc = static_cast<GLuint>( im.instanceStartAttrib + i );
+        glVertexAttribPointer( loc, im.instanceAttribSizes[i], GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>( offset ) );
+        offset += im.instanceAttribSizes[i] * static_cast<int>( sizeof( float ) );
+    }
+    if ( im.staticIBO )
+    {
+        glDrawElementsInstanced( GL_TRIANGLES, staticVertCount, GL_UNSIGNED_SHORT, nullptr, instanceCount ); // staticVertCount counts indices
+    }
+    else
+    {
+        glDrawArraysInstanced( GL_TRIANGLES, 0, staticVertCount, instanceCount );
     }
-    InstancedMesh& im = m_instancedMeshes[handle - 1];
-
-    glBindVertexArray( im.vao );
-    glDrawArraysInstanced( GL_TRIANGLES, 0, staticVertCount, instanceCount );
     glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
 }
 
 
@@ -647,16 +982,16 @@ void RenderBackendGL::DestroyInstancedMesh( uint32_t handle )
         return;
     }
     InstancedMesh& im = m_instancedMeshes[handle - 1];
-    if ( im.instanceVBO )
-    {
-        glDeleteBuffers( 1, &im.instanceVBO );
-        im.instanceVBO = 0;
-    }
     if ( im.staticVBO )
     {
         glDeleteBuffers( 1, &im.staticVBO );
         im.staticVBO = 0;
     }
+    if ( im.staticIBO )
+    {
+        glDeleteBuffers( 1, &im.staticIBO );
+        im.staticIBO = 0;
+    }
     if ( im.vao )
     {
         glDeleteVertexArrays( 1, &im.vao );
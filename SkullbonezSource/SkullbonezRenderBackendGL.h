@@ -3,6 +3,7 @@
 
 // --- Includes ---
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezUploadRing.h"
 #include <vector>
 
 
@@ -11,24 +12,46 @@ namespace SkullbonezCore
 namespace Rendering
 {
 
-// Internal storage for dynamic vertex buffers (Text, HUD)
+// Internal storage for dynamic vertex buffers (Text, HUD); vertices live in the upload ring
 struct DynamicVBGL
 {
     GLuint vao;
-    GLuint vbo;
     int floatsPerVertex;
-    int maxVertices;
+    int numAttribs;
+    int attribComponents[8];
 };
 
 
-// Internal storage for instanced mesh setups (shadows)
+// Internal storage for instanced mesh setups (shadows); instance data lives in the upload ring
 struct InstancedMesh
 {
     GLuint vao;
     GLuint staticVBO;
-    GLuint instanceVBO;
+    GLuint staticIBO; // 0 when the static geometry is a plain triangle list
     int staticFloatsPerVert;
     int instanceFloats;
+    int instanceStartAttrib;
+    int numInstanceAttribs;
+    int instanceAttribSizes[8];
+};
+
+
+// Upload ring buffer replaced by a larger one mid-frame; deleted at Present once its spans are consumed
+struct RetiredUploadGL
+{
+    GLuint buffer;
+    bool mapped;
+};
+
+
+// Pixel-pack buffer a backbuffer readback is written into; fenced so it can be mapped without stalling
+struct CaptureSlotGL
+{
+    GLuint pbo;
+    GLsync fence;
+    int width;
+    int height;
+    uint32_t bytes; // Current PBO size
 };
 
 
@@ -54,6 +77,28 @@ class RenderBackendGL : public IRenderBackend
     std::vector<DynamicVBGL> m_dynamicVBs;
     std::vector<InstancedMesh> m_instancedMeshes;
 
+    // Streaming upload ring (instance data, dynamic vertices)
+    UploadRing m_uploadRing;
+    GLuint m_uploadBuffer;
+    uint8_t* m_uploadMapped;                          // Persistent mapping, or the open transient one (fallback path)
+    uint32_t m_uploadMapStart;                        // Buffer offset m_uploadMapped corresponds to
+    bool m_uploadPersistent;                          // ARB_buffer_storage: mapped once, coherent
+    GLsync m_uploadFences[UploadRing::FRAME_REGIONS]; // Signalled when the GPU has consumed each region
+    std::vector<RetiredUploadGL> m_retiredUploadBuffers;
+
+    // Frames in flight: fence inserted after each swap, waited on before the slot's next frame is recorded
+    GLsync m_frameFences[MAX_FRAMES_IN_FLIGHT];
+    int m_frameSlot;
+
+    // Asynchronous screenshots: FIFO of readbacks, oldest at m_captureHead
+    CaptureSlotGL m_captureSlots[CAPTURE_SLOTS];
+    int m_captureHead;
+    int m_captureCount;
+
+    void CreateUploadBuffer( uint32_t regionBytes );
+    void UnmapUploadBuffers(); // Fallback path: close transient mappings before the GPU reads them
+    void EndUploadFrame();     // Fence this frame's region, drop retired buffers
+
   public:
     RenderBackendGL();
     ~RenderBackendGL() override = default;
@@ -61,6 +106,7 @@ class RenderBackendGL : public IRenderBackend
     bool Init( HWND hwnd, HDC hdc, int width, int height ) override;
     void Shutdown() override;
     void Present() override;
+    void WaitForFrameSlot() override;
     void Finish() override;
     void FlushGPU() override;
     void Resize( int width, int height ) override;
@@ -79,13 +125,17 @@ class RenderBackendGL : public IRenderBackend
 
     std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) override;
     std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) override;
+    std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) override;
     std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) override;
 
     uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) override;
+    uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) override;
     void BindTexture( uint32_t handle, int slot ) override;
     void DeleteTexture( uint32_t handle ) override;
 
     std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) override;
+    bool RequestBackbufferCapture() override;
+    bool PollBackbufferCapture( CapturedImage& out, bool wait ) override;
 
     int GetWidth() const override;
     int GetHeight() const override;
@@ -98,13 +148,14 @@ class RenderBackendGL : public IRenderBackend
         return "OpenGL 3.3";
     }
 
-    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs, int maxVertices ) override;
-    void UploadAndDrawDynamicVB( uint32_t handle, const float* data, int vertexCount ) override;
+    UploadSpan AllocateUpload( int floatCount ) override;
+
+    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) override;
+    void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) override;
     void DestroyDynamicVB( uint32_t handle ) override;
 
-    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int maxInstances, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0 ) override;
-    void UploadInstanceData( uint32_t handle, const float* data, int floatCount ) override;
-    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount ) override;
+    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) override;
+    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) override;
     void DestroyInstancedMesh( uint32_t handle ) override;
 };
 } // namespace Rendering
@@ -0,0 +1,704 @@
+// --- Includes ---
+#include "SkullbonezRenderBackendNull.h"
+#include "SkullbonezProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Math::Transformation;
+
+
+static constexpr size_t MIN_UPLOAD_FLOATS = 64 * 1024; // First upload block (grows by doubling)
+
+
+/* -- NullShader -------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Counts Use() as a shader change and every setter as a uniform set.  Handles are issued per distinct name.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class NullShader : public IShader
+{
+
+  private:
+    RenderBackendNull* m_backend;
+    mutable std::vector<std::string> m_uniformNames; // Index = handle
+
+    void CountSet( UniformHandle handle ) const
+    {
+        if ( handle != UniformHandle::Invalid )
+        {
+            m_backend->Record( &RenderCallStats::uniformSets, 1 );
+        }
+    }
+
+  public:
+    explicit NullShader( RenderBackendNull* backend )
+        : m_backend( backend )
+    {
+    }
+
+    void Use() const override
+    {
+        m_backend->BindShader( this );
+    }
+
+    void SetInt( const char* name, int ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+    void SetFloat( const char* name, float ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+    void SetVec3( const char* name, const Vector3& ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+    void SetVec3( const char* name, float, float, float ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+    void SetVec4( const char* name, float, float, float, float ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+    void SetMat4( const char* name, const Matrix4& ) const override
+    {
+        CountSet( GetUniformHandle( name ) );
+    }
+
+    UniformHandle GetUniformHandle( const char* name ) const override
+    {
+        for ( size_t i = 0; i < m_uniformNames.size(); ++i )
+        {
+            if ( m_uniformNames[i] == name )
+            {
+                return static_cast<UniformHandle>( i );
+            }
+        }
+        m_uniformNames.push_back( name );
+        return static_cast<UniformHandle>( m_uniformNames.size() - 1 );
+    }
+
+    void SetInt( UniformHandle handle, int ) const override
+    {
+        CountSet( handle );
+    }
+    void SetFloat( UniformHandle handle, float ) const override
+    {
+        CountSet( handle );
+    }
+    void SetVec3( UniformHandle handle, const Vector3& ) const override
+    {
+        CountSet( handle );
+    }
+    void SetVec3( UniformHandle handle, float, float, float ) const override
+    {
+        CountSet( handle );
+    }
+    void SetVec4( UniformHandle handle, float, float, float, float ) const override
+    {
+        CountSet( handle );
+    }
+    void SetMat4( UniformHandle handle, const Matrix4& ) const override
+    {
+        CountSet( handle );
+    }
+};
+
+
+/* -- NullMesh ---------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Counts draws and the vertices (or indices) they submit; UpdateVertices counts as static upload bytes.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class NullMesh : public IMesh
+{
+
+  private:
+    RenderBackendNull* m_backend;
+    int m_vertexCount;
+    int m_indexCount;
+    int m_stride; // Bytes per vertex
+
+  public:
+    NullMesh( RenderBackendNull* backend, int vertexCount, int indexCount, int stride )
+        : m_backend( backend ), m_vertexCount( vertexCount ), m_indexCount( indexCount ), m_stride( stride )
+    {
+    }
+
+    void Draw() const override
+    {
+        DrawInstanced( 1 );
+    }
+
+    void DrawInstanced( int instanceCount ) const override
+    {
+        m_backend->Record( &RenderCallStats::drawCalls, 1 );
+        m_backend->Record( &RenderCallStats::instances, instanceCount );
+        m_backend->Record( &RenderCallStats::vertices, static_cast<int64_t>( m_indexCount ? m_indexCount : m_vertexCount ) * instanceCount );
+    }
+
+    int GetVertexCount() const override
+    {
+        return m_vertexCount;
+    }
+
+    int GetIndexCount() const override
+    {
+        return m_indexCount;
+    }
+
+    void UpdateVertices( int, int vertexCount, const void* ) override
+    {
+        m_backend->Record( &RenderCallStats::resourceBytes, static_cast<int64_t>( vertexCount ) * m_stride );
+    }
+};
+
+
+/* -- NullFramebuffer --------------------------------------------------------------------------------------------------------------------------------------------
+
+    Render target binds count as state changes; the colour "texture" is a handle from the backend.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class NullFramebuffer : public IFramebuffer
+{
+
+  private:
+    RenderBackendNull* m_backend;
+    uint32_t m_colorTexture;
+    int m_width;
+    int m_height;
+
+  public:
+    NullFramebuffer( RenderBackendNull* backend, uint32_t colorTexture, int width, int height )
+        : m_backend( backend ), m_colorTexture( colorTexture ), m_width( width ), m_height( height )
+    {
+    }
+
+    void Bind() const override
+    {
+        m_backend->BindFramebuffer( this );
+    }
+
+    void Unbind() const override
+    {
+        m_backend->BindFramebuffer( nullptr );
+    }
+
+    uint32_t GetColorTextureHandle() const override
+    {
+        return m_colorTexture;
+    }
+
+    int GetWidth() const override
+    {
+        return m_width;
+    }
+
+    int GetHeight() const override
+    {
+        return m_height;
+    }
+
+    void ResetResources() override
+    {
+    }
+};
+
+
+RenderBackendNull::RenderBackendNull()
+    : m_width( 0 ), m_height( 0 ), m_depthTestEnabled( true ), m_blendEnabled( false ), m_blendSrc( BlendFactor::One ), m_blendDst( BlendFactor::Zero ), m_cullFaceEnabled( false ), m_polygonOffsetEnabled( false ), m_polygonOffsetFactor( 0.0f ), m_polygonOffsetUnits( 0.0f ), m_clipPlanesEnabled( 0 ), m_viewport{}, m_clearColor{ 0.0f, 0.0f, 0.0f, 1.0f }, m_clearDepth( 1.0f ), m_boundShader( nullptr ), m_boundFramebuffer( nullptr ), m_nextTexture( 1 ), m_nextDynamicVB( 1 ), m_uploadUsed( 0 ), m_pendingCaptures( 0 ), m_frameStats{}, m_sessionStats{}, m_lastMarkerIndex( -1 ), m_frameCount( 0 )
+{
+}
+
+
+RenderBackendNull::~RenderBackendNull()
+{
+    WriteReport();
+}
+
+
+RenderCallStats& RenderBackendNull::GetMarkerStats()
+{
+#if defined( SKULLBONEZ_PROFILE_ENABLED )
+    const char* marker = Basics::Profiler::Instance().GetOpenMarker();
+#else
+    const char* marker = nullptr;
+#endif
+    if ( !marker )
+    {
+        marker = "(outside frame)";
+    }
+
+    if ( m_lastMarkerIndex >= 0 && m_markerStats[m_lastMarkerIndex].marker == marker )
+    {
+        return m_markerStats[m_lastMarkerIndex].stats;
+    }
+    for ( size_t i = 0; i < m_markerStats.size(); ++i )
+    {
+        if ( m_markerStats[i].marker == marker || strcmp( m_markerStats[i].marker, marker ) == 0 )
+        {
+            m_lastMarkerIndex = static_cast<int>( i );
+            return m_markerStats[i].stats;
+        }
+    }
+    m_markerStats.push_back( { marker, RenderCallStats{} } );
+    m_lastMarkerIndex = static_cast<int>( m_markerStats.size() - 1 );
+    return m_markerStats.back().stats;
+}
+
+
+void RenderBackendNull::Record( int64_t RenderCallStats::*field, int64_t value )
+{
+    m_frameStats.*field += value;
+    GetMarkerStats().*field += value;
+}
+
+
+void RenderBackendNull::RecordState( bool isChange )
+{
+    Record( isChange ? &RenderCallStats::stateChanges : &RenderCallStats::redundantStates, 1 );
+}
+
+
+void RenderBackendNull::BindShader( const void* shader )
+{
+    RecordState( shader != m_boundShader );
+    m_boundShader = shader;
+}
+
+
+void RenderBackendNull::BindFramebuffer( const void* framebuffer )
+{
+    RecordState( framebuffer != m_boundFramebuffer );
+    m_boundFramebuffer = framebuffer;
+}
+
+
+void RenderBackendNull::WriteReport() const
+{
+    if ( Cfg().nullRendererStats.empty() || m_frameCount == 0 )
+    {
+        return;
+    }
+
+    FILE* f = nullptr;
+    if ( fopen_s( &f, Cfg().nullRendererStats.c_str(), "w" ) != 0 || !f )
+    {
+        fprintf( stderr, "Null renderer: cannot write %s\n", Cfg().nullRendererStats.c_str() );
+        return;
+    }
+
+    auto writeRow = [f]( const char* scope, const RenderCallStats& s, int frames )
+    {
+        const int64_t values[] = { s.drawCalls, s.instances, s.vertices, s.uploadBytes, s.resourceBytes,
+                                   s.stateChanges, s.redundantStates, s.uniformSets, s.textureBinds, s.clears };
+        fprintf( f, "%s,%d", scope, frames );
+        for ( int64_t value : values )
+        {
+            fprintf( f, ",%lld", static_cast<long long>( value ) );
+        }
+        fprintf( f, "\n" );
+    };
+
+    // Totals over the session; divide by frames for per-frame averages
+    fprintf( f, "scope,frames,draws,instances,vertices,upload_bytes,resource_bytes,state_changes,redundant_states,uniform_sets,texture_binds,clears\n" );
+    writeRow( "Session", m_sessionStats, m_frameCount );
+    for ( const MarkerCallStats& entry : m_markerStats )
+    {
+        writeRow( entry.marker, entry.stats, m_frameCount );
+    }
+    fclose( f );
+}
+
+
+const RenderCallStats& RenderBackendNull::GetSessionStats() const
+{
+    return m_sessionStats;
+}
+
+
+const std::vector<MarkerCallStats>& RenderBackendNull::GetMarkerCallStats() const
+{
+    return m_markerStats;
+}
+
+
+int RenderBackendNull::GetFrameCount() const
+{
+    return m_frameCount;
+}
+
+
+bool RenderBackendNull::Init( HWND, HDC, int width, int height )
+{
+    m_width = width;
+    m_height = height;
+    m_viewport[2] = width;
+    m_viewport[3] = height;
+    return true;
+}
+
+
+void RenderBackendNull::Shutdown()
+{
+}
+
+
+void RenderBackendNull::Present()
+{
+    PROFILE_COUNTER_ADD( "Gfx/Draws", m_frameStats.drawCalls );
+    PROFILE_COUNTER_ADD( "Gfx/Instances", m_frameStats.instances );
+    PROFILE_COUNTER_ADD( "Gfx/Vertices", m_frameStats.vertices );
+    PROFILE_COUNTER_ADD( "Gfx/UploadBytes", m_frameStats.uploadBytes );
+    PROFILE_COUNTER_ADD( "Gfx/ResourceBytes", m_frameStats.resourceBytes );
+    PROFILE_COUNTER_ADD( "Gfx/StateChanges", m_frameStats.stateChanges );
+    PROFILE_COUNTER_ADD( "Gfx/UniformSets", m_frameStats.uniformSets );
+    PROFILE_COUNTER_ADD( "Gfx/TextureBinds", m_frameStats.textureBinds );
+
+    m_sessionStats.drawCalls += m_frameStats.drawCalls;
+    m_sessionStats.instances += m_frameStats.instances;
+    m_sessionStats.vertices += m_frameStats.vertices;
+    m_sessionStats.uploadBytes += m_frameStats.uploadBytes;
+    m_sessionStats.resourceBytes += m_frameStats.resourceBytes;
+    m_sessionStats.stateChanges += m_frameStats.stateChanges;
+    m_sessionStats.redundantStates += m_frameStats.redundantStates;
+    m_sessionStats.uniformSets += m_frameStats.uniformSets;
+    m_sessionStats.textureBinds += m_frameStats.textureBinds;
+    m_sessionStats.clears += m_frameStats.clears;
+    m_frameStats = RenderCallStats{};
+    ++m_frameCount;
+
+    // Every span of the frame has been consumed
+    m_retired.clear();
+    m_uploadUsed = 0;
+    m_boundFramebuffer = nullptr;
+}
+
+
+void RenderBackendNull::WaitForFrameSlot()
+{
+}
+
+
+void RenderBackendNull::Finish()
+{
+}
+
+
+void RenderBackendNull::FlushGPU()
+{
+}
+
+
+void RenderBackendNull::Resize( int width, int height )
+{
+    m_width = width;
+    m_height = height;
+}
+
+
+void RenderBackendNull::SetViewport( int x, int y, int w, int h )
+{
+    RecordState( x != m_viewport[0] || y != m_viewport[1] || w != m_viewport[2] || h != m_viewport[3] );
+    m_viewport[0] = x;
+    m_viewport[1] = y;
+    m_viewport[2] = w;
+    m_viewport[3] = h;
+}
+
+
+void RenderBackendNull::Clear( bool color, bool depth )
+{
+    if ( color || depth )
+    {
+        Record( &RenderCallStats::clears, 1 );
+    }
+}
+
+
+void RenderBackendNull::SetClearColor( float r, float g, float b, float a )
+{
+    RecordState( r != m_clearColor[0] || g != m_clearColor[1] || b != m_clearColor[2] || a != m_clearColor[3] );
+    m_clearColor[0] = r;
+    m_clearColor[1] = g;
+    m_clearColor[2] = b;
+    m_clearColor[3] = a;
+}
+
+
+void RenderBackendNull::SetClearDepth( float depth )
+{
+    RecordState( depth != m_clearDepth );
+    m_clearDepth = depth;
+}
+
+
+void RenderBackendNull::SetDepthTest( bool enable )
+{
+    RecordState( enable != m_depthTestEnabled );
+    m_depthTestEnabled = enable;
+}
+
+
+void RenderBackendNull::SetBlend( bool enable )
+{
+    RecordState( enable != m_blendEnabled );
+    m_blendEnabled = enable;
+}
+
+
+void RenderBackendNull::SetBlendFunc( BlendFactor src, BlendFactor dst )
+{
+    RecordState( src != m_blendSrc || dst != m_blendDst );
+    m_blendSrc = src;
+    m_blendDst = dst;
+}
+
+
+void RenderBackendNull::SetCullFace( bool enable )
+{
+    RecordState( enable != m_cullFaceEnabled );
+    m_cullFaceEnabled = enable;
+}
+
+
+void RenderBackendNull::SetPolygonOffset( bool enable, float factor, float units )
+{
+    RecordState( enable != m_polygonOffsetEnabled || ( enable && ( factor != m_polygonOffsetFactor || units != m_polygonOffsetUnits ) ) );
+    m_polygonOffsetEnabled = enable;
+    m_polygonOffsetFactor = factor;
+    m_polygonOffsetUnits = units;
+}
+
+
+void RenderBackendNull::SetClipPlane( int index, bool enable )
+{
+    uint32_t bit = 1u << ( index & 31 );
+    RecordState( ( ( m_clipPlanesEnabled & bit ) != 0 ) != enable );
+    m_clipPlanesEnabled = enable ? ( m_clipPlanesEnabled | bit ) : ( m_clipPlanesEnabled & ~bit );
+}
+
+
+std::unique_ptr<IShader> RenderBackendNull::CreateShader( const char*, const char* )
+{
+    return std::make_unique<NullShader>( this );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendNull::CreateMesh( const float*, int vertexCount, bool hasNormals, bool hasTexCoords )
+{
+    if ( hasNormals && !hasTexCoords )
+    {
+        throw std::runtime_error( "Meshes with normals must also have texture coordinates.  (RenderBackendNull::CreateMesh)" );
+    }
+
+    int stride = static_cast<int>( sizeof( float ) ) * ( 3 + ( hasNormals ? 3 : 0 ) + ( hasTexCoords ? 2 : 0 ) );
+    Record( &RenderCallStats::resourceBytes, static_cast<int64_t>( vertexCount ) * stride );
+    return std::make_unique<NullMesh>( this, vertexCount, 0, stride );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendNull::CreateIndexedMesh( const void*, int vertexCount, VertexFormat format, const void*, int indexCount, IndexFormat indexFormat )
+{
+    int stride = GetVertexStride( format );
+    if ( indexFormat == IndexFormat::None )
+    {
+        indexCount = 0;
+    }
+    Record( &RenderCallStats::resourceBytes, static_cast<int64_t>( vertexCount ) * stride + static_cast<int64_t>( indexCount ) * GetIndexSize( indexFormat ) );
+    return std::make_unique<NullMesh>( this, vertexCount, indexCount, stride );
+}
+
+
+std::unique_ptr<IFramebuffer> RenderBackendNull::CreateFramebuffer( int width, int height )
+{
+    return std::make_unique<NullFramebuffer>( this, m_nextTexture++, width, height );
+}
+
+
+uint32_t RenderBackendNull::CreateTexture2D( const uint8_t*, int w, int h, int channels, bool generateMips, bool )
+{
+    // A full mip chain adds about a third
+    int64_t bytes = static_cast<int64_t>( w ) * h * channels;
+    Record( &RenderCallStats::resourceBytes, generateMips ? bytes * 4 / 3 : bytes );
+    return m_nextTexture++;
+}
+
+
+uint32_t RenderBackendNull::CreateTexture2DMips( const uint8_t*, int w, int h, int channels, int mipCount, bool )
+{
+    int64_t bytes = 0;
+    for ( int level = 0; level < mipCount; ++level )
+    {
+        bytes += static_cast<int64_t>( w ) * h * channels;
+        w = ( std::max )( w / 2, 1 );
+        h = ( std::max )( h / 2, 1 );
+    }
+    Record( &RenderCallStats::resourceBytes, bytes );
+    return m_nextTexture++;
+}
+
+
+void RenderBackendNull::BindTexture( uint32_t, int )
+{
+    Record( &RenderCallStats::textureBinds, 1 );
+}
+
+
+void RenderBackendNull::DeleteTexture( uint32_t )
+{
+}
+
+
+std::vector<uint8_t> RenderBackendNull::CaptureBackbuffer( int& outWidth, int& outHeight )
+{
+    outWidth = m_width;
+    outHeight = m_height;
+    return std::vector<uint8_t>( static_cast<size_t>( m_width ) * m_height * 3, 0 );
+}
+
+
+bool RenderBackendNull::RequestBackbufferCapture()
+{
+    if ( m_pendingCaptures >= CAPTURE_SLOTS )
+    {
+        return false;
+    }
+    ++m_pendingCaptures;
+    return true;
+}
+
+
+bool RenderBackendNull::PollBackbufferCapture( CapturedImage& out, bool )
+{
+    if ( m_pendingCaptures == 0 )
+    {
+        return false;
+    }
+    --m_pendingCaptures;
+
+    out.width = m_width;
+    out.height = m_height;
+    out.rowPitch = m_width * 4;
+    out.isBottomUp = false;
+    out.pixels.assign( static_cast<size_t>( out.rowPitch ) * m_height, 0 );
+    return true;
+}
+
+
+int RenderBackendNull::GetWidth() const
+{
+    return m_width;
+}
+
+
+int RenderBackendNull::GetHeight() const
+{
+    return m_height;
+}
+
+
+bool RenderBackendNull::IsDepthTestEnabled() const
+{
+    return m_depthTestEnabled;
+}
+
+
+bool RenderBackendNull::IsBlendEnabled() const
+{
+    return m_blendEnabled;
+}
+
+
+bool RenderBackendNull::UsesZeroToOneDepth() const
+{
+    return false;
+}
+
+
+UploadSpan RenderBackendNull::AllocateUpload( int floatCount )
+{
+    UploadSpan span = {};
+    if ( floatCount <= 0 )
+    {
+        return span;
+    }
+
+    size_t count = static_cast<size_t>( floatCount );
+    if ( m_uploadUsed + count > m_upload.size() )
+    {
+        // Moving the block keeps its storage (and the spans pointing into it) alive until Present
+        size_t size = ( std::max )( ( std::max )( m_upload.size() * 2, MIN_UPLOAD_FLOATS ), count );
+        if ( !m_upload.empty() )
+        {
+            m_retired.push_back( std::move( m_upload ) );
+        }
+        m_upload.assign( size, 0.0f );
+        m_uploadUsed = 0;
+    }
+
+    span.data = m_upload.data() + m_uploadUsed;
+    span.buffer = 1;
+    span.offset = static_cast<uint32_t>( m_uploadUsed * sizeof( float ) );
+    m_uploadUsed += count;
+    Record( &RenderCallStats::uploadBytes, static_cast<int64_t>( count * sizeof( float ) ) );
+    return span;
+}
+
+
+uint32_t RenderBackendNull::CreateDynamicVB( const int*, int )
+{
+    return m_nextDynamicVB++;
+}
+
+
+void RenderBackendNull::DrawDynamicVB( uint32_t, const UploadSpan& vertices, int vertexCount )
+{
+    if ( !vertices.data || vertexCount <= 0 )
+    {
+        return;
+    }
+    Record( &RenderCallStats::drawCalls, 1 );
+    Record( &RenderCallStats::instances, 1 );
+    Record( &RenderCallStats::vertices, vertexCount );
+}
+
+
+void RenderBackendNull::DestroyDynamicVB( uint32_t )
+{
+}
+
+
+uint32_t RenderBackendNull::CreateInstancedMesh( const float*, int staticVertCount, int staticFloatsPerVert, int, int, const int*, int, const int*, int, const uint16_t* indices, int indexCount )
+{
+    int64_t indexBytes = indices ? static_cast<int64_t>( indexCount ) * sizeof( uint16_t ) : 0;
+    Record( &RenderCallStats::resourceBytes, static_cast<int64_t>( staticVertCount ) * staticFloatsPerVert * sizeof( float ) + indexBytes );
+
+    m_instancedMeshes.push_back( true );
+    return static_cast<uint32_t>( m_instancedMeshes.size() ); // 1-based; 0 means no mesh
+}
+
+
+void RenderBackendNull::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances )
+{
+    if ( handle == 0 || handle > m_instancedMeshes.size() || !m_instancedMeshes[handle - 1] || instanceCount <= 0 || !instances.data )
+    {
+        return;
+    }
+    Record( &RenderCallStats::drawCalls, 1 );
+    Record( &RenderCallStats::instances, instanceCount );
+    Record( &RenderCallStats::vertices, static_cast<int64_t>( staticVertCount ) * instanceCount );
+}
+
+
+void RenderBackendNull::DestroyInstancedMesh( uint32_t handle )
+{
+    if ( handle != 0 && handle <= m_instancedMeshes.size() )
+    {
+        m_instancedMeshes[handle - 1] = false;
+    }
+}
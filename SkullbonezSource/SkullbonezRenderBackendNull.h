@@ -0,0 +1,165 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezIRenderBackend.h"
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+
+// Call and bandwidth totals recorded by RenderBackendNull
+struct RenderCallStats
+{
+    int64_t drawCalls;       // Mesh, instanced mesh and dynamic vertex buffer draws
+    int64_t instances;       // Instances drawn (1 per non-instanced draw)
+    int64_t vertices;        // Vertices (indices for indexed meshes) processed, over all instances
+    int64_t uploadBytes;     // Streamed through AllocateUpload (instance data, dynamic vertices)
+    int64_t resourceBytes;   // Static vertex, index and texture data created or updated
+    int64_t stateChanges;    // Depth, blend, raster, clip, viewport, clear value, render target and shader changes
+    int64_t redundantStates; // State calls that set what was already set
+    int64_t uniformSets;     // Shader uniform setter calls
+    int64_t textureBinds;    // BindTexture calls
+    int64_t clears;          // Clear calls
+};
+
+
+// Totals of the calls made while one profiler marker was innermost
+struct MarkerCallStats
+{
+    const char* marker; // Profiler marker path literal
+    RenderCallStats stats;
+};
+
+
+/* -- RenderBackendNull ------------------------------------------------------------------------------------------------------------------------------------------
+
+    Backend that does no GPU work and records every call instead: draws, instances, vertices, streamed and static
+    upload bytes, state changes (and redundant state calls), uniform sets, texture binds and clears.  Shaders,
+    meshes and framebuffers it creates report into the same totals.  Selected with --renderer null, it runs the
+    whole render path on machines without a usable GPU, so CPU-side render cost and draw-call counts can be
+    tracked on their own.
+
+    Each frame's totals are published as Gfx profiler counters at Present (and so reach the perf CSV); every
+    call is also attributed to the innermost open profiler marker.  On destruction the session totals, overall
+    and per marker, are written to the null_renderer_stats path as CSV.  Upload spans point into plain memory
+    that is recycled at Present; captures return black images.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class RenderBackendNull : public IRenderBackend
+{
+
+  private:
+    int m_width;
+    int m_height;
+
+    // Tracked state, to tell changes from redundant calls
+    bool m_depthTestEnabled;
+    bool m_blendEnabled;
+    BlendFactor m_blendSrc;
+    BlendFactor m_blendDst;
+    bool m_cullFaceEnabled;
+    bool m_polygonOffsetEnabled;
+    float m_polygonOffsetFactor;
+    float m_polygonOffsetUnits;
+    uint32_t m_clipPlanesEnabled; // Bit per clip plane index
+    int m_viewport[4];
+    float m_clearColor[4];
+    float m_clearDepth;
+    const void* m_boundShader;      // Last shader made current
+    const void* m_boundFramebuffer; // Bound render target (nullptr = backbuffer)
+
+    // Resources
+    uint32_t m_nextTexture;
+    uint32_t m_nextDynamicVB;
+    std::vector<bool> m_instancedMeshes; // Live flag per handle - 1
+
+    // Upload memory: spans stay valid until Present, so a full block is retired rather than reallocated
+    std::vector<float> m_upload;
+    size_t m_uploadUsed;                       // Floats handed out from m_upload this frame
+    std::vector<std::vector<float>> m_retired; // Blocks outgrown this frame, freed at Present
+    int m_pendingCaptures;
+
+    // Statistics
+    RenderCallStats m_frameStats;
+    RenderCallStats m_sessionStats;
+    std::vector<MarkerCallStats> m_markerStats;
+    int m_lastMarkerIndex; // Cache: marker of the previous call (most calls repeat it)
+    int m_frameCount;
+
+    RenderCallStats& GetMarkerStats(); // Totals of the innermost open profiler marker
+    void WriteReport() const;          // Session totals to Cfg().nullRendererStats (no-op when empty)
+
+  public:
+    RenderBackendNull();
+    ~RenderBackendNull() override; // Writes the report
+
+    // Adds value to one statistic of the current frame and marker (also used by the null shader, mesh and framebuffer)
+    void Record( int64_t RenderCallStats::*field, int64_t value );
+    void RecordState( bool isChange ); // Counts a state call as a change or as redundant
+    void BindShader( const void* shader );
+    void BindFramebuffer( const void* framebuffer );
+
+    const RenderCallStats& GetSessionStats() const;
+    const std::vector<MarkerCallStats>& GetMarkerCallStats() const;
+    int GetFrameCount() const;
+
+    bool Init( HWND hwnd, HDC hdc, int width, int height ) override;
+    void Shutdown() override;
+    void Present() override;
+    void WaitForFrameSlot() override;
+    void Finish() override;
+    void FlushGPU() override;
+    void Resize( int width, int height ) override;
+
+    void SetViewport( int x, int y, int w, int h ) override;
+    void Clear( bool color, bool depth ) override;
+    void SetClearColor( float r, float g, float b, float a ) override;
+    void SetClearDepth( float depth ) override;
+
+    void SetDepthTest( bool enable ) override;
+    void SetBlend( bool enable ) override;
+    void SetBlendFunc( BlendFactor src, BlendFactor dst ) override;
+    void SetCullFace( bool enable ) override;
+    void SetPolygonOffset( bool enable, float factor = 0.0f, float units = 0.0f ) override;
+    void SetClipPlane( int index, bool enable ) override;
+
+    std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) override;
+    std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) override;
+    std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) override;
+    std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) override;
+
+    uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) override;
+    uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) override;
+    void BindTexture( uint32_t handle, int slot ) override;
+    void DeleteTexture( uint32_t handle ) override;
+
+    std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) override;
+    bool RequestBackbufferCapture() override;
+    bool PollBackbufferCapture( CapturedImage& out, bool wait ) override;
+
+    int GetWidth() const override;
+    int GetHeight() const override;
+
+    bool IsDepthTestEnabled() const override;
+    bool IsBlendEnabled() const override;
+    bool UsesZeroToOneDepth() const override;
+    const char* GetRendererName() const override
+    {
+        return "Null";
+    }
+
+    UploadSpan AllocateUpload( int floatCount ) override;
+
+    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) override;
+    void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) override;
+    void DestroyDynamicVB( uint32_t handle ) override;
+
+    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) override;
+    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) override;
+    void DestroyInstancedMesh( uint32_t handle ) override;
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
@@ -0,0 +1,1013 @@
+// --- Includes ---
+#include "SkullbonezRenderCapture.h"
+#include "SkullbonezConfig.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
+using namespace SkullbonezCore::Math::Transformation;
+
+
+static constexpr size_t FLUSH_BYTES = 4 * 1024 * 1024;  // Pending stream bytes written out at once
+static constexpr size_t MIN_STAGING_FLOATS = 64 * 1024; // First staging block (grows by doubling)
+
+
+/* -- CaptureShader ----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Records Use() and every uniform set.  Handles given out are indices into the handles resolved on the wrapped
+    shader, so the stream can name them independently of the backend that issued them.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class CaptureShader : public IShader
+{
+
+  private:
+    RenderBackendCapture* m_capture;
+    std::unique_ptr<IShader> m_inner;
+    uint32_t m_id;
+    mutable std::vector<UniformHandle> m_handles; // Index = handle given out
+
+    UniformHandle Inner( UniformHandle handle ) const
+    {
+        int index = static_cast<int>( handle );
+        return index >= 0 && index < static_cast<int>( m_handles.size() ) ? m_handles[index] : UniformHandle::Invalid;
+    }
+
+    bool BeginByName( RenderOp op, const char* name ) const
+    {
+        uint16_t nameId = m_capture->InternString( name );
+        if ( !m_capture->BeginOp( op ) )
+        {
+            return false;
+        }
+        m_capture->Put( m_id );
+        m_capture->Put( nameId );
+        return true;
+    }
+
+    bool BeginByHandle( RenderOp op, UniformHandle handle ) const
+    {
+        if ( handle == UniformHandle::Invalid || !m_capture->BeginOp( op ) )
+        {
+            return false;
+        }
+        m_capture->Put( m_id );
+        m_capture->Put( static_cast<int32_t>( handle ) );
+        return true;
+    }
+
+  public:
+    CaptureShader( RenderBackendCapture* capture, std::unique_ptr<IShader> inner, uint32_t id )
+        : m_capture( capture ), m_inner( std::move( inner ) ), m_id( id )
+    {
+    }
+
+    ~CaptureShader() override
+    {
+        if ( m_capture->BeginOp( RenderOp::DestroyShader ) )
+        {
+            m_capture->Put( m_id );
+        }
+    }
+
+    void Use() const override
+    {
+        if ( m_capture->BeginOp( RenderOp::UseShader ) )
+        {
+            m_capture->Put( m_id );
+        }
+        m_inner->Use();
+    }
+
+    void SetInt( const char* name, int value ) const override
+    {
+        if ( BeginByName( RenderOp::SetIntByName, name ) )
+        {
+            m_capture->Put( static_cast<int32_t>( value ) );
+        }
+        m_inner->SetInt( name, value );
+    }
+    void SetFloat( const char* name, float value ) const override
+    {
+        if ( BeginByName( RenderOp::SetFloatByName, name ) )
+        {
+            m_capture->Put( value );
+        }
+        m_inner->SetFloat( name, value );
+    }
+    void SetVec3( const char* name, const Vector3& v ) const override
+    {
+        SetVec3( name, v.x, v.y, v.z );
+    }
+    void SetVec3( const char* name, float x, float y, float z ) const override
+    {
+        if ( BeginByName( RenderOp::SetVec3ByName, name ) )
+        {
+            const float values[3] = { x, y, z };
+            m_capture->PutRaw( values, sizeof( values ) );
+        }
+        m_inner->SetVec3( name, x, y, z );
+    }
+    void SetVec4( const char* name, float x, float y, float z, float w ) const override
+    {
+        if ( BeginByName( RenderOp::SetVec4ByName, name ) )
+        {
+            const float values[4] = { x, y, z, w };
+            m_capture->PutRaw( values, sizeof( values ) );
+        }
+        m_inner->SetVec4( name, x, y, z, w );
+    }
+    void SetMat4( const char* name, const Matrix4& mat ) const override
+    {
+        if ( BeginByName( RenderOp::SetMat4ByName, name ) )
+        {
+            m_capture->PutRaw( mat.m, sizeof( mat.m ) );
+        }
+        m_inner->SetMat4( name, mat );
+    }
+
+    UniformHandle GetUniformHandle( const char* name ) const override
+    {
+        UniformHandle inner = m_inner->GetUniformHandle( name );
+        if ( inner == UniformHandle::Invalid )
+        {
+            return UniformHandle::Invalid;
+        }
+        auto it = std::find( m_handles.begin(), m_handles.end(), inner );
+        if ( it != m_handles.end() )
+        {
+            return static_cast<UniformHandle>( it - m_handles.begin() );
+        }
+
+        // Recorded in every phase: later sets refer to the handle by index
+        int32_t index = static_cast<int32_t>( m_handles.size() );
+        m_handles.push_back( inner );
+        if ( BeginByName( RenderOp::ResolveUniform, name ) )
+        {
+            m_capture->Put( index );
+        }
+        return static_cast<UniformHandle>( index );
+    }
+
+    void SetInt( UniformHandle handle, int value ) const override
+    {
+        if ( BeginByHandle( RenderOp::SetInt, handle ) )
+        {
+            m_capture->Put( static_cast<int32_t>( value ) );
+        }
+        m_inner->SetInt( Inner( handle ), value );
+    }
+    void SetFloat( UniformHandle handle, float value ) const override
+    {
+        if ( BeginByHandle( RenderOp::SetFloat, handle ) )
+        {
+            m_capture->Put( value );
+        }
+        m_inner->SetFloat( Inner( handle ), value );
+    }
+    void SetVec3( UniformHandle handle, const Vector3& v ) const override
+    {
+        SetVec3( handle, v.x, v.y, v.z );
+    }
+    void SetVec3( UniformHandle handle, float x, float y, float z ) const override
+    {
+        if ( BeginByHandle( RenderOp::SetVec3, handle ) )
+        {
+            const float values[3] = { x, y, z };
+            m_capture->PutRaw( values, sizeof( values ) );
+        }
+        m_inner->SetVec3( Inner( handle ), x, y, z );
+    }
+    void SetVec4( UniformHandle handle, float x, float y, float z, float w ) const override
+    {
+        if ( BeginByHandle( RenderOp::SetVec4, handle ) )
+        {
+            const float values[4] = { x, y, z, w };
+            m_capture->PutRaw( values, sizeof( values ) );
+        }
+        m_inner->SetVec4( Inner( handle ), x, y, z, w );
+    }
+    void SetMat4( UniformHandle handle, const Matrix4& mat ) const override
+    {
+        if ( BeginByHandle( RenderOp::SetMat4, handle ) )
+        {
+            m_capture->PutRaw( mat.m, sizeof( mat.m ) );
+        }
+        m_inner->SetMat4( Inner( handle ), mat );
+    }
+};
+
+
+/* -- CaptureMesh ------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Records draws and vertex updates (with the new vertex bytes) of a wrapped mesh.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class CaptureMesh : public IMesh
+{
+
+  private:
+    RenderBackendCapture* m_capture;
+    std::unique_ptr<IMesh> m_inner;
+    uint32_t m_id;
+    int m_stride; // Bytes per vertex
+
+  public:
+    CaptureMesh( RenderBackendCapture* capture, std::unique_ptr<IMesh> inner, uint32_t id, int stride )
+        : m_capture( capture ), m_inner( std::move( inner ) ), m_id( id ), m_stride( stride )
+    {
+    }
+
+    ~CaptureMesh() override
+    {
+        if ( m_capture->BeginOp( RenderOp::DestroyMesh ) )
+        {
+            m_capture->Put( m_id );
+        }
+    }
+
+    void Draw() const override
+    {
+        if ( m_capture->BeginOp( RenderOp::DrawMesh ) )
+        {
+            m_capture->Put( m_id );
+        }
+        m_inner->Draw();
+    }
+
+    void DrawInstanced( int instanceCount ) const override
+    {
+        if ( m_capture->BeginOp( RenderOp::DrawMeshInstanced ) )
+        {
+            m_capture->Put( m_id );
+            m_capture->Put( static_cast<int32_t>( instanceCount ) );
+        }
+        m_inner->DrawInstanced( instanceCount );
+    }
+
+    int GetVertexCount() const override
+    {
+        return m_inner->GetVertexCount();
+    }
+
+    int GetIndexCount() const override
+    {
+        return m_inner->GetIndexCount();
+    }
+
+    void UpdateVertices( int firstVertex, int vertexCount, const void* data ) override
+    {
+        if ( m_capture->BeginOp( RenderOp::UpdateMeshVertices ) )
+        {
+            m_capture->Put( m_id );
+            m_capture->Put( static_cast<int32_t>( firstVertex ) );
+            m_capture->Put( static_cast<int32_t>( vertexCount ) );
+            m_capture->PutData( data, static_cast<size_t>( vertexCount ) * m_stride );
+        }
+        m_inner->UpdateVertices( firstVertex, vertexCount, data );
+    }
+};
+
+
+/* -- CaptureFramebuffer -----------------------------------------------------------------------------------------------------------------------------------------
+
+    Records binds and resets of a wrapped framebuffer.  Its colour texture handle is recorded whenever it is
+    handed out with a new value, so replay can map binds of it to its own framebuffer's texture.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class CaptureFramebuffer : public IFramebuffer
+{
+
+  private:
+    RenderBackendCapture* m_capture;
+    std::unique_ptr<IFramebuffer> m_inner;
+    uint32_t m_id;
+    mutable uint32_t m_recordedTexture; // Colour handle last recorded (0 = none)
+
+    void RecordOp( RenderOp op ) const
+    {
+        if ( m_capture->BeginOp( op ) )
+        {
+            m_capture->Put( m_id );
+        }
+    }
+
+  public:
+    CaptureFramebuffer( RenderBackendCapture* capture, std::unique_ptr<IFramebuffer> inner, uint32_t id )
+        : m_capture( capture ), m_inner( std::move( inner ) ), m_id( id ), m_recordedTexture( 0 )
+    {
+    }
+
+    ~CaptureFramebuffer() override
+    {
+        RecordOp( RenderOp::DestroyFramebuffer );
+    }
+
+    void Bind() const override
+    {
+        RecordOp( RenderOp::BindFramebuffer );
+        m_inner->Bind();
+    }
+
+    void Unbind() const override
+    {
+        RecordOp( RenderOp::UnbindFramebuffer );
+        m_inner->Unbind();
+    }
+
+    uint32_t GetColorTextureHandle() const override
+    {
+        uint32_t handle = m_inner->GetColorTextureHandle();
+        if ( handle != m_recordedTexture && m_capture->BeginOp( RenderOp::FramebufferTexture ) )
+        {
+            m_capture->Put( m_id );
+            m_capture->Put( handle );
+            m_recordedTexture = handle;
+        }
+        return handle;
+    }
+
+    int GetWidth() const override
+    {
+        return m_inner->GetWidth();
+    }
+
+    int GetHeight() const override
+    {
+        return m_inner->GetHeight();
+    }
+
+    void ResetResources() override
+    {
+        RecordOp( RenderOp::ResetFramebuffer );
+        m_inner->ResetResources();
+    }
+};
+
+
+RenderBackendCapture::RenderBackendCapture( std::unique_ptr<IRenderBackend> inner, const char* path )
+    : m_inner( std::move( inner ) ),
+      m_file( nullptr ),
+      m_path( path ),
+      m_written( 0 ),
+      m_phase( Phase::Prologue ),
+      m_presentCount( 0 ),
+      m_frameCount( 0 ),
+      m_nextShaderId( 0 ),
+      m_nextMeshId( 0 ),
+      m_nextFramebufferId( 0 ),
+      m_stagingUsed( 0 )
+{
+    if ( fopen_s( &m_file, path, "wb" ) != 0 || !m_file )
+    {
+        // The wrapped backend is already ours: keep rendering, just without recording
+        fprintf( stderr, "WARNING: cannot create render capture %s -- not capturing\n", path );
+        m_file = nullptr;
+        m_phase = Phase::Done;
+        return;
+    }
+
+    RenderCaptureHeader header = {};
+    memcpy( header.magic, "SBRC", 4 );
+    header.version = RENDER_CAPTURE_VERSION;
+    header.width = m_inner->GetWidth();
+    header.height = m_inner->GetHeight();
+    PutRaw( &header, sizeof( header ) );
+
+    if ( Cfg().renderCaptureStartFrame <= 0 && BeginOp( RenderOp::BeginFrames ) )
+    {
+        m_phase = Phase::Frames;
+    }
+}
+
+
+RenderBackendCapture::~RenderBackendCapture()
+{
+    if ( m_phase != Phase::Done )
+    {
+        // Ended early (quit, or a short scene): drop the unfinished frame, which holds the engine's
+        // teardown, so the replay loops end on the last presented frame
+        if ( m_phase == Phase::Frames )
+        {
+            m_buffer.clear();
+        }
+        Close();
+    }
+}
+
+
+void RenderBackendCapture::Flush()
+{
+    if ( !m_buffer.empty() )
+    {
+        fwrite( m_buffer.data(), 1, m_buffer.size(), m_file );
+        m_buffer.clear();
+    }
+}
+
+
+void RenderBackendCapture::Close()
+{
+    m_buffer.push_back( static_cast<uint8_t>( RenderOp::EndOfStream ) );
+    Flush();
+
+    // The frame count is only known now
+    fseek( m_file, static_cast<long>( offsetof( RenderCaptureHeader, frameCount ) ), SEEK_SET );
+    fwrite( &m_frameCount, sizeof( m_frameCount ), 1, m_file );
+    fclose( m_file );
+    m_file = nullptr;
+    m_phase = Phase::Done;
+    printf( "Render capture: %u frames written to %s\n", m_frameCount, m_path.c_str() );
+}
+
+
+bool RenderBackendCapture::BeginOp( RenderOp op )
+{
+    switch ( m_phase )
+    {
+    case Phase::Done:
+        return false;
+    case Phase::Prologue:
+        switch ( op )
+        {
+        case RenderOp::Present:
+        case RenderOp::WaitForFrameSlot:
+        case RenderOp::Finish:
+        case RenderOp::Clear:
+        case RenderOp::DrawMesh:
+        case RenderOp::DrawMeshInstanced:
+        case RenderOp::DrawDynamicVB:
+        case RenderOp::DrawInstancedMesh:
+            return false;
+        default:
+            break;
+        }
+        break;
+    case Phase::Frames:
+        break;
+    }
+    m_buffer.push_back( static_cast<uint8_t>( op ) );
+    ++m_written;
+    return true;
+}
+
+
+void RenderBackendCapture::PutRaw( const void* data, size_t size )
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>( data );
+    m_buffer.insert( m_buffer.end(), bytes, bytes + size );
+    m_written += size;
+    if ( m_phase != Phase::Frames && m_buffer.size() >= FLUSH_BYTES )
+    {
+        Flush();
+    }
+}
+
+
+void RenderBackendCapture::PutData( const void* data, size_t size )
+{
+    uint32_t size32 = data ? static_cast<uint32_t>( size ) : 0;
+    Put( size32 );
+    static const uint8_t padding[4] = {};
+    PutRaw( padding, ( 4 - m_written % 4 ) % 4 );
+    if ( size32 )
+    {
+        PutRaw( data, size32 );
+    }
+}
+
+
+uint16_t RenderBackendCapture::InternString( const char* text )
+{
+    auto it = m_strings.find( text );
+    if ( it != m_strings.end() )
+    {
+        return it->second;
+    }
+    if ( m_strings.size() >= UINT16_MAX )
+    {
+        throw std::runtime_error( "Too many distinct names for a render capture.  (RenderBackendCapture::InternString)" );
+    }
+
+    // Defined in every phase but Done, where nothing refers to it
+    uint16_t id = static_cast<uint16_t>( m_strings.size() );
+    if ( m_phase != Phase::Done )
+    {
+        m_strings.emplace( text, id );
+        uint16_t length = static_cast<uint16_t>( ( std::min )( strlen( text ), static_cast<size_t>( UINT16_MAX ) ) );
+        BeginOp( RenderOp::DefineString );
+        Put( id );
+        Put( length );
+        PutRaw( text, length );
+    }
+    return id;
+}
+
+
+uint32_t RenderBackendCapture::NextShaderId()
+{
+    return m_nextShaderId++;
+}
+
+
+uint32_t RenderBackendCapture::NextMeshId()
+{
+    return m_nextMeshId++;
+}
+
+
+uint32_t RenderBackendCapture::NextFramebufferId()
+{
+    return m_nextFramebufferId++;
+}
+
+
+UploadSpan RenderBackendCapture::Forward( const UploadSpan& span )
+{
+    if ( span.buffer == 0 || span.offset >= m_spans.size() )
+    {
+        return span;
+    }
+    const std::pair<const float*, int>& staged = m_spans[span.offset];
+    UploadSpan target = m_inner->AllocateUpload( staged.second );
+    if ( target.data )
+    {
+        memcpy( target.data, staged.first, static_cast<size_t>( staged.second ) * sizeof( float ) );
+    }
+    return target;
+}
+
+
+bool RenderBackendCapture::Init( HWND hwnd, HDC hdc, int width, int height )
+{
+    return m_inner->Init( hwnd, hdc, width, height );
+}
+
+
+void RenderBackendCapture::Shutdown()
+{
+    m_inner->Shutdown();
+}
+
+
+void RenderBackendCapture::Present()
+{
+    BeginOp( RenderOp::Present );
+    m_inner->Present();
+
+    ++m_presentCount;
+    m_retired.clear();
+    m_stagingUsed = 0;
+    m_spans.clear();
+
+    // Recorded frames only reach the file once presented
+    if ( m_phase == Phase::Frames )
+    {
+        Flush();
+    }
+
+    if ( m_phase == Phase::Frames && ++m_frameCount >= static_cast<uint32_t>( ( std::max )( Cfg().renderCaptureFrames, 1 ) ) )
+    {
+        Close();
+    }
+    else if ( m_phase == Phase::Prologue && m_presentCount >= Cfg().renderCaptureStartFrame )
+    {
+        m_phase = Phase::Frames;
+        BeginOp( RenderOp::BeginFrames );
+    }
+}
+
+
+void RenderBackendCapture::WaitForFrameSlot()
+{
+    BeginOp( RenderOp::WaitForFrameSlot );
+    m_inner->WaitForFrameSlot();
+}
+
+
+void RenderBackendCapture::Finish()
+{
+    BeginOp( RenderOp::Finish );
+    m_inner->Finish();
+}
+
+
+void RenderBackendCapture::FlushGPU()
+{
+    BeginOp( RenderOp::FlushGPU );
+    m_inner->FlushGPU();
+}
+
+
+void RenderBackendCapture::Resize( int width, int height )
+{
+    m_inner->Resize( width, height );
+}
+
+
+void RenderBackendCapture::SetViewport( int x, int y, int w, int h )
+{
+    if ( BeginOp( RenderOp::SetViewport ) )
+    {
+        const int32_t values[4] = { x, y, w, h };
+        PutRaw( values, sizeof( values ) );
+    }
+    m_inner->SetViewport( x, y, w, h );
+}
+
+
+void RenderBackendCapture::Clear( bool color, bool depth )
+{
+    if ( BeginOp( RenderOp::Clear ) )
+    {
+        Put( static_cast<uint8_t>( ( color ? 1 : 0 ) | ( depth ? 2 : 0 ) ) );
+    }
+    m_inner->Clear( color, depth );
+}
+
+
+void RenderBackendCapture::SetClearColor( float r, float g, float b, float a )
+{
+    if ( BeginOp( RenderOp::SetClearColor ) )
+    {
+        const float values[4] = { r, g, b, a };
+        PutRaw( values, sizeof( values ) );
+    }
+    m_inner->SetClearColor( r, g, b, a );
+}
+
+
+void RenderBackendCapture::SetClearDepth( float depth )
+{
+    if ( BeginOp( RenderOp::SetClearDepth ) )
+    {
+        Put( depth );
+    }
+    m_inner->SetClearDepth( depth );
+}
+
+
+void RenderBackendCapture::SetDepthTest( bool enable )
+{
+    if ( BeginOp( RenderOp::SetDepthTest ) )
+    {
+        Put( static_cast<uint8_t>( enable ) );
+    }
+    m_inner->SetDepthTest( enable );
+}
+
+
+void RenderBackendCapture::SetBlend( bool enable )
+{
+    if ( BeginOp( RenderOp::SetBlend ) )
+    {
+        Put( static_cast<uint8_t>( enable ) );
+    }
+    m_inner->SetBlend( enable );
+}
+
+
+void RenderBackendCapture::SetBlendFunc( BlendFactor src, BlendFactor dst )
+{
+    if ( BeginOp( RenderOp::SetBlendFunc ) )
+    {
+        Put( static_cast<uint8_t>( src ) );
+        Put( static_cast<uint8_t>( dst ) );
+    }
+    m_inner->SetBlendFunc( src, dst );
+}
+
+
+void RenderBackendCapture::SetCullFace( bool enable )
+{
+    if ( BeginOp( RenderOp::SetCullFace ) )
+    {
+        Put( static_cast<uint8_t>( enable ) );
+    }
+    m_inner->SetCullFace( enable );
+}
+
+
+void RenderBackendCapture::SetPolygonOffset( bool enable, float factor, float units )
+{
+    if ( BeginOp( RenderOp::SetPolygonOffset ) )
+    {
+        Put( static_cast<uint8_t>( enable ) );
+        Put( factor );
+        Put( units );
+    }
+    m_inner->SetPolygonOffset( enable, factor, units );
+}
+
+
+void RenderBackendCapture::SetClipPlane( int index, bool enable )
+{
+    if ( BeginOp( RenderOp::SetClipPlane ) )
+    {
+        Put( static_cast<uint8_t>( index ) );
+        Put( static_cast<uint8_t>( enable ) );
+    }
+    m_inner->SetClipPlane( index, enable );
+}
+
+
+std::unique_ptr<IShader> RenderBackendCapture::CreateShader( const char* vertPath, const char* fragPath )
+{
+    std::unique_ptr<IShader> inner = m_inner->CreateShader( vertPath, fragPath );
+    uint32_t id = NextShaderId();
+    uint16_t vertId = InternString( vertPath );
+    uint16_t fragId = InternString( fragPath );
+    if ( BeginOp( RenderOp::CreateShader ) )
+    {
+        Put( id );
+        Put( vertId );
+        Put( fragId );
+    }
+    return std::make_unique<CaptureShader>( this, std::move( inner ), id );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendCapture::CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords )
+{
+    std::unique_ptr<IMesh> inner = m_inner->CreateMesh( data, vertexCount, hasNormals, hasTexCoords );
+    uint32_t id = NextMeshId();
+    int stride = static_cast<int>( ( 3 + ( hasNormals ? 3 : 0 ) + ( hasTexCoords ? 2 : 0 ) ) * sizeof( float ) );
+    if ( BeginOp( RenderOp::CreateMesh ) )
+    {
+        Put( id );
+        Put( static_cast<int32_t>( vertexCount ) );
+        Put( static_cast<uint8_t>( ( hasNormals ? 1 : 0 ) | ( hasTexCoords ? 2 : 0 ) ) );
+        PutData( data, static_cast<size_t>( vertexCount ) * stride );
+    }
+    return std::make_unique<CaptureMesh>( this, std::move( inner ), id, stride );
+}
+
+
+std::unique_ptr<IMesh> RenderBackendCapture::CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat )
+{
+    std::unique_ptr<IMesh> inner = m_inner->CreateIndexedMesh( vertices, vertexCount, format, indices, indexCount, indexFormat );
+    uint32_t id = NextMeshId();
+    int stride = GetVertexStride( format );
+    if ( BeginOp( RenderOp::CreateIndexedMesh ) )
+    {
+        Put( id );
+        Put( static_cast<uint8_t>( format ) );
+        Put( static_cast<uint8_t>( indexFormat ) );
+        Put( static_cast<int32_t>( vertexCount ) );
+        Put( static_cast<int32_t>( indexCount ) );
+        PutData( vertices, static_cast<size_t>( vertexCount ) * stride );
+        PutData( indexFormat != IndexFormat::None ? indices : nullptr, static_cast<size_t>( indexCount ) * GetIndexSize( indexFormat ) );
+    }
+    return std::make_unique<CaptureMesh>( this, std::move( inner ), id, stride );
+}
+
+
+std::unique_ptr<IFramebuffer> RenderBackendCapture::CreateFramebuffer( int width, int height )
+{
+    std::unique_ptr<IFramebuffer> inner = m_inner->CreateFramebuffer( width, height );
+    uint32_t id = NextFramebufferId();
+    if ( BeginOp( RenderOp::CreateFramebuffer ) )
+    {
+        Put( id );
+        Put( static_cast<int32_t>( width ) );
+        Put( static_cast<int32_t>( height ) );
+    }
+    return std::make_unique<CaptureFramebuffer>( this, std::move( inner ), id );
+}
+
+
+uint32_t RenderBackendCapture::CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter )
+{
+    uint32_t handle = m_inner->CreateTexture2D( data, w, h, channels, generateMips, linearFilter );
+    if ( BeginOp( RenderOp::CreateTexture2D ) )
+    {
+        Put( handle );
+        const int32_t values[3] = { w, h, channels };
+        PutRaw( values, sizeof( values ) );
+        Put( static_cast<uint8_t>( ( generateMips ? 1 : 0 ) | ( linearFilter ? 2 : 0 ) ) );
+        PutData( data, static_cast<size_t>( w ) * h * channels );
+    }
+    return handle;
+}
+
+
+uint32_t RenderBackendCapture::CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter )
+{
+    uint32_t handle = m_inner->CreateTexture2DMips( data, w, h, channels, mipCount, linearFilter );
+    if ( BeginOp( RenderOp::CreateTexture2DMips ) )
+    {
+        size_t size = 0;
+        for ( int level = 0; level < mipCount; ++level )
+        {
+            size += static_cast<size_t>( ( std::max )( w >> level, 1 ) ) * ( std::max )( h >> level, 1 ) * channels;
+        }
+        Put( handle );
+        const int32_t values[4] = { w, h, channels, mipCount };
+        PutRaw( values, sizeof( values ) );
+        Put( static_cast<uint8_t>( linearFilter ) );
+        PutData( data, size );
+    }
+    return handle;
+}
+
+
+void RenderBackendCapture::BindTexture( uint32_t handle, int slot )
+{
+    if ( BeginOp( RenderOp::BindTexture ) )
+    {
+        Put( handle );
+        Put( static_cast<uint8_t>( slot ) );
+    }
+    m_inner->BindTexture( handle, slot );
+}
+
+
+void RenderBackendCapture::DeleteTexture( uint32_t handle )
+{
+    if ( BeginOp( RenderOp::DeleteTexture ) )
+    {
+        Put( handle );
+    }
+    m_inner->DeleteTexture( handle );
+}
+
+
+std::vector<uint8_t> RenderBackendCapture::CaptureBackbuffer( int& outWidth, int& outHeight )
+{
+    return m_inner->CaptureBackbuffer( outWidth, outHeight );
+}
+
+
+bool RenderBackendCapture::RequestBackbufferCapture()
+{
+    return m_inner->RequestBackbufferCapture();
+}
+
+
+bool RenderBackendCapture::PollBackbufferCapture( CapturedImage& out, bool wait )
+{
+    return m_inner->PollBackbufferCapture( out, wait );
+}
+
+
+int RenderBackendCapture::GetWidth() const
+{
+    return m_inner->GetWidth();
+}
+
+
+int RenderBackendCapture::GetHeight() const
+{
+    return m_inner->GetHeight();
+}
+
+
+bool RenderBackendCapture::IsDepthTestEnabled() const
+{
+    return m_inner->IsDepthTestEnabled();
+}
+
+
+bool RenderBackendCapture::IsBlendEnabled() const
+{
+    return m_inner->IsBlendEnabled();
+}
+
+
+bool RenderBackendCapture::UsesZeroToOneDepth() const
+{
+    return m_inner->UsesZeroToOneDepth();
+}
+
+
+const char* RenderBackendCapture::GetRendererName() const
+{
+    return m_inner->GetRendererName();
+}
+
+
+UploadSpan RenderBackendCapture::AllocateUpload( int floatCount )
+{
+    // Spans of unrecorded frames go straight to the wrapped ring (their draws are never recorded)
+    if ( m_phase != Phase::Frames )
+    {
+        return m_inner->AllocateUpload( floatCount );
+    }
+
+    UploadSpan span = {};
+    if ( floatCount <= 0 )
+    {
+        return span;
+    }
+
+    size_t count = static_cast<size_t>( floatCount );
+    if ( m_stagingUsed + count > m_staging.size() )
+    {
+        // Moving the block keeps its storage (and the spans pointing into it) alive until Present
+        size_t size = ( std::max )( ( std::max )( m_staging.size() * 2, MIN_STAGING_FLOATS ), count );
+        if ( !m_staging.empty() )
+        {
+            m_retired.push_back( std::move( m_staging ) );
+        }
+        m_staging.assign( size, 0.0f );
+        m_stagingUsed = 0;
+    }
+
+    span.data = m_staging.data() + m_stagingUsed;
+    span.buffer = 1;
+    span.offset = static_cast<uint32_t>( m_spans.size() );
+    m_spans.emplace_back( span.data, floatCount );
+    m_stagingUsed += count;
+    return span;
+}
+
+
+uint32_t RenderBackendCapture::CreateDynamicVB( const int* attribComponents, int numAttribs )
+{
+    uint32_t handle = m_inner->CreateDynamicVB( attribComponents, numAttribs );
+    if ( BeginOp( RenderOp::CreateDynamicVB ) )
+    {
+        Put( handle );
+        PutData( attribComponents, static_cast<size_t>( numAttribs ) * sizeof( int32_t ) );
+    }
+    return handle;
+}
+
+
+void RenderBackendCapture::DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount )
+{
+    if ( m_phase != Phase::Frames )
+    {
+        m_inner->DrawDynamicVB( handle, vertices, vertexCount );
+        return;
+    }
+
+    const std::pair<const float*, int>* staged = vertices.buffer != 0 && vertices.offset < m_spans.size() ? &m_spans[vertices.offset] : nullptr;
+    if ( BeginOp( RenderOp::DrawDynamicVB ) )
+    {
+        Put( handle );
+        Put( static_cast<int32_t>( vertexCount ) );
+        PutData( staged ? staged->first : nullptr, staged ? static_cast<size_t>( staged->second ) * sizeof( float ) : 0 );
+    }
+    m_inner->DrawDynamicVB( handle, Forward( vertices ), vertexCount );
+}
+
+
+void RenderBackendCapture::DestroyDynamicVB( uint32_t handle )
+{
+    if ( BeginOp( RenderOp::DestroyDynamicVB ) )
+    {
+        Put( handle );
+    }
+    m_inner->DestroyDynamicVB( handle );
+}
+
+
+uint32_t RenderBackendCapture::CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes, int numStaticAttribs, const uint16_t* indices, int indexCount )
+{
+    uint32_t handle = m_inner->CreateInstancedMesh( staticData, staticVertCount, staticFloatsPerVert, instanceFloats, instanceStartAttrib,
+                                                    instanceAttribSizes, numInstanceAttribs, staticAttribSizes, numStaticAttribs, indices, indexCount );
+    if ( BeginOp( RenderOp::CreateInstancedMesh ) )
+    {
+        Put( handle );
+        const int32_t values[4] = { staticVertCount, staticFloatsPerVert, instanceFloats, instanceStartAttrib };
+        PutRaw( values, sizeof( values ) );
+        PutData( staticData, static_cast<size_t>( staticVertCount ) * staticFloatsPerVert * sizeof( float ) );
+        PutData( instanceAttribSizes, static_cast<size_t>( numInstanceAttribs ) * sizeof( int32_t ) );
+        PutData( numStaticAttribs > 0 ? staticAttribSizes : nullptr, static_cast<size_t>( numStaticAttribs ) * sizeof( int32_t ) );
+        PutData( indexCount > 0 ? indices : nullptr, static_cast<size_t>( indexCount ) * sizeof( uint16_t ) );
+    }
+    return handle;
+}
+
+
+void RenderBackendCapture::DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances )
+{
+    if ( m_phase != Phase::Frames )
+    {
+        m_inner->DrawInstancedMesh( handle, staticVertCount, instanceCount, instances );
+        return;
+    }
+
+    const std::pair<const float*, int>* staged = instances.buffer != 0 && instances.offset < m_spans.size() ? &m_spans[instances.offset] : nullptr;
+    if ( BeginOp( RenderOp::DrawInstancedMesh ) )
+    {
+        Put( handle );
+        Put( static_cast<int32_t>( staticVertCount ) );
+        Put( static_cast<int32_t>( instanceCount ) );
+        PutData( staged ? staged->first : nullptr, staged ? static_cast<size_t>( staged->second ) * sizeof( float ) : 0 );
+    }
+    m_inner->DrawInstancedMesh( handle, staticVertCount, instanceCount, Forward( instances ) );
+}
+
+
+void RenderBackendCapture::DestroyInstancedMesh( uint32_t handle )
+{
+    if ( BeginOp( RenderOp::DestroyInstancedMesh ) )
+    {
+        Put( handle );
+    }
+    m_inner->DestroyInstancedMesh( handle );
+}
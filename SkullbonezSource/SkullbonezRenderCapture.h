@@ -0,0 +1,217 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezIRenderBackend.h"
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+
+// One recorded call.  Each opcode byte is followed by the call's arguments in the order the call takes them;
+// bulk data (vertices, indices, texels, upload spans) is padded to a 4-byte stream offset.
+enum class RenderOp : uint8_t
+{
+    EndOfStream,
+    BeginFrames, // Prologue done: the captured frames follow
+    DefineString,
+    Present,
+    WaitForFrameSlot,
+    Finish,
+    FlushGPU,
+    SetViewport,
+    Clear,
+    SetClearColor,
+    SetClearDepth,
+    SetDepthTest,
+    SetBlend,
+    SetBlendFunc,
+    SetCullFace,
+    SetPolygonOffset,
+    SetClipPlane,
+    CreateShader,
+    DestroyShader,
+    UseShader,
+    ResolveUniform,
+    SetIntByName,
+    SetFloatByName,
+    SetVec3ByName,
+    SetVec4ByName,
+    SetMat4ByName,
+    SetInt,
+    SetFloat,
+    SetVec3,
+    SetVec4,
+    SetMat4,
+    CreateMesh,
+    CreateIndexedMesh,
+    DestroyMesh,
+    DrawMesh,
+    DrawMeshInstanced,
+    UpdateMeshVertices,
+    CreateFramebuffer,
+    DestroyFramebuffer,
+    BindFramebuffer,
+    UnbindFramebuffer,
+    ResetFramebuffer,
+    FramebufferTexture, // Captured colour texture handle of a framebuffer, so binds of it can be remapped
+    CreateTexture2D,
+    CreateTexture2DMips,
+    BindTexture,
+    DeleteTexture,
+    CreateDynamicVB,
+    DrawDynamicVB,
+    DestroyDynamicVB,
+    CreateInstancedMesh,
+    DrawInstancedMesh,
+    DestroyInstancedMesh
+};
+
+
+struct RenderCaptureHeader
+{
+    char magic[4];    // "SBRC"
+    uint32_t version; // RENDER_CAPTURE_VERSION
+    int32_t width;    // Backbuffer size at capture start
+    int32_t height;
+    uint32_t frameCount; // Frames after BeginFrames (written when the capture closes)
+};
+
+
+static constexpr uint32_t RENDER_CAPTURE_VERSION = 1;
+
+
+/* -- RenderBackendCapture ---------------------------------------------------------------------------------------------------------------------------------------
+
+    Wraps the real backend and records the exact stream of calls made through it, with their data, into a
+    binary file for RenderReplay.  Every call is forwarded unchanged, so the engine renders as usual.
+
+    Recording begins as soon as the backend is created.  Until Cfg().renderCaptureStartFrame frames have been
+    presented only the calls that build up resources and state are kept (creation, uploads, deletion, state and
+    uniform sets); draws, clears and frame pacing are left out.  The next Cfg().renderCaptureFrames frames are
+    recorded in full, after which the file is closed and the wrapper just forwards (as it does from the start if
+    the file cannot be created).  A run that ends sooner closes the file at its last Present, leaving out the
+    engine's teardown.
+
+    Shaders, meshes and framebuffers are wrapped so their calls are recorded too, and are identified in the
+    stream by sequence number.  Texture, dynamic VB and instanced mesh handles are recorded as the wrapped
+    backend issued them and remapped on replay.  While frames are recorded, upload spans point into staging
+    memory owned by the wrapper; each draw copies its span into the real upload ring and into the stream.
+    Screenshots and resizes are forwarded without being recorded.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class RenderBackendCapture : public IRenderBackend
+{
+
+  private:
+    enum class Phase
+    {
+        Prologue, // Resources and state only
+        Frames,   // Everything
+        Done      // Forward only
+    };
+
+    std::unique_ptr<IRenderBackend> m_inner;
+    FILE* m_file;
+    std::string m_path;
+    std::vector<uint8_t> m_buffer; // Pending stream bytes: written out when large, or at each Present while frames are recorded
+    uint64_t m_written;            // Stream bytes so far (for data alignment)
+    Phase m_phase;
+    int m_presentCount;
+    uint32_t m_frameCount;
+
+    std::unordered_map<std::string, uint16_t> m_strings; // Interned names and paths -> string id
+    uint32_t m_nextShaderId;
+    uint32_t m_nextMeshId;
+    uint32_t m_nextFramebufferId;
+
+    // Staging for upload spans while frames are recorded: span.offset indexes m_spans
+    std::vector<float> m_staging;
+    size_t m_stagingUsed;
+    std::vector<std::vector<float>> m_retired; // Outgrown staging blocks, freed at Present
+    std::vector<std::pair<const float*, int>> m_spans;
+
+    void Flush();                                 // Writes pending bytes to the file
+    void Close();                                 // Ends the stream and fills in the header frame count
+    UploadSpan Forward( const UploadSpan& span ); // Copies a staged span into the wrapped backend's upload ring
+
+  public:
+    RenderBackendCapture( std::unique_ptr<IRenderBackend> inner, const char* path );
+    ~RenderBackendCapture() override; // Closes the file if frames are still being recorded
+
+
+    // --- Stream writing (also used by the shader, mesh and framebuffer wrappers) ---
+
+    bool BeginOp( RenderOp op ); // Writes the opcode and returns true if the call is recorded in the current phase
+    template <typename T>
+    void Put( const T& value )
+    {
+        PutRaw( &value, sizeof( T ) );
+    }
+    void PutRaw( const void* data, size_t size );
+    void PutData( const void* data, size_t size ); // Bulk data: size prefix, then the bytes at a 4-byte offset
+    uint16_t InternString( const char* text );     // Defines the string on first use; call before BeginOp
+    uint32_t NextShaderId();
+    uint32_t NextMeshId();
+    uint32_t NextFramebufferId();
+
+
+    bool Init( HWND hwnd, HDC hdc, int width, int height ) override;
+    void Shutdown() override;
+    void Present() override;
+    void WaitForFrameSlot() override;
+    void Finish() override;
+    void FlushGPU() override;
+    void Resize( int width, int height ) override;
+
+    void SetViewport( int x, int y, int w, int h ) override;
+    void Clear( bool color, bool depth ) override;
+    void SetClearColor( float r, float g, float b, float a ) override;
+    void SetClearDepth( float depth ) override;
+
+    void SetDepthTest( bool enable ) override;
+    void SetBlend( bool enable ) override;
+    void SetBlendFunc( BlendFactor src, BlendFactor dst ) override;
+    void SetCullFace( bool enable ) override;
+    void SetPolygonOffset( bool enable, float factor = 0.0f, float units = 0.0f ) override;
+    void SetClipPlane( int index, bool enable ) override;
+
+    std::unique_ptr<IShader> CreateShader( const char* vertPath, const char* fragPath ) override;
+    std::unique_ptr<IMesh> CreateMesh( const float* data, int vertexCount, bool hasNormals, bool hasTexCoords ) override;
+    std::unique_ptr<IMesh> CreateIndexedMesh( const void* vertices, int vertexCount, VertexFormat format, const void* indices, int indexCount, IndexFormat indexFormat ) override;
+    std::unique_ptr<IFramebuffer> CreateFramebuffer( int width, int height ) override;
+
+    uint32_t CreateTexture2D( const uint8_t* data, int w, int h, int channels, bool generateMips, bool linearFilter ) override;
+    uint32_t CreateTexture2DMips( const uint8_t* data, int w, int h, int channels, int mipCount, bool linearFilter ) override;
+    void BindTexture( uint32_t handle, int slot ) override;
+    void DeleteTexture( uint32_t handle ) override;
+
+    std::vector<uint8_t> CaptureBackbuffer( int& outWidth, int& outHeight ) override;
+    bool RequestBackbufferCapture() override;
+    bool PollBackbufferCapture( CapturedImage& out, bool wait ) override;
+
+    int GetWidth() const override;
+    int GetHeight() const override;
+
+    bool IsDepthTestEnabled() const override;
+    bool IsBlendEnabled() const override;
+    bool UsesZeroToOneDepth() const override;
+    const char* GetRendererName() const override;
+
+    UploadSpan AllocateUpload( int floatCount ) override;
+
+    uint32_t CreateDynamicVB( const int* attribComponents, int numAttribs ) override;
+    void DrawDynamicVB( uint32_t handle, const UploadSpan& vertices, int vertexCount ) override;
+    void DestroyDynamicVB( uint32_t handle ) override;
+
+    uint32_t CreateInstancedMesh( const float* staticData, int staticVertCount, int staticFloatsPerVert, int instanceFloats, int instanceStartAttrib, const int* instanceAttribSizes, int numInstanceAttribs, const int* staticAttribSizes = nullptr, int numStaticAttribs = 0, const uint16_t* indices = nullptr, int indexCount = 0 ) override;
+    void DrawInstancedMesh( uint32_t handle, int staticVertCount, int instanceCount, const UploadSpan& instances ) override;
+    void DestroyInstancedMesh( uint32_t handle ) override;
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
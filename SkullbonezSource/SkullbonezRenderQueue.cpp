@@ -0,0 +1,531 @@
+// --- Includes ---
+#include "SkullbonezRenderQueue.h"
+#include "SkullbonezProfiler.h"
+#include <algorithm>
+#include <cstring>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Math::Transformation;
+
+
+namespace
+{
+constexpr uint32_t INITIAL_PACKETS = 256;
+constexpr uint32_t INITIAL_UNIFORMS = 1024;
+constexpr uint32_t INITIAL_FLOATS = 64 * 1024;
+constexpr uint32_t NO_TEXTURE = 0xFFFFFFFFu; // Executor cache: slot contents unknown
+
+uint8_t PackState( const RenderState& s )
+{
+    return static_cast<uint8_t>( ( s.depthTest ? 0x01 : 0 ) |
+                                 ( s.blend ? 0x02 : 0 ) |
+                                 ( s.cullFace ? 0x04 : 0 ) |
+                                 ( s.polygonOffset ? 0x08 : 0 ) |
+                                 ( s.clipPlane0 ? 0x10 : 0 ) );
+}
+
+bool IsOrderedLayer( RenderLayer layer )
+{
+    return layer == RenderLayer::Transparent || layer == RenderLayer::Overlay;
+}
+} // namespace
+
+
+RenderQueue& RenderQueue::Instance()
+{
+    static RenderQueue instance;
+    return instance;
+}
+
+
+RenderQueue::RenderQueue()
+    : m_open{}, m_isOpen( false ), m_uniformsSealed( false ), m_sequence( 0 ), m_current{}, m_blendFuncKnown( false ), m_currentShader( nullptr ), m_currentTextures{}
+{
+    m_packets.reserve( INITIAL_PACKETS );
+    m_sortEntries.reserve( INITIAL_PACKETS );
+    m_uniformValues.reserve( INITIAL_UNIFORMS );
+    m_floatArena.reserve( INITIAL_FLOATS );
+}
+
+
+void RenderQueue::Begin( RenderLayer layer, const IShader* shader, const RenderState& state )
+{
+    m_open = {};
+    m_open.key = static_cast<uint64_t>( layer ) << 56;
+    m_open.state = state;
+    m_open.shader = shader;
+    m_open.uniformBegin = static_cast<uint32_t>( m_uniformValues.size() );
+    m_open.uniformCount = 0;
+    m_isOpen = true;
+    m_uniformsSealed = false;
+}
+
+
+void RenderQueue::SetTexture( int slot, uint32_t handle )
+{
+    if ( slot >= 0 && slot < MAX_TEXTURE_SLOTS )
+    {
+        m_open.textures[slot] = handle;
+    }
+}
+
+
+uint32_t RenderQueue::PushFloats( const float* data, uint32_t count )
+{
+    uint32_t offset = static_cast<uint32_t>( m_floatArena.size() );
+    m_floatArena.insert( m_floatArena.end(), data, data + count );
+    return offset;
+}
+
+
+void RenderQueue::PushUniform( UniformHandle handle, UniformType type, const float* data, uint32_t count )
+{
+    if ( !m_isOpen || handle == UniformHandle::Invalid )
+    {
+        return;
+    }
+
+    // Draws already emitted reference the current range -- start a copy for the packets that follow
+    if ( m_uniformsSealed )
+    {
+        uint32_t begin = static_cast<uint32_t>( m_uniformValues.size() );
+        for ( uint32_t i = 0; i < m_open.uniformCount; ++i )
+        {
+            m_uniformValues.push_back( m_uniformValues[m_open.uniformBegin + i] );
+        }
+        m_open.uniformBegin = begin;
+        m_uniformsSealed = false;
+    }
+
+    uint32_t offset = PushFloats( data, count );
+    for ( uint32_t i = 0; i < m_open.uniformCount; ++i )
+    {
+        UniformValue& u = m_uniformValues[m_open.uniformBegin + i];
+        if ( u.handle == handle )
+        {
+            u.type = type;
+            u.offset = offset;
+            return;
+        }
+    }
+
+    m_uniformValues.push_back( { handle, type, offset } );
+    ++m_open.uniformCount;
+}
+
+
+void RenderQueue::SetInt( UniformHandle handle, int value )
+{
+    float bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    PushUniform( handle, UniformType::Int, &bits, 1 );
+}
+
+
+void RenderQueue::SetFloat( UniformHandle handle, float value )
+{
+    PushUniform( handle, UniformType::Float, &value, 1 );
+}
+
+
+void RenderQueue::SetVec3( UniformHandle handle, float x, float y, float z )
+{
+    float v[3] = { x, y, z };
+    PushUniform( handle, UniformType::Vec3, v, 3 );
+}
+
+
+void RenderQueue::SetVec4( UniformHandle handle, float x, float y, float z, float w )
+{
+    float v[4] = { x, y, z, w };
+    PushUniform( handle, UniformType::Vec4, v, 4 );
+}
+
+
+void RenderQueue::SetMat4( UniformHandle handle, const Matrix4& mat )
+{
+    PushUniform( handle, UniformType::Mat4, mat.Data(), 16 );
+}
+
+
+uint64_t RenderQueue::BuildKey( const DrawPacket& packet ) const
+{
+    uint64_t key = packet.key & 0xFF00000000000000ull; // layer
+    RenderLayer layer = static_cast<RenderLayer>( key >> 56 );
+
+    if ( IsOrderedLayer( layer ) )
+    {
+        return key | ( static_cast<uint64_t>( m_sequence & 0xFFFFFF ) << 32 );
+    }
+
+    // Shader and texture ids only need to group equal values; collisions cost a bind, never correctness
+    uint64_t shaderId = ( reinterpret_cast<uintptr_t>( packet.shader ) >> 4 ) & 0xFFFF;
+    uint64_t textureId = packet.textures[0] & 0xFFFF;
+    return key |
+           ( static_cast<uint64_t>( PackState( packet.state ) ) << 48 ) |
+           ( shaderId << 32 ) |
+           ( textureId << 16 ) |
+           ( m_sequence & 0xFFFF );
+}
+
+
+void RenderQueue::EmitPacket( DrawKind kind )
+{
+    DrawPacket packet = m_open;
+    packet.kind = kind;
+    packet.key = BuildKey( m_open );
+    m_packets.push_back( packet );
+    m_uniformsSealed = true;
+    ++m_sequence;
+}
+
+
+void RenderQueue::DrawMesh( const IMesh* mesh )
+{
+    if ( !m_isOpen || !mesh )
+    {
+        return;
+    }
+    m_open.mesh = mesh;
+    EmitPacket( DrawKind::Mesh );
+}
+
+
+float* RenderQueue::DrawInstancedMapped( uint32_t instMesh, int vertexCount, int instanceCount, int floatCount )
+{
+    if ( !m_isOpen || !instMesh || instanceCount <= 0 )
+    {
+        return nullptr;
+    }
+    UploadSpan span = Gfx().AllocateUpload( floatCount );
+    if ( !span.data )
+    {
+        return nullptr;
+    }
+    PROFILE_COUNTER_ADD( "Render/UploadBytes", floatCount * sizeof( float ) );
+
+    m_open.handle = instMesh;
+    m_open.vertexCount = vertexCount;
+    m_open.instanceCount = instanceCount;
+    m_open.data = span;
+    EmitPacket( DrawKind::Instanced );
+    return span.data;
+}
+
+
+void RenderQueue::DrawInstanced( uint32_t instMesh, int vertexCount, int instanceCount, const float* instanceData, int floatCount )
+{
+    float* dst = DrawInstancedMapped( instMesh, vertexCount, instanceCount, floatCount );
+    if ( dst )
+    {
+        memcpy( dst, instanceData, static_cast<size_t>( floatCount ) * sizeof( float ) );
+    }
+}
+
+
+void RenderQueue::DrawDynamic( uint32_t dynamicVB, const float* vertices, int floatCount, int vertexCount )
+{
+    if ( !m_isOpen || !dynamicVB || vertexCount <= 0 )
+    {
+        return;
+    }
+    UploadSpan span = Gfx().AllocateUpload( floatCount );
+    if ( !span.data )
+    {
+        return;
+    }
+    memcpy( span.data, vertices, static_cast<size_t>( floatCount ) * sizeof( float ) );
+    PROFILE_COUNTER_ADD( "Render/UploadBytes", floatCount * sizeof( float ) );
+
+    m_open.handle = dynamicVB;
+    m_open.vertexCount = vertexCount;
+    m_open.data = span;
+    EmitPacket( DrawKind::Dynamic );
+}
+
+
+void RenderQueue::ApplyState( const RenderState& state, bool force )
+{
+    IRenderBackend& gfx = Gfx();
+    int changes = 0;
+    int skipped = 0;
+
+    if ( force || state.depthTest != m_current.depthTest )
+    {
+        gfx.SetDepthTest( state.depthTest );
+        ++changes;
+    }
+    else
+    {
+        ++skipped;
+    }
+
+    if ( force || state.blend != m_current.blend )
+    {
+        gfx.SetBlend( state.blend );
+        ++changes;
+    }
+    else
+    {
+        ++skipped;
+    }
+
+    // Blend func only matters while blending; leave it alone for opaque packets
+    if ( state.blend )
+    {
+        if ( !m_blendFuncKnown || state.blendSrc != m_current.blendSrc || state.blendDst != m_current.blendDst )
+        {
+            gfx.SetBlendFunc( state.blendSrc, state.blendDst );
+            m_current.blendSrc = state.blendSrc;
+            m_current.blendDst = state.blendDst;
+            m_blendFuncKnown = true;
+            ++changes;
+        }
+        else
+        {
+            ++skipped;
+        }
+    }
+
+    if ( force || state.cullFace != m_current.cullFace )
+    {
+        gfx.SetCullFace( state.cullFace );
+        ++changes;
+    }
+    else
+    {
+        ++skipped;
+    }
+
+    if ( force || state.polygonOffset != m_current.polygonOffset ||
+         ( state.polygonOffset && ( state.polygonOffsetFactor != m_current.polygonOffsetFactor || state.polygonOffsetUnits != m_current.polygonOffsetUnits ) ) )
+    {
+        gfx.SetPolygonOffset( state.polygonOffset, state.polygonOffsetFactor, state.polygonOffsetUnits );
+        m_current.polygonOffsetFactor = state.polygonOffsetFactor;
+        m_current.polygonOffsetUnits = state.polygonOffsetUnits;
+        ++changes;
+    }
+    else
+    {
+        ++skipped;
+    }
+
+    if ( force || state.clipPlane0 != m_current.clipPlane0 )
+    {
+        gfx.SetClipPlane( 0, state.clipPlane0 );
+        ++changes;
+    }
+    else
+    {
+        ++skipped;
+    }
+
+    m_current.depthTest = state.depthTest;
+    m_current.blend = state.blend;
+    m_current.cullFace = state.cullFace;
+    m_current.polygonOffset = state.polygonOffset;
+    m_current.clipPlane0 = state.clipPlane0;
+
+    PROFILE_COUNTER_ADD( "Render/StateChanges", changes );
+    PROFILE_COUNTER_ADD( "Render/StateSkipped", skipped );
+    (void)changes;
+    (void)skipped;
+}
+
+
+void RenderQueue::ApplyUniforms( const DrawPacket& packet ) const
+{
+    // Shaders drop values equal to what they last sent, so re-applying a shared range is cheap
+    const IShader* shader = packet.shader;
+    for ( uint32_t i = 0; i < packet.uniformCount; ++i )
+    {
+        const UniformValue& u = m_uniformValues[packet.uniformBegin + i];
+        const float* v = &m_floatArena[u.offset];
+        switch ( u.type )
+        {
+        case UniformType::Int:
+        {
+            int value;
+            memcpy( &value, v, sizeof( value ) );
+            shader->SetInt( u.handle, value );
+            break;
+        }
+        case UniformType::Float:
+            shader->SetFloat( u.handle, v[0] );
+            break;
+        case UniformType::Vec3:
+            shader->SetVec3( u.handle, v[0], v[1], v[2] );
+            break;
+        case UniformType::Vec4:
+            shader->SetVec4( u.handle, v[0], v[1], v[2], v[3] );
+            break;
+        case UniformType::Mat4:
+            shader->SetMat4( u.handle, Matrix4( v ) );
+            break;
+        }
+    }
+}
+
+
+void RenderQueue::Execute( const DrawPacket& packet )
+{
+    ApplyState( packet.state, false );
+
+    if ( packet.shader != m_currentShader )
+    {
+        packet.shader->Use();
+        m_currentShader = packet.shader;
+        PROFILE_COUNTER_ADD( "Render/ShaderBinds", 1 );
+    }
+    ApplyUniforms( packet );
+
+    for ( int slot = 0; slot < MAX_TEXTURE_SLOTS; ++slot )
+    {
+        uint32_t tex = packet.textures[slot];
+        if ( tex != 0 && tex != m_currentTextures[slot] )
+        {
+            Gfx().BindTexture( tex, slot );
+            m_currentTextures[slot] = tex;
+            PROFILE_COUNTER_ADD( "Render/TextureBinds", 1 );
+        }
+    }
+
+    switch ( packet.kind )
+    {
+    case DrawKind::Mesh:
+        packet.mesh->Draw();
+        break;
+    case DrawKind::Instanced:
+        Gfx().DrawInstancedMesh( packet.handle, packet.vertexCount, packet.instanceCount, packet.data );
+        break;
+    case DrawKind::Dynamic:
+        Gfx().DrawDynamicVB( packet.handle, packet.data, packet.vertexCount );
+        break;
+    }
+}
+
+
+// Main pass layer markers.  Packets are sorted by layer first, so each layer is one contiguous range
+// of the flush and its GPU time is everything submitted from its first packet to the next layer's.
+static void BeginLayerMarker( RenderLayer layer )
+{
+    switch ( layer )
+    {
+    case RenderLayer::Sky:
+        PROFILE_GPU_BEGIN( "Frame/Render/Execute/Sky" );
+        break;
+    case RenderLayer::Opaque:
+        PROFILE_GPU_BEGIN( "Frame/Render/Execute/Opaque" );
+        break;
+    case RenderLayer::Decal:
+        PROFILE_GPU_BEGIN( "Frame/Render/Execute/Decal" );
+        break;
+    case RenderLayer::Transparent:
+        PROFILE_GPU_BEGIN( "Frame/Render/Execute/Transparent" );
+        break;
+    case RenderLayer::Overlay:
+        PROFILE_GPU_BEGIN( "Frame/Render/Execute/Overlay" );
+        break;
+    }
+}
+
+
+static void EndLayerMarker( RenderLayer layer )
+{
+    switch ( layer )
+    {
+    case RenderLayer::Sky:
+        PROFILE_GPU_END( "Frame/Render/Execute/Sky" );
+        break;
+    case RenderLayer::Opaque:
+        PROFILE_GPU_END( "Frame/Render/Execute/Opaque" );
+        break;
+    case RenderLayer::Decal:
+        PROFILE_GPU_END( "Frame/Render/Execute/Decal" );
+        break;
+    case RenderLayer::Transparent:
+        PROFILE_GPU_END( "Frame/Render/Execute/Transparent" );
+        break;
+    case RenderLayer::Overlay:
+        PROFILE_GPU_END( "Frame/Render/Execute/Overlay" );
+        break;
+    }
+}
+
+
+void RenderQueue::Flush( bool isLayerTimed )
+{
+    if ( m_packets.empty() )
+    {
+        Clear();
+        return;
+    }
+
+    PROFILE_COUNTER_ADD( "Render/Packets", m_packets.size() );
+
+    m_sortEntries.clear();
+    for ( uint32_t i = 0; i < static_cast<uint32_t>( m_packets.size() ); ++i )
+    {
+        m_sortEntries.push_back( { m_packets[i].key, i } );
+    }
+    std::sort( m_sortEntries.begin(), m_sortEntries.end(), []( const SortEntry& a, const SortEntry& b )
+               {
+                   return a.key < b.key;
+               } );
+
+    // Code outside the queue may have touched anything -- the first packet sets every state it owns
+    m_currentShader = nullptr;
+    m_blendFuncKnown = false;
+    for ( int slot = 0; slot < MAX_TEXTURE_SLOTS; ++slot )
+    {
+        m_currentTextures[slot] = NO_TEXTURE;
+    }
+
+    bool depthWasEnabled = Gfx().IsDepthTestEnabled();
+    bool blendWasEnabled = Gfx().IsBlendEnabled();
+
+    ApplyState( m_packets[m_sortEntries[0].index].state, true );
+    RenderLayer timedLayer = static_cast<RenderLayer>( m_sortEntries[0].key >> 56 );
+    if ( isLayerTimed )
+    {
+        BeginLayerMarker( timedLayer );
+    }
+    for ( const SortEntry& entry : m_sortEntries )
+    {
+        RenderLayer layer = static_cast<RenderLayer>( entry.key >> 56 );
+        if ( isLayerTimed && layer != timedLayer )
+        {
+            EndLayerMarker( timedLayer );
+            BeginLayerMarker( layer );
+            timedLayer = layer;
+        }
+        Execute( m_packets[entry.index] );
+    }
+    if ( isLayerTimed )
+    {
+        EndLayerMarker( timedLayer );
+    }
+
+    // Hand back the state immediate-mode code expects: caller's depth/blend, culling on, no offset, no clip
+    RenderState restore;
+    restore.depthTest = depthWasEnabled;
+    restore.blend = blendWasEnabled;
+    restore.blendSrc = m_current.blendSrc;
+    restore.blendDst = m_current.blendDst;
+    ApplyState( restore, false );
+
+    Clear();
+}
+
+
+void RenderQueue::Clear()
+{
+    m_packets.clear();
+    m_uniformValues.clear();
+    m_floatArena.clear();
+    m_isOpen = false;
+    m_uniformsSealed = false;
+    m_sequence = 0;
+}
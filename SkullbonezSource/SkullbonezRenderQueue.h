@@ -0,0 +1,156 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezIRenderBackend.h"
+#include "SkullbonezMatrix4.h"
+#include <cstdint>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+// Coarse draw order within a pass. Sky/Opaque/Decal packets are grouped by state, shader and texture;
+// Transparent and Overlay packets keep submission order (painter's algorithm).
+enum class RenderLayer : uint8_t
+{
+    Sky = 0,
+    Opaque = 1,
+    Decal = 2,
+    Transparent = 3,
+    Overlay = 4
+};
+
+
+// Fixed-function state a packet needs. Anything not listed is left as the backend has it.
+struct RenderState
+{
+    bool depthTest = true;
+    bool blend = false;
+    bool cullFace = true;
+    bool polygonOffset = false;
+    bool clipPlane0 = false;
+    float polygonOffsetFactor = 0.0f;
+    float polygonOffsetUnits = 0.0f;
+    BlendFactor blendSrc = BlendFactor::SrcAlpha;
+    BlendFactor blendDst = BlendFactor::OneMinusSrcAlpha;
+};
+
+
+/* -- Render Queue -----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Per-pass draw packet queue. Subsystems open a packet with Begin(), record uniforms and textures,
+    then emit one or more draws; nothing reaches Gfx() until Flush(), which sorts the packets by their
+    64-bit key and replays them, skipping state, shader and texture changes that are already current.
+
+    Key layout (MSB first):
+      layer:8 | state:8 | shader:16 | texture:16 | sequence:16     Sky / Opaque / Decal
+      layer:8 | sequence:24 | 0:32                                 Transparent / Overlay
+
+    Uniform values are copied into a frame arena at submit time. Instance data and dynamic vertices go
+    straight into the backend's upload ring: DrawInstancedMapped() hands back the mapped span for the
+    caller to fill, the copying variants memcpy into one. Uniforms recorded after a draw apply to the
+    following draws only. Call Flush() before the render target changes and before Present().
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class RenderQueue
+{
+
+  public:
+    static constexpr int MAX_TEXTURE_SLOTS = 2;
+
+    static RenderQueue& Instance();
+
+    void Begin( RenderLayer layer, const IShader* shader, const RenderState& state ); // Open a packet; uniforms/textures reset
+    void SetTexture( int slot, uint32_t handle );                                     // 0 leaves the slot untouched
+    void SetInt( UniformHandle handle, int value );
+    void SetFloat( UniformHandle handle, float value );
+    void SetVec3( UniformHandle handle, float x, float y, float z );
+    void SetVec4( UniformHandle handle, float x, float y, float z, float w );
+    void SetMat4( UniformHandle handle, const Math::Transformation::Matrix4& mat );
+
+    void DrawMesh( const IMesh* mesh );                                                                                     // IMesh::Draw
+    float* DrawInstancedMapped( uint32_t instMesh, int vertexCount, int instanceCount, int floatCount );                    // DrawInstancedMesh; fill the returned ring memory before Flush()
+    void DrawInstanced( uint32_t instMesh, int vertexCount, int instanceCount, const float* instanceData, int floatCount ); // Copying variant of the above
+    void DrawDynamic( uint32_t dynamicVB, const float* vertices, int floatCount, int vertexCount );                         // DrawDynamicVB from a copy in the upload ring
+
+    void Flush( bool isLayerTimed = false ); // Sort and execute all packets, then restore the default state (isLayerTimed: GPU marker per layer)
+    void Clear();                            // Drop queued packets without drawing (device loss / shutdown)
+
+  private:
+    RenderQueue();
+    RenderQueue( const RenderQueue& ) = delete;
+    RenderQueue& operator=( const RenderQueue& ) = delete;
+
+    enum class DrawKind : uint8_t
+    {
+        Mesh,
+        Instanced,
+        Dynamic
+    };
+
+    enum class UniformType : uint8_t
+    {
+        Int,
+        Float,
+        Vec3,
+        Vec4,
+        Mat4
+    };
+
+    struct UniformValue
+    {
+        UniformHandle handle;
+        UniformType type;
+        uint32_t offset; // Into m_floatArena
+    };
+
+    struct DrawPacket
+    {
+        uint64_t key;
+        DrawKind kind;
+        RenderState state;
+        const IShader* shader;
+        uint32_t textures[MAX_TEXTURE_SLOTS];
+        const IMesh* mesh;     // DrawKind::Mesh
+        uint32_t handle;       // DrawKind::Instanced / Dynamic
+        int vertexCount;       // Instanced: per-instance vertex count; Dynamic: vertices to draw
+        int instanceCount;     // Instanced only
+        UploadSpan data;       // Instance data / vertices in the backend upload ring
+        uint32_t uniformBegin; // First entry in m_uniformValues
+        uint32_t uniformCount; // Entries in m_uniformValues
+    };
+
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawPacket> m_packets;         // Submitted this pass
+    std::vector<SortEntry> m_sortEntries;      // Key/index pairs sorted at Flush
+    std::vector<UniformValue> m_uniformValues; // Uniform records for all packets
+    std::vector<float> m_floatArena;           // Uniform payloads
+
+    DrawPacket m_open;     // Template for the next draw (shader, state, textures, uniform range)
+    bool m_isOpen;         // Begin() called since the last Flush()
+    bool m_uniformsSealed; // A draw has referenced the current uniform range; next setter copies it
+    uint32_t m_sequence;   // Submission counter (ordered layers / stable ties)
+
+    // Executor cache: what Gfx() currently has, valid only inside Flush()
+    RenderState m_current;
+    bool m_blendFuncKnown; // SetBlendFunc issued since this Flush() began
+    const IShader* m_currentShader;
+    uint32_t m_currentTextures[MAX_TEXTURE_SLOTS];
+
+    uint32_t PushFloats( const float* data, uint32_t count );
+    void PushUniform( UniformHandle handle, UniformType type, const float* data, uint32_t count );
+    void EmitPacket( DrawKind kind );
+    uint64_t BuildKey( const DrawPacket& packet ) const;
+    void ApplyState( const RenderState& state, bool force );
+    void ApplyUniforms( const DrawPacket& packet ) const;
+    void Execute( const DrawPacket& packet );
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
@@ -0,0 +1,758 @@
+// --- Includes ---
+#include "SkullbonezRenderReplay.h"
+#include "SkullbonezConfig.h"
+#include "SkullbonezTimer.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
+using namespace SkullbonezCore::Environment;
+using namespace SkullbonezCore::Math::Transformation;
+
+
+RenderReplay::RenderReplay( const char* path )
+    : m_cursor( 0 ), m_header()
+{
+    FILE* f = nullptr;
+    if ( fopen_s( &f, path, "rb" ) != 0 || !f )
+    {
+        throw std::runtime_error( "Cannot open the render capture file.  (RenderReplay::RenderReplay)" );
+    }
+    fseek( f, 0, SEEK_END );
+    long size = ftell( f );
+    fseek( f, 0, SEEK_SET );
+    m_stream.resize( size > 0 ? static_cast<size_t>( size ) : 0 );
+    size_t read = fread( m_stream.data(), 1, m_stream.size(), f );
+    fclose( f );
+
+    if ( read != m_stream.size() || m_stream.size() < sizeof( RenderCaptureHeader ) )
+    {
+        throw std::runtime_error( "Render capture file is truncated.  (RenderReplay::RenderReplay)" );
+    }
+    memcpy( &m_header, m_stream.data(), sizeof( m_header ) );
+    if ( memcmp( m_header.magic, "SBRC", 4 ) != 0 || m_header.version != RENDER_CAPTURE_VERSION )
+    {
+        throw std::runtime_error( "Not a render capture of this version.  (RenderReplay::RenderReplay)" );
+    }
+}
+
+
+RenderReplay::~RenderReplay()
+{
+    ReleaseAll();
+}
+
+
+const uint8_t* RenderReplay::ReadRaw( size_t size )
+{
+    if ( size > m_stream.size() - m_cursor )
+    {
+        throw std::runtime_error( "Render capture stream is truncated.  (RenderReplay::ReadRaw)" );
+    }
+    const uint8_t* data = m_stream.data() + m_cursor;
+    m_cursor += size;
+    return data;
+}
+
+
+const void* RenderReplay::ReadData( size_t& size )
+{
+    size = Read<uint32_t>();
+    ReadRaw( ( 4 - m_cursor % 4 ) % 4 );
+    return size ? ReadRaw( size ) : nullptr;
+}
+
+
+const char* RenderReplay::ReadString()
+{
+    uint16_t id = Read<uint16_t>();
+    if ( id >= m_strings.size() )
+    {
+        throw std::runtime_error( "Render capture refers to an undefined string.  (RenderReplay::ReadString)" );
+    }
+    return m_strings[id].c_str();
+}
+
+
+IShader* RenderReplay::FindShader( uint32_t id ) const
+{
+    return id < m_shaders.size() ? m_shaders[id].get() : nullptr;
+}
+
+
+IMesh* RenderReplay::FindMesh( uint32_t id ) const
+{
+    return id < m_meshes.size() ? m_meshes[id].get() : nullptr;
+}
+
+
+IFramebuffer* RenderReplay::FindFramebuffer( uint32_t id ) const
+{
+    return id < m_framebuffers.size() ? m_framebuffers[id].get() : nullptr;
+}
+
+
+UniformHandle RenderReplay::FindUniform( uint32_t shader, int32_t handle ) const
+{
+    if ( shader >= m_uniforms.size() || handle < 0 || handle >= static_cast<int32_t>( m_uniforms[shader].size() ) )
+    {
+        return UniformHandle::Invalid;
+    }
+    return m_uniforms[shader][handle];
+}
+
+
+UploadSpan RenderReplay::Upload( const void* data, size_t size )
+{
+    UploadSpan span = {};
+    if ( !data )
+    {
+        return span;
+    }
+    span = Gfx().AllocateUpload( static_cast<int>( size / sizeof( float ) ) );
+    if ( span.data )
+    {
+        memcpy( span.data, data, size );
+    }
+    return span;
+}
+
+
+// Stream objects are looked up by capture id; a creation replaces (and first flushes) one the previous pass left alive
+template <typename T>
+static std::unique_ptr<T>& Slot( std::vector<std::unique_ptr<T>>& objects, uint32_t id )
+{
+    if ( id >= objects.size() )
+    {
+        objects.resize( id + 1 );
+    }
+    if ( objects[id] )
+    {
+        Gfx().FlushGPU();
+    }
+    return objects[id];
+}
+
+
+RenderOp RenderReplay::Execute()
+{
+    IRenderBackend& gfx = Gfx();
+    RenderOp op = static_cast<RenderOp>( Read<uint8_t>() );
+    size_t size = 0;
+
+    switch ( op )
+    {
+    case RenderOp::EndOfStream:
+    case RenderOp::BeginFrames:
+        break;
+
+    case RenderOp::DefineString:
+    {
+        uint16_t id = Read<uint16_t>();
+        uint16_t length = Read<uint16_t>();
+        const char* text = reinterpret_cast<const char*>( ReadRaw( length ) );
+        if ( id >= m_strings.size() )
+        {
+            m_strings.resize( id + 1 );
+        }
+        m_strings[id].assign( text, length );
+        break;
+    }
+
+    case RenderOp::Present:
+        gfx.Present();
+        break;
+    case RenderOp::WaitForFrameSlot:
+        gfx.WaitForFrameSlot();
+        break;
+    case RenderOp::Finish:
+        gfx.Finish();
+        break;
+    case RenderOp::FlushGPU:
+        gfx.FlushGPU();
+        break;
+
+    case RenderOp::SetViewport:
+    {
+        int32_t v[4];
+        memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+        gfx.SetViewport( v[0], v[1], v[2], v[3] );
+        break;
+    }
+    case RenderOp::Clear:
+    {
+        uint8_t flags = Read<uint8_t>();
+        gfx.Clear( ( flags & 1 ) != 0, ( flags & 2 ) != 0 );
+        break;
+    }
+    case RenderOp::SetClearColor:
+    {
+        float c[4];
+        memcpy( c, ReadRaw( sizeof( c ) ), sizeof( c ) );
+        gfx.SetClearColor( c[0], c[1], c[2], c[3] );
+        break;
+    }
+    case RenderOp::SetClearDepth:
+        gfx.SetClearDepth( Read<float>() );
+        break;
+    case RenderOp::SetDepthTest:
+        gfx.SetDepthTest( Read<uint8_t>() != 0 );
+        break;
+    case RenderOp::SetBlend:
+        gfx.SetBlend( Read<uint8_t>() != 0 );
+        break;
+    case RenderOp::SetBlendFunc:
+    {
+        BlendFactor src = static_cast<BlendFactor>( Read<uint8_t>() );
+        BlendFactor dst = static_cast<BlendFactor>( Read<uint8_t>() );
+        gfx.SetBlendFunc( src, dst );
+        break;
+    }
+    case RenderOp::SetCullFace:
+        gfx.SetCullFace( Read<uint8_t>() != 0 );
+        break;
+    case RenderOp::SetPolygonOffset:
+    {
+        bool enable = Read<uint8_t>() != 0;
+        float factor = Read<float>();
+        float units = Read<float>();
+        gfx.SetPolygonOffset( enable, factor, units );
+        break;
+    }
+    case RenderOp::SetClipPlane:
+    {
+        int index = Read<uint8_t>();
+        gfx.SetClipPlane( index, Read<uint8_t>() != 0 );
+        break;
+    }
+
+    case RenderOp::CreateShader:
+    {
+        uint32_t id = Read<uint32_t>();
+        const char* vertPath = ReadString();
+        const char* fragPath = ReadString();
+        Slot( m_shaders, id ) = gfx.CreateShader( vertPath, fragPath );
+        if ( id >= m_uniforms.size() )
+        {
+            m_uniforms.resize( id + 1 );
+        }
+        m_uniforms[id].clear();
+        break;
+    }
+    case RenderOp::DestroyShader:
+    {
+        uint32_t id = Read<uint32_t>();
+        if ( id < m_shaders.size() )
+        {
+            m_shaders[id].reset();
+        }
+        break;
+    }
+    case RenderOp::UseShader:
+        if ( IShader* shader = FindShader( Read<uint32_t>() ) )
+        {
+            shader->Use();
+        }
+        break;
+    case RenderOp::ResolveUniform:
+    {
+        uint32_t id = Read<uint32_t>();
+        const char* name = ReadString();
+        int32_t handle = Read<int32_t>();
+        IShader* shader = FindShader( id );
+        if ( shader && handle >= 0 )
+        {
+            std::vector<UniformHandle>& handles = m_uniforms[id];
+            if ( handle >= static_cast<int32_t>( handles.size() ) )
+            {
+                handles.resize( handle + 1, UniformHandle::Invalid );
+            }
+            handles[handle] = shader->GetUniformHandle( name );
+        }
+        break;
+    }
+
+    case RenderOp::SetIntByName:
+    case RenderOp::SetFloatByName:
+    case RenderOp::SetVec3ByName:
+    case RenderOp::SetVec4ByName:
+    case RenderOp::SetMat4ByName:
+    {
+        IShader* shader = FindShader( Read<uint32_t>() );
+        const char* name = ReadString();
+        if ( op == RenderOp::SetIntByName )
+        {
+            int32_t value = Read<int32_t>();
+            if ( shader )
+            {
+                shader->SetInt( name, value );
+            }
+        }
+        else if ( op == RenderOp::SetFloatByName )
+        {
+            float value = Read<float>();
+            if ( shader )
+            {
+                shader->SetFloat( name, value );
+            }
+        }
+        else if ( op == RenderOp::SetVec3ByName )
+        {
+            float v[3];
+            memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+            if ( shader )
+            {
+                shader->SetVec3( name, v[0], v[1], v[2] );
+            }
+        }
+        else if ( op == RenderOp::SetVec4ByName )
+        {
+            float v[4];
+            memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+            if ( shader )
+            {
+                shader->SetVec4( name, v[0], v[1], v[2], v[3] );
+            }
+        }
+        else
+        {
+            Matrix4 mat;
+            memcpy( mat.m, ReadRaw( sizeof( mat.m ) ), sizeof( mat.m ) );
+            if ( shader )
+            {
+                shader->SetMat4( name, mat );
+            }
+        }
+        break;
+    }
+
+    case RenderOp::SetInt:
+    case RenderOp::SetFloat:
+    case RenderOp::SetVec3:
+    case RenderOp::SetVec4:
+    case RenderOp::SetMat4:
+    {
+        uint32_t id = Read<uint32_t>();
+        UniformHandle handle = FindUniform( id, Read<int32_t>() );
+        IShader* shader = FindShader( id );
+        if ( op == RenderOp::SetInt )
+        {
+            int32_t value = Read<int32_t>();
+            if ( shader )
+            {
+                shader->SetInt( handle, value );
+            }
+        }
+        else if ( op == RenderOp::SetFloat )
+        {
+            float value = Read<float>();
+            if ( shader )
+            {
+                shader->SetFloat( handle, value );
+            }
+        }
+        else if ( op == RenderOp::SetVec3 )
+        {
+            float v[3];
+            memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+            if ( shader )
+            {
+                shader->SetVec3( handle, v[0], v[1], v[2] );
+            }
+        }
+        else if ( op == RenderOp::SetVec4 )
+        {
+            float v[4];
+            memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+            if ( shader )
+            {
+                shader->SetVec4( handle, v[0], v[1], v[2], v[3] );
+            }
+        }
+        else
+        {
+            Matrix4 mat;
+            memcpy( mat.m, ReadRaw( sizeof( mat.m ) ), sizeof( mat.m ) );
+            if ( shader )
+            {
+                shader->SetMat4( handle, mat );
+            }
+        }
+        break;
+    }
+
+    case RenderOp::CreateMesh:
+    {
+        uint32_t id = Read<uint32_t>();
+        int32_t vertexCount = Read<int32_t>();
+        uint8_t flags = Read<uint8_t>();
+        const float* data = static_cast<const float*>( ReadData( size ) );
+        Slot( m_meshes, id ) = gfx.CreateMesh( data, vertexCount, ( flags & 1 ) != 0, ( flags & 2 ) != 0 );
+        break;
+    }
+    case RenderOp::CreateIndexedMesh:
+    {
+        uint32_t id = Read<uint32_t>();
+        VertexFormat format = static_cast<VertexFormat>( Read<uint8_t>() );
+        IndexFormat indexFormat = static_cast<IndexFormat>( Read<uint8_t>() );
+        int32_t vertexCount = Read<int32_t>();
+        int32_t indexCount = Read<int32_t>();
+        const void* vertices = ReadData( size );
+        const void* indices = ReadData( size );
+        Slot( m_meshes, id ) = gfx.CreateIndexedMesh( vertices, vertexCount, format, indices, indexCount, indexFormat );
+        break;
+    }
+    case RenderOp::DestroyMesh:
+    {
+        uint32_t id = Read<uint32_t>();
+        if ( id < m_meshes.size() )
+        {
+            m_meshes[id].reset();
+        }
+        break;
+    }
+    case RenderOp::DrawMesh:
+        if ( IMesh* mesh = FindMesh( Read<uint32_t>() ) )
+        {
+            mesh->Draw();
+        }
+        break;
+    case RenderOp::DrawMeshInstanced:
+    {
+        IMesh* mesh = FindMesh( Read<uint32_t>() );
+        int32_t instanceCount = Read<int32_t>();
+        if ( mesh )
+        {
+            mesh->DrawInstanced( instanceCount );
+        }
+        break;
+    }
+    case RenderOp::UpdateMeshVertices:
+    {
+        IMesh* mesh = FindMesh( Read<uint32_t>() );
+        int32_t firstVertex = Read<int32_t>();
+        int32_t vertexCount = Read<int32_t>();
+        const void* data = ReadData( size );
+        if ( mesh && data )
+        {
+            mesh->UpdateVertices( firstVertex, vertexCount, data );
+        }
+        break;
+    }
+
+    case RenderOp::CreateFramebuffer:
+    {
+        uint32_t id = Read<uint32_t>();
+        int32_t width = Read<int32_t>();
+        int32_t height = Read<int32_t>();
+        Slot( m_framebuffers, id ) = gfx.CreateFramebuffer( width, height );
+        break;
+    }
+    case RenderOp::DestroyFramebuffer:
+    {
+        uint32_t id = Read<uint32_t>();
+        if ( id < m_framebuffers.size() )
+        {
+            m_framebuffers[id].reset();
+        }
+        break;
+    }
+    case RenderOp::BindFramebuffer:
+    case RenderOp::UnbindFramebuffer:
+    case RenderOp::ResetFramebuffer:
+        if ( IFramebuffer* framebuffer = FindFramebuffer( Read<uint32_t>() ) )
+        {
+            if ( op == RenderOp::BindFramebuffer )
+            {
+                framebuffer->Bind();
+            }
+            else if ( op == RenderOp::UnbindFramebuffer )
+            {
+                framebuffer->Unbind();
+            }
+            else
+            {
+                framebuffer->ResetResources();
+            }
+        }
+        break;
+    case RenderOp::FramebufferTexture:
+    {
+        IFramebuffer* framebuffer = FindFramebuffer( Read<uint32_t>() );
+        uint32_t handle = Read<uint32_t>();
+        if ( framebuffer )
+        {
+            m_framebufferTextures[handle] = framebuffer->GetColorTextureHandle();
+        }
+        break;
+    }
+
+    case RenderOp::CreateTexture2D:
+    case RenderOp::CreateTexture2DMips:
+    {
+        uint32_t handle = Read<uint32_t>();
+        int32_t width = Read<int32_t>();
+        int32_t height = Read<int32_t>();
+        int32_t channels = Read<int32_t>();
+        int32_t mipCount = op == RenderOp::CreateTexture2DMips ? Read<int32_t>() : 0;
+        uint8_t flags = Read<uint8_t>();
+        const uint8_t* data = static_cast<const uint8_t*>( ReadData( size ) );
+
+        auto existing = m_textures.find( handle );
+        if ( existing != m_textures.end() )
+        {
+            gfx.FlushGPU();
+            gfx.DeleteTexture( existing->second );
+        }
+        m_textures[handle] = op == RenderOp::CreateTexture2DMips
+                                 ? gfx.CreateTexture2DMips( data, width, height, channels, mipCount, ( flags & 1 ) != 0 )
+                                 : gfx.CreateTexture2D( data, width, height, channels, ( flags & 1 ) != 0, ( flags & 2 ) != 0 );
+        break;
+    }
+    case RenderOp::BindTexture:
+    {
+        uint32_t handle = Read<uint32_t>();
+        int slot = Read<uint8_t>();
+        auto texture = m_textures.find( handle );
+        auto framebufferTexture = m_framebufferTextures.find( handle );
+        if ( texture != m_textures.end() )
+        {
+            gfx.BindTexture( texture->second, slot );
+        }
+        else if ( framebufferTexture != m_framebufferTextures.end() )
+        {
+            gfx.BindTexture( framebufferTexture->second, slot );
+        }
+        else if ( handle == 0 )
+        {
+            gfx.BindTexture( 0, slot );
+        }
+        break;
+    }
+    case RenderOp::DeleteTexture:
+    {
+        auto texture = m_textures.find( Read<uint32_t>() );
+        if ( texture != m_textures.end() )
+        {
+            gfx.DeleteTexture( texture->second );
+            m_textures.erase( texture );
+        }
+        break;
+    }
+
+    case RenderOp::CreateDynamicVB:
+    {
+        uint32_t handle = Read<uint32_t>();
+        const int* attribs = static_cast<const int*>( ReadData( size ) );
+        auto existing = m_dynamicVBs.find( handle );
+        if ( existing != m_dynamicVBs.end() )
+        {
+            gfx.FlushGPU();
+            gfx.DestroyDynamicVB( existing->second );
+        }
+        m_dynamicVBs[handle] = gfx.CreateDynamicVB( attribs, static_cast<int>( size / sizeof( int32_t ) ) );
+        break;
+    }
+    case RenderOp::DrawDynamicVB:
+    {
+        auto vb = m_dynamicVBs.find( Read<uint32_t>() );
+        int32_t vertexCount = Read<int32_t>();
+        const void* data = ReadData( size );
+        if ( vb != m_dynamicVBs.end() )
+        {
+            gfx.DrawDynamicVB( vb->second, Upload( data, size ), vertexCount );
+        }
+        break;
+    }
+    case RenderOp::DestroyDynamicVB:
+    {
+        auto vb = m_dynamicVBs.find( Read<uint32_t>() );
+        if ( vb != m_dynamicVBs.end() )
+        {
+            gfx.DestroyDynamicVB( vb->second );
+            m_dynamicVBs.erase( vb );
+        }
+        break;
+    }
+
+    case RenderOp::CreateInstancedMesh:
+    {
+        uint32_t handle = Read<uint32_t>();
+        int32_t v[4];
+        memcpy( v, ReadRaw( sizeof( v ) ), sizeof( v ) );
+        size_t instanceAttribBytes = 0;
+        size_t staticAttribBytes = 0;
+        size_t indexBytes = 0;
+        const float* staticData = static_cast<const float*>( ReadData( size ) );
+        const int* instanceAttribs = static_cast<const int*>( ReadData( instanceAttribBytes ) );
+        const int* staticAttribs = static_cast<const int*>( ReadData( staticAttribBytes ) );
+        const uint16_t* indices = static_cast<const uint16_t*>( ReadData( indexBytes ) );
+
+        auto existing = m_instancedMeshes.find( handle );
+        if ( existing != m_instancedMeshes.end() )
+        {
+            gfx.FlushGPU();
+            gfx.DestroyInstancedMesh( existing->second );
+        }
+        m_instancedMeshes[handle] = gfx.CreateInstancedMesh( staticData, v[0], v[1], v[2], v[3],
+                                                             instanceAttribs, static_cast<int>( instanceAttribBytes / sizeof( int32_t ) ),
+                                                             staticAttribs, static_cast<int>( staticAttribBytes / sizeof( int32_t ) ),
+                                                             indices, static_cast<int>( indexBytes / sizeof( uint16_t ) ) );
+        break;
+    }
+    case RenderOp::DrawInstancedMesh:
+    {
+        auto mesh = m_instancedMeshes.find( Read<uint32_t>() );
+        int32_t staticVertCount = Read<int32_t>();
+        int32_t instanceCount = Read<int32_t>();
+        const void* data = ReadData( size );
+        if ( mesh != m_instancedMeshes.end() )
+        {
+            gfx.DrawInstancedMesh( mesh->second, staticVertCount, instanceCount, Upload( data, size ) );
+        }
+        break;
+    }
+    case RenderOp::DestroyInstancedMesh:
+    {
+        auto mesh = m_instancedMeshes.find( Read<uint32_t>() );
+        if ( mesh != m_instancedMeshes.end() )
+        {
+            gfx.DestroyInstancedMesh( mesh->second );
+            m_instancedMeshes.erase( mesh );
+        }
+        break;
+    }
+
+    default:
+        throw std::runtime_error( "Unknown call in render capture.  (RenderReplay::Execute)" );
+    }
+    return op;
+}
+
+
+void RenderReplay::ReleaseAll()
+{
+    if ( !IsGfxReady() )
+    {
+        return;
+    }
+    IRenderBackend& gfx = Gfx();
+    gfx.FlushGPU();
+
+    m_meshes.clear();
+    m_shaders.clear();
+    m_uniforms.clear();
+    m_framebuffers.clear();
+    m_framebufferTextures.clear();
+    for ( const auto& texture : m_textures )
+    {
+        gfx.DeleteTexture( texture.second );
+    }
+    m_textures.clear();
+    for ( const auto& vb : m_dynamicVBs )
+    {
+        gfx.DestroyDynamicVB( vb.second );
+    }
+    m_dynamicVBs.clear();
+    for ( const auto& mesh : m_instancedMeshes )
+    {
+        gfx.DestroyInstancedMesh( mesh.second );
+    }
+    m_instancedMeshes.clear();
+}
+
+
+bool RenderReplay::Run( int loops )
+{
+    if ( m_header.width != Gfx().GetWidth() || m_header.height != Gfx().GetHeight() )
+    {
+        printf( "Render replay: captured at %dx%d, replaying at %dx%d\n", m_header.width, m_header.height, Gfx().GetWidth(), Gfx().GetHeight() );
+    }
+
+    // Prologue: resources and state the captured frames start from
+    m_cursor = sizeof( RenderCaptureHeader );
+    RenderOp op;
+    do
+    {
+        op = Execute();
+    } while ( op != RenderOp::BeginFrames && op != RenderOp::EndOfStream );
+    if ( op != RenderOp::BeginFrames || m_header.frameCount == 0 )
+    {
+        throw std::runtime_error( "Render capture holds no frames.  (RenderReplay::Run)" );
+    }
+    size_t framesStart = m_cursor;
+
+    loops = ( std::max )( loops, 1 );
+    std::vector<float> frameMs;
+    frameMs.reserve( static_cast<size_t>( loops ) * m_header.frameCount );
+    bool isQuit = false;
+
+    Timer timer;
+    timer.StartTimer();
+    for ( int loop = 0; loop < loops && !isQuit; ++loop )
+    {
+        m_cursor = framesStart;
+        while ( !isQuit && ( op = Execute() ) != RenderOp::EndOfStream )
+        {
+            if ( op != RenderOp::Present )
+            {
+                continue;
+            }
+            frameMs.push_back( static_cast<float>( timer.GetTimeSinceLastStart() * 1000.0 ) );
+
+            // Keep the window responsive; the pump is left out of the frame times
+            MSG msg;
+            while ( PeekMessage( &msg, nullptr, 0, 0, PM_REMOVE ) )
+            {
+                if ( msg.message == WM_QUIT )
+                {
+                    isQuit = true;
+                }
+                TranslateMessage( &msg );
+                DispatchMessage( &msg );
+            }
+            timer.StartTimer();
+        }
+    }
+    Gfx().FlushGPU();
+
+    if ( frameMs.empty() )
+    {
+        return !isQuit;
+    }
+
+    // Per-frame times, in replay order
+    if ( !Cfg().replayReport.empty() )
+    {
+        FILE* f = nullptr;
+        if ( fopen_s( &f, Cfg().replayReport.c_str(), "w" ) == 0 && f )
+        {
+            fprintf( f, "renderer,loop,frame,ms\n" );
+            for ( size_t i = 0; i < frameMs.size(); ++i )
+            {
+                fprintf( f, "%s,%zu,%zu,%.4f\n", Gfx().GetRendererName(), i / m_header.frameCount + 1, i % m_header.frameCount + 1, frameMs[i] );
+            }
+            fclose( f );
+        }
+        else
+        {
+            fprintf( stderr, "Render replay: cannot write %s\n", Cfg().replayReport.c_str() );
+        }
+    }
+
+    std::vector<float> sorted( frameMs );
+    std::sort( sorted.begin(), sorted.end() );
+    double total = 0.0;
+    for ( float ms : sorted )
+    {
+        total += ms;
+    }
+    printf( "Render replay (%s): %zu frames over %d loops, mean %.3f ms, p50 %.3f ms, p99 %.3f ms, min %.3f ms, max %.3f ms\n",
+            Gfx().GetRendererName(), sorted.size(), loops, total / sorted.size(),
+            sorted[sorted.size() / 2], sorted[( sorted.size() * 99 ) / 100], sorted.front(), sorted.back() );
+    return !isQuit;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezRenderCapture.h"
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+/* -- RenderReplay -----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Plays a render capture written by RenderBackendCapture into the active backend (Gfx()), with no simulation,
+    scene logic or input, so backends can be profiled and compared on an identical command stream.
+
+    The prologue (resources and state built up before the captured frames) is executed once.  The captured
+    frames are then replayed back to back the requested number of times, timing each from the end of one
+    Present to the end of the next.  Objects, texture handles and uniform handles recorded in the stream are
+    mapped to the ones this backend issues.  Frames that create objects replace, on the next pass, the ones
+    they created the pass before; calls that refer to an object the stream has already destroyed are skipped.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class RenderReplay
+{
+
+  private:
+    std::vector<uint8_t> m_stream;
+    size_t m_cursor;
+    RenderCaptureHeader m_header;
+
+    std::vector<std::string> m_strings;                           // Index = string id
+    std::vector<std::unique_ptr<IShader>> m_shaders;              // Index = capture id
+    std::vector<std::vector<UniformHandle>> m_uniforms;           // [shader id][captured handle]
+    std::vector<std::unique_ptr<IMesh>> m_meshes;                 // Index = capture id
+    std::vector<std::unique_ptr<IFramebuffer>> m_framebuffers;    // Index = capture id
+    std::unordered_map<uint32_t, uint32_t> m_textures;            // Captured handle -> created texture
+    std::unordered_map<uint32_t, uint32_t> m_framebufferTextures; // Captured handle -> framebuffer colour texture
+    std::unordered_map<uint32_t, uint32_t> m_dynamicVBs;          // Captured handle -> dynamic VB
+    std::unordered_map<uint32_t, uint32_t> m_instancedMeshes;     // Captured handle -> instanced mesh
+
+    template <typename T>
+    T Read()
+    {
+        T value;
+        memcpy( &value, ReadRaw( sizeof( T ) ), sizeof( T ) );
+        return value;
+    }
+    const uint8_t* ReadRaw( size_t size );
+    const void* ReadData( size_t& size ); // Bulk data written by RenderBackendCapture::PutData (nullptr when empty)
+    const char* ReadString();             // String id -> text
+
+    IShader* FindShader( uint32_t id ) const;
+    IMesh* FindMesh( uint32_t id ) const;
+    IFramebuffer* FindFramebuffer( uint32_t id ) const;
+    UniformHandle FindUniform( uint32_t shader, int32_t handle ) const;
+    UploadSpan Upload( const void* data, size_t size ); // Copies recorded span data into the upload ring
+    void ReleaseAll();                                  // Destroys every object the replay created
+
+    RenderOp Execute(); // Runs the next recorded call and returns its opcode
+
+  public:
+    explicit RenderReplay( const char* path );
+    ~RenderReplay();
+
+    // Replays the captured frames loops times; prints a summary and writes Cfg().replayReport.  False if the window closed early.
+    bool Run( int loops );
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
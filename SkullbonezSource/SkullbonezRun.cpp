@@ -5,11 +5,13 @@
 #include "SkullbonezGameModel.h"
 #include "SkullbonezProfiler.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
 #include "SkullbonezCollisionResponse.h"
 #include <time.h>
 #include <cstring>
 #include <psapi.h>
 #include <cmath>
+#include <algorithm>
 
 // Define to enable per-frame omega/velocity angle logging to Debug/vector_log.csv
 #define VECTOR_LOG_ENABLED
@@ -39,6 +41,8 @@ SkullbonezRun::SkullbonezRun( std::vector<std::string> sceneQueue )
     m_screenshotInterval = -1;
     m_intervalCaptureCount = 0;
     m_screenshotDir[0] = '\0';
+    m_videoStride = -1;
+    m_videoFrameCount = 0;
     m_perfLogPath[0] = '\0';
     m_perfLogFile = nullptr;
     m_physicsLogFile = nullptr;
@@ -62,6 +66,9 @@ SkullbonezRun::SkullbonezRun( std::vector<std::string> sceneQueue )
     m_isWaterNoReflect = false;
     m_isWaterFlatDebug = false;
     m_isDebugVectors = false;
+    m_isSimulationPaused = false;
+    m_reflectionAge = 0;
+    m_isReflectionValid = false;
     m_timeScale = 1.0f;
     m_frozenWaterTime = 0.0f;
     m_trackBallIndex = -1;
@@ -69,13 +76,18 @@ SkullbonezRun::SkullbonezRun( std::vector<std::string> sceneQueue )
     m_autoCycleInterval = -1.0f;
     m_autoCycleAccum = 0.0f;
     m_autoCycleShotsTaken = 0;
+    m_isTerrainDeformed = false;
     m_sInputState = {};
     m_modelCount = 0;
+    SkullbonezHelper::SetSphereImpostors( Cfg().sphereImpostors );
 }
 
 
 SkullbonezRun::~SkullbonezRun()
 {
+    // The simulation thread reads the terrain and writes the collection; join it before either goes away
+    m_cSimulationThread.Stop();
+
     if ( m_perfLogFile )
     {
         fclose( m_perfLogFile );
@@ -99,6 +111,10 @@ SkullbonezRun::~SkullbonezRun()
     // Flush GPU before destroying resources to avoid use-after-free
     if ( IsGfxReady() )
     {
+        // Readbacks still in flight go to the image writer, which finishes them before it is destroyed
+        while ( CollectScreenshot( true ) )
+        {
+        }
         Gfx().FlushGPU();
     }
 
@@ -154,10 +170,11 @@ void SkullbonezRun::Initialise()
         m_cWorldEnvironment.SetTerrainBounds( tb.m_xMin, tb.m_xMax, tb.m_zMin, tb.m_zMax );
     }
 
-    // Init reflection FBO at the current viewport size
-    int fboW = Gfx().GetWidth() * 2;
-    int fboH = Gfx().GetHeight() * 2;
+    // Init reflection FBO, scaled from the current viewport size
+    int fboW = ( std::max )( 1, static_cast<int>( Gfx().GetWidth() * Cfg().reflectionScale ) );
+    int fboH = ( std::max )( 1, static_cast<int>( Gfx().GetHeight() * Cfg().reflectionScale ) );
     m_cReflectionFBO = Gfx().CreateFramebuffer( fboW, fboH );
+    m_isReflectionValid = false;
 
     // Init font (HDC, font)
     Text2d::BuildFont( m_cWindow->m_sDevice, "Verdana" );
@@ -255,10 +272,28 @@ void SkullbonezRun::Run()
                 UpdateLogic( static_cast<float>( secondsPerFrame ) * m_timeScale );
             }
 
-            // Drain GPU pipeline before render
-            PROFILE_BEGIN( "Frame/PipelineSync" );
-            Gfx().Finish();
-            PROFILE_END( "Frame/PipelineSync" );
+            // Simulation above overlapped the GPU's previous frames; before recording this one, wait only
+            // until the GPU has retired the frame whose per-frame resources it reuses
+            PROFILE_BEGIN( "Frame/GpuWait" );
+            Gfx().WaitForFrameSlot();
+            PROFILE_END( "Frame/GpuWait" );
+
+            // Scene ground edits upload mesh rows, so they wait for the frame slot like any other upload
+            if ( m_isSceneMode && !m_sceneDeforms.empty() )
+            {
+                ApplySceneDeforms();
+            }
+
+            // Pick up the newest body transforms; without the simulation thread this frame publishes its own
+            if ( m_cSimulationThread.IsRunning() )
+            {
+                PROFILE_COUNTER_ADD( "Sim/Steps", m_cSimulationThread.TakeStepCount() );
+            }
+            else
+            {
+                m_cGameModelCollection.PublishRenderState();
+            }
+            m_cGameModelCollection.AcquireRenderState();
 
             // Render
             PROFILE_GPU_BEGIN( "Frame/Render" );
@@ -312,19 +347,42 @@ void SkullbonezRun::Run()
                 {
                     ++m_intervalCaptureCount;
                     char intervalPath[512];
-                    sprintf_s( intervalPath, sizeof( intervalPath ), "%s/capture_%04d.bmp", m_screenshotDir, m_intervalCaptureCount );
+                    sprintf_s( intervalPath, sizeof( intervalPath ), "%s/capture_%04d.%s", m_screenshotDir, m_intervalCaptureCount, Cfg().captureFormat.c_str() );
                     SaveScreenshot( intervalPath );
                 }
             }
 
+            // Video capture: append a frame to the scene's y4m stream every N frames
+            bool isVideoFrame = false;
+            if ( m_isSceneMode && m_videoStride > 0 && ( m_currentFrame + 1 ) % m_videoStride == 0 )
+            {
+                SaveScreenshot( "" );
+                ++m_videoFrameCount;
+                isVideoFrame = true;
+            }
+
             // Auto-cycle screenshots (scene directive: auto_cycle_interval N).
             // Every N real seconds: screenshot current tracked ball, cycle to next, exit when all done.
+            // With capture_video the shot is a frame of the stream (shared with an interval frame on the same
+            // frame), otherwise a file per ball.
             if ( m_isSceneMode && m_autoCycleInterval > 0.0f && m_autoCycleAccum >= m_autoCycleInterval )
             {
                 int ballCount = m_cGameModelCollection.GetModelCount();
                 char shotPath[256];
-                sprintf_s( shotPath, sizeof( shotPath ), "Profile/cardinal_ball%d.bmp", m_autoCycleShotsTaken );
-                SaveScreenshot( shotPath );
+                if ( m_videoStride > 0 )
+                {
+                    if ( !isVideoFrame )
+                    {
+                        SaveScreenshot( "" );
+                        ++m_videoFrameCount;
+                    }
+                    sprintf_s( shotPath, sizeof( shotPath ), "video frame %d", m_videoFrameCount - 1 );
+                }
+                else
+                {
+                    sprintf_s( shotPath, sizeof( shotPath ), "Profile/cardinal_ball%d.%s", m_autoCycleShotsTaken, Cfg().captureFormat.c_str() );
+                    SaveScreenshot( shotPath );
+                }
                 fprintf( stdout, "Auto-shot %d: ball index %d -> %s\n", m_autoCycleShotsTaken, m_trackBallIndex, shotPath );
                 fflush( stdout );
 
@@ -347,6 +405,16 @@ void SkullbonezRun::Run()
             Gfx().Present();
             PROFILE_END( "Frame/VsyncWait" );
 
+            // Hand screenshots whose readback has landed to the writer thread; never waits on the GPU
+            if ( !m_pendingScreenshots.empty() )
+            {
+                PROFILE_BEGIN( "Frame/Screenshots" );
+                while ( CollectScreenshot( false ) )
+                {
+                }
+                PROFILE_END( "Frame/Screenshots" );
+            }
+
             m_cFrameTimer.StopTimer();
 
             // Close profiler frame and refresh timing fields
@@ -356,7 +424,8 @@ void SkullbonezRun::Run()
                 using SkullbonezCore::Basics::Profiler;
                 static constexpr uint32_t kPhysicsHash = ::HashStr( "Frame/Physics" );
                 static constexpr uint32_t kRenderHash = ::HashStr( "Frame/Render" );
-                m_physicsTime = Profiler::Instance().LastFrameMsByHash( kPhysicsHash ) * 0.001f;
+                m_physicsTime = m_cSimulationThread.IsRunning() ? m_cSimulationThread.GetLastStepMs() * 0.001f
+                                                                : Profiler::Instance().LastFrameMsByHash( kPhysicsHash ) * 0.001f;
                 m_renderTime = Profiler::Instance().LastFrameMsByHash( kRenderHash ) * 0.001f;
             }
 #endif
@@ -433,6 +502,9 @@ void SkullbonezRun::Run()
             }
         }
     }
+
+    // Screenshots taken on the last frames are still being read back or encoded
+    FlushScreenshots();
 }
 
 
@@ -484,6 +556,10 @@ void SkullbonezRun::TakeInput()
     }
     m_isWaterNoReflect = ( Input::IsKeyToggled( '2' ) != 0 ); // Reflection default ON
     m_isWaterFlatDebug = ( Input::IsKeyToggled( '3' ) != 0 ); // Ocean wave displacement ON
+
+    // Ball renderer: '4' flips between the configured path and the other one (mesh LODs / impostors)
+    SkullbonezHelper::SetSphereImpostors( Cfg().sphereImpostors != ( Input::IsKeyToggled( '4' ) != 0 ) );
+
     // Debug vectors: in scene mode, start from the scene-loaded value and edge-detect '9' toggles.
     // In legacy mode, mirror the Windows key-toggle state.
     if ( m_isSceneMode )
@@ -564,7 +640,17 @@ void SkullbonezRun::TakeInput()
 
 void SkullbonezRun::UpdateLogic( float fSecondsPerFrame )
 {
-    if ( !m_isFlyMode || Input::IsKeyDown( VK_SPACE ) )
+    bool isStepping = !m_isFlyMode || Input::IsKeyDown( VK_SPACE );
+    if ( m_cSimulationThread.IsRunning() )
+    {
+        // The simulation thread keeps its own clock; only tell it when fly mode pauses or resumes it
+        if ( isStepping == m_isSimulationPaused &&
+             m_cSimulationThread.PushCommand( SimulationThread::CommandType::SetPaused, isStepping ? 0.0f : 1.0f ) )
+        {
+            m_isSimulationPaused = !isStepping;
+        }
+    }
+    else if ( isStepping )
     {
         // update the game models (sub-markers added inside RunPhysics)
         PROFILE_BEGIN( "Frame/Physics" );
@@ -647,11 +733,62 @@ void SkullbonezRun::Render()
     // set the camera into its m_position
     m_cCameras->SetCamera();
 
+    {
+        PROFILE_SCOPED( "Frame/Render/TerrainStreaming" );
+        StreamTerrain( false );
+    }
+
     // now camera rotation has been done, draw OpenGL primitives
     DrawPrimitives();
 }
 
 
+void SkullbonezRun::StreamTerrain( bool isLoading )
+{
+    m_terrainFocus.clear();
+    m_terrainFocus.push_back( m_cCameras->GetCameraTranslation() );
+    if ( isLoading )
+    {
+        // Nothing has been published to the renderer yet
+        for ( int i = 0; i < m_cGameModelCollection.GetModelCount(); ++i )
+        {
+            m_terrainFocus.push_back( m_cGameModelCollection.GetModelAtIndex( i ).GetPosition() );
+        }
+    }
+    else
+    {
+        for ( const GameModelCollection::RenderBody& body : m_cGameModelCollection.GetRenderBodies() )
+        {
+            m_terrainFocus.push_back( Vector3( body.instance[0], body.instance[1], body.instance[2] ) );
+        }
+    }
+
+    m_cTerrain->UpdateStreaming( m_terrainFocus.data(), static_cast<int>( m_terrainFocus.size() ), isLoading );
+}
+
+
+void SkullbonezRun::ApplySceneDeforms()
+{
+    PROFILE_SCOPED( "Frame/Deform" );
+
+    int lastFrame = 0;
+    for ( const SceneDeform& deform : m_sceneDeforms )
+    {
+        if ( m_currentFrame < deform.frames )
+        {
+            m_isTerrainDeformed |= m_cTerrain->Deform( Vector3( deform.x, 0.0f, deform.z ), deform.radius, deform.delta );
+        }
+        lastFrame = ( std::max )( lastFrame, deform.frames );
+    }
+
+    // Everything Deform patched in place must agree with building the terrain from scratch
+    if ( m_currentFrame + 1 == lastFrame && !m_cTerrain->CheckAgainstRebuild() )
+    {
+        throw std::runtime_error( "Deformed terrain differs from a full rebuild.  (SkullbonezRun::ApplySceneDeforms)" );
+    }
+}
+
+
 void SkullbonezRun::DrawPrimitives()
 {
     float lightPosition[] = { 200.0f, 400.0f, 1200.0f, 1.0f };
@@ -659,22 +796,16 @@ void SkullbonezRun::DrawPrimitives()
     // Get view and projection matrices from camera/window
     Matrix4 baseView = m_cCameras->GetViewMatrix();
     Matrix4 proj = m_cWindow->GetProjectionMatrix();
-    Matrix4 reflVP;
 
     // Camera m_position for skybox placement
     Vector3 eye = m_cCameras->GetCameraTranslation();
 
-    // render skybox ------------------------------
-    {
-        PROFILE_GPU_SCOPED( "Frame/Render/Skybox" );
-        Matrix4 skyView = baseView * Matrix4::Translate( eye.x, Cfg().skyboxRenderHeight, eye.z ) * Matrix4::Scale( Cfg().skyboxScale );
-        m_cSkyBox->Render( skyView, proj );
-    }
+    // Subsystems submit packets to the render queue; each pass is sorted and executed by its Flush()
+    RenderQueue& queue = RenderQueue::Instance();
 
     // reflection pre-pass: render above-water scene from mirrored camera into FBO
     // TODO: this needs to run when camera m_isTweening!!
     {
-        PROFILE_GPU_SCOPED( "Frame/Render/Reflection" );
         float waterY = m_cWorldEnvironment.GetFluidSurfaceHeight();
         Vector3 center = m_cCameras->GetCameraView();
 
@@ -683,59 +814,115 @@ void SkullbonezRun::DrawPrimitives()
         Vector3 reflCenter( center.x, 2.0f * waterY - center.y, center.z );
         Vector3 reflUp( 0.0f, -1.0f, 0.0f );
         Matrix4 reflView = Matrix4::LookAt( reflEye, reflCenter, reflUp );
-        reflVP = proj * reflView;
+        Matrix4 reflVP = proj * reflView;
+        const float reflClip[4] = { 0.0f, 1.0f, 0.0f, -waterY };
 
-        m_cReflectionFBO->Bind();
-        Gfx().SetViewport( 0, 0, m_cReflectionFBO->GetWidth(), m_cReflectionFBO->GetHeight() );
-        Gfx().Clear( true, true );
+        // Keep last frame's reflection unless it is old enough and the camera or a reflected body has moved
+        ++m_reflectionAge;
+        bool isStale = !m_isReflectionValid;
+        if ( !isStale && m_reflectionAge >= Cfg().reflectionInterval )
+        {
+            float threshold = Cfg().reflectionReuseThreshold;
+            Frustum reflFrustum( reflVP );
+            reflFrustum.SetClipPlane( reflClip[0], reflClip[1], reflClip[2], reflClip[3] );
+            isStale = Vector::Distance( eye, m_reflectionEye ) > threshold || Vector::Distance( center, m_reflectionCenter ) > threshold ||
+                      m_cGameModelCollection.HasVisibleMotion( reflFrustum, m_reflectionBodies, threshold );
+        }
 
-        // Skybox reflected (XZ follows eye; Y anchored at Cfg().skyboxRenderHeight)
+        if ( isStale )
         {
-            PROFILE_GPU_SCOPED( "Frame/Render/Reflection/Skybox" );
-            Matrix4 skyReflView = reflView * Matrix4::Translate( eye.x, Cfg().skyboxRenderHeight, eye.z ) * Matrix4::Scale( Cfg().skyboxScale );
-            m_cSkyBox->Render( skyReflView, proj );
+            PROFILE_GPU_SCOPED( "Frame/Render/Reflection" );
+            m_cReflectionFBO->Bind();
+            Gfx().SetViewport( 0, 0, m_cReflectionFBO->GetWidth(), m_cReflectionFBO->GetHeight() );
+            Gfx().Clear( true, true );
+
+            // Skybox reflected (XZ follows eye; Y anchored at Cfg().skyboxRenderHeight)
+            {
+                PROFILE_SCOPED( "Frame/Render/Reflection/Skybox" );
+                Matrix4 skyReflView = reflView * Matrix4::Translate( eye.x, Cfg().skyboxRenderHeight, eye.z ) * Matrix4::Scale( Cfg().skyboxScale );
+                m_cSkyBox->Render( skyReflView, proj );
+            }
+
+            // Game models reflected — culled against the mirrored frustum and water plane, clipped at the surface
+            PROFILE_BEGIN( "Frame/Render/Reflection/Balls" );
+            SkullbonezHelper::SetClipPlaneEnabled( true );
+            SkullbonezHelper::SetClipPlane( 0.0f, 1.0f, 0.0f, -waterY );
+            int reflVisible = m_cGameModelCollection.RenderModels( reflView, proj, lightPosition, m_cReflectionFBO->GetHeight(), reflClip );
+            PROFILE_COUNTER_ADD( "Cull/Reflection/Visible", reflVisible );
+            PROFILE_COUNTER_ADD( "Cull/Reflection/Culled", m_cGameModelCollection.GetModelCount() - reflVisible );
+            SkullbonezHelper::SetClipPlaneEnabled( false );
+            SkullbonezHelper::SetClipPlane( 0.0f, 1.0f, 0.0f, 1.0e9f );
+            PROFILE_END( "Frame/Render/Reflection/Balls" );
+
+            queue.Flush();
+            m_cReflectionFBO->Unbind();
+            Gfx().SetViewport( 0, 0, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
+
+            m_reflectionVP = reflVP;
+            m_reflectionEye = eye;
+            m_reflectionCenter = center;
+            m_cGameModelCollection.SnapshotRenderBodies( m_reflectionBodies );
+            m_reflectionAge = 0;
+            m_isReflectionValid = true;
         }
+        else
+        {
+            PROFILE_COUNTER_ADD( "Reflection/Reused", 1 );
+        }
+    }
 
-        // Game models reflected — clip at water surface (above-water portion only)
-        PROFILE_GPU_BEGIN( "Frame/Render/Reflection/Balls" );
-        Gfx().SetClipPlane( 0, true );
-        SkullbonezHelper::SetClipPlane( 0.0f, 1.0f, 0.0f, -waterY );
-        m_cTextures->SelectTexture( TEXTURE_BOUNDING_SPHERE );
-        m_cGameModelCollection.RenderModels( reflView, proj, lightPosition );
-        Gfx().SetClipPlane( 0, false );
-        SkullbonezHelper::SetClipPlane( 0.0f, 1.0f, 0.0f, 1.0e9f );
-        PROFILE_GPU_END( "Frame/Render/Reflection/Balls" );
+    // terrain horizon for the main view: balls and shadows behind hills are skipped
+    {
+        PROFILE_SCOPED( "Frame/Render/Horizon" );
+        if ( Cfg().horizonCulling )
+        {
+            m_cTerrain->BuildHorizon( eye, m_terrainHorizon );
+        }
+        else
+        {
+            m_terrainHorizon.Disable();
+        }
+    }
 
-        m_cReflectionFBO->Unbind();
-        Gfx().SetViewport( 0, 0, m_cWindow->m_sWindowDimensions.x, m_cWindow->m_sWindowDimensions.y );
+    // render skybox ------------------------------
+    {
+        PROFILE_SCOPED( "Frame/Render/Skybox" );
+        Matrix4 skyView = baseView * Matrix4::Translate( eye.x, Cfg().skyboxRenderHeight, eye.z ) * Matrix4::Scale( Cfg().skyboxScale );
+        m_cSkyBox->Render( skyView, proj );
     }
 
     // render game models -----------------------------
-    PROFILE_GPU_BEGIN( "Frame/Render/Balls" );
-    m_cTextures->SelectTexture( TEXTURE_BOUNDING_SPHERE );
-    m_cGameModelCollection.RenderModels( baseView, proj, lightPosition );
-    PROFILE_GPU_END( "Frame/Render/Balls" );
+    PROFILE_BEGIN( "Frame/Render/Balls" );
+    int mainVisible = m_cGameModelCollection.RenderModels( baseView, proj, lightPosition, m_cWindow->m_sWindowDimensions.y, nullptr, &m_terrainHorizon );
+    PROFILE_COUNTER_ADD( "Cull/Main/Visible", mainVisible );
+    PROFILE_COUNTER_ADD( "Cull/Main/Culled", m_cGameModelCollection.GetModelCount() - mainVisible );
+    PROFILE_END( "Frame/Render/Balls" );
 
     // render m_terrain ------------------------------
     {
-        PROFILE_GPU_SCOPED( "Frame/Render/Terrain" );
-        m_cTextures->SelectTexture( TEXTURE_GROUND );
+        PROFILE_SCOPED( "Frame/Render/Terrain" );
         m_cTerrain->Render( baseView, proj, lightPosition );
     }
 
     // render ground shadows on top of m_terrain
     {
-        PROFILE_GPU_SCOPED( "Frame/Render/Shadows" );
-        m_cGameModelCollection.RenderShadows( m_cTerrain.get(), baseView, proj );
+        PROFILE_SCOPED( "Frame/Render/Shadows" );
+        m_cGameModelCollection.RenderShadows( m_cTerrain.get(), baseView, proj, &m_terrainHorizon );
     }
 
     // render the fluid ---------------------------
     {
-        PROFILE_GPU_SCOPED( "Frame/Render/Water" );
+        PROFILE_SCOPED( "Frame/Render/Water" );
         float waterTime = m_isWaterFreezeDebug
                               ? m_frozenWaterTime
                               : static_cast<float>( m_cSimulationTimer.GetTimeSinceLastStart() );
-        m_cWorldEnvironment.RenderFluid( baseView, proj, reflVP, waterTime, m_cReflectionFBO->GetColorTextureHandle(), m_isWaterFlatDebug, m_isWaterNoReflect );
+        m_cWorldEnvironment.RenderFluid( baseView, proj, m_reflectionVP, waterTime, m_cReflectionFBO->GetColorTextureHandle(), m_isWaterFlatDebug, m_isWaterNoReflect );
+    }
+
+    // execute the main pass (sky → opaque → decals → transparent)
+    {
+        PROFILE_GPU_SCOPED( "Frame/Render/Execute" );
+        queue.Flush( true );
     }
 
     // debug vector overlay — GL only, toggled with V (or debug_vectors in scene)
@@ -751,13 +938,11 @@ void SkullbonezRun::DrawPrimitives()
         std::vector<std::pair<Vector3, Vector3>> upAlignedLines;
         std::vector<std::pair<Vector3, Vector3>> upErrorLines;
         const float axisToleranceRad = 5.0f * _PI / 180.0f;
-        int modelCount = m_cGameModelCollection.GetModelCount();
-        for ( int i = 0; i < modelCount; ++i )
+        for ( const GameModelCollection::RenderBody& body : m_cGameModelCollection.GetRenderBodies() )
         {
-            GameModel& mdl = m_cGameModelCollection.GetModelAtIndex( i );
-            Vector3 pos = mdl.GetPosition();
-            Vector3 vel = mdl.GetVelocity();
-            Vector3 omega = mdl.GetAngularVelocity();
+            Vector3 pos( body.instance[0], body.instance[1], body.instance[2] );
+            Vector3 vel = body.velocity;
+            Vector3 omega = body.angularVelocity;
             const float velScale = 0.5f;
             const float omegaScale = 2.0f;
             velLines.push_back( { pos, pos + vel * velScale } );
@@ -765,8 +950,8 @@ void SkullbonezRun::DrawPrimitives()
 
             // White spike: starts at sphere centre, points along the visual "up" axis.
             // Length = 2.5× radius so it clearly protrudes above the ball surface.
-            Vector3 orientUp = mdl.GetOrientationUp();
-            float radius = mdl.GetBoundingRadius();
+            Vector3 orientUp = body.orientationUp;
+            float radius = body.instance[3];
             bool isWithinPlaneTolerance = false;
             float omegaMag = Vector::VectorMag( omega );
             float orientUpMag = Vector::VectorMag( orientUp );
@@ -879,6 +1064,10 @@ void SkullbonezRun::DrawWindowText( const double dSecondsPerFrame )
         Profiler::Instance().RenderOverlay( -0.53f, -0.43f, 0.018f, 0.012f, m_r_fpsTime );
     }
 #endif
+
+    // All of the frame's text and HUD quads go out as one draw
+    Text2d::FlushBatch();
+    RenderQueue::Instance().Flush();
 }
 
 
@@ -1022,7 +1211,10 @@ void SkullbonezRun::MoveCamera( float keyMovementQty, float mouseMovementQty )
     if ( !m_isFlyMode && !m_isSceneMode )
     {
         Vector3 translatedCameraPosition = m_cCameras->GetCameraTranslation();
-        float minY = m_cTerrain->GetTerrainHeightAt( translatedCameraPosition.x, translatedCameraPosition.z, true ) + Cfg().minCameraHeight;
+
+        // Above the highest ground in the camera's cell (and the water) there is nothing to clamp against
+        float clearY = ( std::max )( m_cTerrain->GetMaxHeightInRegion( translatedCameraPosition.x, translatedCameraPosition.z, translatedCameraPosition.x, translatedCameraPosition.z ), Cfg().fluidHeight ) + Cfg().minCameraHeight;
+        float minY = translatedCameraPosition.y >= clearY ? clearY : m_cTerrain->GetTerrainHeightAt( translatedCameraPosition.x, translatedCameraPosition.z, true ) + Cfg().minCameraHeight;
         if ( minY > translatedCameraPosition.y )
         {
             m_cCameras->AmmendPrimaryY( minY );
@@ -1094,6 +1286,12 @@ void SkullbonezRun::SetUpGameModelsFromScene( const TestScene& scene )
 
 void SkullbonezRun::LoadScene( int index )
 {
+    // The collection and terrain are rebuilt below; the simulation thread must not be stepping them
+    m_cSimulationThread.Stop();
+
+    // The previous scene's captures must be on disk before the next scene (or the test harness) looks for them
+    FlushScreenshots();
+
     // Flush GPU before destroying scene resources to avoid use-after-free
     if ( IsGfxReady() )
     {
@@ -1133,16 +1331,26 @@ void SkullbonezRun::LoadScene( int index )
     m_screenshotInterval = -1;
     m_intervalCaptureCount = 0;
     m_screenshotDir[0] = '\0';
+    m_videoStride = -1;
+    m_videoFrameCount = 0;
     m_perfLogPath[0] = '\0';
 
     // Reset cameras and game models
     m_cCameras->Reset();
     m_cGameModelCollection.Clear();
 
+    // A scene's ground edits do not carry into the next scene
+    if ( m_isTerrainDeformed )
+    {
+        m_cTerrain = std::make_unique<Terrain>( Cfg().terrainRaw.c_str(), 256, 8, 15 );
+        m_isTerrainDeformed = false;
+    }
+
     // Reset input and debug state
     m_isFlyMode = false;
     m_isWaterFreezeDebug = false;
     m_isWaterNoReflect = false;
+    m_isReflectionValid = false;
     m_isWaterFlatDebug = false;
     m_isDebugVectors = false;
     m_timeScale = 1.0f;
@@ -1152,6 +1360,7 @@ void SkullbonezRun::LoadScene( int index )
     m_autoCycleInterval = -1.0f;
     m_autoCycleAccum = 0.0f;
     m_autoCycleShotsTaken = 0;
+    m_sceneDeforms.clear();
     m_sInputState = {};
     m_isProfilerOverlay = true;
     m_selectedCamera = 0;
@@ -1205,6 +1414,13 @@ void SkullbonezRun::LoadScene( int index )
             CreateDirectoryA( m_screenshotDir, nullptr );
         }
 
+        // Video capture: one stream file for the whole scene instead of a file per capture
+        if ( scene.GetVideoPath()[0] != '\0' )
+        {
+            m_cImageWriter.OpenVideo( scene.GetVideoPath(), scene.GetVideoDownscale(), scene.GetVideoStride() );
+            m_videoStride = scene.GetVideoStride();
+        }
+
         // Perf test: open CSV log file
         const char* pPerfPath = scene.GetPerfLogPath();
         if ( pPerfPath[0] != '\0' )
@@ -1260,6 +1476,16 @@ void SkullbonezRun::LoadScene( int index )
             Gfx().FlushGPU();
             m_cTerrain = std::make_unique<Terrain>( scene.GetFlatBaseY(), scene.GetFlatSlopeX(), scene.GetFlatSlopeZ() );
         }
+        else if ( scene.HasProceduralTerrain() )
+        {
+            Gfx().FlushGPU();
+            m_cTerrain = std::make_unique<Terrain>( scene.GetProceduralSeed() );
+        }
+
+        for ( int i = 0; i < scene.GetDeformCount(); ++i )
+        {
+            m_sceneDeforms.push_back( scene.GetDeform( i ) );
+        }
 
         SetUpCamerasFromScene( scene );
 
@@ -1272,6 +1498,9 @@ void SkullbonezRun::LoadScene( int index )
             SetUpGameModelsFromScene( scene );
         }
 
+        // Ground under the spawn points must be solid before the first physics step
+        StreamTerrain( true );
+
         // Ball-tracking camera: enabled when scene specifies a positive track_height
         if ( scene.GetTrackHeight() > 0.0f )
         {
@@ -1292,6 +1521,14 @@ void SkullbonezRun::LoadScene( int index )
     m_cUpdateTimer.StartTimer();
     m_cCameraTimer.StartTimer();
     m_cSimulationTimer.StartTimer();
+
+    // Legacy mode steps physics on its own thread; scene mode stays in lockstep with the frame counter so
+    // its captures and logs remain deterministic
+    if ( !m_isSceneMode && Cfg().simulationThread )
+    {
+        m_cSimulationThread.Start( &m_cGameModelCollection, Cfg().simulationRate, m_timeScale );
+        m_isSimulationPaused = false;
+    }
 }
 
 
@@ -1321,58 +1558,52 @@ bool SkullbonezRun::AdvanceScene()
 
 void SkullbonezRun::SaveScreenshot( const char* path )
 {
-    // Capture backbuffer via render backend (returns BGR, bottom-up, 4-byte aligned rows)
-    int m_width = 0;
-    int m_height = 0;
-    std::vector<uint8_t> pixels = Gfx().CaptureBackbuffer( m_width, m_height );
-
-    // Row stride padded to 4-byte boundary (BMP requirement)
-    int rowStride = ( m_width * 3 + 3 ) & ~3;
-    int imageSize = rowStride * m_height;
-
-    // BMP file header (14 bytes)
-    unsigned char fileHeader[14] = {};
-    int fileSize = 14 + 40 + imageSize;
-    fileHeader[0] = 'B';
-    fileHeader[1] = 'M';
-    fileHeader[2] = (unsigned char)( fileSize );
-    fileHeader[3] = (unsigned char)( fileSize >> 8 );
-    fileHeader[4] = (unsigned char)( fileSize >> 16 );
-    fileHeader[5] = (unsigned char)( fileSize >> 24 );
-    fileHeader[10] = 54; // pixel data offset
-
-    // BMP info header (40 bytes)
-    unsigned char infoHeader[40] = {};
-    infoHeader[0] = 40; // header size
-    infoHeader[4] = (unsigned char)( m_width );
-    infoHeader[5] = (unsigned char)( m_width >> 8 );
-    infoHeader[6] = (unsigned char)( m_width >> 16 );
-    infoHeader[7] = (unsigned char)( m_width >> 24 );
-    infoHeader[8] = (unsigned char)( m_height );
-    infoHeader[9] = (unsigned char)( m_height >> 8 );
-    infoHeader[10] = (unsigned char)( m_height >> 16 );
-    infoHeader[11] = (unsigned char)( m_height >> 24 );
-    infoHeader[12] = 1;  // color planes
-    infoHeader[14] = 24; // bits per pixel
-    infoHeader[20] = (unsigned char)( imageSize );
-    infoHeader[21] = (unsigned char)( imageSize >> 8 );
-    infoHeader[22] = (unsigned char)( imageSize >> 16 );
-    infoHeader[23] = (unsigned char)( imageSize >> 24 );
-
-    // Write to file
-    FILE* file = nullptr;
-    errno_t err = fopen_s( &file, path, "wb" );
-    if ( err != 0 || !file )
-    {
-        char msg[512];
-        sprintf_s( msg, sizeof( msg ), "Failed to open screenshot file: %s  (SkullbonezRun::SaveScreenshot)", path );
-        throw std::runtime_error( msg );
-    }
-
-    fwrite( fileHeader, 1, 14, file );
-    fwrite( infoHeader, 1, 40, file );
-    fwrite( pixels.data(), 1, static_cast<size_t>( imageSize ), file );
-    fclose( file );
+    // Every readback slot busy: retire the oldest first (only stalls when captures outpace the GPU)
+    if ( !Gfx().RequestBackbufferCapture() )
+    {
+        CollectScreenshot( true );
+        if ( !Gfx().RequestBackbufferCapture() )
+        {
+            throw std::runtime_error( "Failed to queue backbuffer capture.  (SkullbonezRun::SaveScreenshot)" );
+        }
+    }
+    m_pendingScreenshots.push_back( path );
+}
+
+
+bool SkullbonezRun::CollectScreenshot( bool wait )
+{
+    if ( m_pendingScreenshots.empty() )
+    {
+        return false;
+    }
+
+    CapturedImage image;
+    if ( !Gfx().PollBackbufferCapture( image, wait ) )
+    {
+        return false;
+    }
+
+    if ( m_pendingScreenshots.front().empty() )
+    {
+        m_cImageWriter.SubmitVideoFrame( std::move( image ) );
+    }
+    else
+    {
+        m_cImageWriter.Submit( m_pendingScreenshots.front().c_str(), std::move( image ) );
+    }
+    m_pendingScreenshots.pop_front();
+    return true;
+}
+
+
+void SkullbonezRun::FlushScreenshots()
+{
+    while ( CollectScreenshot( true ) )
+    {
+    }
+    m_cImageWriter.Flush();
+    m_cImageWriter.CloseVideo();
 }
 
 
@@ -2,6 +2,7 @@
 
 
 // --- Includes ---
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,6 +17,8 @@
 #include "SkullbonezSkyBox.h"
 #include "SkullbonezGeometricMath.h"
 #include "SkullbonezGameModelCollection.h"
+#include "SkullbonezSimulationThread.h"
+#include "SkullbonezImageWriter.h"
 #include "SkullbonezWorldEnvironment.h"
 #include "SkullbonezIFramebuffer.h"
 #include "SkullbonezTestScene.h"
@@ -80,10 +83,19 @@ class SkullbonezRun
     TextureCollection* m_cTextures;                 // SkullbonezCore::Textures::TextureCollection class
     SkullbonezWindow* m_cWindow;                    // SkullbonezCore::Basics::SkullbonezWindow class
     std::unique_ptr<Terrain> m_cTerrain;            // SkullbonezCore::Geometry::Terrain class
+    std::vector<Vector3> m_terrainFocus;            // Camera and body positions the procedural terrain streams around
+    TerrainHorizon m_terrainHorizon;                // Ground occluding the main view, rebuilt each frame from the camera
     SkyBox* m_cSkyBox;                              // SkullbonezCore::Geometry::SkyBox class
     WorldEnvironment m_cWorldEnvironment;           // SkullbonezCore::Environment::WorldEnvironment class
     GameModelCollection m_cGameModelCollection;     // SkullbonezCore::GameObjects::GameModelCollection class
+    SimulationThread m_cSimulationThread;           // Steps m_cGameModelCollection off the render thread (legacy mode)
     std::unique_ptr<IFramebuffer> m_cReflectionFBO; // Offscreen reflection render target
+    Matrix4 m_reflectionVP;                         // Mirrored view-projection the reflection target was last rendered with
+    Vector3 m_reflectionEye;                        // Camera eye when the reflection was last rendered
+    Vector3 m_reflectionCenter;                     // Camera look-at target when the reflection was last rendered
+    std::vector<float> m_reflectionBodies;          // Body instance data when the reflection was last rendered
+    int m_reflectionAge;                            // Frames since the reflection was last rendered
+    bool m_isReflectionValid;                       // Reflection target holds a usable image (false = must render this frame)
     InputState m_sInputState;                       // Current frame input state
     bool m_isFlyMode;                               // Free-fly camera mode active (toggle with F)
     bool m_isProfilerOverlay;                       // Profiler overlay visible (toggle with 0; default ON in profile builds)
@@ -91,6 +103,11 @@ class SkullbonezRun
     bool m_isWaterNoReflect;                        // Disable ocean reflection, output flat tint (toggle with 2)
     bool m_isWaterFlatDebug;                        // Force ocean mesh fully flat, no displacement (toggle with 3)
     bool m_isDebugVectors;                          // Draw velocity (green) and angular velocity (red) vectors (toggle with V)
+    bool m_isSimulationPaused;                      // Pause state last sent to the simulation thread
+    ImageWriter m_cImageWriter;                     // Encodes and writes screenshots off the render thread
+    std::deque<std::string> m_pendingScreenshots;   // Output paths of readbacks still in flight, oldest first ("" = video frame)
+    int m_videoStride;                              // Append a video frame every N frames (-1 = no video capture)
+    int m_videoFrameCount;                          // Frames queued into this scene's video stream
     float m_timeScale;                              // Physics time multiplier from scene file (1.0 = realtime)
     float m_frozenWaterTime;                        // Simulation time captured when freeze was toggled on
     int m_trackBallIndex;                           // Index of ball to track with camera (-1 = no tracking)
@@ -98,6 +115,8 @@ class SkullbonezRun
     float m_autoCycleInterval;                      // Seconds between per-ball auto screenshots (-1 = disabled)
     float m_autoCycleAccum;                         // Accumulated real-time seconds since last shot
     int m_autoCycleShotsTaken;                      // Number of per-ball screenshots taken so far
+    std::vector<SceneDeform> m_sceneDeforms;        // Ground edits from the scene's deform directives
+    bool m_isTerrainDeformed;                       // Height map edited by a scene (rebuilt before the next one)
 
     void Render();                                                     // Main render method
     void RelativeUpdateCamera( uint32_t hash );                        // Relative update specified camera
@@ -111,11 +130,15 @@ class SkullbonezRun
     void SetInitialOpenGlState();                                      // Sets the initial state of the OpenGL evironment
     void SetViewingOrientation();                                      // Renders camera views etc
     void DrawWindowText( const double dSecondsPerFrame );              // Renders text to the window
-    void SaveScreenshot( const char* path );                           // Saves framebuffer to BMP file via glReadPixels
+    void SaveScreenshot( const char* path );                           // Queues a backbuffer readback; written as BMP or QOI by extension
+    bool CollectScreenshot( bool wait );                               // Hands the oldest finished readback to the image writer
+    void FlushScreenshots();                                           // Blocks until every queued screenshot is on disk and closes the video stream
     void LogPerfMemory( const char* checkpoint );                      // Log memory usage to perf CSV
     void LoadScene( int index );                                       // Resets scene-specific state and loads a scene by queue index
     bool AdvanceScene();                                               // Advances to the next scene in the queue (returns false if done)
     void MoveCamera( float keyMovementQty, float mouseMovemementQty ); // Moves the camera
+    void StreamTerrain( bool isLoading );                              // Streams procedural terrain around the camera and bodies (blocking while loading)
+    void ApplySceneDeforms();                                          // This frame's scene deform edits; checks the terrain against a full rebuild after the last
 
   public:
     SkullbonezRun( std::vector<std::string> sceneQueue ); // Constructor (scene queue; empty string = legacy mode)
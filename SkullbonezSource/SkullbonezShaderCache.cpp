@@ -0,0 +1,169 @@
+// --- Includes ---
+#include "SkullbonezShaderCache.h"
+#include "SkullbonezConfig.h"
+#include <cstring>
+
+#pragma comment( lib, "d3dcompiler.lib" )
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
+
+
+ShaderCache& ShaderCache::Instance()
+{
+    static ShaderCache s_instance;
+    return s_instance;
+}
+
+
+uint64_t ShaderCache::Hash( uint64_t hash, const void* data, size_t size )
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>( data );
+    for ( size_t i = 0; i < size; ++i )
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+uint64_t ShaderCache::Hash( uint64_t hash, const char* text )
+{
+    return Hash( hash, text, strlen( text ) + 1 );
+}
+
+
+std::string ShaderCache::GetEntryPath( uint64_t key ) const
+{
+    char name[32];
+    sprintf_s( name, sizeof( name ), "/%016llx.bin", static_cast<unsigned long long>( key ) );
+    return Cfg().shaderCacheDir + name;
+}
+
+
+bool ShaderCache::Load( uint64_t key, std::vector<uint8_t>& data, uint32_t& format )
+{
+    auto it = m_entries.find( key );
+    if ( it != m_entries.end() )
+    {
+        data = it->second.data;
+        format = it->second.format;
+        return true;
+    }
+    if ( Cfg().shaderCacheDir.empty() )
+    {
+        return false;
+    }
+
+    FILE* file = nullptr;
+    if ( fopen_s( &file, GetEntryPath( key ).c_str(), "rb" ) != 0 || !file )
+    {
+        return false;
+    }
+
+    ShaderCacheHeader header = {};
+    bool isValid = fread( &header, sizeof( header ), 1, file ) == 1 &&
+                   header.magic == SHADER_CACHE_MAGIC &&
+                   header.version == SHADER_CACHE_VERSION &&
+                   header.key == key &&
+                   header.size > 0;
+    if ( isValid )
+    {
+        data.resize( header.size );
+        isValid = fread( data.data(), 1, header.size, file ) == header.size &&
+                  Hash( SHADER_CACHE_SEED, data.data(), data.size() ) == header.checksum;
+    }
+    fclose( file );
+    if ( !isValid )
+    {
+        return false; // Rebuilt and overwritten by the caller's Store
+    }
+
+    format = header.format;
+    m_entries[key] = Entry{ format, data };
+    return true;
+}
+
+
+void ShaderCache::Store( uint64_t key, const void* data, size_t size, uint32_t format )
+{
+    if ( !data || size == 0 )
+    {
+        return;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>( data );
+    m_entries[key] = Entry{ format, std::vector<uint8_t>( bytes, bytes + size ) };
+    if ( Cfg().shaderCacheDir.empty() )
+    {
+        return;
+    }
+
+    if ( !m_isDirectoryReady )
+    {
+        CreateDirectoryA( Cfg().shaderCacheDir.c_str(), nullptr ); // Fails harmlessly when it already exists
+        m_isDirectoryReady = true;
+    }
+
+    // A failed write only costs a compile next run
+    FILE* file = nullptr;
+    if ( fopen_s( &file, GetEntryPath( key ).c_str(), "wb" ) != 0 || !file )
+    {
+        return;
+    }
+    ShaderCacheHeader header = {};
+    header.magic = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.format = format;
+    header.size = static_cast<uint32_t>( size );
+    header.key = key;
+    header.checksum = Hash( SHADER_CACHE_SEED, data, size );
+    fwrite( &header, sizeof( header ), 1, file );
+    fwrite( data, 1, size, file );
+    fclose( file );
+}
+
+
+void ShaderCache::Evict( uint64_t key )
+{
+    m_entries.erase( key );
+    if ( !Cfg().shaderCacheDir.empty() )
+    {
+        remove( GetEntryPath( key ).c_str() );
+    }
+}
+
+
+HRESULT ShaderCache::CompileHLSL( const char* source, size_t sourceSize, const char* path, const char* entryPoint, const char* target, UINT flags,
+                                  ID3DBlob** code, ID3DBlob** errors )
+{
+    // DXBC does not depend on the driver, only on the compiler and what it was asked to do
+    uint64_t key = Hash( SHADER_CACHE_SEED, "HLSL" );
+    uint32_t compilerVersion = D3D_COMPILER_VERSION;
+    key = Hash( key, &compilerVersion, sizeof( compilerVersion ) );
+    key = Hash( key, entryPoint );
+    key = Hash( key, target );
+    key = Hash( key, &flags, sizeof( flags ) );
+    key = Hash( key, source, sourceSize );
+
+    std::vector<uint8_t> cached;
+    uint32_t format = 0;
+    if ( Load( key, cached, format ) && SUCCEEDED( D3DCreateBlob( cached.size(), code ) ) )
+    {
+        memcpy( ( *code )->GetBufferPointer(), cached.data(), cached.size() );
+        if ( errors )
+        {
+            *errors = nullptr;
+        }
+        return S_OK;
+    }
+
+    HRESULT hr = D3DCompile( source, sourceSize, path, nullptr, nullptr, entryPoint, target, flags, 0, code, errors );
+    if ( SUCCEEDED( hr ) )
+    {
+        Store( key, ( *code )->GetBufferPointer(), ( *code )->GetBufferSize(), 0 );
+    }
+    return hr;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezCommon.h"
+#include <d3dcompiler.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+constexpr uint32_t SHADER_CACHE_MAGIC = 0x43534253; // "SBSC"
+constexpr uint32_t SHADER_CACHE_VERSION = 1;
+constexpr uint64_t SHADER_CACHE_SEED = 14695981039346656037ull; // FNV-1a 64-bit offset basis
+
+
+// On-disk entry header, followed by size bytes of program binary or bytecode
+struct ShaderCacheHeader
+{
+    uint32_t magic;    // SHADER_CACHE_MAGIC
+    uint32_t version;  // SHADER_CACHE_VERSION
+    uint32_t format;   // GL program binary format (0 for HLSL bytecode)
+    uint32_t size;     // Payload bytes
+    uint64_t key;      // Cache key the entry was stored under (also its file name)
+    uint64_t checksum; // FNV-1a of the payload (truncation / corruption check)
+};
+
+static_assert( sizeof( ShaderCacheHeader ) == 32, "ShaderCacheHeader layout changed" );
+
+
+/* -- Shader Cache -----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Compiled shaders kept on disk between runs, one file per entry in Cfg().shaderCacheDir, and in memory for
+    the rest of the session (so ResetGLResources rebuilds without touching the disk).  Keys are FNV-1a hashes
+    of everything the compiled result depends on: the source text of every stage plus, for GL, the vendor,
+    renderer and version strings of the driver (program binaries are only valid on the driver that made them),
+    and for HLSL the compiler version, entry point, target and flags.  Misses, unreadable entries and binaries
+    the driver rejects all fall back to compiling from source, whose result is then stored.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class ShaderCache
+{
+
+  private:
+    struct Entry
+    {
+        uint32_t format;
+        std::vector<uint8_t> data;
+    };
+
+    ShaderCache() = default;
+    ShaderCache( const ShaderCache& ) = delete;
+    ShaderCache& operator=( const ShaderCache& ) = delete;
+
+    std::unordered_map<uint64_t, Entry> m_entries; // Entries loaded or stored this session
+    bool m_isDirectoryReady = false;               // Cache directory created (or found) this session
+
+    std::string GetEntryPath( uint64_t key ) const;
+
+  public:
+    static ShaderCache& Instance();                                       // Access the process-wide cache
+    static uint64_t Hash( uint64_t hash, const void* data, size_t size ); // FNV-1a 64-bit, continuing from hash
+    static uint64_t Hash( uint64_t hash, const char* text );              // Same, over a NUL-terminated string (terminator included)
+
+    bool Load( uint64_t key, std::vector<uint8_t>& data, uint32_t& format ); // Memory, then disk; false on a miss or a bad entry
+    void Store( uint64_t key, const void* data, size_t size, uint32_t format );
+    void Evict( uint64_t key ); // Drops an entry the driver rejected so it is rebuilt
+
+
+    // --- HLSL ---
+    // Drop-in for D3DCompile without macros or an include handler: the key only covers the given source, so an
+    // #include fails to compile rather than being served stale.  A cache hit returns the stored bytecode in a new
+    // blob and no errors
+    HRESULT CompileHLSL( const char* source, size_t sourceSize, const char* path, const char* entryPoint, const char* target, UINT flags,
+                         ID3DBlob** code, ID3DBlob** errors );
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
@@ -2,9 +2,12 @@
 #include "SkullbonezShaderDX11.h"
 #include "SkullbonezRenderBackendDX11.h"
 #include "SkullbonezVector3.h"
+#include "SkullbonezAssetPack.h"
+#include "SkullbonezShaderCache.h"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <cstring>
 
 #pragma comment( lib, "d3dcompiler.lib" )
 #pragma comment( lib, "dxguid.lib" )
@@ -14,6 +17,7 @@
 using namespace SkullbonezCore::Rendering;
 using namespace SkullbonezCore::Math::Transformation;
 using namespace SkullbonezCore::Math::Vector;
+using namespace SkullbonezCore::Basics;
 
 
 ShaderDX11::ShaderDX11( ID3D11Device* device, ID3D11DeviceContext* context )
@@ -41,16 +45,31 @@ ShaderDX11::~ShaderDX11()
 
 bool ShaderDX11::Compile( const char* hlslPath )
 {
-    // Read HLSL source
-    std::ifstream file( hlslPath, std::ios::binary );
-    if ( !file.is_open() )
+    // Read HLSL source (packed sources are compiled straight out of the mapping)
+    std::string fileSource;
+    const char* source = nullptr;
+    size_t sourceSize = 0;
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( hlslPath );
+    if ( entry && entry->type == AssetType::Text )
     {
-        throw std::runtime_error( std::string( "Failed to open HLSL: " ) + hlslPath );
+        source = reinterpret_cast<const char*>( pack.GetData( *entry ) );
+        sourceSize = static_cast<size_t>( entry->size );
     }
+    else
+    {
+        std::ifstream file( hlslPath, std::ios::binary );
+        if ( !file.is_open() )
+        {
+            throw std::runtime_error( std::string( "Failed to open HLSL: " ) + hlslPath );
+        }
 
-    std::stringstream ss;
-    ss << file.rdbuf();
-    std::string source = ss.str();
+        std::stringstream ss;
+        ss << file.rdbuf();
+        fileSource = ss.str();
+        source = fileSource.c_str();
+        sourceSize = fileSource.size();
+    }
 
     // Compile vertex ShaderGL
     ID3DBlob* vsBlob = nullptr;
@@ -59,17 +78,14 @@ bool ShaderDX11::Compile( const char* hlslPath )
 #ifndef _DEBUG
     compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
 #endif
-    HRESULT hr = D3DCompile( source.c_str(),
-                             source.size(),
-                             hlslPath,
-                             nullptr,
-                             nullptr,
-                             "main_vs",
-                             "vs_5_0",
-                             compileFlags,
-                             0,
-                             &vsBlob,
-                             &errBlob );
+    HRESULT hr = ShaderCache::Instance().CompileHLSL( source,
+                                                      sourceSize,
+                                                      hlslPath,
+                                                      "main_vs",
+                                                      "vs_5_0",
+                                                      compileFlags,
+                                                      &vsBlob,
+                                                      &errBlob );
     if ( FAILED( hr ) )
     {
         std::string err = errBlob ? (const char*)errBlob->GetBufferPointer() : "Unknown error";
@@ -94,54 +110,21 @@ bool ShaderDX11::Compile( const char* hlslPath )
         throw std::runtime_error( "CreateVertexShader failed" );
     }
 
-    // Reflect VS to build uniform map
-    ID3D11ShaderReflection* reflection = nullptr;
-    hr = D3DReflect( vsBlob->GetBufferPointer(),
-                     vsBlob->GetBufferSize(),
-                     IID_ID3D11ShaderReflection,
-                     (void**)&reflection );
-    if ( SUCCEEDED( hr ) )
-    {
-        D3D11_SHADER_DESC shaderDesc;
-        reflection->GetDesc( &shaderDesc );
-
-        for ( UINT cb = 0; cb < shaderDesc.ConstantBuffers; ++cb )
-        {
-            ID3D11ShaderReflectionConstantBuffer* cbRef = reflection->GetConstantBufferByIndex( cb );
-            D3D11_SHADER_BUFFER_DESC cbDesc;
-            cbRef->GetDesc( &cbDesc );
-
-            if ( cbDesc.Size > m_cbSize )
-            {
-                m_cbSize = cbDesc.Size;
-            }
-
-            for ( UINT v = 0; v < cbDesc.Variables; ++v )
-            {
-                ID3D11ShaderReflectionVariable* var = cbRef->GetVariableByIndex( v );
-                D3D11_SHADER_VARIABLE_DESC varDesc;
-                var->GetDesc( &varDesc );
-                m_uniformMap[varDesc.Name] = { varDesc.StartOffset, varDesc.Size };
-            }
-        }
-        reflection->Release();
-    }
+    // Reflect VS to build uniform list
+    ReflectUniforms( vsBlob );
     vsBlob->Release();
 
     // Compile pixel ShaderGL
     ID3DBlob* psBlob = nullptr;
     errBlob = nullptr;
-    hr = D3DCompile( source.c_str(),
-                     source.size(),
-                     hlslPath,
-                     nullptr,
-                     nullptr,
-                     "main_ps",
-                     "ps_5_0",
-                     compileFlags,
-                     0,
-                     &psBlob,
-                     &errBlob );
+    hr = ShaderCache::Instance().CompileHLSL( source,
+                                              sourceSize,
+                                              hlslPath,
+                                              "main_ps",
+                                              "ps_5_0",
+                                              compileFlags,
+                                              &psBlob,
+                                              &errBlob );
     if ( FAILED( hr ) )
     {
         std::string err = errBlob ? (const char*)errBlob->GetBufferPointer() : "Unknown error";
@@ -157,40 +140,7 @@ bool ShaderDX11::Compile( const char* hlslPath )
     }
 
     // Also reflect PS to capture PS-only uniforms
-    reflection = nullptr;
-    hr = D3DReflect( psBlob->GetBufferPointer(),
-                     psBlob->GetBufferSize(),
-                     IID_ID3D11ShaderReflection,
-                     (void**)&reflection );
-    if ( SUCCEEDED( hr ) )
-    {
-        D3D11_SHADER_DESC shaderDesc;
-        reflection->GetDesc( &shaderDesc );
-
-        for ( UINT cb = 0; cb < shaderDesc.ConstantBuffers; ++cb )
-        {
-            ID3D11ShaderReflectionConstantBuffer* cbRef = reflection->GetConstantBufferByIndex( cb );
-            D3D11_SHADER_BUFFER_DESC cbDesc;
-            cbRef->GetDesc( &cbDesc );
-
-            if ( cbDesc.Size > m_cbSize )
-            {
-                m_cbSize = cbDesc.Size;
-            }
-
-            for ( UINT v = 0; v < cbDesc.Variables; ++v )
-            {
-                ID3D11ShaderReflectionVariable* var = cbRef->GetVariableByIndex( v );
-                D3D11_SHADER_VARIABLE_DESC varDesc;
-                var->GetDesc( &varDesc );
-                if ( m_uniformMap.find( varDesc.Name ) == m_uniformMap.end() )
-                {
-                    m_uniformMap[varDesc.Name] = { varDesc.StartOffset, varDesc.Size };
-                }
-            }
-        }
-        reflection->Release();
-    }
+    ReflectUniforms( psBlob );
 
     hr = m_device->CreatePixelShader( psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &m_ps );
     psBlob->Release();
@@ -203,6 +153,7 @@ bool ShaderDX11::Compile( const char* hlslPath )
     if ( m_cbSize > 0 )
     {
         m_cbData.resize( m_cbSize, 0 );
+        m_cbDirty = true; // buffer contents are undefined until the first upload
 
         D3D11_BUFFER_DESC bd = {};
         bd.ByteWidth = m_cbSize;
@@ -224,6 +175,13 @@ void ShaderDX11::Use() const
 {
     m_context->VSSetShader( m_vs, nullptr, 0 );
     m_context->PSSetShader( m_ps, nullptr, 0 );
+
+    // Bind here so an unchanged (never re-uploaded) CB is still the one the shader reads
+    if ( m_cbuffer )
+    {
+        m_context->VSSetConstantBuffers( 0, 1, &m_cbuffer );
+        m_context->PSSetConstantBuffers( 0, 1, &m_cbuffer );
+    }
     RenderBackendDX11::Get()->SetActiveShader( const_cast<ShaderDX11*>( this ) );
 }
 
@@ -242,78 +200,161 @@ void ShaderDX11::FlushCB() const
         memcpy( mapped.pData, m_cbData.data(), m_cbData.size() );
         m_context->Unmap( m_cbuffer, 0 );
     }
-
-    m_context->VSSetConstantBuffers( 0, 1, &m_cbuffer );
-    m_context->PSSetConstantBuffers( 0, 1, &m_cbuffer );
     m_cbDirty = false;
 }
 
 
-void ShaderDX11::SetInt( const char* name, int value ) const
+void ShaderDX11::ReflectUniforms( ID3DBlob* blob )
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
+    ID3D11ShaderReflection* reflection = nullptr;
+    HRESULT hr = D3DReflect( blob->GetBufferPointer(),
+                             blob->GetBufferSize(),
+                             IID_ID3D11ShaderReflection,
+                             (void**)&reflection );
+    if ( FAILED( hr ) )
     {
         return;
     }
-    memcpy( m_cbData.data() + it->second.offset, &value, sizeof( int ) );
-    m_cbDirty = true;
+
+    D3D11_SHADER_DESC shaderDesc;
+    reflection->GetDesc( &shaderDesc );
+
+    for ( UINT cb = 0; cb < shaderDesc.ConstantBuffers; ++cb )
+    {
+        ID3D11ShaderReflectionConstantBuffer* cbRef = reflection->GetConstantBufferByIndex( cb );
+        D3D11_SHADER_BUFFER_DESC cbDesc;
+        cbRef->GetDesc( &cbDesc );
+
+        if ( cbDesc.Size > m_cbSize )
+        {
+            m_cbSize = cbDesc.Size;
+        }
+
+        for ( UINT v = 0; v < cbDesc.Variables; ++v )
+        {
+            ID3D11ShaderReflectionVariable* var = cbRef->GetVariableByIndex( v );
+            D3D11_SHADER_VARIABLE_DESC varDesc;
+            var->GetDesc( &varDesc );
+
+            // VS and PS share one cbuffer layout -- first stage to declare a name wins
+            if ( GetUniformHandle( varDesc.Name ) == UniformHandle::Invalid )
+            {
+                UniformInfo info = {};
+                strncpy_s( info.name, sizeof( info.name ), varDesc.Name, _TRUNCATE );
+                info.offset = varDesc.StartOffset;
+                info.size = varDesc.Size;
+                m_uniforms.push_back( info );
+            }
+        }
+    }
+    reflection->Release();
 }
 
 
-void ShaderDX11::SetFloat( const char* name, float value ) const
+UniformHandle ShaderDX11::GetUniformHandle( const char* name ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
+    for ( size_t i = 0; i < m_uniforms.size(); ++i )
     {
-        return;
+        if ( strcmp( m_uniforms[i].name, name ) == 0 )
+        {
+            return static_cast<UniformHandle>( i );
+        }
     }
-    memcpy( m_cbData.data() + it->second.offset, &value, sizeof( float ) );
-    m_cbDirty = true;
+    return UniformHandle::Invalid;
 }
 
 
-void ShaderDX11::SetVec3( const char* name, float x, float y, float z ) const
+bool ShaderDX11::WriteCB( UniformHandle handle, const void* data, uint32_t size ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
+    int index = static_cast<int>( handle );
+    if ( index < 0 || index >= static_cast<int>( m_uniforms.size() ) )
     {
-        return;
+        return false;
     }
-    float v[3] = { x, y, z };
-    memcpy( m_cbData.data() + it->second.offset, v, sizeof( v ) );
+
+    // The CPU shadow doubles as the last-sent cache: equal bytes never dirty the CB
+    uint8_t* dst = m_cbData.data() + m_uniforms[index].offset;
+    if ( memcmp( dst, data, size ) == 0 )
+    {
+        return false;
+    }
+    memcpy( dst, data, size );
     m_cbDirty = true;
+    return true;
 }
 
 
-void ShaderDX11::SetVec4( const char* name, float x, float y, float z, float w ) const
+void ShaderDX11::SetInt( UniformHandle handle, int value ) const
+{
+    WriteCB( handle, &value, sizeof( int ) );
+}
+
+
+void ShaderDX11::SetFloat( UniformHandle handle, float value ) const
+{
+    WriteCB( handle, &value, sizeof( float ) );
+}
+
+
+void ShaderDX11::SetVec3( UniformHandle handle, float x, float y, float z ) const
+{
+    float v[3] = { x, y, z };
+    WriteCB( handle, v, sizeof( v ) );
+}
+
+
+void ShaderDX11::SetVec3( UniformHandle handle, const Vector3& v ) const
+{
+    SetVec3( handle, v.x, v.y, v.z );
+}
+
+
+void ShaderDX11::SetVec4( UniformHandle handle, float x, float y, float z, float w ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
-    {
-        return;
-    }
     float v[4] = { x, y, z, w };
-    memcpy( m_cbData.data() + it->second.offset, v, sizeof( v ) );
-    m_cbDirty = true;
+    WriteCB( handle, v, sizeof( v ) );
+}
+
+
+void ShaderDX11::SetMat4( UniformHandle handle, const Matrix4& mat ) const
+{
+    WriteCB( handle, mat.Data(), 16 * sizeof( float ) );
+}
+
+
+void ShaderDX11::SetInt( const char* name, int value ) const
+{
+    SetInt( GetUniformHandle( name ), value );
+}
+
+
+void ShaderDX11::SetFloat( const char* name, float value ) const
+{
+    SetFloat( GetUniformHandle( name ), value );
+}
+
+
+void ShaderDX11::SetVec3( const char* name, float x, float y, float z ) const
+{
+    SetVec3( GetUniformHandle( name ), x, y, z );
+}
+
+
+void ShaderDX11::SetVec4( const char* name, float x, float y, float z, float w ) const
+{
+    SetVec4( GetUniformHandle( name ), x, y, z, w );
 }
 
 
 void ShaderDX11::SetMat4( const char* name, const Matrix4& mat ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
-    {
-        return;
-    }
-    memcpy( m_cbData.data() + it->second.offset, mat.Data(), 16 * sizeof( float ) );
-    m_cbDirty = true;
+    SetMat4( GetUniformHandle( name ), mat );
 }
 
 
 void ShaderDX11::SetVec3( const char* name, const Vector3& v ) const
 {
-    SetVec3( name, v.x, v.y, v.z );
+    SetVec3( GetUniformHandle( name ), v.x, v.y, v.z );
 }
 
 
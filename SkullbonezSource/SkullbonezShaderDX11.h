@@ -6,8 +6,6 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <vector>
-#include <unordered_map>
-#include <string>
 
 
 namespace SkullbonezCore
@@ -17,7 +15,8 @@ namespace Rendering
 /* -- ShaderDX11 --------------------------------------------------------------------------------------------------------------------------------------------------
 
     DirectX 11 implementation of the IShader interface.
-    Compiles HLSL from combined VS+PS files. Uses D3D11 reflection for constant buffer layout.
+    Compiles HLSL from combined VS+PS files. Uses D3D11 reflection for constant buffer layout;
+    uniform handles are indices into the reflected variable list and carry the CB offset directly.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class ShaderDX11 : public IShader
 {
@@ -36,10 +35,14 @@ class ShaderDX11 : public IShader
 
     struct UniformInfo
     {
+        char name[64];
         uint32_t offset;
         uint32_t size;
     };
-    std::unordered_map<std::string, UniformInfo> m_uniformMap;
+    std::vector<UniformInfo> m_uniforms; // Indexed by UniformHandle
+
+    void ReflectUniforms( ID3DBlob* blob );                                      // Merge a stage's cbuffer variables into m_uniforms
+    bool WriteCB( UniformHandle handle, const void* data, uint32_t size ) const; // Copy into m_cbData if changed
 
   public:
     ShaderDX11( ID3D11Device* device, ID3D11DeviceContext* context );
@@ -55,6 +58,14 @@ class ShaderDX11 : public IShader
     void SetVec4( const char* name, float x, float y, float z, float w ) const override;
     void SetMat4( const char* name, const Math::Transformation::Matrix4& mat ) const override;
 
+    UniformHandle GetUniformHandle( const char* name ) const override;
+    void SetInt( UniformHandle handle, int value ) const override;
+    void SetFloat( UniformHandle handle, float value ) const override;
+    void SetVec3( UniformHandle handle, const Vector3& v ) const override;
+    void SetVec3( UniformHandle handle, float x, float y, float z ) const override;
+    void SetVec4( UniformHandle handle, float x, float y, float z, float w ) const override;
+    void SetMat4( UniformHandle handle, const Math::Transformation::Matrix4& mat ) const override;
+
     void FlushCB() const;
     const void* GetVSBytecode() const;
     size_t GetVSBytecodeSize() const;
@@ -1,6 +1,8 @@
 // --- Includes ---
 #include "SkullbonezShaderDX12.h"
 #include "SkullbonezRenderBackendDX12.h"
+#include "SkullbonezAssetPack.h"
+#include "SkullbonezShaderCache.h"
 #include <d3d11shader.h>
 #include <stdexcept>
 #include <string>
@@ -15,10 +17,11 @@
 using namespace SkullbonezCore::Rendering;
 using namespace SkullbonezCore::Math::Vector;
 using namespace SkullbonezCore::Math::Transformation;
+using namespace SkullbonezCore::Basics;
 
 
 ShaderDX12::ShaderDX12()
-    : m_vsBlob( nullptr ), m_psBlob( nullptr ), m_cbSize( 0 ), m_cbDirty( false )
+    : m_vsBlob( nullptr ), m_psBlob( nullptr ), m_cbSize( 0 ), m_cbDirty( false ), m_lastCBAddr( 0 ), m_lastCBEpoch( 0 )
 {
 }
 
@@ -38,13 +41,28 @@ ShaderDX12::~ShaderDX12()
 
 bool ShaderDX12::Compile( const char* hlslPath )
 {
-    // Read file
-    std::ifstream file( hlslPath, std::ios::binary );
-    if ( !file.is_open() )
+    // Read file (packed sources are compiled straight out of the mapping)
+    std::string fileSource;
+    const char* source = nullptr;
+    size_t sourceSize = 0;
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( hlslPath );
+    if ( entry && entry->type == AssetType::Text )
     {
-        throw std::runtime_error( std::string( "Cannot open HLSL: " ) + hlslPath );
+        source = reinterpret_cast<const char*>( pack.GetData( *entry ) );
+        sourceSize = static_cast<size_t>( entry->size );
+    }
+    else
+    {
+        std::ifstream file( hlslPath, std::ios::binary );
+        if ( !file.is_open() )
+        {
+            throw std::runtime_error( std::string( "Cannot open HLSL: " ) + hlslPath );
+        }
+        fileSource.assign( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+        source = fileSource.c_str();
+        sourceSize = fileSource.size();
     }
-    std::string source( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
 
     UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
 #ifdef _DEBUG
@@ -55,7 +73,7 @@ bool ShaderDX12::Compile( const char* hlslPath )
 
     // Compile VS
     ID3DBlob* errors = nullptr;
-    HRESULT hr = D3DCompile( source.c_str(), source.size(), hlslPath, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main_vs", "vs_5_0", flags, 0, &m_vsBlob, &errors );
+    HRESULT hr = ShaderCache::Instance().CompileHLSL( source, sourceSize, hlslPath, "main_vs", "vs_5_0", flags, &m_vsBlob, &errors );
     if ( FAILED( hr ) )
     {
         std::string msg = "VS compile failed: ";
@@ -73,7 +91,7 @@ bool ShaderDX12::Compile( const char* hlslPath )
     }
 
     // Compile PS
-    hr = D3DCompile( source.c_str(), source.size(), hlslPath, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main_ps", "ps_5_0", flags, 0, &m_psBlob, &errors );
+    hr = ShaderCache::Instance().CompileHLSL( source, sourceSize, hlslPath, "main_ps", "ps_5_0", flags, &m_psBlob, &errors );
     if ( FAILED( hr ) )
     {
         std::string msg = "PS compile failed: ";
@@ -120,7 +138,14 @@ void ShaderDX12::ReflectCB( ID3DBlob* blob )
             ID3D11ShaderReflectionVariable* var = cb->GetVariableByIndex( v );
             D3D11_SHADER_VARIABLE_DESC varDesc = {};
             var->GetDesc( &varDesc );
-            m_uniformMap[varDesc.Name] = { varDesc.StartOffset, varDesc.Size };
+            if ( GetUniformHandle( varDesc.Name ) == UniformHandle::Invalid )
+            {
+                UniformInfo info = {};
+                strncpy_s( info.name, sizeof( info.name ), varDesc.Name, _TRUNCATE );
+                info.offset = varDesc.StartOffset;
+                info.size = varDesc.Size;
+                m_uniforms.push_back( info );
+            }
         }
     }
 
@@ -129,6 +154,7 @@ void ShaderDX12::ReflectCB( ID3DBlob* blob )
     // Align CB size to 256 bytes (DX12 requirement)
     m_cbSize = ( m_cbSize + 255 ) & ~255u;
     m_cbData.resize( m_cbSize, 0 );
+    m_cbDirty = true;
 }
 
 
@@ -142,72 +168,110 @@ void ShaderDX12::Use() const
 }
 
 
-void ShaderDX12::SetInt( const char* name, int value ) const
+UniformHandle ShaderDX12::GetUniformHandle( const char* name ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
+    for ( size_t i = 0; i < m_uniforms.size(); ++i )
     {
-        return;
+        if ( strcmp( m_uniforms[i].name, name ) == 0 )
+        {
+            return static_cast<UniformHandle>( i );
+        }
     }
-    memcpy( m_cbData.data() + it->second.offset, &value, sizeof( int ) );
-    m_cbDirty = true;
+    return UniformHandle::Invalid;
 }
 
 
-void ShaderDX12::SetFloat( const char* name, float value ) const
+void ShaderDX12::WriteCB( UniformHandle handle, const void* data, UINT size ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
+    int index = static_cast<int>( handle );
+    if ( index < 0 || index >= static_cast<int>( m_uniforms.size() ) )
     {
         return;
     }
-    memcpy( m_cbData.data() + it->second.offset, &value, sizeof( float ) );
+
+    // Unchanged values keep the last uploaded CB valid
+    uint8_t* dst = m_cbData.data() + m_uniforms[index].offset;
+    if ( memcmp( dst, data, size ) == 0 )
+    {
+        return;
+    }
+    memcpy( dst, data, size );
     m_cbDirty = true;
 }
 
 
-void ShaderDX12::SetVec3( const char* name, float x, float y, float z ) const
+void ShaderDX12::SetInt( UniformHandle handle, int value ) const
+{
+    WriteCB( handle, &value, sizeof( int ) );
+}
+
+
+void ShaderDX12::SetFloat( UniformHandle handle, float value ) const
+{
+    WriteCB( handle, &value, sizeof( float ) );
+}
+
+
+void ShaderDX12::SetVec3( UniformHandle handle, float x, float y, float z ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
-    {
-        return;
-    }
     float v[3] = { x, y, z };
-    memcpy( m_cbData.data() + it->second.offset, v, sizeof( v ) );
-    m_cbDirty = true;
+    WriteCB( handle, v, sizeof( v ) );
+}
+
+
+void ShaderDX12::SetVec3( UniformHandle handle, const Vector3& v ) const
+{
+    SetVec3( handle, v.x, v.y, v.z );
+}
+
+
+void ShaderDX12::SetVec4( UniformHandle handle, float x, float y, float z, float w ) const
+{
+    float v[4] = { x, y, z, w };
+    WriteCB( handle, v, sizeof( v ) );
+}
+
+
+void ShaderDX12::SetMat4( UniformHandle handle, const Matrix4& m ) const
+{
+    // HLSL uses #pragma pack_matrix(column_major) — send data as-is
+    WriteCB( handle, m.Data(), 64 );
+}
+
+
+void ShaderDX12::SetInt( const char* name, int value ) const
+{
+    SetInt( GetUniformHandle( name ), value );
+}
+
+
+void ShaderDX12::SetFloat( const char* name, float value ) const
+{
+    SetFloat( GetUniformHandle( name ), value );
+}
+
+
+void ShaderDX12::SetVec3( const char* name, float x, float y, float z ) const
+{
+    SetVec3( GetUniformHandle( name ), x, y, z );
 }
 
 
 void ShaderDX12::SetVec3( const char* name, const Vector3& v ) const
 {
-    SetVec3( name, v.x, v.y, v.z );
+    SetVec3( GetUniformHandle( name ), v.x, v.y, v.z );
 }
 
 
 void ShaderDX12::SetVec4( const char* name, float x, float y, float z, float w ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
-    {
-        return;
-    }
-    float v[4] = { x, y, z, w };
-    memcpy( m_cbData.data() + it->second.offset, v, sizeof( v ) );
-    m_cbDirty = true;
+    SetVec4( GetUniformHandle( name ), x, y, z, w );
 }
 
 
 void ShaderDX12::SetMat4( const char* name, const Matrix4& m ) const
 {
-    auto it = m_uniformMap.find( name );
-    if ( it == m_uniformMap.end() )
-    {
-        return;
-    }
-    // HLSL uses #pragma pack_matrix(column_major) — send data as-is
-    memcpy( m_cbData.data() + it->second.offset, m.Data(), 64 );
-    m_cbDirty = true;
+    SetMat4( GetUniformHandle( name ), m );
 }
 
 
@@ -224,9 +288,17 @@ D3D12_GPU_VIRTUAL_ADDRESS ShaderDX12::FlushCB() const
         return 0;
     }
 
+    // The previous copy stays resident until the upload buffer rewinds, so clean draws rebind it
+    if ( !m_cbDirty && m_lastCBAddr != 0 && m_lastCBEpoch == backend->GetUploadEpoch() )
+    {
+        return m_lastCBAddr;
+    }
+
     D3D12_GPU_VIRTUAL_ADDRESS addr = backend->SubAllocateUpload( m_cbSize, 256 );
     memcpy( backend->GetUploadPtr( addr ), m_cbData.data(), m_cbSize );
     m_cbDirty = false;
+    m_lastCBAddr = addr;
+    m_lastCBEpoch = backend->GetUploadEpoch();
     return addr;
 }
 
@@ -5,8 +5,6 @@
 #include "SkullbonezIShader.h"
 #include <d3d12.h>
 #include <d3dcompiler.h>
-#include <string>
-#include <unordered_map>
 #include <vector>
 
 
@@ -33,15 +31,19 @@ class ShaderDX12 : public IShader
     // Uniform reflection
     struct UniformInfo
     {
+        char name[64];
         UINT offset;
         UINT size;
     };
-    std::unordered_map<std::string, UniformInfo> m_uniformMap;
+    std::vector<UniformInfo> m_uniforms; // Indexed by UniformHandle
     UINT m_cbSize;
     mutable std::vector<uint8_t> m_cbData;
     mutable bool m_cbDirty;
+    mutable D3D12_GPU_VIRTUAL_ADDRESS m_lastCBAddr; // Upload-heap copy of m_cbData from the last flush
+    mutable UINT64 m_lastCBEpoch;                   // Backend upload epoch m_lastCBAddr belongs to
 
     void ReflectCB( ID3DBlob* blob );
+    void WriteCB( UniformHandle handle, const void* data, UINT size ) const;
 
   public:
     ShaderDX12();
@@ -57,7 +59,15 @@ class ShaderDX12 : public IShader
     void SetVec4( const char* name, float x, float y, float z, float w ) const override;
     void SetMat4( const char* name, const Math::Transformation::Matrix4& m ) const override;
 
-    // DX12-specific: flush CB to upload buffer, return GPU VA
+    UniformHandle GetUniformHandle( const char* name ) const override;
+    void SetInt( UniformHandle handle, int value ) const override;
+    void SetFloat( UniformHandle handle, float value ) const override;
+    void SetVec3( UniformHandle handle, float x, float y, float z ) const override;
+    void SetVec3( UniformHandle handle, const Math::Vector::Vector3& v ) const override;
+    void SetVec4( UniformHandle handle, float x, float y, float z, float w ) const override;
+    void SetMat4( UniformHandle handle, const Math::Transformation::Matrix4& m ) const override;
+
+    // DX12-specific: flush CB to upload buffer, return GPU VA (reused while clean and the upload buffer has not rewound)
     D3D12_GPU_VIRTUAL_ADDRESS FlushCB() const;
 
     const void* GetVSBytecode() const;
@@ -1,45 +1,55 @@
 // --- Includes ---
 #include "SkullbonezShaderGL.h"
+#include "SkullbonezAssetPack.h"
+#include "SkullbonezConfig.h"
+#include "SkullbonezShaderCache.h"
+#include <cstring>
 
 
 // --- Usings ---
 using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
 
 
-char* ShaderGL::LoadShaderSource( const char* path )
+const char* ShaderGL::GetShaderSource( const char* path, std::string& storage, GLint& length )
 {
+    // Packed sources are compiled straight out of the mapping
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( path );
+    if ( entry && entry->type == AssetType::Text )
+    {
+        length = static_cast<GLint>( entry->size );
+        return reinterpret_cast<const char*>( pack.GetData( *entry ) );
+    }
+
     FILE* file = nullptr;
     errno_t err = fopen_s( &file, path, "rb" );
     if ( err != 0 || !file )
     {
         char msg[512];
-        sprintf_s( msg, sizeof( msg ), "Failed to open m_shader file: %s  (ShaderGL::LoadShaderSource)", path );
+        sprintf_s( msg, sizeof( msg ), "Failed to open m_shader file: %s  (ShaderGL::GetShaderSource)", path );
         throw std::runtime_error( msg );
     }
 
     fseek( file, 0, SEEK_END );
-    long length = ftell( file );
+    long fileLength = ftell( file );
     fseek( file, 0, SEEK_SET );
 
-    char* source = new char[length + 1];
-    fread( source, 1, static_cast<size_t>( length ), file );
-    source[length] = '\0';
+    storage.resize( static_cast<size_t>( fileLength ) );
+    storage.resize( fread( &storage[0], 1, storage.size(), file ) );
     fclose( file );
 
-    return source;
+    length = static_cast<GLint>( storage.size() );
+    return storage.c_str();
 }
 
 
-GLuint ShaderGL::CompileShader( const char* path, GLenum type )
+GLuint ShaderGL::CompileShader( const char* path, const char* source, GLint length, GLenum type )
 {
-    char* source = LoadShaderSource( path );
-
     GLuint m_shader = glCreateShader( type );
-    glShaderSource( m_shader, 1, &source, nullptr );
+    glShaderSource( m_shader, 1, &source, &length );
     glCompileShader( m_shader );
 
-    delete[] source;
-
     GLint success = 0;
     glGetShaderiv( m_shader, GL_COMPILE_STATUS, &success );
     if ( !success )
@@ -57,12 +67,122 @@ GLuint ShaderGL::CompileShader( const char* path, GLenum type )
 }
 
 
+bool ShaderGL::IsProgramBinarySupported()
+{
+    // Core in 4.1, ARB_get_program_binary before that -- glad leaves the pointers null when neither is present
+    static const bool s_isSupported = [] {
+        if ( Cfg().shaderCacheDir.empty() || !glGetProgramBinary || !glProgramBinary || !glProgramParameteri )
+        {
+            return false;
+        }
+        GLint formatCount = 0;
+        glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount );
+        return formatCount > 0;
+    }();
+    return s_isSupported;
+}
+
+
+uint64_t ShaderGL::GetDriverKey()
+{
+    // A program binary is only valid on the driver build that produced it
+    static const uint64_t s_key = [] {
+        uint64_t key = ShaderCache::Hash( SHADER_CACHE_SEED, "GLSL" );
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for ( GLenum name : names )
+        {
+            const char* text = reinterpret_cast<const char*>( glGetString( name ) );
+            key = ShaderCache::Hash( key, text ? text : "" );
+        }
+        return key;
+    }();
+    return s_key;
+}
+
+
+bool ShaderGL::LoadProgramBinary( uint64_t key )
+{
+    std::vector<uint8_t> binary;
+    uint32_t format = 0;
+    if ( !ShaderCache::Instance().Load( key, binary, format ) )
+    {
+        return false;
+    }
+
+    glProgramBinary( m_programID, static_cast<GLenum>( format ), binary.data(), static_cast<GLsizei>( binary.size() ) );
+
+    GLint success = 0;
+    glGetProgramiv( m_programID, GL_LINK_STATUS, &success );
+    if ( !success )
+    {
+        // Rejected (driver changed in a way its strings do not show) -- start over from source
+        ShaderCache::Instance().Evict( key );
+        glDeleteProgram( m_programID );
+        m_programID = glCreateProgram();
+        return false;
+    }
+    return true;
+}
+
+
+void ShaderGL::StoreProgramBinary( uint64_t key ) const
+{
+    GLint size = 0;
+    glGetProgramiv( m_programID, GL_PROGRAM_BINARY_LENGTH, &size );
+    if ( size <= 0 )
+    {
+        return;
+    }
+
+    std::vector<uint8_t> binary( static_cast<size_t>( size ) );
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary( m_programID, size, &written, &format, binary.data() );
+    if ( written > 0 )
+    {
+        ShaderCache::Instance().Store( key, binary.data(), static_cast<size_t>( written ), static_cast<uint32_t>( format ) );
+    }
+}
+
+
 ShaderGL::ShaderGL( const char* vertPath, const char* fragPath )
 {
-    GLuint vertShader = CompileShader( vertPath, GL_VERTEX_SHADER );
-    GLuint fragShader = CompileShader( fragPath, GL_FRAGMENT_SHADER );
+    std::string vertStorage, fragStorage;
+    GLint vertLength = 0, fragLength = 0;
+    const char* vertSource = GetShaderSource( vertPath, vertStorage, vertLength );
+    const char* fragSource = GetShaderSource( fragPath, fragStorage, fragLength );
 
     m_programID = glCreateProgram();
+
+    // A cached binary of this exact source on this exact driver skips compile and link entirely
+    bool isCacheable = IsProgramBinarySupported();
+    uint64_t key = 0;
+    if ( isCacheable )
+    {
+        key = ShaderCache::Hash( GetDriverKey(), vertSource, static_cast<size_t>( vertLength ) );
+        key = ShaderCache::Hash( key, fragSource, static_cast<size_t>( fragLength ) );
+        if ( LoadProgramBinary( key ) )
+        {
+            ReflectUniforms();
+            return;
+        }
+        glProgramParameteri( m_programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+    }
+
+    GLuint vertShader = 0;
+    GLuint fragShader = 0;
+    try
+    {
+        vertShader = CompileShader( vertPath, vertSource, vertLength, GL_VERTEX_SHADER );
+        fragShader = CompileShader( fragPath, fragSource, fragLength, GL_FRAGMENT_SHADER );
+    }
+    catch ( ... )
+    {
+        glDeleteShader( vertShader );
+        glDeleteProgram( m_programID );
+        throw;
+    }
+
     glAttachShader( m_programID, vertShader );
     glAttachShader( m_programID, fragShader );
     glLinkProgram( m_programID );
@@ -85,6 +205,43 @@ ShaderGL::ShaderGL( const char* vertPath, const char* fragPath )
     // Shaders are linked into the program — delete the intermediate objects
     glDeleteShader( vertShader );
     glDeleteShader( fragShader );
+
+    if ( isCacheable )
+    {
+        StoreProgramBinary( key );
+    }
+
+    ReflectUniforms();
+}
+
+
+void ShaderGL::ReflectUniforms()
+{
+    GLint count = 0;
+    glGetProgramiv( m_programID, GL_ACTIVE_UNIFORMS, &count );
+    m_uniforms.reserve( static_cast<size_t>( count ) );
+
+    for ( GLint i = 0; i < count; ++i )
+    {
+        UniformSlot slot = {};
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform( m_programID, static_cast<GLuint>( i ), sizeof( slot.name ), nullptr, &arraySize, &type, slot.name );
+
+        // Arrays are reported as "name[0]" -- callers address them by the bare name
+        char* bracket = strchr( slot.name, '[' );
+        if ( bracket )
+        {
+            *bracket = '\0';
+        }
+
+        // Uniform block members have no location and cannot be set through glUniform*
+        slot.location = glGetUniformLocation( m_programID, slot.name );
+        if ( slot.location >= 0 )
+        {
+            m_uniforms.push_back( slot );
+        }
+    }
 }
 
 
@@ -109,50 +266,128 @@ GLuint ShaderGL::GetProgramID() const
 }
 
 
-GLint ShaderGL::GetUniformLocation( const char* name ) const
+UniformHandle ShaderGL::GetUniformHandle( const char* name ) const
+{
+    for ( size_t i = 0; i < m_uniforms.size(); ++i )
+    {
+        if ( strcmp( m_uniforms[i].name, name ) == 0 )
+        {
+            return static_cast<UniformHandle>( i );
+        }
+    }
+    return UniformHandle::Invalid;
+}
+
+
+const ShaderGL::UniformSlot* ShaderGL::UpdateSlot( UniformHandle handle, const void* data, int size ) const
+{
+    int index = static_cast<int>( handle );
+    if ( index < 0 || index >= static_cast<int>( m_uniforms.size() ) )
+    {
+        return nullptr;
+    }
+
+    UniformSlot& slot = m_uniforms[index];
+    if ( slot.valueSize == size && memcmp( slot.value, data, static_cast<size_t>( size ) ) == 0 )
+    {
+        return nullptr; // program already holds this value
+    }
+
+    memcpy( slot.value, data, static_cast<size_t>( size ) );
+    slot.valueSize = size;
+    return &slot;
+}
+
+
+void ShaderGL::SetInt( UniformHandle handle, int value ) const
+{
+    const UniformSlot* slot = UpdateSlot( handle, &value, sizeof( value ) );
+    if ( slot )
+    {
+        glUniform1i( slot->location, value );
+    }
+}
+
+
+void ShaderGL::SetFloat( UniformHandle handle, float value ) const
+{
+    const UniformSlot* slot = UpdateSlot( handle, &value, sizeof( value ) );
+    if ( slot )
+    {
+        glUniform1f( slot->location, value );
+    }
+}
+
+
+void ShaderGL::SetVec3( UniformHandle handle, const Vector3& v ) const
+{
+    SetVec3( handle, v.x, v.y, v.z );
+}
+
+
+void ShaderGL::SetVec3( UniformHandle handle, float x, float y, float z ) const
+{
+    float v[3] = { x, y, z };
+    const UniformSlot* slot = UpdateSlot( handle, v, sizeof( v ) );
+    if ( slot )
+    {
+        glUniform3f( slot->location, x, y, z );
+    }
+}
+
+
+void ShaderGL::SetVec4( UniformHandle handle, float x, float y, float z, float w ) const
+{
+    float v[4] = { x, y, z, w };
+    const UniformSlot* slot = UpdateSlot( handle, v, sizeof( v ) );
+    if ( slot )
+    {
+        glUniform4f( slot->location, x, y, z, w );
+    }
+}
+
+
+void ShaderGL::SetMat4( UniformHandle handle, const Matrix4& mat ) const
 {
-    auto it = m_uniformCache.find( name );
-    if ( it != m_uniformCache.end() )
+    const UniformSlot* slot = UpdateSlot( handle, mat.Data(), 16 * sizeof( float ) );
+    if ( slot )
     {
-        return it->second;
+        glUniformMatrix4fv( slot->location, 1, GL_FALSE, mat.Data() );
     }
-    GLint loc = glGetUniformLocation( m_programID, name );
-    m_uniformCache[name] = loc;
-    return loc;
 }
 
 
 void ShaderGL::SetInt( const char* name, int value ) const
 {
-    glUniform1i( GetUniformLocation( name ), value );
+    SetInt( GetUniformHandle( name ), value );
 }
 
 
 void ShaderGL::SetFloat( const char* name, float value ) const
 {
-    glUniform1f( GetUniformLocation( name ), value );
+    SetFloat( GetUniformHandle( name ), value );
 }
 
 
 void ShaderGL::SetVec3( const char* name, const Vector3& v ) const
 {
-    glUniform3f( GetUniformLocation( name ), v.x, v.y, v.z );
+    SetVec3( GetUniformHandle( name ), v.x, v.y, v.z );
 }
 
 
 void ShaderGL::SetVec3( const char* name, float x, float y, float z ) const
 {
-    glUniform3f( GetUniformLocation( name ), x, y, z );
+    SetVec3( GetUniformHandle( name ), x, y, z );
 }
 
 
 void ShaderGL::SetVec4( const char* name, float x, float y, float z, float w ) const
 {
-    glUniform4f( GetUniformLocation( name ), x, y, z, w );
+    SetVec4( GetUniformHandle( name ), x, y, z, w );
 }
 
 
 void ShaderGL::SetMat4( const char* name, const Matrix4& mat ) const
 {
-    glUniformMatrix4fv( GetUniformLocation( name ), 1, GL_FALSE, mat.Data() );
+    SetMat4( GetUniformHandle( name ), mat );
 }
@@ -4,8 +4,8 @@
 // --- Includes ---
 #include "SkullbonezCommon.h"
 #include "SkullbonezIShader.h"
-#include <unordered_map>
 #include <string>
+#include <vector>
 
 
 // --- Usings ---
@@ -26,12 +26,25 @@ class ShaderGL : public IShader
 {
 
   private:
-    GLuint m_programID; // OpenGL ShaderGL program handle
-    mutable std::unordered_map<std::string, GLint> m_uniformCache;
+    struct UniformSlot
+    {
+        char name[64];   // Active uniform name ("[0]" suffix stripped for arrays)
+        GLint location;  // Location resolved once at link time
+        int valueSize;   // Bytes held in value (0 = never written)
+        float value[16]; // Last value sent to GL (ints stored bitwise)
+    };
 
-    static GLuint CompileShader( const char* path, GLenum type ); // Compile a single ShaderGL stage from file
-    static char* LoadShaderSource( const char* path );            // Read ShaderGL source from file
-    GLint GetUniformLocation( const char* name ) const;           // Cached uniform location lookup
+    GLuint m_programID;                          // OpenGL ShaderGL program handle
+    mutable std::vector<UniformSlot> m_uniforms; // Active uniforms, indexed by UniformHandle
+
+    static const char* GetShaderSource( const char* path, std::string& storage, GLint& length );    // Packed source in place, or a loose file read into storage
+    static GLuint CompileShader( const char* path, const char* source, GLint length, GLenum type ); // Compile a single ShaderGL stage
+    static bool IsProgramBinarySupported();                                                         // Driver can hand back program binaries (and the cache is on)
+    static uint64_t GetDriverKey();                                                                 // Cache key seed from the vendor / renderer / version strings
+    bool LoadProgramBinary( uint64_t key );                                                         // Load a cached binary into m_programID; false (fresh program) if missing or rejected
+    void StoreProgramBinary( uint64_t key ) const;                                                  // Save the linked program's binary to the cache
+    void ReflectUniforms();                                                                         // Enumerate active uniforms into m_uniforms
+    const UniformSlot* UpdateSlot( UniformHandle handle, const void* data, int size ) const;        // Cache value; nullptr if invalid or unchanged
 
   public:
     ShaderGL( const char* vertPath, const char* fragPath ); // Constructor: compile and link from files
@@ -46,6 +59,14 @@ class ShaderGL : public IShader
     void SetVec3( const char* name, float x, float y, float z ) const override;          // Set vec3 uniform (components)
     void SetVec4( const char* name, float x, float y, float z, float w ) const override; // Set vec4 uniform
     void SetMat4( const char* name, const Matrix4& mat ) const override;                 // Set mat4 uniform
+
+    UniformHandle GetUniformHandle( const char* name ) const override;                       // Resolve a uniform name (no GL call)
+    void SetInt( UniformHandle handle, int value ) const override;                           // Set int uniform
+    void SetFloat( UniformHandle handle, float value ) const override;                       // Set float uniform
+    void SetVec3( UniformHandle handle, const Vector3& v ) const override;                   // Set vec3 uniform
+    void SetVec3( UniformHandle handle, float x, float y, float z ) const override;          // Set vec3 uniform (components)
+    void SetVec4( UniformHandle handle, float x, float y, float z, float w ) const override; // Set vec4 uniform
+    void SetMat4( UniformHandle handle, const Matrix4& mat ) const override;                 // Set mat4 uniform
 };
 } // namespace Rendering
 } // namespace SkullbonezCore
@@ -0,0 +1,158 @@
+// --- Includes ---
+#include "SkullbonezSimulationThread.h"
+#include "SkullbonezGameModelCollection.h"
+#include "SkullbonezCollisionResponse.h"
+#include <chrono>
+#include <mmsystem.h>
+
+#pragma comment( lib, "winmm.lib" )
+
+
+// --- Usings ---
+using namespace SkullbonezCore::GameObjects;
+using namespace SkullbonezCore::Physics;
+
+
+SimulationThread::SimulationThread()
+    : m_models( nullptr ), m_isStopRequested( false ), m_stepsTaken( 0 ), m_lastStepMs( 0.0f ), m_stepSeconds( 0.0f ), m_timeScale( 1.0f ), m_isPaused( false ), m_stepIndex( 0 )
+{
+}
+
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+
+void SimulationThread::Start( GameModelCollection* models, float stepsPerSecond, float timeScale )
+{
+    if ( !models || stepsPerSecond <= 0.0f )
+    {
+        throw std::runtime_error( "Invalid simulation thread parameters.  (SimulationThread::Start)" );
+    }
+
+    Stop();
+
+    m_models = models;
+    m_stepSeconds = 1.0f / stepsPerSecond;
+    m_timeScale = timeScale;
+    m_isPaused = false;
+    m_stepIndex = 0;
+    m_stepsTaken.store( 0, std::memory_order_relaxed );
+    m_isStopRequested.store( false, std::memory_order_relaxed );
+
+    // Drop commands aimed at the previous run
+    Command stale;
+    while ( m_commands.Pop( stale ) )
+    {
+    }
+
+    // The renderer has something to draw before the first step lands
+    m_models->PublishRenderState();
+
+    m_thread = std::thread( &SimulationThread::ThreadMain, this );
+}
+
+
+void SimulationThread::Stop()
+{
+    if ( !m_thread.joinable() )
+    {
+        return;
+    }
+
+    m_isStopRequested.store( true, std::memory_order_release );
+    m_thread.join();
+}
+
+
+bool SimulationThread::IsRunning() const
+{
+    return m_thread.joinable();
+}
+
+
+bool SimulationThread::PushCommand( CommandType type, float value )
+{
+    return m_commands.Push( { type, value } );
+}
+
+
+int SimulationThread::TakeStepCount()
+{
+    return m_stepsTaken.exchange( 0, std::memory_order_relaxed );
+}
+
+
+float SimulationThread::GetLastStepMs() const
+{
+    return m_lastStepMs.load( std::memory_order_relaxed );
+}
+
+
+void SimulationThread::ApplyCommands()
+{
+    Command command;
+    while ( m_commands.Pop( command ) )
+    {
+        switch ( command.type )
+        {
+        case CommandType::SetPaused:
+            m_isPaused = command.value != 0.0f;
+            break;
+        }
+    }
+}
+
+
+void SimulationThread::Step()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    CollisionResponse::SetPhysicsFrame( m_stepIndex++ );
+    m_models->RunPhysics( m_stepSeconds * m_timeScale );
+    m_models->PublishRenderState();
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_lastStepMs.store( elapsed.count(), std::memory_order_relaxed );
+    m_stepsTaken.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+void SimulationThread::ThreadMain()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Default timer resolution (~15.6 ms) is coarser than a step; ask for 1 ms while we run
+    timeBeginPeriod( 1 );
+
+    const auto step = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( m_stepSeconds ) );
+    auto nextStep = Clock::now();
+
+    while ( !m_isStopRequested.load( std::memory_order_acquire ) )
+    {
+        ApplyCommands();
+
+        auto now = Clock::now();
+        if ( now < nextStep )
+        {
+            std::this_thread::sleep_until( nextStep );
+            continue;
+        }
+
+        // A long stall (debugger, window drag) would otherwise replay as a burst of steps
+        if ( now - nextStep > step * MAX_CATCH_UP_STEPS )
+        {
+            nextStep = now;
+        }
+        nextStep += step;
+
+        if ( !m_isPaused )
+        {
+            Step();
+        }
+    }
+
+    timeEndPeriod( 1 );
+}
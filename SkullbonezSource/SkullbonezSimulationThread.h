@@ -0,0 +1,76 @@
+#pragma once
+
+
+// --- Includes ---
+#include <atomic>
+#include <thread>
+#include "SkullbonezCommon.h"
+#include "SkullbonezSpscQueue.h"
+
+
+namespace SkullbonezCore
+{
+namespace GameObjects
+{
+class GameModelCollection;
+
+
+/* -- Simulation Thread ------------------------------------------------------------------------------------------------------------------------------------------
+
+    Runs GameModelCollection::RunPhysics on a dedicated thread at a fixed step rate, independent of the
+    render loop.  Every step publishes the body transforms through the collection's triple buffer; the render
+    thread picks up the newest set with AcquireRenderState().  The render thread talks to the simulation only
+    through a lock-free command queue, so neither side ever blocks on the other.
+
+    The collection must not be modified from the render thread while the thread is running: Stop() before
+    clearing or adding models, Start() again afterwards.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class SimulationThread
+{
+
+  public:
+    enum class CommandType : uint8_t
+    {
+        SetPaused, // value != 0 pauses stepping (the last published state stays on screen)
+    };
+
+    struct Command
+    {
+        CommandType type;
+        float value;
+    };
+
+  private:
+    static constexpr int COMMAND_CAPACITY = 64;
+    static constexpr int MAX_CATCH_UP_STEPS = 4; // Further behind than this and the backlog is dropped
+
+    GameModelCollection* m_models;
+    std::thread m_thread;
+    std::atomic<bool> m_isStopRequested;
+    Basics::SpscQueue<Command, COMMAND_CAPACITY> m_commands; // Render thread -> simulation
+    std::atomic<int> m_stepsTaken;                           // Steps since the render thread last took the count
+    std::atomic<float> m_lastStepMs;                         // Wall time of the most recent step
+
+    // Owned by the simulation thread while it runs
+    float m_stepSeconds;
+    float m_timeScale;
+    bool m_isPaused;
+    int m_stepIndex;
+
+    void ThreadMain();
+    void ApplyCommands();
+    void Step();
+
+  public:
+    SimulationThread();
+    ~SimulationThread();
+
+    void Start( GameModelCollection* models, float stepsPerSecond, float timeScale ); // Publishes an initial state, then starts stepping
+    void Stop();                                                                      // Joins the thread; no-op when not running
+    bool IsRunning() const;
+    bool PushCommand( CommandType type, float value ); // Render thread only; false when the queue is full
+    int TakeStepCount();                               // Steps completed since the previous call
+    float GetLastStepMs() const;
+};
+} // namespace GameObjects
+} // namespace SkullbonezCore
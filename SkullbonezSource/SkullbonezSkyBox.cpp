@@ -1,6 +1,11 @@
 // --- Includes ---
 #include "SkullbonezSkyBox.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
+#include "SkullbonezVertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <vector>
 
 
@@ -22,6 +27,8 @@ SkyBox::SkyBox( int m_xMin,
     m_boundaries.m_zMin = m_zMin;
     m_boundaries.m_zMax = m_zMax;
     m_textures = 0;
+    m_uView = UniformHandle::Invalid;
+    m_uProjection = UniformHandle::Invalid;
 }
 
 
@@ -265,9 +272,47 @@ void SkyBox::BuildMeshes()
     float* faceData[] = { up, down, right, left, front, back };
     m_faceTextures = { TEXTURE_SKY_UP, TEXTURE_SKY_DOWN, TEXTURE_SKY_RIGHT, TEXTURE_SKY_LEFT, TEXTURE_SKY_FRONT, TEXTURE_SKY_BACK };
 
+    // Each face's two triangles share two corners: upload its 4 distinct vertices and 6 16-bit indices.
+    // Corners are whole numbers, so half-float positions are exact up to 2048 units from the origin.
+    float extent = ( std::max )( { fabsf( xn ), fabsf( xp ), fabsf( yn ), fabsf( yp ), fabsf( zn ), fabsf( zp ) } );
+    bool isHalfExact = extent <= 2048.0f;
     for ( int i = 0; i < 6; ++i )
     {
-        m_faceMeshes[i] = Gfx().CreateMesh( faceData[i], 6, false, true );
+        float corners[6 * 5];
+        uint16_t indices[6];
+        int cornerCount = 0;
+        for ( int v = 0; v < 6; ++v )
+        {
+            const float* vertex = &faceData[i][v * 5];
+            int corner = 0;
+            while ( corner < cornerCount && memcmp( &corners[corner * 5], vertex, 5 * sizeof( float ) ) != 0 )
+            {
+                ++corner;
+            }
+            if ( corner == cornerCount )
+            {
+                memcpy( &corners[cornerCount++ * 5], vertex, 5 * sizeof( float ) );
+            }
+            indices[v] = static_cast<uint16_t>( corner );
+        }
+
+        if ( !isHalfExact )
+        {
+            m_faceMeshes[i] = Gfx().CreateIndexedMesh( corners, cornerCount, VertexFormat::Pos3_Tex2, indices, 6, IndexFormat::UInt16 );
+            continue;
+        }
+
+        PackedUnlitVertex packed[6] = {};
+        for ( int c = 0; c < cornerCount; ++c )
+        {
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                packed[c].position[axis] = PackHalf( corners[c * 5 + axis] );
+            }
+            packed[c].texCoord[0] = PackUNorm16( corners[c * 5 + 3] );
+            packed[c].texCoord[1] = PackUNorm16( corners[c * 5 + 4] );
+        }
+        m_faceMeshes[i] = Gfx().CreateIndexedMesh( packed, cornerCount, VertexFormat::HalfPos_UNormTex, indices, 6, IndexFormat::UInt16 );
     }
 
     // Load m_shader
@@ -277,6 +322,8 @@ void SkyBox::BuildMeshes()
     m_shader->Use();
     m_shader->SetMat4( "uModel", Matrix4() );
     m_shader->SetVec4( "uColorTint", 1.0f, 1.0f, 1.0f, 1.0f );
+    m_uView = m_shader->GetUniformHandle( "uView" );
+    m_uProjection = m_shader->GetUniformHandle( "uProjection" );
 }
 
 
@@ -319,13 +366,14 @@ void SkyBox::ResetGLResources()
 
 void SkyBox::Render( const Matrix4& view, const Matrix4& proj )
 {
-    m_shader->Use();
-    m_shader->SetMat4( "uView", view );
-    m_shader->SetMat4( "uProjection", proj );
+    RenderQueue& queue = RenderQueue::Instance();
+    queue.Begin( RenderLayer::Sky, m_shader.get(), RenderState() );
+    queue.SetMat4( m_uView, view );
+    queue.SetMat4( m_uProjection, proj );
 
     for ( int i = 0; i < 6; ++i )
     {
-        m_textures->SelectTexture( m_faceTextures[i] );
-        m_faceMeshes[i]->Draw();
+        queue.SetTexture( 0, m_textures->GetTextureHandle( m_faceTextures[i] ) );
+        queue.DrawMesh( m_faceMeshes[i].get() );
     }
 }
@@ -38,6 +38,8 @@ class SkyBox
     std::unique_ptr<IShader> m_shader;                  // Unlit textured m_shader
     std::array<std::unique_ptr<IMesh>, 6> m_faceMeshes; // VBO mesh per face
     std::array<uint32_t, 6> m_faceTextures;             // Texture hash per face
+    UniformHandle m_uView;                              // Cached uniform handles (resolved in BuildMeshes)
+    UniformHandle m_uProjection;
 
     SkyBox( int xMin, int xMax, int yMin, int yMax, int zMin, int zMax ); // Overloaded constructor
     ~SkyBox() = default;                                                  // Destructor
@@ -0,0 +1,67 @@
+#pragma once
+
+
+// --- Includes ---
+#include <atomic>
+#include <cstdint>
+
+
+namespace SkullbonezCore
+{
+namespace Basics
+{
+/* -- SPSC Queue -------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Fixed-capacity lock-free queue for exactly one producer thread and one consumer thread.  Head and tail
+    are free-running counters on separate cache lines; CAPACITY must be a power of two.  Push() fails rather
+    than blocks when the queue is full.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+template <typename T, int CAPACITY>
+class SpscQueue
+{
+    static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "SpscQueue capacity must be a power of two" );
+
+  private:
+    static constexpr uint32_t INDEX_MASK = CAPACITY - 1;
+
+    T m_items[CAPACITY];
+    alignas( 64 ) std::atomic<uint32_t> m_head; // Next item to pop (written by the consumer)
+    alignas( 64 ) std::atomic<uint32_t> m_tail; // Next free slot (written by the producer)
+
+  public:
+    SpscQueue()
+        : m_items(), m_head( 0 ), m_tail( 0 )
+    {
+    }
+
+    SpscQueue( const SpscQueue& ) = delete;
+    SpscQueue& operator=( const SpscQueue& ) = delete;
+
+    // Producer only
+    bool Push( const T& item )
+    {
+        uint32_t tail = m_tail.load( std::memory_order_relaxed );
+        if ( tail - m_head.load( std::memory_order_acquire ) == static_cast<uint32_t>( CAPACITY ) )
+        {
+            return false;
+        }
+        m_items[tail & INDEX_MASK] = item;
+        m_tail.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+
+    // Consumer only
+    bool Pop( T& out )
+    {
+        uint32_t head = m_head.load( std::memory_order_relaxed );
+        if ( head == m_tail.load( std::memory_order_acquire ) )
+        {
+            return false;
+        }
+        out = m_items[head & INDEX_MASK];
+        m_head.store( head + 1, std::memory_order_release );
+        return true;
+    }
+};
+} // namespace Basics
+} // namespace SkullbonezCore
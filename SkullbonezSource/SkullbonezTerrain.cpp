@@ -1,11 +1,252 @@
 // --- Includes ---
 #include "SkullbonezTerrain.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
+#include "SkullbonezTextureCollection.h"
+#include "SkullbonezAssetPack.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
 
 
 // --- Usings ---
 using namespace SkullbonezCore::Geometry;
 using namespace SkullbonezCore::Math;
+using namespace SkullbonezCore::Basics;
+using namespace SkullbonezCore::Textures;
+
+
+struct Terrain::SweepQuery
+{
+    Vector3 origin;  // Sphere centre (or ray origin) at time 0
+    Vector3 motion;  // Displacement per unit of time
+    float radius;    // 0 for rays
+    float bestTime;  // Earliest contact so far; starts at the query's time limit
+    TerrainHit hit;
+    bool isHit;
+
+    const CompactHeightfield* heightfield; // Grid being descended: the map, or one procedural tile
+    const HeightPyramid* pyramid;
+    float offsetX;                         // World position of the grid's post (0, 0)
+    float offsetZ;
+};
+
+
+// Narrows [tEnter, tExit] to the times origin + motion * t spends inside [lo, hi] on one axis
+static bool ClipSlab( float origin, float motion, float lo, float hi, float& tEnter, float& tExit )
+{
+    if ( fabsf( motion ) < TOLERANCE )
+    {
+        return origin >= lo && origin <= hi;
+    }
+
+    float t0 = ( lo - origin ) / motion;
+    float t1 = ( hi - origin ) / motion;
+    if ( t0 > t1 )
+    {
+        float swap = t0;
+        t0 = t1;
+        t1 = swap;
+    }
+    tEnter = ( std::max )( tEnter, t0 );
+    tExit = ( std::min )( tExit, t1 );
+    return tEnter <= tExit;
+}
+
+
+// Time the query first touches the plane n.p = d from above (n unit length, pointing up); false if it never does
+static bool SweepPlane( const Vector3& n, float d, float radius, const Vector3& origin, const Vector3& motion, float& outTime )
+{
+    float separation = n * origin - d;
+    if ( separation >= radius )
+    {
+        float approach = n * motion;
+        if ( approach >= 0.0f )
+        {
+            return false;
+        }
+        outTime = ( radius - separation ) / approach;
+        return true;
+    }
+
+    // Already touching (spheres only: a ray starting below the surface never hits it)
+    if ( separation > -radius )
+    {
+        outTime = 0.0f;
+        return true;
+    }
+    return false;
+}
+
+
+static bool IsInsideTriangleXZ( const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c )
+{
+    float e0 = ( b.x - a.x ) * ( p.z - a.z ) - ( b.z - a.z ) * ( p.x - a.x );
+    float e1 = ( c.x - b.x ) * ( p.z - b.z ) - ( c.z - b.z ) * ( p.x - b.x );
+    float e2 = ( a.x - c.x ) * ( p.z - c.z ) - ( a.z - c.z ) * ( p.x - c.x );
+    return ( e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f ) || ( e0 <= 0.0f && e1 <= 0.0f && e2 <= 0.0f );
+}
+
+
+// Closest point to p on triangle abc (Voronoi region walk)
+static Vector3 ClosestPointOnTriangle( const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c )
+{
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+    Vector3 ap = p - a;
+    float d1 = ab * ap;
+    float d2 = ac * ap;
+    if ( d1 <= 0.0f && d2 <= 0.0f )
+    {
+        return a;
+    }
+
+    Vector3 bp = p - b;
+    float d3 = ab * bp;
+    float d4 = ac * bp;
+    if ( d3 >= 0.0f && d4 <= d3 )
+    {
+        return b;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if ( vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f )
+    {
+        return a + ab * ( d1 / ( d1 - d3 ) );
+    }
+
+    Vector3 cp = p - c;
+    float d5 = ab * cp;
+    float d6 = ac * cp;
+    if ( d6 >= 0.0f && d5 <= d6 )
+    {
+        return c;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if ( vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f )
+    {
+        return a + ac * ( d2 / ( d2 - d6 ) );
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if ( va <= 0.0f && ( d4 - d3 ) >= 0.0f && ( d5 - d6 ) >= 0.0f )
+    {
+        return b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+    }
+
+    float denominator = 1.0f / ( va + vb + vc );
+    return a + ab * ( vb * denominator ) + ac * ( vc * denominator );
+}
+
+
+// Earliest root in [0, maxTime] of a*t^2 + 2*b*t + c = 0 entered from outside (c > 0)
+static bool EarliestRoot( float a, float b, float c, float maxTime, float& outTime )
+{
+    if ( a < TOLERANCE || b >= 0.0f )
+    {
+        return false; // Not moving, or moving away
+    }
+    float discriminant = b * b - a * c;
+    if ( discriminant < 0.0f )
+    {
+        return false;
+    }
+    float time = ( -b - sqrtf( discriminant ) ) / a;
+    if ( time < 0.0f || time > maxTime )
+    {
+        return false;
+    }
+    outTime = time;
+    return true;
+}
+
+
+// First contact in [0, maxTime] of a sphere (or ray, radius 0) moving from origin by motion with triangle abc:
+// the face, then (spheres only) the three edges and three corners
+static bool SweepTriangle( const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& origin, const Vector3& motion, float radius, float maxTime, TerrainHit& outHit )
+{
+    Vector3 n = Vector::CrossProduct( b - a, c - a );
+    n.Normalise();
+    if ( n.y < 0.0f )
+    {
+        n = n * -1.0f;
+    }
+    float d = n * a;
+
+    // Already overlapping: contact at the closest point
+    if ( radius > 0.0f )
+    {
+        Vector3 closest = ClosestPointOnTriangle( origin, a, b, c );
+        Vector3 offset = origin - closest;
+        float distanceSquared = offset * offset;
+        if ( distanceSquared < radius * radius )
+        {
+            float distance = sqrtf( distanceSquared );
+            outHit.time = 0.0f;
+            outHit.point = closest;
+            outHit.normal = distance > TOLERANCE ? offset / distance : n;
+            return true;
+        }
+    }
+
+    // Face: nothing touches earlier than a contact inside the triangle, since the sphere was clear of the whole plane
+    float time;
+    if ( SweepPlane( n, d, radius, origin, motion, time ) && time <= maxTime )
+    {
+        Vector3 center = origin + motion * time;
+        Vector3 point = center - n * ( n * center - d );
+        if ( IsInsideTriangleXZ( point, a, b, c ) )
+        {
+            outHit.time = time;
+            outHit.point = point;
+            outHit.normal = n;
+            return true;
+        }
+    }
+
+    if ( radius <= 0.0f )
+    {
+        return false;
+    }
+
+    bool isHit = false;
+    float motionSquared = motion * motion;
+    const Vector3* corners[3] = { &a, &b, &c };
+    for ( int i = 0; i < 3; ++i )
+    {
+        // Edge: the centre path against the cylinder of the radius around the edge, kept if it lands between the ends
+        const Vector3& start = *corners[i];
+        Vector3 edge = *corners[( i + 1 ) % 3] - start;
+        Vector3 w = origin - start;
+        float ee = edge * edge;
+        float em = edge * motion;
+        float ew = edge * w;
+        if ( EarliestRoot( ee * motionSquared - em * em, ee * ( motion * w ) - em * ew, ee * ( w * w - radius * radius ) - ew * ew, maxTime, time ) )
+        {
+            float along = ( ew + em * time ) / ee;
+            if ( along >= 0.0f && along <= 1.0f )
+            {
+                maxTime = time;
+                outHit.time = time;
+                outHit.point = start + edge * along;
+                outHit.normal = ( origin + motion * time - outHit.point ) / radius;
+                isHit = true;
+            }
+        }
+
+        // Corner: the centre path against the sphere of the radius around the post
+        if ( EarliestRoot( motionSquared, motion * w, w * w - radius * radius, maxTime, time ) )
+        {
+            maxTime = time;
+            outHit.time = time;
+            outHit.point = start;
+            outHit.normal = ( origin + motion * time - start ) / radius;
+            isHit = true;
+        }
+    }
+    return isHit;
+}
 
 
 Terrain::Terrain( const char* sFileName,
@@ -17,6 +258,8 @@ Terrain::Terrain( const char* sFileName,
     m_stepSize = iStepSize;
     m_textureWrap = iTextureWrap;
     m_isFlatSlope = false;
+    m_isProcedural = false;
+    m_heightMap = nullptr;
     m_slopeBaseY = 0.0f;
     m_slopeX = 0.0f;
     m_slopeZ = 0.0f;
@@ -30,20 +273,24 @@ Terrain::Terrain( const char* sFileName,
     LoadTerrainData( sFileName );
     BuildTerrain();
     BuildMesh();
+    m_heightfield.Build( m_postData, m_postsPerSide, m_stepSize * Cfg().terrainScale );
+    m_heightPyramid.Build( m_heightfield );
 
-    // Load the m_shader
-    m_terrainShader = Gfx().CreateShader(
-        "SkullbonezData/shaders/lit_textured.vert",
-        "SkullbonezData/shaders/lit_textured.frag" );
+    m_postHeights.resize( m_postData.size() );
+    for ( size_t i = 0; i < m_postData.size(); ++i )
+    {
+        m_postHeights[i] = m_postData[i].vPosition.y;
+    }
 
-    m_terrainShader->Use();
-    m_terrainShader->SetVec4( "uLightAmbient", 1.0f, 0.5f, 0.5f, 1.0f );
-    m_terrainShader->SetVec4( "uLightDiffuse", 1.0f, 0.5f, 0.5f, 1.0f );
-    m_terrainShader->SetVec4( "uMaterialAmbient", 0.2f, 0.2f, 0.2f, 1.0f );
-    m_terrainShader->SetVec4( "uMaterialDiffuse", 0.8f, 0.8f, 0.8f, 1.0f );
-    m_terrainShader->SetInt( "uTexture", 0 );
+    // Collision reads the compact heightfield from here on
+    m_postData.clear();
+    m_postData.shrink_to_fit();
+
+    // Load the m_shader
+    LoadShader();
 
     // m_height map no longer needed after build
+    m_heightMap = nullptr;
     m_terrainData.clear();
     m_terrainData.shrink_to_fit();
 }
@@ -57,12 +304,45 @@ Terrain::Terrain( float slopeBaseY, float slopeX, float slopeZ )
     m_postsPerSide = 0;
     m_terrainSizeWorldCoords = 0;
     m_isFlatSlope = true;
+    m_isProcedural = false;
+    m_heightMap = nullptr;
     m_slopeBaseY = slopeBaseY;
     m_slopeX = slopeX;
     m_slopeZ = slopeZ;
 
     BuildFlatSlopeMesh();
+    LoadShader();
+}
+
+
+Terrain::Terrain( uint32_t proceduralSeed )
+{
+    m_mapSize = 0;
+    m_stepSize = 0;
+    m_textureWrap = 0;
+    m_postsPerSide = 0;
+    m_terrainSizeWorldCoords = 0;
+    m_isFlatSlope = false;
+    m_isProcedural = true;
+    m_heightMap = nullptr;
+    m_slopeBaseY = 0.0f;
+    m_slopeX = 0.0f;
+    m_slopeZ = 0.0f;
+
+    // No tiles until the first UpdateStreaming: the caller knows where the bodies and the camera are
+    m_tileCache = std::make_unique<TerrainTileCache>( proceduralSeed );
+    LoadShader();
+}
 
+
+Terrain::~Terrain()
+{
+    // MeshGL and ShaderGL cleaned up by unique_ptr
+}
+
+
+void Terrain::LoadShader()
+{
     m_terrainShader = Gfx().CreateShader(
         "SkullbonezData/shaders/lit_textured.vert",
         "SkullbonezData/shaders/lit_textured.frag" );
@@ -73,12 +353,19 @@ Terrain::Terrain( float slopeBaseY, float slopeX, float slopeZ )
     m_terrainShader->SetVec4( "uMaterialAmbient", 0.2f, 0.2f, 0.2f, 1.0f );
     m_terrainShader->SetVec4( "uMaterialDiffuse", 0.8f, 0.8f, 0.8f, 1.0f );
     m_terrainShader->SetInt( "uTexture", 0 );
+    m_terrainShader->SetMat4( "uModel", Matrix4() ); // m_terrain vertices are in world space
+    m_uView = m_terrainShader->GetUniformHandle( "uView" );
+    m_uProjection = m_terrainShader->GetUniformHandle( "uProjection" );
+    m_uLightPosition = m_terrainShader->GetUniformHandle( "uLightPosition" );
 }
 
 
-Terrain::~Terrain()
+void Terrain::UpdateStreaming( const Vector3* focusPoints, int focusCount, bool isBlocking )
 {
-    // MeshGL and ShaderGL cleaned up by unique_ptr
+    if ( m_isProcedural )
+    {
+        m_tileCache->Update( focusPoints, focusCount, isBlocking );
+    }
 }
 
 
@@ -96,12 +383,25 @@ void Terrain::BuildTerrain()
 
 int Terrain::GetPixelHeightAt( int xCoord, int yCoord )
 {
-    return m_terrainData[xCoord + yCoord * m_mapSize];
+    return m_heightMap[xCoord + yCoord * m_mapSize];
 }
 
 
 void Terrain::LoadTerrainData( const char* sFileName )
 {
+    // Packed height map is read in place from the mapping
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( sFileName );
+    if ( entry && entry->type == AssetType::Raw )
+    {
+        if ( entry->size < static_cast<uint64_t>( m_mapSize ) * m_mapSize )
+        {
+            throw std::runtime_error( "Packed m_height map is smaller than the map size.  (Terrain::LoadTerrain)" );
+        }
+        m_heightMap = pack.GetData( *entry );
+        return;
+    }
+
     FILE* pRawFile = nullptr;
     fopen_s( &pRawFile, sFileName, "rb" );
 
@@ -122,27 +422,35 @@ void Terrain::LoadTerrainData( const char* sFileName )
     }
 
     fclose( pRawFile );
+    m_heightMap = m_terrainData.data();
 }
 
 
 void Terrain::Render( const Matrix4& view, const Matrix4& projection, const float* lightPosition )
 {
-    m_terrainShader->Use();
-
-    // Model matrix is identity (m_terrain vertices are in world space)
-    Matrix4 model;
-    m_terrainShader->SetMat4( "uModel", model );
-    m_terrainShader->SetMat4( "uView", view );
-    m_terrainShader->SetMat4( "uProjection", projection );
+    RenderQueue& queue = RenderQueue::Instance();
+    queue.Begin( RenderLayer::Opaque, m_terrainShader.get(), RenderState() );
+    queue.SetTexture( 0, TextureCollection::Instance()->GetTextureHandle( TEXTURE_GROUND ) );
+    queue.SetMat4( m_uView, view );
+    queue.SetMat4( m_uProjection, projection );
 
     // Transform light position to view space
     float lx = view.m[0] * lightPosition[0] + view.m[4] * lightPosition[1] + view.m[8] * lightPosition[2] + view.m[12] * lightPosition[3];
     float ly = view.m[1] * lightPosition[0] + view.m[5] * lightPosition[1] + view.m[9] * lightPosition[2] + view.m[13] * lightPosition[3];
     float lz = view.m[2] * lightPosition[0] + view.m[6] * lightPosition[1] + view.m[10] * lightPosition[2] + view.m[14] * lightPosition[3];
     float lw = lightPosition[3];
-    m_terrainShader->SetVec4( "uLightPosition", lx, ly, lz, lw );
+    queue.SetVec4( m_uLightPosition, lx, ly, lz, lw );
 
-    m_terrainMesh->Draw();
+    if ( m_isProcedural )
+    {
+        for ( const TerrainTileCache::Tile* tile : m_tileCache->GetResidentTiles() )
+        {
+            queue.DrawMesh( tile->mesh.get() );
+        }
+        return;
+    }
+
+    queue.DrawMesh( m_terrainMesh.get() );
 }
 
 
@@ -185,6 +493,480 @@ Vector3 Terrain::GetTerrainNormalAt( float xPosition, float zPosition )
 }
 
 
+float Terrain::GetMaxHeightInRegion( float xMin, float zMin, float xMax, float zMax )
+{
+    if ( m_isFlatSlope )
+    {
+        // A plane peaks at one of the corners of the (clamped) rectangle
+        xMin = ( std::max )( xMin, 0.0f );
+        zMin = ( std::max )( zMin, 0.0f );
+        xMax = ( std::min )( xMax, 1000.0f );
+        zMax = ( std::min )( zMax, 1000.0f );
+        return m_slopeBaseY + ( std::max )( m_slopeX * xMin, m_slopeX * xMax ) + ( std::max )( m_slopeZ * zMin, m_slopeZ * zMax );
+    }
+
+    if ( m_isProcedural )
+    {
+        // Each overlapping tile's pyramid, or the noise's upper bound where the tile is not resident
+        float tileSize = m_tileCache->GetTileSize();
+        float inverseCellSize = 1.0f / m_tileCache->GetSpacing();
+        int lastTile = m_tileCache->GetWorldTiles() - 1;
+        int tileXMin = ( std::max )( static_cast<int>( floorf( xMin / tileSize ) ), 0 );
+        int tileZMin = ( std::max )( static_cast<int>( floorf( zMin / tileSize ) ), 0 );
+        int tileXMax = ( std::min )( static_cast<int>( floorf( xMax / tileSize ) ), lastTile );
+        int tileZMax = ( std::min )( static_cast<int>( floorf( zMax / tileSize ) ), lastTile );
+
+        auto lock = m_tileCache->LockForRead();
+        float maxY = -FLT_MAX;
+        for ( int tileX = tileXMin; tileX <= tileXMax; ++tileX )
+        {
+            for ( int tileZ = tileZMin; tileZ <= tileZMax; ++tileZ )
+            {
+                const TerrainTileCache::Tile* tile = m_tileCache->FindTile( tileX, tileZ );
+                if ( !tile )
+                {
+                    return m_tileCache->GetMaxPossibleHeight();
+                }
+
+                float originX = tileX * tileSize;
+                float originZ = tileZ * tileSize;
+                maxY = ( std::max )( maxY, tile->pyramid.GetMaxHeight( static_cast<int>( floorf( ( xMin - originX ) * inverseCellSize ) ),
+                                                                       static_cast<int>( floorf( ( zMin - originZ ) * inverseCellSize ) ),
+                                                                       static_cast<int>( floorf( ( xMax - originX ) * inverseCellSize ) ),
+                                                                       static_cast<int>( floorf( ( zMax - originZ ) * inverseCellSize ) ) ) );
+            }
+        }
+        return maxY > -FLT_MAX ? maxY : m_tileCache->GetMaxPossibleHeight();
+    }
+
+    float inverseCellSize = 1.0f / ( m_stepSize * Cfg().terrainScale );
+    return m_heightPyramid.GetMaxHeight( static_cast<int>( floorf( xMin * inverseCellSize ) ),
+                                         static_cast<int>( floorf( zMin * inverseCellSize ) ),
+                                         static_cast<int>( floorf( xMax * inverseCellSize ) ),
+                                         static_cast<int>( floorf( zMax * inverseCellSize ) ) );
+}
+
+
+void Terrain::BuildHorizon( const Vector3& eye, TerrainHorizon& horizon )
+{
+    // A plane hides nothing from an eye above it
+    if ( m_isFlatSlope || !IsInBounds( eye.x, eye.z ) )
+    {
+        horizon.Disable();
+        return;
+    }
+
+    // The eye must clear the ground around it by more than the near plane, or the surface a hidden sphere
+    // sits behind could be clipped away in front of it (the margin dwarfs the pyramid's quantisation error)
+    float clearance = 2.0f * Cfg().frustumNear;
+    if ( eye.y - clearance <= GetMaxHeightInRegion( eye.x - clearance, eye.z - clearance, eye.x + clearance, eye.z + clearance ) )
+    {
+        horizon.Disable();
+        return;
+    }
+
+    float range = Cfg().horizonRange;
+    int chunkLevel = 0;
+    while ( ( 2 << chunkLevel ) <= Cfg().horizonChunkCells && chunkLevel + 1 < HeightPyramid::MAX_LEVELS )
+    {
+        ++chunkLevel;
+    }
+
+    // Each pyramid node within range is an occluder at its minimum height, less the quantisation error
+    auto addChunks = [&]( const HeightPyramid& pyramid, const CompactHeightfield& heightfield, float originX, float originZ, float cellSize )
+    {
+        int level = ( std::min )( chunkLevel, pyramid.GetLevelCount() - 1 );
+        int cells = pyramid.GetCellsPerSide();
+        int side = pyramid.GetLevelSide( level );
+        float nodeSize = cellSize * static_cast<float>( 1 << level );
+        float margin = 3.0f * heightfield.GetHeightStep();
+        int cxMin = ( std::max )( static_cast<int>( floorf( ( eye.x - range - originX ) / nodeSize ) ), 0 );
+        int czMin = ( std::max )( static_cast<int>( floorf( ( eye.z - range - originZ ) / nodeSize ) ), 0 );
+        int cxMax = ( std::min )( static_cast<int>( floorf( ( eye.x + range - originX ) / nodeSize ) ), side - 1 );
+        int czMax = ( std::min )( static_cast<int>( floorf( ( eye.z + range - originZ ) / nodeSize ) ), side - 1 );
+        for ( int cx = cxMin; cx <= cxMax; ++cx )
+        {
+            for ( int cz = czMin; cz <= czMax; ++cz )
+            {
+                horizon.AddOccluder( originX + static_cast<float>( cx << level ) * cellSize,
+                                     originZ + static_cast<float>( cz << level ) * cellSize,
+                                     originX + static_cast<float>( ( std::min )( ( cx + 1 ) << level, cells ) ) * cellSize,
+                                     originZ + static_cast<float>( ( std::min )( ( cz + 1 ) << level, cells ) ) * cellSize,
+                                     pyramid.GetRange( level, cx, cz ).minY - margin );
+            }
+        }
+    };
+
+    horizon.Begin( eye, range );
+    if ( m_isProcedural )
+    {
+        // Only tiles reached from the eye over resident ground: past a gap the view runs under the surface.
+        // Every straight path from the eye's tile to another stays inside the tile rectangle spanning both.
+        float tileSize = m_tileCache->GetTileSize();
+        int eyeTileX = static_cast<int>( eye.x / tileSize );
+        int eyeTileZ = static_cast<int>( eye.z / tileSize );
+        for ( const TerrainTileCache::Tile* tile : m_tileCache->GetResidentTiles() )
+        {
+            float originX = tile->tileX * tileSize;
+            float originZ = tile->tileZ * tileSize;
+            if ( originX - eye.x > range || eye.x - ( originX + tileSize ) > range ||
+                 originZ - eye.z > range || eye.z - ( originZ + tileSize ) > range )
+            {
+                continue;
+            }
+
+            bool isConnected = true;
+            for ( int tileX = ( std::min )( eyeTileX, tile->tileX ); isConnected && tileX <= ( std::max )( eyeTileX, tile->tileX ); ++tileX )
+            {
+                for ( int tileZ = ( std::min )( eyeTileZ, tile->tileZ ); tileZ <= ( std::max )( eyeTileZ, tile->tileZ ); ++tileZ )
+                {
+                    if ( !m_tileCache->FindTile( tileX, tileZ ) )
+                    {
+                        isConnected = false;
+                        break;
+                    }
+                }
+            }
+            if ( isConnected )
+            {
+                addChunks( tile->pyramid, tile->heightfield, originX, originZ, m_tileCache->GetSpacing() );
+            }
+        }
+    }
+    else
+    {
+        addChunks( m_heightPyramid, m_heightfield, 0.0f, 0.0f, m_stepSize * Cfg().terrainScale );
+    }
+    horizon.End();
+}
+
+
+bool Terrain::Raycast( const Vector3& origin, const Vector3& direction, float maxT, TerrainHit& outHit )
+{
+    return Sweep( origin, 0.0f, direction, maxT, outHit );
+}
+
+
+bool Terrain::SweepSphere( const Vector3& center, float radius, const Vector3& motion, TerrainHit& outHit )
+{
+    return Sweep( center, radius, motion, 1.0f, outHit );
+}
+
+
+bool Terrain::Sweep( const Vector3& origin, float radius, const Vector3& motion, float maxTime, TerrainHit& outHit )
+{
+    SweepQuery query;
+    query.origin = origin;
+    query.motion = motion;
+    query.radius = radius;
+    query.bestTime = maxTime;
+    query.isHit = false;
+
+    if ( m_isFlatSlope )
+    {
+        // y = base + slopeX * x + slopeZ * z  <=>  (-slopeX, 1, -slopeZ) . p = base
+        Vector3 n( -m_slopeX, 1.0f, -m_slopeZ );
+        float inverseLength = 1.0f / VectorMag( n );
+        n *= inverseLength;
+
+        float time;
+        if ( SweepPlane( n, m_slopeBaseY * inverseLength, radius, origin, motion, time ) && time <= maxTime )
+        {
+            Vector3 center = origin + motion * time;
+            Vector3 point = center - n * ( n * center - m_slopeBaseY * inverseLength );
+            if ( IsInBounds( point.x, point.z ) )
+            {
+                query.hit.time = time;
+                query.hit.point = point;
+                query.hit.normal = n;
+                query.isHit = true;
+            }
+        }
+    }
+    else if ( m_isProcedural )
+    {
+        // Every resident tile the swept box (grown by the radius) overlaps; the rest of the world is not solid yet
+        Vector3 end = origin + motion * maxTime;
+        float tileSize = m_tileCache->GetTileSize();
+        int lastTile = m_tileCache->GetWorldTiles() - 1;
+        int tileXMin = ( std::max )( static_cast<int>( floorf( ( ( std::min )( origin.x, end.x ) - radius ) / tileSize ) ), 0 );
+        int tileZMin = ( std::max )( static_cast<int>( floorf( ( ( std::min )( origin.z, end.z ) - radius ) / tileSize ) ), 0 );
+        int tileXMax = ( std::min )( static_cast<int>( floorf( ( ( std::max )( origin.x, end.x ) + radius ) / tileSize ) ), lastTile );
+        int tileZMax = ( std::min )( static_cast<int>( floorf( ( ( std::max )( origin.z, end.z ) + radius ) / tileSize ) ), lastTile );
+
+        auto lock = m_tileCache->LockForRead();
+        for ( int tileX = tileXMin; tileX <= tileXMax; ++tileX )
+        {
+            for ( int tileZ = tileZMin; tileZ <= tileZMax; ++tileZ )
+            {
+                const TerrainTileCache::Tile* tile = m_tileCache->FindTile( tileX, tileZ );
+                if ( tile )
+                {
+                    query.heightfield = &tile->heightfield;
+                    query.pyramid = &tile->pyramid;
+                    query.offsetX = tileX * tileSize;
+                    query.offsetZ = tileZ * tileSize;
+                    SweepNode( tile->pyramid.GetLevelCount() - 1, 0, 0, query );
+                }
+            }
+        }
+    }
+    else
+    {
+        query.heightfield = &m_heightfield;
+        query.pyramid = &m_heightPyramid;
+        query.offsetX = 0.0f;
+        query.offsetZ = 0.0f;
+        SweepNode( m_heightPyramid.GetLevelCount() - 1, 0, 0, query );
+    }
+
+    if ( query.isHit )
+    {
+        outHit = query.hit;
+    }
+    return query.isHit;
+}
+
+
+void Terrain::SweepNode( int level, int cx, int cz, SweepQuery& query )
+{
+    // Skip the node unless the query passes through its box (grown by the radius) before the best hit so far
+    const HeightPyramid::Range& range = query.pyramid->GetRange( level, cx, cz );
+    float cellSize = query.heightfield->GetSpacing();
+    int cellsPerSide = query.pyramid->GetCellsPerSide();
+    int cellXMin = cx << level;
+    int cellZMin = cz << level;
+    int cellXMax = ( std::min )( ( cx + 1 ) << level, cellsPerSide );
+    int cellZMax = ( std::min )( ( cz + 1 ) << level, cellsPerSide );
+
+    float tEnter = 0.0f;
+    float tExit = query.bestTime;
+    if ( !ClipSlab( query.origin.y, query.motion.y, range.minY - query.radius, range.maxY + query.radius, tEnter, tExit ) ||
+         !ClipSlab( query.origin.x, query.motion.x, query.offsetX + cellXMin * cellSize - query.radius, query.offsetX + cellXMax * cellSize + query.radius, tEnter, tExit ) ||
+         !ClipSlab( query.origin.z, query.motion.z, query.offsetZ + cellZMin * cellSize - query.radius, query.offsetZ + cellZMax * cellSize + query.radius, tEnter, tExit ) )
+    {
+        return;
+    }
+
+    if ( level == 0 )
+    {
+        SweepCell( cx, cz, query );
+        return;
+    }
+
+    // Children nearest the origin first, so later ones are usually pruned by the hit already found
+    int childSide = query.pyramid->GetLevelSide( level - 1 );
+    int flipX = query.motion.x < 0.0f ? 1 : 0;
+    int flipZ = query.motion.z < 0.0f ? 1 : 0;
+    for ( int i = 0; i < 2; ++i )
+    {
+        for ( int j = 0; j < 2; ++j )
+        {
+            int childX = cx * 2 + ( i ^ flipX );
+            int childZ = cz * 2 + ( j ^ flipZ );
+            if ( childX < childSide && childZ < childSide )
+            {
+                SweepNode( level - 1, childX, childZ, query );
+            }
+        }
+    }
+}
+
+
+void Terrain::SweepCell( int cx, int cz, SweepQuery& query )
+{
+    // Same split as LocatePolygon and the render mesh: the diagonal runs from post (cx + 1, cz) to (cx, cz + 1)
+    Vector3 offset( query.offsetX, 0.0f, query.offsetZ );
+    Vector3 p00 = query.heightfield->GetPosition( cx, cz ) + offset;
+    Vector3 p01 = query.heightfield->GetPosition( cx, cz + 1 ) + offset;
+    Vector3 p10 = query.heightfield->GetPosition( cx + 1, cz ) + offset;
+    Vector3 p11 = query.heightfield->GetPosition( cx + 1, cz + 1 ) + offset;
+
+    TerrainHit hit;
+    if ( SweepTriangle( p10, p00, p01, query.origin, query.motion, query.radius, query.bestTime, hit ) )
+    {
+        query.bestTime = hit.time;
+        query.hit = hit;
+        query.isHit = true;
+    }
+    if ( SweepTriangle( p10, p01, p11, query.origin, query.motion, query.radius, query.bestTime, hit ) )
+    {
+        query.bestTime = hit.time;
+        query.hit = hit;
+        query.isHit = true;
+    }
+}
+
+
+bool Terrain::Deform( const Vector3& center, float radius, float delta )
+{
+    if ( m_isFlatSlope || m_isProcedural || radius <= 0.0f || delta == 0.0f )
+    {
+        return false;
+    }
+
+    // Posts inside the radius (clamped to the map)
+    float spacing = m_heightfield.GetSpacing();
+    int lastPost = m_postsPerSide - 1;
+    int ixMin = ( std::max )( static_cast<int>( ceilf( ( center.x - radius ) / spacing ) ), 0 );
+    int ixMax = ( std::min )( static_cast<int>( floorf( ( center.x + radius ) / spacing ) ), lastPost );
+    int izMin = ( std::max )( static_cast<int>( ceilf( ( center.z - radius ) / spacing ) ), 0 );
+    int izMax = ( std::min )( static_cast<int>( floorf( ( center.z + radius ) / spacing ) ), lastPost );
+    if ( ixMin > ixMax || izMin > izMax )
+    {
+        return false;
+    }
+
+    // Heights: raised cosine falloff, full delta at the centre and zero slope at the rim
+    bool isRequantised = false;
+    bool isChanged = false;
+    for ( int ix = ixMin; ix <= ixMax; ++ix )
+    {
+        for ( int iz = izMin; iz <= izMax; ++iz )
+        {
+            Vector3 post = GetPostPosition( ix, iz );
+            float dx = post.x - center.x;
+            float dz = post.z - center.z;
+            float distance = sqrtf( dx * dx + dz * dz );
+            if ( distance >= radius )
+            {
+                continue;
+            }
+
+            float& height = m_postHeights[ix * m_postsPerSide + iz];
+            height += delta * 0.5f * ( 1.0f + cosf( _PI * distance / radius ) );
+            isRequantised |= m_heightfield.SetHeight( ix, iz, height );
+            isChanged = true;
+        }
+    }
+    if ( !isChanged )
+    {
+        return false;
+    }
+
+    // Collision: LocatePolygon and the sweeps read the heightfield directly, so only the pyramid needs refitting
+    if ( isRequantised )
+    {
+        m_heightPyramid.Build( m_heightfield );
+    }
+    else
+    {
+        m_heightPyramid.Refit( m_heightfield, ixMin - 1, izMin - 1, ixMax, izMax );
+    }
+
+    // Normals move one post beyond the edited ones; those posts are the mesh vertices to rewrite.  The posts
+    // of a row are contiguous vertices, so each row is one sub-range upload.
+    int rowMin = ( std::max )( ixMin - 1, 0 );
+    int rowMax = ( std::min )( ixMax + 1, lastPost );
+    int colMin = ( std::max )( izMin - 1, 0 );
+    int colMax = ( std::min )( izMax + 1, lastPost );
+    int postCols = colMax - colMin + 1;
+    std::vector<PackedLitVertex> vertexData( static_cast<size_t>( postCols ) );
+    for ( int row = rowMin; row <= rowMax; ++row )
+    {
+        for ( int col = colMin; col <= colMax; ++col )
+        {
+            Vector3 normal = ComputePostNormal( row, col );
+            m_heightfield.SetNormal( row, col, normal );
+            WritePostVertex( row, col, GetPostPosition( row, col ), normal, vertexData[col - colMin] );
+        }
+        m_terrainMesh->UpdateVertices( row * m_postsPerSide + colMin, postCols, vertexData.data() );
+    }
+
+    return true;
+}
+
+
+bool Terrain::CheckAgainstRebuild()
+{
+    if ( m_isFlatSlope || m_isProcedural )
+    {
+        return true;
+    }
+
+    // Rebuild through the construction path from the current heights
+    m_postData.resize( m_postHeights.size() );
+    for ( int ix = 0; ix < m_postsPerSide; ++ix )
+    {
+        for ( int iz = 0; iz < m_postsPerSide; ++iz )
+        {
+            m_postData[ix * m_postsPerSide + iz].vPosition = GetPostPosition( ix, iz );
+        }
+    }
+    GenerateNormals();
+    CompactHeightfield rebuiltField;
+    rebuiltField.Build( m_postData, m_postsPerSide, m_heightfield.GetSpacing() );
+
+    // Heights: both fields quantise the same source, the edited one over a range widened by requantisation.
+    // Normals and mesh vertices are recomputed from full-precision heights on both paths, so must match exactly.
+    float heightTolerance = 2.5f * m_heightfield.GetHeightStep() + 0.5f * rebuiltField.GetHeightStep();
+    int heightMismatches = 0;
+    int normalMismatches = 0;
+    int vertexMismatches = 0;
+    for ( int ix = 0; ix < m_postsPerSide; ++ix )
+    {
+        for ( int iz = 0; iz < m_postsPerSide; ++iz )
+        {
+            if ( fabsf( m_heightfield.GetHeight( ix, iz ) - rebuiltField.GetHeight( ix, iz ) ) > heightTolerance )
+            {
+                ++heightMismatches;
+            }
+
+            Vector3 normal = m_heightfield.GetNormal( ix, iz );
+            Vector3 rebuiltNormal = rebuiltField.GetNormal( ix, iz );
+            if ( normal.x != rebuiltNormal.x || normal.y != rebuiltNormal.y || normal.z != rebuiltNormal.z )
+            {
+                ++normalMismatches;
+            }
+
+            // What Deform uploads for a rewritten post against what BuildMesh writes
+            const TerrainPost& post = m_postData[ix * m_postsPerSide + iz];
+            PackedLitVertex edited;
+            PackedLitVertex rebuilt;
+            WritePostVertex( ix, iz, GetPostPosition( ix, iz ), ComputePostNormal( ix, iz ), edited );
+            WritePostVertex( ix, iz, post.vPosition, post.vNormal, rebuilt );
+            if ( memcmp( &edited, &rebuilt, sizeof( edited ) ) != 0 )
+            {
+                ++vertexMismatches;
+            }
+        }
+    }
+
+    // Pyramid: refitted nodes must equal a full build over the same (edited) heightfield
+    HeightPyramid rebuiltPyramid;
+    rebuiltPyramid.Build( m_heightfield );
+    int nodeMismatches = 0;
+    for ( int level = 0; level < m_heightPyramid.GetLevelCount(); ++level )
+    {
+        int side = m_heightPyramid.GetLevelSide( level );
+        for ( int cx = 0; cx < side; ++cx )
+        {
+            for ( int cz = 0; cz < side; ++cz )
+            {
+                const HeightPyramid::Range& range = m_heightPyramid.GetRange( level, cx, cz );
+                const HeightPyramid::Range& rebuiltRange = rebuiltPyramid.GetRange( level, cx, cz );
+                if ( range.minY != rebuiltRange.minY || range.maxY != rebuiltRange.maxY )
+                {
+                    ++nodeMismatches;
+                }
+            }
+        }
+    }
+
+    m_postData.clear();
+    m_postData.shrink_to_fit();
+
+    if ( heightMismatches + normalMismatches + vertexMismatches + nodeMismatches > 0 )
+    {
+        fprintf( stderr, "ERROR: deformed terrain differs from a full rebuild: %d heights, %d normals, %d mesh vertices, %d pyramid nodes\n",
+                 heightMismatches, normalMismatches, vertexMismatches, nodeMismatches );
+        return false;
+    }
+    fprintf( stdout, "Deformed terrain matches a full rebuild (%d posts, %d pyramid levels)\n", m_postsPerSide * m_postsPerSide, m_heightPyramid.GetLevelCount() );
+    return true;
+}
+
+
 bool Terrain::IsInBounds( float xPosition, float zPosition )
 {
     if ( m_isFlatSlope )
@@ -193,6 +975,20 @@ bool Terrain::IsInBounds( float xPosition, float zPosition )
                  zPosition >= 0.0f && zPosition < 1000.0f );
     }
 
+    if ( m_isProcedural )
+    {
+        // Inside the world and on a tile that has been streamed in (bodies cannot run onto ground that is not there yet)
+        float tileSize = m_tileCache->GetTileSize();
+        float worldSize = m_tileCache->GetWorldTiles() * tileSize;
+        if ( xPosition < 0.0f || zPosition < 0.0f || xPosition >= worldSize || zPosition >= worldSize )
+        {
+            return false;
+        }
+
+        auto lock = m_tileCache->LockForRead();
+        return m_tileCache->FindTile( static_cast<int>( xPosition / tileSize ), static_cast<int>( zPosition / tileSize ) ) != nullptr;
+    }
+
     /*
         Justification for not allowing coordinates to the absolute outer bound:
         -----------------------------------------------------------------------
@@ -232,6 +1028,15 @@ XZBounds Terrain::GetXZBounds()
         return bounds;
     }
 
+    if ( m_isProcedural )
+    {
+        bounds.m_xMin = 0.0f;
+        bounds.m_zMin = 0.0f;
+        bounds.m_xMax = m_tileCache->GetWorldTiles() * m_tileCache->GetTileSize();
+        bounds.m_zMax = bounds.m_xMax;
+        return bounds;
+    }
+
     bounds.m_xMin = 0.0f;
     bounds.m_zMin = 0.0f;
     bounds.m_xMax = m_terrainSizeWorldCoords * Cfg().terrainScale;
@@ -243,6 +1048,11 @@ XZBounds Terrain::GetXZBounds()
 
 Triangle Terrain::LocatePolygon( float xPosition, float zPosition )
 {
+    if ( m_isProcedural )
+    {
+        return LocateProceduralPolygon( xPosition, zPosition );
+    }
+
     // check to ensure specified co-ordinates are inside the m_terrain map bounds
     if ( !IsInBounds( xPosition, zPosition ) )
     {
@@ -316,19 +1126,21 @@ Triangle Terrain::LocatePolygon( float xPosition, float zPosition )
 
         (NOTE: The gradient of the cross section is equal to -1)
     */
+    int targetX = targetQuadric / m_postsPerSide;
+    int targetZ = targetQuadric % m_postsPerSide;
     if ( isGradientInfinite || gradient < -1.0f )
     {
         // TRIANGLE A
-        targetPolygon.v1 = m_postData[targetQuadric].vPosition;
-        targetPolygon.v2 = m_postData[targetQuadric - m_postsPerSide].vPosition;
-        targetPolygon.v3 = m_postData[targetQuadric - m_postsPerSide + 1].vPosition;
+        targetPolygon.v1 = m_heightfield.GetPosition( targetX, targetZ );
+        targetPolygon.v2 = m_heightfield.GetPosition( targetX - 1, targetZ );
+        targetPolygon.v3 = m_heightfield.GetPosition( targetX - 1, targetZ + 1 );
     }
     else
     {
         // TRIANGLE B
-        targetPolygon.v1 = m_postData[targetQuadric].vPosition;
-        targetPolygon.v2 = m_postData[targetQuadric - m_postsPerSide + 1].vPosition;
-        targetPolygon.v3 = m_postData[targetQuadric + 1].vPosition;
+        targetPolygon.v1 = m_heightfield.GetPosition( targetX, targetZ );
+        targetPolygon.v2 = m_heightfield.GetPosition( targetX - 1, targetZ + 1 );
+        targetPolygon.v3 = m_heightfield.GetPosition( targetX, targetZ + 1 );
     }
 
     // return the target poly
@@ -336,6 +1148,70 @@ Triangle Terrain::LocatePolygon( float xPosition, float zPosition )
 }
 
 
+Triangle Terrain::LocateProceduralPolygon( float xPosition, float zPosition )
+{
+    // Heights and normals off a resident tile are still well defined: the noise is evaluated directly, so
+    // callers that probe ahead of the streaming (camera, spawn placement) see the ground that will load
+    float tileSize = m_tileCache->GetTileSize();
+    float worldSize = m_tileCache->GetWorldTiles() * tileSize;
+    if ( xPosition < 0.0f || zPosition < 0.0f || xPosition >= worldSize || zPosition >= worldSize )
+    {
+        throw std::runtime_error( "Specified co-ordinates are out of m_terrain bounds.  (Terrain::LocateProceduralPolygon)" );
+    }
+
+    float spacing = m_tileCache->GetSpacing();
+    int cellsPerSide = m_tileCache->GetCellsPerSide();
+    int postX = static_cast<int>( xPosition / spacing );
+    int postZ = static_cast<int>( zPosition / spacing );
+    int tileX = postX / cellsPerSide;
+    int tileZ = postZ / cellsPerSide;
+
+    Vector3 p00, p01, p10, p11;
+    {
+        auto lock = m_tileCache->LockForRead();
+        const TerrainTileCache::Tile* tile = m_tileCache->FindTile( tileX, tileZ );
+        if ( tile )
+        {
+            // Quantised tile posts, so the answer matches the sweeps against the same tile
+            int cx = postX - tileX * cellsPerSide;
+            int cz = postZ - tileZ * cellsPerSide;
+            Vector3 offset( tileX * tileSize, 0.0f, tileZ * tileSize );
+            p00 = tile->heightfield.GetPosition( cx, cz ) + offset;
+            p01 = tile->heightfield.GetPosition( cx, cz + 1 ) + offset;
+            p10 = tile->heightfield.GetPosition( cx + 1, cz ) + offset;
+            p11 = tile->heightfield.GetPosition( cx + 1, cz + 1 ) + offset;
+        }
+        else
+        {
+            float x0 = postX * spacing;
+            float z0 = postZ * spacing;
+            p00 = Vector3( x0, m_tileCache->SampleHeight( postX, postZ ), z0 );
+            p01 = Vector3( x0, m_tileCache->SampleHeight( postX, postZ + 1 ), z0 + spacing );
+            p10 = Vector3( x0 + spacing, m_tileCache->SampleHeight( postX + 1, postZ ), z0 );
+            p11 = Vector3( x0 + spacing, m_tileCache->SampleHeight( postX + 1, postZ + 1 ), z0 + spacing );
+        }
+    }
+
+    // Same split and vertex order as the height map case: triangle A below the diagonal from p10 to p01
+    Triangle targetPolygon;
+    float fx = xPosition - p00.x;
+    float fz = zPosition - p00.z;
+    if ( fx + fz < spacing )
+    {
+        targetPolygon.v1 = p10;
+        targetPolygon.v2 = p00;
+        targetPolygon.v3 = p01;
+    }
+    else
+    {
+        targetPolygon.v1 = p10;
+        targetPolygon.v2 = p01;
+        targetPolygon.v3 = p11;
+    }
+    return targetPolygon;
+}
+
+
 void Terrain::TranslatePostings()
 {
     int indexCounter = 0;
@@ -671,125 +1547,119 @@ void Terrain::GenerateNormals()
 }
 
 
-void Terrain::BuildMesh()
+Vector3 Terrain::GetPostPosition( int ix, int iz ) const
 {
-    // 2 triangles per quad, 6 vertices each, 8 floats per vertex (pos3 + normal3 + texcoord2)
-    int quadsPerSide = m_postsPerSide - 1;
-    int totalQuads = quadsPerSide * quadsPerSide;
-    int totalVerts = totalQuads * 6;
+    return Vector3( static_cast<float>( ix * m_stepSize ) * Cfg().terrainScale,
+                    m_postHeights[ix * m_postsPerSide + iz],
+                    static_cast<float>( iz * m_stepSize ) * Cfg().terrainScale );
+}
 
-    std::vector<float> vertexData;
-    vertexData.reserve( static_cast<size_t>( totalVerts ) * 8 );
 
-    for ( int row = 0; row < quadsPerSide; ++row )
+Vector3 Terrain::ComputePostNormal( int ix, int iz ) const
+{
+    // The six triangles around a post, in GenerateNormals order: neighbour offsets (along X, along Z) and weight.
+    // A triangle only counts when both of its neighbours exist, which reproduces GenerateNormals' edge cases.
+    static const struct
+    {
+        int ax, az, bx, bz;
+        float weight;
+    } fan[6] = {
+        { 0, -1, -1, 0, 0.25f },  // top-left
+        { -1, 0, -1, 1, 0.125f }, // top-top-right
+        { -1, 1, 0, 1, 0.125f },  // top-right-right
+        { 0, 1, 1, 0, 0.25f },    // right-down
+        { 1, 0, 1, -1, 0.125f },  // down-down-left
+        { 1, -1, 0, -1, 0.125f }, // down-left-left
+    };
+
+    Vector3 centre = GetPostPosition( ix, iz );
+    Vector3 normal;
+    normal.Zero();
+    for ( const auto& triangle : fan )
     {
-        for ( int col = 0; col < quadsPerSide; ++col )
+        int axIndex = ix + triangle.ax;
+        int azIndex = iz + triangle.az;
+        int bxIndex = ix + triangle.bx;
+        int bzIndex = iz + triangle.bz;
+        if ( axIndex < 0 || azIndex < 0 || bxIndex < 0 || bzIndex < 0 ||
+             axIndex >= m_postsPerSide || azIndex >= m_postsPerSide || bxIndex >= m_postsPerSide || bzIndex >= m_postsPerSide )
         {
-            float texCoordS = ( static_cast<float>( col ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap;
-            float texCoordT = ( static_cast<float>( row ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap;
-            float texCoordSP1 = ( static_cast<float>( col + 1 ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap;
-            float texCoordTP1 = ( static_cast<float>( row + 1 ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap;
+            continue;
+        }
 
-            int idx = row * m_postsPerSide + col;
+        Vector3 a = GetPostPosition( axIndex, azIndex );
+        Vector3 b = GetPostPosition( bxIndex, bzIndex );
+        a -= centre;
+        b -= centre;
+        normal += triangle.weight * CrossProduct( a, b );
+    }
+    normal.Normalise();
+    return normal;
+}
 
-            // Post references (matching glVertex3i truncation from original display list)
-            const TerrainPost& p00 = m_postData[idx];
-            const TerrainPost& p10 = m_postData[idx + 1];
-            const TerrainPost& p01 = m_postData[idx + m_postsPerSide];
-            const TerrainPost& p11 = m_postData[idx + m_postsPerSide + 1];
 
-            // Helper lambda: push m_position (int-truncated) + m_normal + texcoord
-            auto pushVertex = [&]( const TerrainPost& p, float s, float t )
-            {
-                vertexData.push_back( static_cast<float>( static_cast<int>( p.vPosition.x ) ) );
-                vertexData.push_back( static_cast<float>( static_cast<int>( p.vPosition.y ) ) );
-                vertexData.push_back( static_cast<float>( static_cast<int>( p.vPosition.z ) ) );
-                vertexData.push_back( p.vNormal.x );
-                vertexData.push_back( p.vNormal.y );
-                vertexData.push_back( p.vNormal.z );
-                vertexData.push_back( s );
-                vertexData.push_back( t );
-            };
-
-            // Triangle 1 (upper-left): v1, v2, v3
-            pushVertex( p00, texCoordS, texCoordT );
-            pushVertex( p10, texCoordSP1, texCoordT );
-            pushVertex( p01, texCoordS, texCoordTP1 );
-
-            // Triangle 2 (lower-right): v3, v2, v5
-            pushVertex( p01, texCoordS, texCoordTP1 );
-            pushVertex( p10, texCoordSP1, texCoordT );
-            pushVertex( p11, texCoordSP1, texCoordTP1 );
+void Terrain::BuildMesh()
+{
+    // One vertex per post, shared by the (up to) six triangles around it
+    std::vector<PackedLitVertex> vertexData( static_cast<size_t>( m_postsPerSide ) * m_postsPerSide );
+    for ( int ix = 0; ix < m_postsPerSide; ++ix )
+    {
+        for ( int iz = 0; iz < m_postsPerSide; ++iz )
+        {
+            const TerrainPost& post = m_postData[ix * m_postsPerSide + iz];
+            WritePostVertex( ix, iz, post.vPosition, post.vNormal, vertexData[ix * m_postsPerSide + iz] );
         }
     }
 
-    m_terrainMesh = Gfx().CreateMesh(
-        vertexData.data(),
-        totalVerts,
-        true, // hasNormals
-        true  // hasTexCoords
-    );
+    m_terrainMesh = TerrainTileCache::CreateGridMesh( vertexData.data(), m_postsPerSide );
+}
+
+
+void Terrain::WritePostVertex( int ix, int iz, const Vector3& position, const Vector3& normal, PackedLitVertex& out ) const
+{
+    // Position int-truncated, matching glVertex3i from the original display list.  Texcoords are (iz, ix) /
+    // postsPerSide * wrap: exact in half precision for the shipped map (15 repeats over 32 posts).
+    out.position[0] = static_cast<float>( static_cast<int>( position.x ) );
+    out.position[1] = static_cast<float>( static_cast<int>( position.y ) );
+    out.position[2] = static_cast<float>( static_cast<int>( position.z ) );
+    out.normal = PackNormal1010102( normal.x, normal.y, normal.z );
+    out.texCoord[0] = PackHalf( ( static_cast<float>( iz ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap );
+    out.texCoord[1] = PackHalf( ( static_cast<float>( ix ) / static_cast<float>( m_postsPerSide ) ) * m_textureWrap );
 }
 
 
 void Terrain::BuildFlatSlopeMesh()
 {
-    // Generate a 40x40 quad grid over [0,1000] x [0,1000]
+    // A 40x40 quad grid over [0,1000] x [0,1000]: 41x41 posts, vertex (xi, zi) at xi * 41 + zi
     // Height at each point: y = m_slopeBaseY + m_slopeX*x + m_slopeZ*z
     // Constant normal:       normalize(-m_slopeX, 1.0f, -m_slopeZ)
 
     const int gridN = 40;
+    const int postsPerSide = gridN + 1;
     const float gridMax = 1000.0f;
     const float step = gridMax / static_cast<float>( gridN );
     const float textureWrap = 8.0f;
 
     float nLen = sqrtf( m_slopeX * m_slopeX + 1.0f + m_slopeZ * m_slopeZ );
-    float nx = -m_slopeX / nLen;
-    float ny =  1.0f    / nLen;
-    float nz = -m_slopeZ / nLen;
-
-    int totalVerts = gridN * gridN * 6;
-    std::vector<float> vertexData;
-    vertexData.reserve( static_cast<size_t>( totalVerts ) * 8 );
-
-    auto pushVert = [&]( float x, float z )
-    {
-        float y = m_slopeBaseY + m_slopeX * x + m_slopeZ * z;
-        vertexData.push_back( x );
-        vertexData.push_back( y );
-        vertexData.push_back( z );
-        vertexData.push_back( nx );
-        vertexData.push_back( ny );
-        vertexData.push_back( nz );
-        vertexData.push_back( ( x / gridMax ) * textureWrap );
-        vertexData.push_back( ( z / gridMax ) * textureWrap );
-    };
+    uint32_t normal = PackNormal1010102( -m_slopeX / nLen, 1.0f / nLen, -m_slopeZ / nLen );
 
-    for ( int row = 0; row < gridN; ++row )
+    std::vector<PackedLitVertex> vertexData( static_cast<size_t>( postsPerSide ) * postsPerSide );
+    for ( int xi = 0; xi < postsPerSide; ++xi )
     {
-        for ( int col = 0; col < gridN; ++col )
+        for ( int zi = 0; zi < postsPerSide; ++zi )
         {
-            float x0 = col * step;
-            float x1 = x0 + step;
-            float z0 = row * step;
-            float z1 = z0 + step;
-
-            // Triangle 1 — CCW from above (+Y), front face up
-            pushVert( x0, z0 );
-            pushVert( x0, z1 );
-            pushVert( x1, z0 );
-
-            // Triangle 2 — CCW from above (+Y), front face up
-            pushVert( x0, z1 );
-            pushVert( x1, z1 );
-            pushVert( x1, z0 );
+            float x = xi * step;
+            float z = zi * step;
+            PackedLitVertex& vertex = vertexData[xi * postsPerSide + zi];
+            vertex.position[0] = x;
+            vertex.position[1] = m_slopeBaseY + m_slopeX * x + m_slopeZ * z;
+            vertex.position[2] = z;
+            vertex.normal = normal;
+            vertex.texCoord[0] = PackHalf( ( x / gridMax ) * textureWrap );
+            vertex.texCoord[1] = PackHalf( ( z / gridMax ) * textureWrap );
         }
     }
 
-    m_terrainMesh = Gfx().CreateMesh(
-        vertexData.data(),
-        totalVerts,
-        true,
-        true
-    );
+    // The grid's diagonal and winding match the original (x0,z0) (x0,z1) (x1,z0) / (x0,z1) (x1,z1) (x1,z0) quads
+    m_terrainMesh = TerrainTileCache::CreateGridMesh( vertexData.data(), postsPerSide );
 }
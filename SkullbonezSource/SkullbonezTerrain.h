@@ -7,6 +7,10 @@
 #include "SkullbonezMatrix4.h"
 #include "SkullbonezGeometricStructures.h"
 #include "SkullbonezGeometricMath.h"
+#include "SkullbonezCompactHeightfield.h"
+#include "SkullbonezHeightPyramid.h"
+#include "SkullbonezTerrainTileCache.h"
+#include "SkullbonezTerrainHorizon.h"
 #include "SkullbonezIMesh.h"
 #include "SkullbonezIShader.h"
 
@@ -24,6 +28,14 @@ namespace Geometry
 /* -- Terrain ----------------------------------------------------------------------------------------------------------------------------------------------------
 
     Represents a texturable terrain geometry that must be loaded from a .RAW file.  Also provides information to assist with collision detection.
+    Ray casts, sphere sweeps and region height bounds descend a min/max height pyramid, so queries well above the
+    ground are answered without touching individual polygons.  Sphere sweeps are continuous against every triangle
+    the swept volume reaches (faces, edges and posts), so fast or large spheres cannot tunnel between steps.
+    Deform edits heights in place and refreshes only what depends on them: the affected normals, pyramid nodes
+    and mesh quads, uploaded as one vertex sub-range per mesh row.  CheckAgainstRebuild verifies that against
+    the construction path (scene deform directives run it after their last edit).
+    Procedural terrain streams noise-generated tiles around the focus points passed to UpdateStreaming (see
+    TerrainTileCache).  Queries run against the resident tiles; only resident ground counts as in bounds.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class Terrain
 {
@@ -31,6 +43,7 @@ class Terrain
   public:
     Terrain( const char* sFileName, int iMapSize, int iStepSize, int iTextureWrap ); // Overloaded constructor: sFileName is path to .raw file, iMapSize is the size of map (pixels length), iStepSize is steps (pixel steps AND vertex steps), iTextureWrap is number of times to wrap texture
     Terrain( float slopeBaseY, float slopeX, float slopeZ );                         // Flat analytic slope constructor: y = slopeBaseY + slopeX*x + slopeZ*z
+    Terrain( uint32_t proceduralSeed );                                               // Procedural constructor: streamed fractal noise tiles (procedural_* config keys)
     ~Terrain();                                                                       // Default destructor
 
     void Render( const Matrix4& view, const Matrix4& projection, const float* lightPosition ); // Renders the terrain with shader
@@ -40,31 +53,63 @@ class Terrain
     float GetTerrainHeightAt( float xPosition, float zPosition, bool isFluidMin = false );     // Returns the height of the terrain at the specified coordinates
     Vector3 GetTerrainNormalAt( float xPosition, float zPosition );                            // Returns the surface normal of the terrain at the specified coordinates
 
+    float GetMaxHeightInRegion( float xMin, float zMin, float xMax, float zMax );                       // Upper bound of the terrain height over an XZ rectangle (clamped to the map, no polygon search)
+    void BuildHorizon( const Vector3& eye, TerrainHorizon& horizon );                                   // Render thread: fills horizon with the ground that can hide things from eye (disabled when it cannot be trusted)
+    bool Raycast( const Vector3& origin, const Vector3& direction, float maxT, TerrainHit& outHit );    // First hit of origin + direction * t for t in [0, maxT], seen from above
+    bool SweepSphere( const Vector3& center, float radius, const Vector3& motion, TerrainHit& outHit ); // First contact of a sphere moved by motion (time in [0, 1])
+
+    bool Deform( const Vector3& center, float radius, float delta );                             // Raises (delta > 0) or lowers the ground within radius of center in XZ with a smooth falloff; false if nothing changed
+    bool CheckAgainstRebuild();                                                                  // Debug: compares what Deform maintains in place with a full rebuild from the current heights; reports and returns false on a mismatch
+    void UpdateStreaming( const Vector3* focusPoints, int focusCount, bool isBlocking = false ); // Render thread, once a frame: streams procedural tiles around the focus points (no-op otherwise)
+
   private:
     UINT displayListReference;                // Reference to the display list (retained for fallback)
     std::unique_ptr<IMesh> m_terrainMesh;     // VBO mesh for m_shader rendering
     std::unique_ptr<IShader> m_terrainShader; // Lit+textured m_shader program
-    std::vector<TerrainPost> m_postData;      // Vertices that make up the m_terrain
+    UniformHandle m_uView;                    // Cached uniform handles (resolved after shader creation)
+    UniformHandle m_uProjection;
+    UniformHandle m_uLightPosition;
+    std::vector<TerrainPost> m_postData;      // Vertices that make up the m_terrain (construction only, released once m_heightfield is built)
     std::vector<BYTE> m_terrainData;          // Raw m_height map byte data (populated during construction, cleared after build)
+    const BYTE* m_heightMap;                  // Height map being built from: m_terrainData or the asset pack mapping
     int m_mapSize;                            // Size of map (pixels length)
     int m_stepSize;                           // Steps size between posts
     int m_textureWrap;                        // Number of times to wrap texture over m_terrain
     int m_postsPerSide;                       // Terrain postings per side of m_terrain
     int m_terrainSizeWorldCoords;             // size per side of m_terrain in world coordinates
 
+    CompactHeightfield m_heightfield; // Quantised posts read by all collision queries (height map mode)
+    HeightPyramid m_heightPyramid;    // Height range per cell and per block of cells (height map mode)
+    std::vector<float> m_postHeights; // Full-precision post heights: Deform accumulates here and rebuilds mesh ranges from them
+
     // Flat slope mode
     bool  m_isFlatSlope;
     float m_slopeBaseY;
     float m_slopeX;
     float m_slopeZ;
 
-    void LoadTerrainData( const char* sFileName );  // Loads terrain from .RAW file into terrainData member
+    // Procedural mode
+    bool m_isProcedural;
+    std::unique_ptr<TerrainTileCache> m_tileCache;
+
+    void LoadTerrainData( const char* sFileName );  // Points m_heightMap at the packed .RAW, or loads the file into terrainData
     void BuildTerrain();                            // Builds the terrain
     void TranslatePostings();                       // Translates terrain posts
     void GenerateNormals();                         // Generates normals for posts
     void BuildMesh();                               // Builds VBO mesh from post data
     void BuildFlatSlopeMesh();                      // Builds VBO mesh for analytic flat slope
     int GetPixelHeightAt( int xCoord, int yCoord ); // Returns the .raw height at the specified pixel coordinates
+    void LoadShader();                              // Creates the lit textured shader shared by every mode
+
+    struct SweepQuery;
+    bool Sweep( const Vector3& origin, float radius, const Vector3& motion, float maxTime, TerrainHit& outHit ); // Shared by Raycast (radius 0) and SweepSphere
+    void SweepNode( int level, int cx, int cz, SweepQuery& query );                                              // Visits a pyramid node, near children first
+    void SweepCell( int cx, int cz, SweepQuery& query );                                                         // Tests the two triangles of a cell
+    Triangle LocateProceduralPolygon( float xPosition, float zPosition );                                        // LocatePolygon for procedural mode (resident tile, or the noise itself)
+
+    Vector3 GetPostPosition( int ix, int iz ) const;                                                                    // World position of a post from m_postHeights (as TranslatePostings placed it)
+    Vector3 ComputePostNormal( int ix, int iz ) const;                                                                  // Post normal from its neighbours, with the same weights and order as GenerateNormals
+    void WritePostVertex( int ix, int iz, const Vector3& position, const Vector3& normal, PackedLitVertex& out ) const; // The mesh vertex of post (ix, iz)
 };
 } // namespace Geometry
 } // namespace SkullbonezCore
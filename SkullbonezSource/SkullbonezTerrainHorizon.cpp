@@ -0,0 +1,168 @@
+// --- Includes ---
+#include "SkullbonezTerrainHorizon.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Geometry;
+
+
+static constexpr float PI = 3.14159265358979f;
+static constexpr float COLUMN_WIDTH = 2.0f * PI / TerrainHorizon::COLUMN_COUNT; // Radians per azimuth column
+
+
+// Azimuth in [-pi, pi] -> fractional column coordinate in [0, COLUMN_COUNT]
+static float ToColumn( float angle )
+{
+    return ( angle + PI ) / COLUMN_WIDTH;
+}
+
+
+static int WrapColumn( int column )
+{
+    return ( ( column % TerrainHorizon::COLUMN_COUNT ) + TerrainHorizon::COLUMN_COUNT ) % TerrainHorizon::COLUMN_COUNT;
+}
+
+
+TerrainHorizon::TerrainHorizon()
+    : m_eyeX( 0.0f ), m_eyeY( 0.0f ), m_eyeZ( 0.0f ), m_bandSize( 1.0f ), m_isActive( false )
+{
+}
+
+
+void TerrainHorizon::Begin( const Vector3& eye, float range )
+{
+    m_eyeX = eye.x;
+    m_eyeY = eye.y;
+    m_eyeZ = eye.z;
+    m_bandSize = ( std::max )( range, 1.0f ) / BAND_COUNT;
+    m_isActive = false;
+    std::fill( m_slopes, m_slopes + COLUMN_COUNT * BAND_COUNT, -FLT_MAX );
+}
+
+
+void TerrainHorizon::AddOccluder( float xMin, float zMin, float xMax, float zMax, float groundY )
+{
+    // Nearest and farthest horizontal distance of the rectangle from the eye
+    float nearX = ( std::min )( ( std::max )( m_eyeX, xMin ), xMax ) - m_eyeX;
+    float nearZ = ( std::min )( ( std::max )( m_eyeZ, zMin ), zMax ) - m_eyeZ;
+    float nearDist = sqrtf( nearX * nearX + nearZ * nearZ );
+    if ( nearDist <= 0.0f )
+    {
+        return; // The eye is over the rectangle: its ground surrounds the eye rather than standing in front of it
+    }
+
+    float farX = ( std::max )( fabsf( xMin - m_eyeX ), fabsf( xMax - m_eyeX ) );
+    float farZ = ( std::max )( fabsf( zMin - m_eyeZ ), fabsf( zMax - m_eyeZ ) );
+    float farDist = sqrtf( farX * farX + farZ * farZ );
+    int band = static_cast<int>( farDist / m_bandSize );
+    if ( band >= BAND_COUNT )
+    {
+        return;
+    }
+
+    // Every direction through the rectangle meets ground at least groundY high somewhere in [nearDist, farDist]
+    float rise = groundY - m_eyeY;
+    float slope = rise / ( rise >= 0.0f ? farDist : nearDist );
+
+    // Angular extent of the corners around the direction of the centre (under pi, since the eye is outside)
+    float centreAngle = atan2f( ( zMin + zMax ) * 0.5f - m_eyeZ, ( xMin + xMax ) * 0.5f - m_eyeX );
+    float cornerX[4] = { xMin, xMax, xMin, xMax };
+    float cornerZ[4] = { zMin, zMin, zMax, zMax };
+    float lo = 0.0f;
+    float hi = 0.0f;
+    for ( int i = 0; i < 4; ++i )
+    {
+        float offset = atan2f( cornerZ[i] - m_eyeZ, cornerX[i] - m_eyeX ) - centreAngle;
+        if ( offset > PI )
+        {
+            offset -= 2.0f * PI;
+        }
+        else if ( offset < -PI )
+        {
+            offset += 2.0f * PI;
+        }
+        lo = ( std::min )( lo, offset );
+        hi = ( std::max )( hi, offset );
+    }
+
+    // Only columns lying wholly inside the extent are guaranteed to cross the rectangle
+    int first = static_cast<int>( ceilf( ToColumn( centreAngle + lo ) ) );
+    int last = static_cast<int>( floorf( ToColumn( centreAngle + hi ) ) ) - 1;
+    for ( int column = first; column <= last; ++column )
+    {
+        float& stored = m_slopes[WrapColumn( column ) * BAND_COUNT + band];
+        stored = ( std::max )( stored, slope );
+    }
+}
+
+
+void TerrainHorizon::End()
+{
+    // Ground within a nearer band is also within every farther one
+    for ( int column = 0; column < COLUMN_COUNT; ++column )
+    {
+        float* slopes = &m_slopes[column * BAND_COUNT];
+        for ( int band = 1; band < BAND_COUNT; ++band )
+        {
+            slopes[band] = ( std::max )( slopes[band], slopes[band - 1] );
+        }
+    }
+    m_isActive = true;
+}
+
+
+void TerrainHorizon::Disable()
+{
+    m_isActive = false;
+}
+
+
+bool TerrainHorizon::IsActive() const
+{
+    return m_isActive;
+}
+
+
+bool TerrainHorizon::IsSphereOccluded( float x, float y, float z, float r ) const
+{
+    if ( !m_isActive )
+    {
+        return false;
+    }
+
+    float dx = x - m_eyeX;
+    float dz = z - m_eyeZ;
+    float dist = sqrtf( dx * dx + dz * dz );
+    float nearDist = dist - r;
+    if ( nearDist <= 0.0f )
+    {
+        return false;
+    }
+
+    // Occluders must lie wholly nearer than the sphere: the last band whose far edge is within nearDist
+    int band = ( std::min )( static_cast<int>( nearDist / m_bandSize ) - 1, BAND_COUNT - 1 );
+    if ( band < 0 )
+    {
+        return false;
+    }
+
+    // Steepest slope from the eye to any point of the sphere
+    float rise = y + r - m_eyeY;
+    float slope = rise / ( rise >= 0.0f ? nearDist : dist + r );
+
+    float centreAngle = atan2f( dz, dx );
+    float halfWidth = asinf( r / dist );
+    int first = static_cast<int>( floorf( ToColumn( centreAngle - halfWidth ) ) );
+    int last = static_cast<int>( floorf( ToColumn( centreAngle + halfWidth ) ) );
+    for ( int column = first; column <= last; ++column )
+    {
+        if ( slope >= m_slopes[WrapColumn( column ) * BAND_COUNT + band] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
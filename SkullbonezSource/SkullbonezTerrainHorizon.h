@@ -0,0 +1,53 @@
+#pragma once
+
+
+// --- Includes ---
+#include "SkullbonezCommon.h"
+#include "SkullbonezVector3.h"
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Math::Vector;
+
+
+namespace SkullbonezCore
+{
+namespace Geometry
+{
+/* -- Terrain Horizon --------------------------------------------------------------------------------------------------------------------------------------------
+
+    Conservative occlusion by the ground, seen from one eye point.  Directions around the eye are split into
+    azimuth columns and horizontal distance into bands.  Each (column, band) holds the steepest elevation slope
+    (rise over horizontal distance from the eye) that solid ground is known to reach, along every direction of
+    the column, no farther out than the band's far edge.  Occluders are rectangles the ground never dips below
+    (terrain chunk minima).  Once End() has folded the bands front to back, a sphere is hidden when, in every
+    column it spans, its steepest point lies below ground that is nearer than all of it: a ray from an eye above
+    the ground to any point of the sphere must cross the surface first.  The eye must be above the ground and the
+    ground continuous between it and the occluders, which the caller (Terrain::BuildHorizon) checks.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class TerrainHorizon
+{
+
+  public:
+    static constexpr int COLUMN_COUNT = 256; // Azimuth columns around the eye
+    static constexpr int BAND_COUNT = 32;    // Distance bands out to the range
+
+  private:
+    float m_slopes[COLUMN_COUNT * BAND_COUNT]; // [column * BAND_COUNT + band]: steepest ground slope known within the band's far edge
+    float m_eyeX, m_eyeY, m_eyeZ;
+    float m_bandSize;  // Horizontal distance per band
+    bool m_isActive;   // End() has run since Begin() (false = nothing is occluded)
+
+  public:
+    TerrainHorizon();
+
+    void Begin( const Vector3& eye, float range );                                    // Clears the buffer for a new eye point; occluders farther than range are ignored
+    void AddOccluder( float xMin, float zMin, float xMax, float zMax, float groundY ); // The ground is at least groundY everywhere over the XZ rectangle
+    void End();                                                                       // Folds the bands front to back and enables queries
+    void Disable();                                                                   // Nothing is occluded until the next Begin() / End()
+
+    bool IsActive() const;
+    bool IsSphereOccluded( float x, float y, float z, float r ) const; // True only if the whole sphere is hidden behind the ground
+};
+} // namespace Geometry
+} // namespace SkullbonezCore
@@ -0,0 +1,434 @@
+// --- Includes ---
+#include "SkullbonezTerrainTileCache.h"
+#include "SkullbonezIRenderBackend.h"
+#include "SkullbonezConfig.h"
+#include <algorithm>
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Geometry;
+using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
+
+
+static constexpr float TEXTURE_REPEATS_PER_POST = 0.5f; // Close to the .raw map's 15 repeats over 32 posts; keeps tile texcoords exact in half precision
+
+
+// Lattice point hash (multiply-xorshift finaliser); every octave gets its own seed
+static uint32_t HashLattice( int x, int z, uint32_t seed )
+{
+    uint32_t h = seed ^ ( static_cast<uint32_t>( x ) * 0x8da6b343u ) ^ ( static_cast<uint32_t>( z ) * 0xd8163841u );
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+
+// 2D gradient noise in [-1, 1]: eight unit gradients on the integer lattice, quintic fade between them
+static float GradientNoise( float x, float z, uint32_t seed )
+{
+    static const float GRADIENTS[8][2] = {
+        { 1.0f, 0.0f }, { -1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.0f, -1.0f },
+        { 0.70710678f, 0.70710678f }, { -0.70710678f, 0.70710678f }, { 0.70710678f, -0.70710678f }, { -0.70710678f, -0.70710678f },
+    };
+
+    float floorX = floorf( x );
+    float floorZ = floorf( z );
+    int ix = static_cast<int>( floorX );
+    int iz = static_cast<int>( floorZ );
+    float dx = x - floorX;
+    float dz = z - floorZ;
+
+    auto corner = [&]( int cx, int cz )
+    {
+        const float* g = GRADIENTS[HashLattice( ix + cx, iz + cz, seed ) & 7];
+        return g[0] * ( dx - static_cast<float>( cx ) ) + g[1] * ( dz - static_cast<float>( cz ) );
+    };
+
+    float u = dx * dx * dx * ( dx * ( dx * 6.0f - 15.0f ) + 10.0f );
+    float v = dz * dz * dz * ( dz * ( dz * 6.0f - 15.0f ) + 10.0f );
+    float n0 = corner( 0, 0 ) + ( corner( 1, 0 ) - corner( 0, 0 ) ) * u;
+    float n1 = corner( 0, 1 ) + ( corner( 1, 1 ) - corner( 0, 1 ) ) * u;
+
+    // Unit gradients peak at sqrt(1/2) mid-cell; rescale to [-1, 1]
+    return ( n0 + ( n1 - n0 ) * v ) * 1.41421356f;
+}
+
+
+TerrainTileCache::TerrainTileCache( uint32_t seed )
+    : m_seed( seed ), m_frame( 0 ), m_isStopRequested( false )
+{
+    const SkullbonezConfig& cfg = Cfg();
+    m_cellsPerSide = ( std::max )( cfg.proceduralTileCells, 1 );
+    m_spacing = cfg.proceduralPostSpacing;
+    m_tileSize = static_cast<float>( m_cellsPerSide ) * m_spacing;
+    m_worldTiles = ( std::max )( cfg.proceduralWorldTiles, 1 );
+    m_heightBase = cfg.proceduralHeightBase;
+    m_heightAmplitude = cfg.proceduralHeightAmplitude;
+    m_frequency = 1.0f / cfg.proceduralFeatureSize;
+    m_octaves = ( std::max )( cfg.proceduralOctaves, 1 );
+
+    if ( m_spacing <= 0.0f || cfg.proceduralFeatureSize <= 0.0f )
+    {
+        throw std::runtime_error( "Procedural post spacing and feature size must be positive.  (TerrainTileCache::TerrainTileCache)" );
+    }
+
+    for ( int i = 0; i < cfg.proceduralWorkers; ++i )
+    {
+        m_workers.emplace_back( &TerrainTileCache::WorkerMain, this );
+    }
+}
+
+
+TerrainTileCache::~TerrainTileCache()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_jobLock );
+        m_isStopRequested = true;
+    }
+    m_jobQueued.notify_all();
+    for ( std::thread& worker : m_workers )
+    {
+        worker.join();
+    }
+}
+
+
+uint64_t TerrainTileCache::MakeKey( int tileX, int tileZ )
+{
+    return ( static_cast<uint64_t>( static_cast<uint32_t>( tileX ) ) << 32 ) | static_cast<uint32_t>( tileZ );
+}
+
+
+float TerrainTileCache::SampleHeight( int postX, int postZ ) const
+{
+    float x = static_cast<float>( postX ) * m_spacing * m_frequency;
+    float z = static_cast<float>( postZ ) * m_spacing * m_frequency;
+
+    // Fractal sum: each octave doubles the frequency and halves the amplitude
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float totalAmplitude = 0.0f;
+    for ( int octave = 0; octave < m_octaves; ++octave )
+    {
+        sum += amplitude * GradientNoise( x, z, m_seed + static_cast<uint32_t>( octave ) * 0x9e3779b9u );
+        totalAmplitude += amplitude;
+        amplitude *= 0.5f;
+        x *= 2.0f;
+        z *= 2.0f;
+    }
+
+    return m_heightBase + m_heightAmplitude * ( sum / totalAmplitude );
+}
+
+
+float TerrainTileCache::GetMaxPossibleHeight() const
+{
+    return m_heightBase + fabsf( m_heightAmplitude );
+}
+
+
+std::unique_ptr<TerrainTileCache::Tile> TerrainTileCache::GenerateTile( int tileX, int tileZ ) const
+{
+    auto tile = std::make_unique<Tile>();
+    tile->tileX = tileX;
+    tile->tileZ = tileZ;
+    tile->lastWantedFrame = 0;
+
+    // Heights with a one-post apron, so normals on the tile border see the neighbouring tile's posts
+    int posts = m_cellsPerSide + 1;
+    int apron = posts + 2;
+    int firstPostX = tileX * m_cellsPerSide;
+    int firstPostZ = tileZ * m_cellsPerSide;
+    std::vector<float> heights( static_cast<size_t>( apron ) * apron );
+    for ( int i = 0; i < apron; ++i )
+    {
+        for ( int j = 0; j < apron; ++j )
+        {
+            heights[i * apron + j] = SampleHeight( firstPostX + i - 1, firstPostZ + j - 1 );
+        }
+    }
+    auto heightAt = [&]( int ix, int iz )
+    { return heights[( ix + 1 ) * apron + iz + 1]; };
+
+    // Central-difference normals: built from heights alone, so both tiles of a border post get identical bits
+    std::vector<TerrainPost> postData( static_cast<size_t>( posts ) * posts );
+    for ( int ix = 0; ix < posts; ++ix )
+    {
+        for ( int iz = 0; iz < posts; ++iz )
+        {
+            TerrainPost& post = postData[ix * posts + iz];
+            post.vPosition.SetAll( static_cast<float>( ix ) * m_spacing, heightAt( ix, iz ), static_cast<float>( iz ) * m_spacing );
+            post.vNormal.SetAll( heightAt( ix - 1, iz ) - heightAt( ix + 1, iz ),
+                                 2.0f * m_spacing,
+                                 heightAt( ix, iz - 1 ) - heightAt( ix, iz + 1 ) );
+            post.vNormal.Normalise();
+        }
+    }
+
+    tile->heightfield.Build( postData, posts, m_spacing );
+    tile->pyramid.Build( tile->heightfield );
+
+    // Mesh: same vertex format, diagonal and winding as Terrain::BuildMesh, in world space.  X and Z come from
+    // global post indices so the shared border vertices of neighbouring tiles are bit-identical.  Texcoords
+    // drop whole repeats of the global post index (only its parity matters at half a repeat per post), so
+    // they stay small and exact in half precision anywhere in the world.
+    tile->vertices.resize( static_cast<size_t>( posts ) * posts );
+    float texCoordS0 = static_cast<float>( firstPostZ & 1 ) * TEXTURE_REPEATS_PER_POST;
+    float texCoordT0 = static_cast<float>( firstPostX & 1 ) * TEXTURE_REPEATS_PER_POST;
+    for ( int ix = 0; ix < posts; ++ix )
+    {
+        for ( int iz = 0; iz < posts; ++iz )
+        {
+            const TerrainPost& post = postData[ix * posts + iz];
+            PackedLitVertex& vertex = tile->vertices[ix * posts + iz];
+            vertex.position[0] = static_cast<float>( firstPostX + ix ) * m_spacing;
+            vertex.position[1] = post.vPosition.y;
+            vertex.position[2] = static_cast<float>( firstPostZ + iz ) * m_spacing;
+            vertex.normal = PackNormal1010102( post.vNormal.x, post.vNormal.y, post.vNormal.z );
+            vertex.texCoord[0] = PackHalf( texCoordS0 + static_cast<float>( iz ) * TEXTURE_REPEATS_PER_POST );
+            vertex.texCoord[1] = PackHalf( texCoordT0 + static_cast<float>( ix ) * TEXTURE_REPEATS_PER_POST );
+        }
+    }
+
+    return tile;
+}
+
+
+std::unique_ptr<IMesh> TerrainTileCache::CreateGridMesh( const PackedLitVertex* vertices, int postsPerSide )
+{
+    int vertexCount = postsPerSide * postsPerSide;
+    int indexCount = ( postsPerSide - 1 ) * ( postsPerSide - 1 ) * 6;
+    if ( vertexCount <= 65536 )
+    {
+        std::vector<uint16_t> indices( static_cast<size_t>( indexCount ) );
+        WriteGridIndices( postsPerSide, indices.data() );
+        return Gfx().CreateIndexedMesh( vertices, vertexCount, VertexFormat::Pos3_PackedNorm_HalfTex, indices.data(), indexCount, IndexFormat::UInt16 );
+    }
+
+    std::vector<uint32_t> indices( static_cast<size_t>( indexCount ) );
+    WriteGridIndices( postsPerSide, indices.data() );
+    return Gfx().CreateIndexedMesh( vertices, vertexCount, VertexFormat::Pos3_PackedNorm_HalfTex, indices.data(), indexCount, IndexFormat::UInt32 );
+}
+
+
+void TerrainTileCache::WorkerMain()
+{
+    for ( ;; )
+    {
+        uint64_t key;
+        {
+            std::unique_lock<std::mutex> lock( m_jobLock );
+            m_jobQueued.wait( lock, [this] { return m_isStopRequested || !m_requests.empty(); } );
+            if ( m_isStopRequested )
+            {
+                return;
+            }
+            key = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        std::unique_ptr<Tile> tile = GenerateTile( static_cast<int>( static_cast<uint32_t>( key >> 32 ) ),
+                                                   static_cast<int>( static_cast<uint32_t>( key ) ) );
+
+        std::lock_guard<std::mutex> lock( m_jobLock );
+        m_done.push_back( std::move( tile ) );
+    }
+}
+
+
+void TerrainTileCache::Publish( std::unique_ptr<Tile> tile )
+{
+    uint64_t key = MakeKey( tile->tileX, tile->tileZ );
+    if ( m_tiles.count( key ) )
+    {
+        return; // Generated inline by a blocking Update while the worker was still on it
+    }
+
+    tile->mesh = CreateGridMesh( tile->vertices.data(), m_cellsPerSide + 1 );
+    tile->vertices.clear();
+    tile->vertices.shrink_to_fit();
+    tile->lastWantedFrame = m_frame;
+
+    std::unique_lock<std::shared_mutex> lock( m_tableLock );
+    m_resident.push_back( tile.get() );
+    m_tiles.emplace( key, std::move( tile ) );
+}
+
+
+void TerrainTileCache::Evict( int keepCount )
+{
+    if ( static_cast<int>( m_resident.size() ) <= keepCount )
+    {
+        return;
+    }
+
+    // Least recently wanted first; tiles wanted this frame are never evicted, even over capacity
+    std::vector<Tile*> candidates;
+    for ( Tile* tile : m_resident )
+    {
+        if ( tile->lastWantedFrame < m_frame )
+        {
+            candidates.push_back( tile );
+        }
+    }
+    std::sort( candidates.begin(), candidates.end(), []( const Tile* a, const Tile* b ) { return a->lastWantedFrame < b->lastWantedFrame; } );
+
+    size_t evictCount = ( std::min )( candidates.size(), m_resident.size() - static_cast<size_t>( keepCount ) );
+    candidates.resize( evictCount );
+
+    std::unique_lock<std::shared_mutex> lock( m_tableLock );
+    for ( Tile* tile : candidates )
+    {
+        m_retired.push_back( { std::move( tile->mesh ), m_frame + RETIRE_FRAMES } );
+        m_resident.erase( std::find( m_resident.begin(), m_resident.end(), tile ) );
+        m_tiles.erase( MakeKey( tile->tileX, tile->tileZ ) );
+    }
+}
+
+
+void TerrainTileCache::Update( const Vector3* focusPoints, int focusCount, bool isBlocking )
+{
+    ++m_frame;
+
+    // Finished tiles first, so this frame's wanted set already counts them as resident
+    std::vector<std::unique_ptr<Tile>> done;
+    {
+        std::lock_guard<std::mutex> lock( m_jobLock );
+        done.swap( m_done );
+        for ( const auto& tile : done )
+        {
+            m_inFlight.erase( MakeKey( tile->tileX, tile->tileZ ) );
+        }
+    }
+    for ( auto& tile : done )
+    {
+        Publish( std::move( tile ) );
+    }
+
+    // Tiles touching the stream radius of any focus point, clamped to the world
+    float radius = Cfg().proceduralStreamRadius;
+    std::vector<std::pair<float, uint64_t>> missing;
+    for ( int i = 0; i < focusCount; ++i )
+    {
+        const Vector3& focus = focusPoints[i];
+        int tileXMin = ( std::max )( static_cast<int>( floorf( ( focus.x - radius ) / m_tileSize ) ), 0 );
+        int tileXMax = ( std::min )( static_cast<int>( floorf( ( focus.x + radius ) / m_tileSize ) ), m_worldTiles - 1 );
+        int tileZMin = ( std::max )( static_cast<int>( floorf( ( focus.z - radius ) / m_tileSize ) ), 0 );
+        int tileZMax = ( std::min )( static_cast<int>( floorf( ( focus.z + radius ) / m_tileSize ) ), m_worldTiles - 1 );
+
+        for ( int tileX = tileXMin; tileX <= tileXMax; ++tileX )
+        {
+            for ( int tileZ = tileZMin; tileZ <= tileZMax; ++tileZ )
+            {
+                // Distance from the focus to the tile's XZ rectangle
+                float dx = ( std::max )( ( std::max )( tileX * m_tileSize - focus.x, focus.x - ( tileX + 1 ) * m_tileSize ), 0.0f );
+                float dz = ( std::max )( ( std::max )( tileZ * m_tileSize - focus.z, focus.z - ( tileZ + 1 ) * m_tileSize ), 0.0f );
+                float distanceSquared = dx * dx + dz * dz;
+                if ( distanceSquared > radius * radius )
+                {
+                    continue;
+                }
+
+                auto found = m_tiles.find( MakeKey( tileX, tileZ ) );
+                if ( found != m_tiles.end() )
+                {
+                    found->second->lastWantedFrame = m_frame;
+                }
+                else
+                {
+                    missing.push_back( { distanceSquared, MakeKey( tileX, tileZ ) } );
+                }
+            }
+        }
+    }
+    std::sort( missing.begin(), missing.end() );
+
+    if ( isBlocking || m_workers.empty() )
+    {
+        for ( const auto& request : missing )
+        {
+            if ( !m_tiles.count( request.second ) )
+            {
+                Publish( GenerateTile( static_cast<int>( static_cast<uint32_t>( request.second >> 32 ) ),
+                                       static_cast<int>( static_cast<uint32_t>( request.second ) ) ) );
+            }
+        }
+    }
+    else
+    {
+        // Requests not started yet are replaced by this frame's list, so tiles that fell out of range are never built
+        std::lock_guard<std::mutex> lock( m_jobLock );
+        for ( uint64_t key : m_requests )
+        {
+            m_inFlight.erase( key );
+        }
+        m_requests.clear();
+        for ( const auto& request : missing )
+        {
+            if ( m_inFlight.insert( request.second ).second )
+            {
+                m_requests.push_back( request.second );
+            }
+        }
+    }
+    m_jobQueued.notify_all();
+
+    Evict( Cfg().proceduralTileCache );
+
+    // Meshes evicted a few frames ago are no longer referenced by any frame in flight
+    m_retired.erase( std::remove_if( m_retired.begin(), m_retired.end(), [this]( const RetiredMesh& retired ) { return retired.releaseFrame <= m_frame; } ),
+                     m_retired.end() );
+}
+
+
+const std::vector<TerrainTileCache::Tile*>& TerrainTileCache::GetResidentTiles() const
+{
+    return m_resident;
+}
+
+
+std::shared_lock<std::shared_mutex> TerrainTileCache::LockForRead() const
+{
+    return std::shared_lock<std::shared_mutex>( m_tableLock );
+}
+
+
+const TerrainTileCache::Tile* TerrainTileCache::FindTile( int tileX, int tileZ ) const
+{
+    auto found = m_tiles.find( MakeKey( tileX, tileZ ) );
+    return found != m_tiles.end() ? found->second.get() : nullptr;
+}
+
+
+float TerrainTileCache::GetSpacing() const
+{
+    return m_spacing;
+}
+
+
+float TerrainTileCache::GetTileSize() const
+{
+    return m_tileSize;
+}
+
+
+int TerrainTileCache::GetCellsPerSide() const
+{
+    return m_cellsPerSide;
+}
+
+
+int TerrainTileCache::GetWorldTiles() const
+{
+    return m_worldTiles;
+}
+
+
+size_t TerrainTileCache::GetResidentCount() const
+{
+    return m_resident.size();
+}
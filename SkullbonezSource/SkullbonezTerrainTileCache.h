@@ -0,0 +1,119 @@
+#pragma once
+
+
+// --- Includes ---
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "SkullbonezCommon.h"
+#include "SkullbonezVector3.h"
+#include "SkullbonezCompactHeightfield.h"
+#include "SkullbonezHeightPyramid.h"
+#include "SkullbonezIMesh.h"
+#include "SkullbonezVertexPacking.h"
+
+
+namespace SkullbonezCore
+{
+namespace Geometry
+{
+/* -- Terrain Tile Cache -----------------------------------------------------------------------------------------------------------------------------------------
+
+    Procedural terrain cut into square tiles of cells.  Heights are seeded fractal gradient noise sampled at
+    global post indices, so any post can be evaluated on its own and neighbouring tiles agree exactly on the
+    posts they share.  Tile (tx, tz) covers world [tx, tx + 1) * tileSize on X and Z.
+
+    Update() runs on the render thread once a frame: it hands finished tiles their render mesh, asks the worker
+    threads for missing tiles within the stream radius of each focus point (nearest first), and evicts the
+    least recently wanted tiles once more than the cache capacity are resident.  Evicted meshes are released a
+    few frames later, after the GPU has stopped drawing them.
+
+    Collision data (heightfield and pyramid) is immutable once a tile is published.  Queries from any thread
+    take LockForRead() and may then use FindTile() until the lock is released; Update() takes the lock
+    exclusively only to publish or evict tiles.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class TerrainTileCache
+{
+
+  public:
+    struct Tile
+    {
+        int tileX, tileZ;
+        CompactHeightfield heightfield; // Posts in tile-local coordinates (origin at the tile's minimum corner)
+        HeightPyramid pyramid;
+        std::vector<Rendering::PackedLitVertex> vertices; // One per post, released once the mesh is created
+        std::unique_ptr<Rendering::IMesh> mesh;           // Created on the render thread
+        int lastWantedFrame;
+    };
+
+  private:
+    static constexpr int RETIRE_FRAMES = 4; // Frames an evicted mesh outlives its tile (more than the frames in flight)
+
+    struct RetiredMesh
+    {
+        std::unique_ptr<Rendering::IMesh> mesh;
+        int releaseFrame;
+    };
+
+    // Generation parameters (fixed at construction)
+    uint32_t m_seed;
+    int m_cellsPerSide;
+    float m_spacing;
+    float m_tileSize;
+    int m_worldTiles;
+    float m_heightBase;
+    float m_heightAmplitude;
+    float m_frequency; // Of the broadest octave, per world unit
+    int m_octaves;
+
+    // Residency (written by the render thread; readers hold m_tableLock)
+    mutable std::shared_mutex m_tableLock;
+    std::unordered_map<uint64_t, std::unique_ptr<Tile>> m_tiles;
+    std::vector<Tile*> m_resident; // Same tiles, for iteration on the render thread
+    std::vector<RetiredMesh> m_retired;
+    int m_frame;
+
+    // Worker hand-off
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobLock;
+    std::condition_variable m_jobQueued;
+    std::deque<uint64_t> m_requests;           // Guarded by m_jobLock; rebuilt every Update, nearest first
+    std::unordered_set<uint64_t> m_inFlight;   // Guarded by m_jobLock; requested or being generated, not yet published
+    std::vector<std::unique_ptr<Tile>> m_done; // Guarded by m_jobLock
+    bool m_isStopRequested;
+
+    static uint64_t MakeKey( int tileX, int tileZ );
+    void WorkerMain();
+    std::unique_ptr<Tile> GenerateTile( int tileX, int tileZ ) const;
+    void Publish( std::unique_ptr<Tile> tile ); // Render thread: creates the mesh and inserts the tile
+    void Evict( int keepCount );                // Render thread: drops least recently wanted tiles not wanted this frame
+
+  public:
+    TerrainTileCache( uint32_t seed ); // Other parameters come from the procedural_* config keys
+    ~TerrainTileCache();               // Joins the workers
+
+    void Update( const Vector3* focusPoints, int focusCount, bool isBlocking ); // Render thread; isBlocking generates missing tiles inline
+    const std::vector<Tile*>& GetResidentTiles() const;                         // Render thread
+
+    std::shared_lock<std::shared_mutex> LockForRead() const;
+    const Tile* FindTile( int tileX, int tileZ ) const; // Caller holds LockForRead (or is the render thread); nullptr when not resident
+
+    static std::unique_ptr<Rendering::IMesh> CreateGridMesh( const Rendering::PackedLitVertex* vertices, int postsPerSide ); // Indexed mesh over a square post grid (WriteGridIndices layout); also used by Terrain
+
+    float SampleHeight( int postX, int postZ ) const; // Noise height at a global post index (tile-independent)
+    float GetMaxPossibleHeight() const;               // Upper bound of SampleHeight
+    float GetSpacing() const;
+    float GetTileSize() const;
+    int GetCellsPerSide() const;
+    int GetWorldTiles() const; // World extent in tiles per side, starting at tile 0
+    size_t GetResidentCount() const;
+};
+} // namespace Geometry
+} // namespace SkullbonezCore
@@ -1,5 +1,6 @@
 // --- Includes ---
 #include "SkullbonezTestScene.h"
+#include "SkullbonezAssetPack.h"
 #include <cstring>
 
 
@@ -22,6 +23,9 @@ TestScene::TestScene()
     m_legacyBallCount = 0;
     m_screenshotInterval = -1;
     m_screenshotDir[0] = '\0';
+    m_videoPath[0] = '\0';
+    m_videoStride = -1;
+    m_videoDownscale = 1;
     m_timeScale = 1.0f;
     m_isDebugVectors = false;
     m_trackHeight = -1.0f;
@@ -30,6 +34,8 @@ TestScene::TestScene()
     m_flatBaseY = 0.0f;
     m_flatSlopeX = 0.0f;
     m_flatSlopeZ = 0.0f;
+    m_hasProceduralTerrain = false;
+    m_proceduralSeed = 0;
 }
 
 
@@ -37,9 +43,8 @@ TestScene TestScene::LoadFromFile( const char* path )
 {
     TestScene scene;
 
-    FILE* file = nullptr;
-    errno_t err = fopen_s( &file, path, "r" );
-    if ( err != 0 || !file )
+    AssetTextReader file;
+    if ( !file.Open( path ) )
     {
         char msg[256];
         sprintf_s( msg, sizeof( msg ), "Failed to open scene file: %s  (TestScene::LoadFromFile)", path );
@@ -49,7 +54,7 @@ TestScene TestScene::LoadFromFile( const char* path )
     char line[512];
     int lineNumber = 0;
 
-    while ( fgets( line, sizeof( line ), file ) )
+    while ( file.ReadLine( line, sizeof( line ) ) )
     {
         ++lineNumber;
 
@@ -83,7 +88,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             }
             else
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid physics value at line %d: %s  (TestScene::LoadFromFile)", lineNumber, line + 8 );
                 throw std::runtime_error( msg );
@@ -104,7 +109,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             }
             else
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid text value at line %d: %s  (TestScene::LoadFromFile)", lineNumber, line + 5 );
                 throw std::runtime_error( msg );
@@ -124,7 +129,7 @@ TestScene TestScene::LoadFromFile( const char* path )
                 scene.m_frameCount = atoi( line + 7 );
                 if ( scene.m_frameCount <= 0 )
                 {
-                    fclose( file );
+                    file.Close();
                     char msg[256];
                     sprintf_s( msg, sizeof( msg ), "Invalid frame count at line %d: %s  (TestScene::LoadFromFile)", lineNumber, line + 7 );
                     throw std::runtime_error( msg );
@@ -143,7 +148,7 @@ TestScene TestScene::LoadFromFile( const char* path )
 
             if ( parsed != 3 || triggerValue <= 0 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid screenshot at line %d (expected: screenshot <path> frame|ms <N>)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -163,7 +168,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             }
             else
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid screenshot trigger '%s' at line %d (expected 'frame' or 'ms')  (TestScene::LoadFromFile)", triggerType, lineNumber );
                 throw std::runtime_error( msg );
@@ -177,7 +182,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             scene.m_seed = static_cast<unsigned int>( atoi( line + 5 ) );
             if ( scene.m_seed == 0 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid seed at line %d (must be > 0)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -191,7 +196,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             scene.m_legacyBallCount = atoi( line + 13 );
             if ( scene.m_legacyBallCount <= 0 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid legacy_balls count at line %d (must be > 0)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -229,7 +234,7 @@ TestScene TestScene::LoadFromFile( const char* path )
 
             if ( parsed != 2 || intervalFrames <= 0 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid screenshot_interval at line %d (expected: screenshot_interval <dir> <N>)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -240,12 +245,34 @@ TestScene TestScene::LoadFromFile( const char* path )
             continue;
         }
 
+        // parse capture_video directive: capture_video <path.y4m> <N> [downscale <D>]
+        if ( strncmp( line, "capture_video ", 14 ) == 0 )
+        {
+            char outPath[256] = {};
+            int strideFrames = 0;
+            int downscale = 1;
+            int parsed = sscanf_s( line + 14, "%255s %d downscale %d", outPath, static_cast<unsigned>( sizeof( outPath ) ), &strideFrames, &downscale );
+
+            if ( parsed < 2 || strideFrames <= 0 || downscale < 1 || downscale > 8 )
+            {
+                file.Close();
+                char msg[256];
+                sprintf_s( msg, sizeof( msg ), "Invalid capture_video at line %d (expected: capture_video <path> <N> [downscale 1-8])  (TestScene::LoadFromFile)", lineNumber );
+                throw std::runtime_error( msg );
+            }
+
+            strcpy_s( scene.m_videoPath, sizeof( scene.m_videoPath ), outPath );
+            scene.m_videoStride = strideFrames;
+            scene.m_videoDownscale = downscale;
+            continue;
+        }
+
         // parse camera line
         if ( strncmp( line, "camera ", 7 ) == 0 )
         {
             if ( static_cast<int>( scene.m_cameras.size() ) >= TOTAL_CAMERA_COUNT )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Too many cameras at line %d (max %d)  (TestScene::LoadFromFile)", lineNumber, TOTAL_CAMERA_COUNT );
                 throw std::runtime_error( msg );
@@ -258,7 +285,7 @@ TestScene TestScene::LoadFromFile( const char* path )
 
             if ( parsed != 10 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid camera at line %d (expected 10 fields, got %d)  (TestScene::LoadFromFile)", lineNumber, parsed );
                 throw std::runtime_error( msg );
@@ -293,7 +320,7 @@ TestScene TestScene::LoadFromFile( const char* path )
                 }
                 else if ( parsed != 8 )
                 {
-                    fclose( file );
+                    file.Close();
                     char msg[256];
                     sprintf_s( msg, sizeof( msg ), "Invalid ball at line %d (expected 8, 11, 14 or 17 fields, got %d)  (TestScene::LoadFromFile)", lineNumber, parsed );
                     throw std::runtime_error( msg );
@@ -310,7 +337,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             float val = static_cast<float>( atof( line + 11 ) );
             if ( val <= 0.0f )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid time_scale at line %d (must be > 0)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -332,7 +359,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             }
             else
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid debug_vectors value at line %d  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -346,7 +373,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             float val = static_cast<float>( atof( line + 13 ) );
             if ( val <= 0.0f )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid track_height at line %d (must be > 0)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -361,7 +388,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             float val = static_cast<float>( atof( line + 20 ) );
             if ( val <= 0.0f )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid auto_cycle_interval at line %d (must be > 0)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -377,7 +404,7 @@ TestScene TestScene::LoadFromFile( const char* path )
             int parsed = sscanf_s( line + 11, "%f %f %f", &baseY, &slopeX, &slopeZ );
             if ( parsed != 3 )
             {
-                fclose( file );
+                file.Close();
                 char msg[256];
                 sprintf_s( msg, sizeof( msg ), "Invalid flat_slope at line %d (expected: flat_slope <baseY> <slopeX> <slopeZ>)  (TestScene::LoadFromFile)", lineNumber );
                 throw std::runtime_error( msg );
@@ -389,14 +416,48 @@ TestScene TestScene::LoadFromFile( const char* path )
             continue;
         }
 
+        // parse procedural_terrain directive: procedural_terrain <seed>
+        if ( strncmp( line, "procedural_terrain ", 19 ) == 0 )
+        {
+            unsigned int seed = 0;
+            int parsed = sscanf_s( line + 19, "%u", &seed );
+            if ( parsed != 1 )
+            {
+                file.Close();
+                char msg[256];
+                sprintf_s( msg, sizeof( msg ), "Invalid procedural_terrain at line %d (expected: procedural_terrain <seed>)  (TestScene::LoadFromFile)", lineNumber );
+                throw std::runtime_error( msg );
+            }
+            scene.m_hasProceduralTerrain = true;
+            scene.m_proceduralSeed = seed;
+            continue;
+        }
+
+        // parse deform directive: deform <x> <z> <radius> <delta> [frames]
+        if ( strncmp( line, "deform ", 7 ) == 0 )
+        {
+            SceneDeform deform;
+            deform.frames = 1;
+            int parsed = sscanf_s( line + 7, "%f %f %f %f %d", &deform.x, &deform.z, &deform.radius, &deform.delta, &deform.frames );
+            if ( ( parsed != 4 && parsed != 5 ) || deform.radius <= 0.0f || deform.frames <= 0 )
+            {
+                file.Close();
+                char msg[256];
+                sprintf_s( msg, sizeof( msg ), "Invalid deform at line %d (expected: deform <x> <z> <radius> <delta> [frames], radius and frames > 0)  (TestScene::LoadFromFile)", lineNumber );
+                throw std::runtime_error( msg );
+            }
+            scene.m_deforms.push_back( deform );
+            continue;
+        }
+
         // unknown directive
-        fclose( file );
+        file.Close();
         char msg[256];
         sprintf_s( msg, sizeof( msg ), "Unknown directive at line %d: %.64s  (TestScene::LoadFromFile)", lineNumber, line );
         throw std::runtime_error( msg );
     }
 
-    fclose( file );
+    file.Close();
 
     // validate
     if ( scene.m_cameras.empty() )
@@ -486,6 +547,24 @@ const char* TestScene::GetScreenshotDir() const
 }
 
 
+const char* TestScene::GetVideoPath() const
+{
+    return m_videoPath;
+}
+
+
+int TestScene::GetVideoStride() const
+{
+    return m_videoStride;
+}
+
+
+int TestScene::GetVideoDownscale() const
+{
+    return m_videoDownscale;
+}
+
+
 int TestScene::GetCameraCount() const
 {
     return static_cast<int>( m_cameras.size() );
@@ -540,12 +619,30 @@ float TestScene::GetFlatSlopeZ() const
 }
 
 
+bool TestScene::HasProceduralTerrain() const
+{
+    return m_hasProceduralTerrain;
+}
+
+
+unsigned int TestScene::GetProceduralSeed() const
+{
+    return m_proceduralSeed;
+}
+
+
 int TestScene::GetBallCount() const
 {
     return static_cast<int>( m_balls.size() );
 }
 
 
+int TestScene::GetDeformCount() const
+{
+    return static_cast<int>( m_deforms.size() );
+}
+
+
 const SceneCamera& TestScene::GetCamera( int index ) const
 {
     if ( index < 0 || index >= static_cast<int>( m_cameras.size() ) )
@@ -566,3 +663,14 @@ const SceneBall& TestScene::GetBall( int index ) const
 
     return m_balls[index];
 }
+
+
+const SceneDeform& TestScene::GetDeform( int index ) const
+{
+    if ( index < 0 || index >= static_cast<int>( m_deforms.size() ) )
+    {
+        throw std::runtime_error( "Deform index out of range.  (TestScene::GetDeform)" );
+    }
+
+    return m_deforms[index];
+}
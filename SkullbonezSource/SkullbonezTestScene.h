@@ -37,6 +37,14 @@ struct SceneBall
     bool hasInitOrient;
 };
 
+struct SceneDeform
+{
+    float x, z;   // Centre of the edit in world XZ
+    float radius; // Falloff radius
+    float delta;  // Height change per frame at the centre (negative digs)
+    int frames;   // Frames the edit repeats for, starting with the first
+};
+
 /* -- Test Scene -------------------------------------------------------------------------------------------------------------------------------------------------
 
     Loads and holds a deterministic scene description from a .scene file.
@@ -60,6 +68,9 @@ class TestScene
     char m_rollLogPath[256];    // output path for roll orientation log (empty = none)
     int m_screenshotInterval;   // save screenshot every N frames (-1 = disabled)
     char m_screenshotDir[256];  // output directory for interval captures
+    char m_videoPath[256];      // output path for the streamed Y4M capture (empty = none)
+    int m_videoStride;          // capture every N frames into the video (-1 = disabled)
+    int m_videoDownscale;       // integer box-filter reduction applied to video frames (1 = full size)
     float m_timeScale;          // Physics time multiplier (1.0 = realtime)
     bool m_isDebugVectors;      // Draw velocity/omega debug arrows (default false)
     float m_trackHeight;        // Height above tracked ball for camera (-1 = no tracking)
@@ -68,8 +79,11 @@ class TestScene
     float m_flatBaseY;          // y = m_flatBaseY + m_flatSlopeX*x + m_flatSlopeZ*z
     float m_flatSlopeX;
     float m_flatSlopeZ;
+    bool m_hasProceduralTerrain;   // True when scene streams procedural noise terrain instead of the height map
+    unsigned int m_proceduralSeed; // Noise seed for the procedural terrain
     std::vector<SceneCamera> m_cameras;
     std::vector<SceneBall> m_balls;
+    std::vector<SceneDeform> m_deforms;
 
   public:
     TestScene();
@@ -88,6 +102,9 @@ class TestScene
     const char* GetRollLogPath() const;
     int GetScreenshotInterval() const;
     const char* GetScreenshotDir() const;
+    const char* GetVideoPath() const;
+    int GetVideoStride() const;
+    int GetVideoDownscale() const;
     float GetTimeScale() const;
     bool IsDebugVectors() const;
     float GetTrackHeight() const;        // Returns tracking camera height above ball (-1 = disabled)
@@ -96,10 +113,14 @@ class TestScene
     float GetFlatBaseY() const;
     float GetFlatSlopeX() const;
     float GetFlatSlopeZ() const;
+    bool HasProceduralTerrain() const; // True when scene specifies streamed procedural terrain
+    unsigned int GetProceduralSeed() const;
     int GetCameraCount() const;
     int GetBallCount() const;
+    int GetDeformCount() const;
     const SceneCamera& GetCamera( int index ) const;
     const SceneBall& GetBall( int index ) const;
+    const SceneDeform& GetDeform( int index ) const;
 };
 } // namespace Basics
 } // namespace SkullbonezCore
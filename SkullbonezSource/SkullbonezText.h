@@ -12,11 +12,16 @@ namespace Text
 {
 /* -- Text 2d ----------------------------------------------------------------------------------------------------------------------------------------------------
 
-    Provides a series of static methods to draw 2D text to the screen using a shader-based
-    font atlas. Replaces the legacy wglUseFontOutlines / display list approach.
+    Provides a series of static methods to draw 2D text to the screen using a signed-distance
+    font atlas (see FontAtlas), so every text size is drawn from the one small texture. Replaces
+    the legacy wglUseFontOutlines / display list approach.
 
     Coordinate space matches the legacy system: x/y positions are in the frustum-unit space
     at the near clip plane (FOV=45 degrees, aspect=screen_x/screen_y from engine.cfg).
+
+    Text and HUD quads are appended to one per-frame vertex stream with per-vertex colour and
+    submitted as a single overlay draw by FlushBatch().  A line whose text, position, size and
+    colour match the same call slot last frame copies last frame's vertices instead of rebuilding.
 -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
 class Text2d
 {
@@ -25,7 +30,7 @@ class Text2d
     inline static uint32_t fontTexture = 0;
     inline static uint32_t dynamicVB = 0;
     inline static std::unique_ptr<Rendering::IShader> pTextShader;
-    inline static std::unique_ptr<Rendering::IShader> pSolidShader;
+    inline static Rendering::UniformHandle uTextProjection = Rendering::UniformHandle::Invalid;
     inline static float charAdvance[96] = {};
 
     // NOTES: positioning is relational to centre of client rect
@@ -35,7 +40,8 @@ class Text2d
     static void Render2dText( float xPosition, float yPosition, float fSize, const char* cRawText, ... );                                 // Renders white text
     static void Render2dTextColor( float xPosition, float yPosition, float fSize, float r, float g, float b, const char* cRawText, ... ); // Renders colored text
     static void Render2dQuad( float x0, float y0, float x1, float y1, float r, float g, float b, float a );                               // Renders a flat-coloured 2D HUD quad
-    static void BuildFont( const HDC hDC, const char* cFontName );                                                                        // Builds font atlas into GL texture
+    static void FlushBatch();                                                                                                             // Submits the frame's text and quads as one overlay draw
+    static void BuildFont( const HDC hDC, const char* cFontName );                                                                        // Loads (or bakes) the font atlas into a texture
     static void DeleteFont();                                                                                                             // Releases GL font resources
 };
 } // namespace Text
@@ -1,12 +1,14 @@
 // --- Includes ---
 #include "SkullbonezTextureCollection.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezAssetPack.h"
 #include "stb_image.h"
 
 
 // --- Usings ---
 using namespace SkullbonezCore::Textures;
 using namespace SkullbonezCore::Rendering;
+using namespace SkullbonezCore::Basics;
 
 
 TextureCollection::TextureCollection()
@@ -128,6 +130,12 @@ void TextureCollection::SelectTexture( uint32_t hash )
 }
 
 
+uint32_t TextureCollection::GetTextureHandle( uint32_t hash )
+{
+    return m_textureArray[FindIndex( hash )];
+}
+
+
 void TextureCollection::CreateJpegTexture( const char* cFileName,
                                            uint32_t hash )
 {
@@ -138,6 +146,16 @@ void TextureCollection::CreateJpegTexture( const char* cFileName,
 
     m_textureHashes[m_nextAvailableTextureIndex] = hash;
 
+    // Packed textures are pre-decoded with their mip chain -- hand the mapping straight to the backend
+    const AssetPack& pack = AssetPack::Instance();
+    const AssetPackEntry* entry = pack.Find( cFileName );
+    if ( entry && entry->type == AssetType::Texture )
+    {
+        m_textureArray[m_nextAvailableTextureIndex] = Gfx().CreateTexture2DMips( pack.GetData( *entry ), entry->width, entry->height, entry->channels, entry->mipCount, true );
+        UpdateCounters();
+        return;
+    }
+
     // Load image via stb_image (supports JPEG, PNG, BMP, etc.)
     int width = 0;
     int height = 0;
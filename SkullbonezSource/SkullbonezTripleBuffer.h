@@ -0,0 +1,72 @@
+#pragma once
+
+
+// --- Includes ---
+#include <atomic>
+#include <cstdint>
+
+
+namespace SkullbonezCore
+{
+namespace Basics
+{
+/* -- Triple Buffer ----------------------------------------------------------------------------------------------------------------------------------------------
+
+    Lock-free hand-off of the latest value from one writer thread to one reader thread.  Each side owns one
+    of three slots; the third sits in the middle and is swapped atomically.  Publish() never waits for the
+    reader and Acquire() never waits for the writer; the reader always sees the newest complete value and
+    intermediate values it did not get round to are dropped.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+template <typename T>
+class TripleBuffer
+{
+
+  private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T m_slots[3];
+    std::atomic<uint8_t> m_middle; // Shared slot index; FRESH_BIT set while the reader has not taken it
+    uint8_t m_back;                // Writer's slot
+    uint8_t m_front;               // Reader's slot
+
+  public:
+    TripleBuffer()
+        : m_middle( 1 ), m_back( 0 ), m_front( 2 )
+    {
+    }
+
+    TripleBuffer( const TripleBuffer& ) = delete;
+    TripleBuffer& operator=( const TripleBuffer& ) = delete;
+
+    // Writer: fill this slot completely, then Publish()
+    T& GetWriteBuffer()
+    {
+        return m_slots[m_back];
+    }
+
+    void Publish()
+    {
+        uint8_t previous = m_middle.exchange( static_cast<uint8_t>( m_back | FRESH_BIT ), std::memory_order_acq_rel );
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Reader: switch to the newest published slot; false when nothing newer has been published
+    bool Acquire()
+    {
+        if ( !( m_middle.load( std::memory_order_relaxed ) & FRESH_BIT ) )
+        {
+            return false;
+        }
+        uint8_t previous = m_middle.exchange( m_front, std::memory_order_acq_rel );
+        m_front = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& GetReadBuffer() const
+    {
+        return m_slots[m_front];
+    }
+};
+} // namespace Basics
+} // namespace SkullbonezCore
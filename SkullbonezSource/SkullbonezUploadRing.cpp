@@ -0,0 +1,70 @@
+// --- Includes ---
+#include "SkullbonezUploadRing.h"
+
+
+// --- Usings ---
+using namespace SkullbonezCore::Rendering;
+
+
+UploadRing::UploadRing()
+    : m_regionBytes( 0 ), m_head( 0 ), m_region( 0 )
+{
+}
+
+
+void UploadRing::Reset( uint32_t regionBytes )
+{
+    m_regionBytes = regionBytes;
+    m_head = 0;
+}
+
+
+bool UploadRing::Allocate( uint32_t bytes, uint32_t& outOffset )
+{
+    uint32_t aligned = ( m_head + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+    if ( aligned + bytes > m_regionBytes )
+    {
+        return false;
+    }
+
+    outOffset = static_cast<uint32_t>( m_region ) * m_regionBytes + aligned;
+    m_head = aligned + bytes;
+    return true;
+}
+
+
+uint32_t UploadRing::GetGrownRegionBytes( uint32_t bytes ) const
+{
+    uint32_t grown = m_regionBytes ? m_regionBytes * 2 : INITIAL_REGION_BYTES;
+    while ( grown < bytes + ALIGNMENT )
+    {
+        grown *= 2;
+    }
+    return grown;
+}
+
+
+int UploadRing::Advance()
+{
+    m_region = ( m_region + 1 ) % FRAME_REGIONS;
+    m_head = 0;
+    return m_region;
+}
+
+
+int UploadRing::GetRegion() const
+{
+    return m_region;
+}
+
+
+uint32_t UploadRing::GetRegionBytes() const
+{
+    return m_regionBytes;
+}
+
+
+uint32_t UploadRing::GetBufferBytes() const
+{
+    return m_regionBytes * FRAME_REGIONS;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+
+// --- Includes ---
+#include <cstdint>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+/* -- Upload Ring ------------------------------------------------------------------------------------------------------------------------------------------------
+
+    Offset bookkeeping for the backends' streaming vertex buffers (instance data, dynamic vertices).  The
+    buffer is split into FRAME_REGIONS equal regions, one per frame in flight; a frame bump-allocates from its
+    own region, the backend fences the region at Present() and waits on that fence before the region comes
+    round again.  When a frame outgrows its region the backend replaces the buffer with a larger one and
+    keeps the old one alive until the frame's work has been submitted.  Holds no GPU objects.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+class UploadRing
+{
+
+  public:
+    static constexpr int FRAME_REGIONS = 3;                      // Frames of space: CPU writing, GPU reading, one in the queue
+    static constexpr uint32_t ALIGNMENT = 16;                    // Span start alignment in bytes
+    static constexpr uint32_t INITIAL_REGION_BYTES = 256 * 1024; // Per frame; grows on demand
+
+  private:
+    uint32_t m_regionBytes; // Size of one frame's region
+    uint32_t m_head;        // Next free byte within the current region
+    int m_region;           // Region the current frame allocates from
+
+  public:
+    UploadRing();
+
+    void Reset( uint32_t regionBytes );                   // A new buffer was created: keep the region index, empty the head
+    bool Allocate( uint32_t bytes, uint32_t& outOffset ); // Buffer-relative offset; false when the region is full
+    uint32_t GetGrownRegionBytes( uint32_t bytes ) const; // Doubled region size that also fits a request of this size
+    int Advance();                                        // End of frame: move to the next region and return its index
+
+    int GetRegion() const;
+    uint32_t GetRegionBytes() const;
+    uint32_t GetBufferBytes() const;
+};
+} // namespace Rendering
+} // namespace SkullbonezCore
@@ -0,0 +1,130 @@
+#pragma once
+
+
+// --- Includes ---
+#include <cstdint>
+#include <cstring>
+
+
+namespace SkullbonezCore
+{
+namespace Rendering
+{
+/* -- Vertex Packing ---------------------------------------------------------------------------------------------------------------------------------------------
+
+    CPU-side encoders for the packed attributes of VertexFormat::Pos3_PackedNorm_HalfTex and HalfPos_UNormTex,
+    the matching vertex structs, and the index pattern of the square post grids the terrain meshes use.  The GPU expands every packed attribute back to float on fetch:
+    half floats as is, 10:10:10:2 and 16-bit values as unsigned normalised [0, 1].  Normals are stored biased
+    (n * 0.5 + 0.5) because neither DXGI nor GL 3.3 core pairs 10:10:10:2 with signed normalisation on both
+    APIs, so shaders fed packed normals decode them with n * 2 - 1.
+-----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+struct PackedLitVertex
+{
+    float position[3];    // World units (half precision would shift terrain posts by up to half a unit)
+    uint32_t normal;      // PackNormal1010102
+    uint16_t texCoord[2]; // PackHalf
+};
+
+
+struct PackedUnlitVertex
+{
+    uint16_t position[4]; // PackHalf; w is padding (DXGI has no three-component 16-bit format)
+    uint16_t texCoord[2]; // PackUNorm16
+};
+
+
+static_assert( sizeof( PackedLitVertex ) == 20, "PackedLitVertex must match VertexFormat::Pos3_PackedNorm_HalfTex" );
+static_assert( sizeof( PackedUnlitVertex ) == 12, "PackedUnlitVertex must match VertexFormat::HalfPos_UNormTex" );
+
+
+// IEEE 754 binary16, round to nearest even; overflow saturates to infinity, tiny values flush to zero
+inline uint16_t PackHalf( float value )
+{
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+
+    uint32_t sign = ( bits >> 16 ) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>( ( bits >> 23 ) & 0xffu ) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if ( ( ( bits >> 23 ) & 0xffu ) == 0xffu )
+    {
+        return static_cast<uint16_t>( sign | 0x7c00u | ( mantissa ? 0x200u : 0u ) ); // Inf / NaN
+    }
+    if ( exponent >= 31 )
+    {
+        return static_cast<uint16_t>( sign | 0x7c00u );
+    }
+    if ( exponent <= 0 )
+    {
+        if ( exponent < -10 )
+        {
+            return static_cast<uint16_t>( sign );
+        }
+        // Subnormal half: shift the implicit leading one in
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>( 14 - exponent );
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ( ( 1u << shift ) - 1u );
+        uint32_t halfway = 1u << ( shift - 1 );
+        if ( remainder > halfway || ( remainder == halfway && ( half & 1u ) ) )
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>( sign | half );
+    }
+
+    uint32_t half = ( static_cast<uint32_t>( exponent ) << 10 ) | ( mantissa >> 13 );
+    uint32_t remainder = mantissa & 0x1fffu;
+    if ( remainder > 0x1000u || ( remainder == 0x1000u && ( half & 1u ) ) )
+    {
+        ++half; // A carry into the exponent is still the correctly rounded value
+    }
+    return static_cast<uint16_t>( sign | half );
+}
+
+
+// [0, 1] -> 16-bit unsigned normalised
+inline uint16_t PackUNorm16( float value )
+{
+    value = value < 0.0f ? 0.0f : ( value > 1.0f ? 1.0f : value );
+    return static_cast<uint16_t>( value * 65535.0f + 0.5f );
+}
+
+
+// Unit vector -> biased 10:10:10:2 unsigned normalised (x in the low bits, w = 0)
+inline uint32_t PackNormal1010102( float x, float y, float z )
+{
+    auto encode = []( float component )
+    {
+        float biased = component * 0.5f + 0.5f;
+        biased = biased < 0.0f ? 0.0f : ( biased > 1.0f ? 1.0f : biased );
+        return static_cast<uint32_t>( biased * 1023.0f + 0.5f );
+    };
+    return encode( x ) | ( encode( y ) << 10 ) | ( encode( z ) << 20 );
+}
+
+
+// Triangle list over a postsPerSide^2 grid whose vertex (row, col) is row * postsPerSide + col: per cell
+// (row, col), (row, col + 1), (row + 1, col) then (row + 1, col), (row, col + 1), (row + 1, col + 1).
+// Writes (postsPerSide - 1)^2 * 6 indices; Index must be able to hold postsPerSide^2 - 1.
+template <typename Index>
+inline void WriteGridIndices( int postsPerSide, Index* out )
+{
+    for ( int row = 0; row + 1 < postsPerSide; ++row )
+    {
+        for ( int col = 0; col + 1 < postsPerSide; ++col )
+        {
+            Index corner = static_cast<Index>( row * postsPerSide + col );
+            Index below = static_cast<Index>( corner + postsPerSide );
+            *out++ = corner;
+            *out++ = static_cast<Index>( corner + 1 );
+            *out++ = below;
+            *out++ = below;
+            *out++ = static_cast<Index>( corner + 1 );
+            *out++ = static_cast<Index>( below + 1 );
+        }
+    }
+}
+} // namespace Rendering
+} // namespace SkullbonezCore
@@ -1,6 +1,7 @@
 // --- Includes ---
 #include "SkullbonezWorldEnvironment.h"
 #include "SkullbonezIRenderBackend.h"
+#include "SkullbonezRenderQueue.h"
 #include <vector>
 
 
@@ -51,27 +52,28 @@ void WorldEnvironment::RenderFluid( const Matrix4& view, const Matrix4& proj, co
         BuildFluidMesh();
     }
 
-    Gfx().SetBlend( true );
-    Gfx().BindTexture( reflectionTex, 1 );
+    RenderState state;
+    state.blend = true;
+    RenderQueue& queue = RenderQueue::Instance();
 
     // --- calm (inner) pass: flat, always reflective, no waves ---
-    m_calmShader->Use();
-    m_calmShader->SetMat4( "uView", view );
-    m_calmShader->SetMat4( "uProjection", proj );
-    m_calmShader->SetMat4( "uReflectVP", reflectVP );
-    m_calmMesh->Draw();
+    queue.Begin( RenderLayer::Transparent, m_calmShader.get(), state );
+    queue.SetTexture( 1, reflectionTex );
+    queue.SetMat4( m_calmView, view );
+    queue.SetMat4( m_calmProjection, proj );
+    queue.SetMat4( m_calmReflectVP, reflectVP );
+    queue.DrawMesh( m_calmMesh.get() );
 
     // --- ocean (outer) pass: vertex displacement + UV perturbation ---
-    m_oceanShader->Use();
-    m_oceanShader->SetMat4( "uView", view );
-    m_oceanShader->SetMat4( "uProjection", proj );
-    m_oceanShader->SetMat4( "uReflectVP", reflectVP );
-    m_oceanShader->SetFloat( "uTime", time );
-    m_oceanShader->SetInt( "uNoReflect", noReflect ? 1 : 0 );
-    m_oceanShader->SetInt( "uFlatWater", flatWater ? 1 : 0 );
-    m_oceanMesh->Draw();
-
-    Gfx().SetBlend( false );
+    queue.Begin( RenderLayer::Transparent, m_oceanShader.get(), state );
+    queue.SetTexture( 1, reflectionTex );
+    queue.SetMat4( m_oceanView, view );
+    queue.SetMat4( m_oceanProjection, proj );
+    queue.SetMat4( m_oceanReflectVP, reflectVP );
+    queue.SetFloat( m_oceanTime, time );
+    queue.SetInt( m_oceanNoReflect, noReflect ? 1 : 0 );
+    queue.SetInt( m_oceanFlatWater, flatWater ? 1 : 0 );
+    queue.DrawMesh( m_oceanMesh.get() );
 }
 
 
@@ -93,10 +95,29 @@ void WorldEnvironment::BuildFluidMesh()
     float calmZMin = czMid - czHalf;
     float calmZMax = czMid + czHalf;
 
-    std::vector<float> calmVerts;
-    std::vector<float> oceanVerts;
-    calmVerts.reserve( N * N * 6 * 3 );
-    oceanVerts.reserve( N * N * 6 * 3 );
+    // Each mesh holds only the grid posts its own quads use; a post shared by both keeps a copy in each
+    struct FluidGrid
+    {
+        std::vector<float> vertices;
+        std::vector<uint16_t> indices;
+        std::vector<int> postVertex; // Grid post -> vertex index in this mesh, -1 until used
+    };
+    FluidGrid calm, ocean;
+    calm.postVertex.assign( ( N + 1 ) * ( N + 1 ), -1 );
+    ocean.postVertex.assign( ( N + 1 ) * ( N + 1 ), -1 );
+
+    auto addPost = [&]( FluidGrid& grid, int row, int col )
+    {
+        int& vertex = grid.postVertex[row * ( N + 1 ) + col];
+        if ( vertex < 0 )
+        {
+            vertex = static_cast<int>( grid.vertices.size() / 3 );
+            grid.vertices.push_back( -f + static_cast<float>( col ) * step );
+            grid.vertices.push_back( h );
+            grid.vertices.push_back( -f + static_cast<float>( row ) * step );
+        }
+        grid.indices.push_back( static_cast<uint16_t>( vertex ) );
+    };
 
     for ( int row = 0; row < N; ++row )
     {
@@ -111,35 +132,24 @@ void WorldEnvironment::BuildFluidMesh()
             bool isCalm = ( x0 >= calmXMin && x1 <= calmXMax &&
                             z0 >= calmZMin && z1 <= calmZMax );
 
-            std::vector<float>& v = isCalm ? calmVerts : oceanVerts;
-
-            v.push_back( x0 );
-            v.push_back( h );
-            v.push_back( z0 );
-            v.push_back( x0 );
-            v.push_back( h );
-            v.push_back( z1 );
-            v.push_back( x1 );
-            v.push_back( h );
-            v.push_back( z1 );
-
-            v.push_back( x0 );
-            v.push_back( h );
-            v.push_back( z0 );
-            v.push_back( x1 );
-            v.push_back( h );
-            v.push_back( z1 );
-            v.push_back( x1 );
-            v.push_back( h );
-            v.push_back( z0 );
+            FluidGrid& grid = isCalm ? calm : ocean;
+
+            // (x0,z0) (x0,z1) (x1,z1), then (x0,z0) (x1,z1) (x1,z0)
+            addPost( grid, row, col );
+            addPost( grid, row + 1, col );
+            addPost( grid, row + 1, col + 1 );
+
+            addPost( grid, row, col );
+            addPost( grid, row + 1, col + 1 );
+            addPost( grid, row, col + 1 );
         }
     }
 
-    int calmCount = static_cast<int>( calmVerts.size() ) / 3;
-    int oceanCount = static_cast<int>( oceanVerts.size() ) / 3;
-
-    m_calmMesh = Gfx().CreateMesh( calmVerts.data(), calmCount, false, false );
-    m_oceanMesh = Gfx().CreateMesh( oceanVerts.data(), oceanCount, false, false );
+    // Float positions: the grid spans +/- frustumFar, well beyond where half precision holds whole units
+    m_calmMesh = Gfx().CreateIndexedMesh( calm.vertices.data(), static_cast<int>( calm.vertices.size() / 3 ), VertexFormat::Pos3,
+                                          calm.indices.data(), static_cast<int>( calm.indices.size() ), IndexFormat::UInt16 );
+    m_oceanMesh = Gfx().CreateIndexedMesh( ocean.vertices.data(), static_cast<int>( ocean.vertices.size() / 3 ), VertexFormat::Pos3,
+                                           ocean.indices.data(), static_cast<int>( ocean.indices.size() ), IndexFormat::UInt16 );
 
     m_calmShader = Gfx().CreateShader( "SkullbonezData/shaders/water_calm.vert", "SkullbonezData/shaders/water_calm.frag" );
     m_calmShader->Use();
@@ -147,6 +157,9 @@ void WorldEnvironment::BuildFluidMesh()
     m_calmShader->SetVec4( "uColorTint", 0.05f, 0.15f, 0.42f, 0.65f );
     m_calmShader->SetFloat( "uReflectionStrength", 0.35f );
     m_calmShader->SetInt( "uReflectionTex", 1 );
+    m_calmView = m_calmShader->GetUniformHandle( "uView" );
+    m_calmProjection = m_calmShader->GetUniformHandle( "uProjection" );
+    m_calmReflectVP = m_calmShader->GetUniformHandle( "uReflectVP" );
 
     m_oceanShader = Gfx().CreateShader( "SkullbonezData/shaders/water_ocean.vert", "SkullbonezData/shaders/water_ocean.frag" );
     m_oceanShader->Use();
@@ -156,6 +169,12 @@ void WorldEnvironment::BuildFluidMesh()
     m_oceanShader->SetFloat( "uPerturbStrength", Cfg().oceanPerturbStrength );
     m_oceanShader->SetFloat( "uReflectionStrength", 0.25f );
     m_oceanShader->SetInt( "uReflectionTex", 1 );
+    m_oceanView = m_oceanShader->GetUniformHandle( "uView" );
+    m_oceanProjection = m_oceanShader->GetUniformHandle( "uProjection" );
+    m_oceanReflectVP = m_oceanShader->GetUniformHandle( "uReflectVP" );
+    m_oceanTime = m_oceanShader->GetUniformHandle( "uTime" );
+    m_oceanNoReflect = m_oceanShader->GetUniformHandle( "uNoReflect" );
+    m_oceanFlatWater = m_oceanShader->GetUniformHandle( "uFlatWater" );
 }
 
 
@@ -59,6 +59,17 @@ class WorldEnvironment
     std::unique_ptr<IMesh> m_oceanMesh; // Outer water: waves + perturbation
     std::unique_ptr<IShader> m_oceanShader;
 
+    // Cached uniform handles (resolved in BuildFluidMesh)
+    UniformHandle m_calmView = UniformHandle::Invalid;
+    UniformHandle m_calmProjection = UniformHandle::Invalid;
+    UniformHandle m_calmReflectVP = UniformHandle::Invalid;
+    UniformHandle m_oceanView = UniformHandle::Invalid;
+    UniformHandle m_oceanProjection = UniformHandle::Invalid;
+    UniformHandle m_oceanReflectVP = UniformHandle::Invalid;
+    UniformHandle m_oceanTime = UniformHandle::Invalid;
+    UniformHandle m_oceanNoReflect = UniformHandle::Invalid;
+    UniformHandle m_oceanFlatWater = UniformHandle::Invalid;
+
     void BuildFluidMesh(); // Builds calm and ocean meshes
 
     float CalculateGravity( float objectMass );                                                                                              // returns Y-component representing Newtons of gravity acting on object